@@ -0,0 +1,522 @@
+/*
+ *  Copyright (C) 2026 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* Checks the output layout on random topologies, without an X server.
+ * The layouts come from the g_test_rand_*() helpers, so a failure can be
+ * reproduced with the seed the test prints.  Run with "-m perf" to also
+ * time the snapping while dragging.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "display-layout.h"
+
+
+
+/* motion events per benchmark run */
+#define BENCHMARK_MOTIONS (10000)
+
+
+
+static void
+layout_rand_size (XfceLayoutRect *rect)
+{
+    rect->width = g_test_rand_int_range (640, 2561);
+    rect->height = g_test_rand_int_range (480, 1601);
+}
+
+
+
+static gboolean
+layout_overlaps (const XfceLayoutRect *rects,
+                 guint                 n_rects,
+                 const XfceLayoutRect *rect)
+{
+    guint i;
+
+    for (i = 0; i < n_rects; ++i)
+    {
+        if (rect->x < rects[i].x + rects[i].width
+            && rects[i].x < rect->x + rect->width
+            && rect->y < rects[i].y + rects[i].height
+            && rects[i].y < rect->y + rect->height)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+
+/* n outputs of random sizes, each one put against a random side of a
+ * random previous one at a random offset, so the layout is aligned but
+ * the corners of the outputs rarely line up */
+static XfceLayoutRect *
+layout_aligned_new (guint n)
+{
+    XfceLayoutRect *rects;
+    XfceLayoutRect *rect;
+    XfceLayoutRect *other;
+    guint           i;
+
+    rects = g_new (XfceLayoutRect, n);
+
+    for (i = 0; i < n; ++i)
+    {
+        rect = &rects[i];
+        layout_rand_size (rect);
+
+        if (i == 0)
+        {
+            rect->x = g_test_rand_int_range (-4000, 4000);
+            rect->y = g_test_rand_int_range (-4000, 4000);
+            continue;
+        }
+
+        do
+        {
+            other = &rects[g_test_rand_int_range (0, i)];
+
+            switch (g_test_rand_int_range (0, 4))
+            {
+                case 0: /* right */
+                    rect->x = other->x + other->width;
+                    rect->y = other->y + g_test_rand_int_range (-rect->height, other->height + 1);
+                    break;
+
+                case 1: /* left */
+                    rect->x = other->x - rect->width;
+                    rect->y = other->y + g_test_rand_int_range (-rect->height, other->height + 1);
+                    break;
+
+                case 2: /* below */
+                    rect->x = other->x + g_test_rand_int_range (-rect->width, other->width + 1);
+                    rect->y = other->y + other->height;
+                    break;
+
+                default: /* above */
+                    rect->x = other->x + g_test_rand_int_range (-rect->width, other->width + 1);
+                    rect->y = other->y - rect->height;
+                    break;
+            }
+        }
+        while (layout_overlaps (rects, i, rect));
+    }
+
+    return rects;
+}
+
+
+
+/* n outputs of random sizes anywhere, most likely detached or
+ * overlapping each other */
+static XfceLayoutRect *
+layout_scattered_new (guint n)
+{
+    XfceLayoutRect *rects;
+    guint           i;
+
+    rects = g_new (XfceLayoutRect, n);
+
+    for (i = 0; i < n; ++i)
+    {
+        layout_rand_size (&rects[i]);
+        rects[i].x = g_test_rand_int_range (-8000, 8000);
+        rects[i].y = g_test_rand_int_range (-8000, 8000);
+    }
+
+    return rects;
+}
+
+
+
+static gboolean
+reference_overlap (gint s1,
+                   gint e1,
+                   gint s2,
+                   gint e2)
+{
+    return (!(e1 < s2 || s1 >= e2));
+}
+
+
+
+static void
+reference_try_snap (XfceLayoutRect *rects,
+                    guint           n_rects,
+                    gint            dx,
+                    gint            dy,
+                    gint           *best)
+{
+    XfceLayoutRect  rect = rects[n_rects - 1];
+    gint            distance = MAX (ABS (dx), ABS (dy));
+
+    if (ABS (dx) > XFCE_LAYOUT_SNAP_DISTANCE && ABS (dy) > XFCE_LAYOUT_SNAP_DISTANCE)
+        return;
+
+    if (*best >= 0 && distance >= *best)
+        return;
+
+    rects[n_rects - 1].x += dx;
+    rects[n_rects - 1].y += dy;
+
+    if (xfce_layout_is_aligned (rects, n_rects))
+        *best = distance;
+
+    rects[n_rects - 1] = rect;
+}
+
+
+
+/* distance of the nearest snap of the last output that leaves the
+ * layout aligned, found by trying every snap between the corners and
+ * edges of the last output and those of the others, -1 if none does */
+static gint
+reference_snap_distance (XfceLayoutRect *rects,
+                         guint           n_rects)
+{
+    XfceLayoutRect *rect = &rects[n_rects - 1];
+    XfceLayoutRect *other;
+    gint            xs[2] = { rect->x, rect->x + rect->width };
+    gint            ys[2] = { rect->y, rect->y + rect->height };
+    gint            other_xs[2], other_ys[2];
+    gint            best = -1;
+    guint           i, j, k, l, m;
+
+    for (i = 0; i + 1 < n_rects; ++i)
+    {
+        other = &rects[i];
+        other_xs[0] = other->x;
+        other_xs[1] = other->x + other->width;
+        other_ys[0] = other->y;
+        other_ys[1] = other->y + other->height;
+
+        for (j = 0; j < 2; ++j)
+        {
+            for (k = 0; k < 2; ++k)
+            {
+                /* horizontal and vertical edges */
+                if (reference_overlap (xs[0], xs[1], other_xs[0], other_xs[1]))
+                    reference_try_snap (rects, n_rects, 0, other_ys[k] - ys[j], &best);
+                if (reference_overlap (ys[0], ys[1], other_ys[0], other_ys[1]))
+                    reference_try_snap (rects, n_rects, other_xs[k] - xs[j], 0, &best);
+
+                /* corners */
+                for (l = 0; l < 2; ++l)
+                    for (m = 0; m < 2; ++m)
+                        reference_try_snap (rects, n_rects, other_xs[l] - xs[j],
+                                            other_ys[m] - ys[k], &best);
+            }
+        }
+    }
+
+    return best;
+}
+
+
+
+static void
+test_aligned (void)
+{
+    XfceLayoutRect *rects;
+    XfceLayoutRect  corner[2];
+    guint           n, i;
+
+    for (n = 1; n <= 16; ++n)
+    {
+        for (i = 0; i < 10; ++i)
+        {
+            rects = layout_aligned_new (n);
+            g_assert (xfce_layout_is_aligned (rects, n));
+
+            if (n > 1)
+            {
+                /* an output detached from the others */
+                rects[n - 1].x += 100000;
+                g_assert (!xfce_layout_is_aligned (rects, n));
+
+                /* an output overlapping another one */
+                rects[n - 1].x = rects[0].x + 1;
+                rects[n - 1].y = rects[0].y + 1;
+                g_assert (!xfce_layout_is_aligned (rects, n));
+            }
+
+            g_free (rects);
+        }
+    }
+
+    /* touching in a corner is enough */
+    layout_rand_size (&corner[0]);
+    layout_rand_size (&corner[1]);
+    corner[0].x = g_test_rand_int_range (-4000, 4000);
+    corner[0].y = g_test_rand_int_range (-4000, 4000);
+    corner[1].x = corner[0].x + corner[0].width;
+    corner[1].y = corner[0].y + corner[0].height;
+    g_assert (xfce_layout_is_aligned (corner, 2));
+}
+
+
+
+static void
+test_snap (void)
+{
+    XfceLayoutSnapper *snapper;
+    XfceLayoutRect    *rects;
+    XfceLayoutRect     origin;
+    XfceLayoutRect     rect;
+    gint               x2, y2;
+    gint               distance;
+    guint              n, i, j;
+
+    for (n = 2; n <= 12; ++n)
+    {
+        for (i = 0; i < 20; ++i)
+        {
+            /* the last output is dragged, the others stay put; some
+             * layouts are not aligned to begin with */
+            rects = (i % 4 == 0) ? layout_scattered_new (n) : layout_aligned_new (n);
+            snapper = xfce_layout_snapper_new (rects, n - 1);
+            origin = rects[n - 1];
+
+            for (j = 0; j < 10; ++j)
+            {
+                rects[n - 1] = origin;
+                rects[n - 1].x += g_test_rand_int_range (-2 * XFCE_LAYOUT_SNAP_DISTANCE,
+                                                         2 * XFCE_LAYOUT_SNAP_DISTANCE);
+                rects[n - 1].y += g_test_rand_int_range (-2 * XFCE_LAYOUT_SNAP_DISTANCE,
+                                                         2 * XFCE_LAYOUT_SNAP_DISTANCE);
+
+                /* the snapper finds the nearest snap every snap is tried for */
+                distance = reference_snap_distance (rects, n);
+
+                rect = rects[n - 1];
+                if (xfce_layout_snapper_snap (snapper, &rect))
+                {
+                    g_assert_cmpint (MAX (ABS (rect.x - rects[n - 1].x),
+                                          ABS (rect.y - rects[n - 1].y)), ==, distance);
+
+                    rects[n - 1] = rect;
+                    g_assert (xfce_layout_is_aligned (rects, n));
+                }
+                else
+                {
+                    g_assert_cmpint (distance, ==, -1);
+                    g_assert_cmpint (rect.x, ==, rects[n - 1].x);
+                    g_assert_cmpint (rect.y, ==, rects[n - 1].y);
+                }
+            }
+
+            /* too far away from every other output */
+            x2 = y2 = G_MININT;
+            for (j = 0; j + 1 < n; ++j)
+            {
+                x2 = MAX (x2, rects[j].x + rects[j].width);
+                y2 = MAX (y2, rects[j].y + rects[j].height);
+            }
+            rect = origin;
+            rect.x = x2 + 2 * XFCE_LAYOUT_SNAP_DISTANCE;
+            rect.y = y2 + 2 * XFCE_LAYOUT_SNAP_DISTANCE;
+            g_assert (!xfce_layout_snapper_snap (snapper, &rect));
+            g_assert_cmpint (rect.x, ==, x2 + 2 * XFCE_LAYOUT_SNAP_DISTANCE);
+            g_assert_cmpint (rect.y, ==, y2 + 2 * XFCE_LAYOUT_SNAP_DISTANCE);
+
+            xfce_layout_snapper_free (snapper);
+            g_free (rects);
+        }
+    }
+}
+
+
+
+static void
+test_mirror_state (void)
+{
+    gulong   modes[3] = { 1, 1, 0 };
+    gboolean mirrored[3] = { TRUE, TRUE, FALSE };
+
+    /* the output that is off does not count */
+    g_assert_cmpint (xfce_layout_get_mirror_state (modes, mirrored, 3, 1), ==, XFCE_LAYOUT_CLONED);
+
+    /* no mode the outputs share */
+    g_assert_cmpint (xfce_layout_get_mirror_state (modes, mirrored, 3, 0), ==, XFCE_LAYOUT_NOT_MIRRORED);
+
+    /* a single output */
+    g_assert_cmpint (xfce_layout_get_mirror_state (modes, mirrored, 1, 1), ==, XFCE_LAYOUT_NOT_MIRRORED);
+
+    /* mirrored in different modes */
+    modes[1] = 2;
+    g_assert_cmpint (xfce_layout_get_mirror_state (modes, mirrored, 3, 1), ==, XFCE_LAYOUT_MIRRORED);
+
+    /* extended */
+    mirrored[0] = mirrored[1] = FALSE;
+    g_assert_cmpint (xfce_layout_get_mirror_state (modes, mirrored, 3, 1), ==, XFCE_LAYOUT_NOT_MIRRORED);
+}
+
+
+
+static void
+test_lay_out_horizontally (void)
+{
+    XfceLayoutRect rects[8];
+    gboolean       on[8];
+    gint           x, end;
+    guint          n, i;
+
+    for (n = 1; n <= G_N_ELEMENTS (rects); ++n)
+    {
+        /* the outputs that are on in a row, the others at the origin */
+        for (i = 0, x = 0; i < n; ++i)
+        {
+            layout_rand_size (&rects[i]);
+            on[i] = (i == 0 || g_test_rand_int_range (0, 2) == 1);
+            rects[i].x = on[i] ? x : 0;
+            rects[i].y = 0;
+            if (on[i])
+                x += rects[i].width;
+        }
+
+        xfce_layout_lay_out_horizontally (rects, on, n);
+
+        for (i = 0, end = 0; i < n; ++i)
+        {
+            if (on[i])
+                end = rects[i].x + rects[i].width;
+        }
+
+        /* the outputs that are off follow in order */
+        for (i = 0; i < n; ++i)
+        {
+            if (on[i])
+                continue;
+
+            g_assert_cmpint (rects[i].x, ==, end);
+            g_assert_cmpint (rects[i].y, ==, 0);
+            end += rects[i].width;
+        }
+
+        g_assert (xfce_layout_is_aligned (rects, n));
+    }
+}
+
+
+
+static void
+test_normalize (void)
+{
+    XfceLayoutRect *rects;
+    XfceLayoutRect  rects_copy[6];
+    gint            min_x = G_MAXINT, min_y = G_MAXINT;
+    gint            max_x = G_MININT, max_y = G_MININT;
+    gint            width, height;
+    guint           i;
+
+    rects = layout_scattered_new (6);
+
+    for (i = 0; i < 6; ++i)
+    {
+        rects_copy[i] = rects[i];
+        min_x = MIN (min_x, rects[i].x);
+        min_y = MIN (min_y, rects[i].y);
+        max_x = MAX (max_x, rects[i].x + rects[i].width);
+        max_y = MAX (max_y, rects[i].y + rects[i].height);
+    }
+
+    g_assert (xfce_layout_normalize (rects, 6, &width, &height) == (min_x != 0 || min_y != 0));
+    g_assert_cmpint (width, ==, max_x - min_x);
+    g_assert_cmpint (height, ==, max_y - min_y);
+
+    /* the outputs keep their places relative to each other */
+    for (i = 0; i < 6; ++i)
+    {
+        g_assert_cmpint (rects[i].x, ==, rects_copy[i].x - min_x);
+        g_assert_cmpint (rects[i].y, ==, rects_copy[i].y - min_y);
+    }
+
+    /* already at the origin */
+    g_assert (!xfce_layout_normalize (rects, 6, NULL, NULL));
+
+    /* nothing to lay out */
+    g_assert (!xfce_layout_normalize (rects, 0, &width, &height));
+    g_assert_cmpint (width, ==, 0);
+    g_assert_cmpint (height, ==, 0);
+
+    g_free (rects);
+}
+
+
+
+static void
+test_snap_benchmark (void)
+{
+    XfceLayoutSnapper *snapper;
+    XfceLayoutRect    *rects;
+    XfceLayoutRect     rect;
+    guint              n, i;
+    gdouble            elapsed = 0.0;
+
+    for (n = 2; n <= 32; n *= 2)
+    {
+        rects = layout_aligned_new (n);
+
+        g_test_timer_start ();
+
+        /* one snapper per drag, one snap per motion event */
+        snapper = xfce_layout_snapper_new (rects, n - 1);
+        for (i = 0; i < BENCHMARK_MOTIONS; ++i)
+        {
+            rect = rects[n - 1];
+            rect.x += (gint) (i % 300) - 150;
+            rect.y += (gint) (i % 200) - 100;
+            xfce_layout_snapper_snap (snapper, &rect);
+        }
+        xfce_layout_snapper_free (snapper);
+
+        elapsed = g_test_timer_elapsed ();
+        g_test_message ("%u outputs: %.2f us per motion event",
+                        n, elapsed * 1e6 / BENCHMARK_MOTIONS);
+
+        g_free (rects);
+    }
+
+    g_test_minimized_result (elapsed * 1e6 / BENCHMARK_MOTIONS,
+                             "%.2f us per motion event with %u outputs",
+                             elapsed * 1e6 / BENCHMARK_MOTIONS, n / 2);
+}
+
+
+
+gint
+main (gint argc, gchar **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/display-layout/aligned", test_aligned);
+    g_test_add_func ("/display-layout/snap", test_snap);
+    g_test_add_func ("/display-layout/mirror-state", test_mirror_state);
+    g_test_add_func ("/display-layout/lay-out-horizontally", test_lay_out_horizontally);
+    g_test_add_func ("/display-layout/normalize", test_normalize);
+
+    if (g_test_perf ())
+        g_test_add_func ("/display-layout/snap-benchmark", test_snap_benchmark);
+
+    return g_test_run ();
+}
@@ -0,0 +1,855 @@
+/*
+ *  Copyright (C) 2026 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* Layout of the outputs on plain rectangles: snapping of a dragged
+ * output against the outputs that stay put, mirror detection, placement
+ * of the outputs that are off and normalization.  None of this needs an
+ * X server, so xfsettingsd and the layout test share it with the dialog.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "display-layout.h"
+
+
+
+typedef struct _Edge Edge;
+typedef struct _Snap Snap;
+
+struct _Edge
+{
+    /* index of the rectangle, -1 for the dragged one */
+    gint rect;
+    gint x1, y1;
+    gint x2, y2;
+};
+
+struct _Snap
+{
+    gint dx;
+    gint dy;
+};
+
+struct _XfceLayoutSnapper
+{
+    /* rectangles that do not move */
+    GArray   *rects;
+
+    /* their horizontal edges sorted by y, vertical edges sorted by x
+     * and all edges sorted by the x and y of their first corner */
+    GArray   *h_edges;
+    GArray   *v_edges;
+    GArray   *corners_x;
+    GArray   *corners_y;
+
+    /* rectangles not aligned among themselves, the dragged one has to
+     * align them */
+    GArray   *unaligned;
+
+    /* whether the rectangles overlap each other */
+    gboolean  overlapping;
+
+    /* bounding box of the rectangles */
+    gint      x1, y1;
+    gint      x2, y2;
+
+    /* edges of the dragged rectangle and of one unaligned rectangle */
+    GArray   *rect_edges;
+    GArray   *scratch;
+
+    /* snaps within one range of distances */
+    GArray   *snaps;
+};
+
+
+
+static gboolean
+xfce_layout_rect_intersects (const XfceLayoutRect *rect1,
+                             const XfceLayoutRect *rect2)
+{
+    return (rect1->x < rect2->x + rect2->width
+            && rect2->x < rect1->x + rect1->width
+            && rect1->y < rect2->y + rect2->height
+            && rect2->y < rect1->y + rect1->height);
+}
+
+
+
+static void
+xfce_layout_add_edge (GArray *edges,
+                      gint    rect,
+                      gint    x1,
+                      gint    y1,
+                      gint    x2,
+                      gint    y2)
+{
+    Edge e;
+
+    e.rect = rect;
+    e.x1 = x1;
+    e.y1 = y1;
+    e.x2 = x2;
+    e.y2 = y2;
+
+    g_array_append_val (edges, e);
+}
+
+
+
+static void
+xfce_layout_list_edges (const XfceLayoutRect *rect,
+                        gint                  index,
+                        GArray               *edges)
+{
+    gint x = rect->x, y = rect->y;
+    gint w = rect->width, h = rect->height;
+
+    /* Top, Bottom, Left, Right */
+    xfce_layout_add_edge (edges, index, x, y, x + w, y);
+    xfce_layout_add_edge (edges, index, x, y + h, x + w, y + h);
+    xfce_layout_add_edge (edges, index, x, y, x, y + h);
+    xfce_layout_add_edge (edges, index, x + w, y, x + w, y + h);
+}
+
+
+
+static gboolean
+xfce_layout_overlap (gint s1,
+                     gint e1,
+                     gint s2,
+                     gint e2)
+{
+    return (!(e1 < s2 || s1 >= e2));
+}
+
+
+
+static gboolean
+xfce_layout_is_corner_snap (const Snap *s)
+{
+    return s->dx != 0 && s->dy != 0;
+}
+
+
+
+static gint
+xfce_layout_compare_snaps (gconstpointer v1,
+                           gconstpointer v2)
+{
+    const Snap *s1 = v1;
+    const Snap *s2 = v2;
+    gint        sv1 = MAX (ABS (s1->dx), ABS (s1->dy));
+    gint        sv2 = MAX (ABS (s2->dx), ABS (s2->dy));
+
+    if (sv1 != sv2)
+        return sv1 - sv2;
+
+    /* prefer corner snaps at the same distance; this is good enough, but
+     * corner snapping now depends on the distance in an axis that you
+     * cannot actually see, a horizontal/vertical snap followed by a
+     * corner snap from the new coordinates would be better */
+    if (xfce_layout_is_corner_snap (s1) && !xfce_layout_is_corner_snap (s2))
+        return -1;
+    else if (xfce_layout_is_corner_snap (s2) && !xfce_layout_is_corner_snap (s1))
+        return 1;
+
+    return 0;
+}
+
+
+
+static gboolean
+xfce_layout_corner_on_edge (gint        x,
+                            gint        y,
+                            const Edge *e)
+{
+    if (x == e->x1 && x == e->x2 && y >= e->y1 && y <= e->y2)
+        return TRUE;
+
+    if (y == e->y1 && y == e->y2 && x >= e->x1 && x <= e->x2)
+        return TRUE;
+
+    return FALSE;
+}
+
+
+
+static gboolean
+xfce_layout_edges_align (const Edge *e1,
+                         const Edge *e2)
+{
+    return (xfce_layout_corner_on_edge (e1->x1, e1->y1, e2)
+            || xfce_layout_corner_on_edge (e2->x1, e2->y1, e1));
+}
+
+
+
+static gboolean
+xfce_layout_rect_is_aligned (gint    rect,
+                             GArray *edges)
+{
+    guint i, j;
+
+    for (i = 0; i < edges->len; ++i)
+    {
+        Edge *rect_edge = &g_array_index (edges, Edge, i);
+
+        if (rect_edge->rect != rect)
+            continue;
+
+        /* we are aligned if an edge matches an edge of another rectangle */
+        for (j = 0; j < edges->len; ++j)
+        {
+            Edge *edge = &g_array_index (edges, Edge, j);
+
+            if (edge->rect != rect && xfce_layout_edges_align (rect_edge, edge))
+                return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+
+
+static gint
+xfce_layout_compare_edges_x (gconstpointer v1,
+                             gconstpointer v2)
+{
+    const Edge *e1 = v1;
+    const Edge *e2 = v2;
+
+    return e1->x1 - e2->x1;
+}
+
+
+
+static gint
+xfce_layout_compare_edges_y (gconstpointer v1,
+                             gconstpointer v2)
+{
+    const Edge *e1 = v1;
+    const Edge *e2 = v2;
+
+    return e1->y1 - e2->y1;
+}
+
+
+
+/* first edge in the sorted array whose x1 (or y1) is not below value */
+static guint
+xfce_layout_lower_bound (GArray   *edges,
+                         gboolean  by_x,
+                         gint      value)
+{
+    guint lo = 0, hi = edges->len, mid;
+    Edge *e;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        e = &g_array_index (edges, Edge, mid);
+
+        if ((by_x ? e->x1 : e->y1) < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+
+
+static void
+xfce_layout_add_snap (GArray *snaps,
+                      gint    dx,
+                      gint    dy,
+                      gint    min_distance,
+                      gint    max_distance)
+{
+    Snap snap;
+    gint distance = MAX (ABS (dx), ABS (dy));
+
+    if (distance <= min_distance || distance > max_distance)
+        return;
+
+    /* never snap further than the snap distance on both axes */
+    if (ABS (dx) > XFCE_LAYOUT_SNAP_DISTANCE && ABS (dy) > XFCE_LAYOUT_SNAP_DISTANCE)
+        return;
+
+    snap.dx = dx;
+    snap.dy = dy;
+
+    g_array_append_val (snaps, snap);
+}
+
+
+
+/* sorted snaps of rect whose distance is above min_distance and up to
+ * max_distance; only the static edges that close to the edges of rect
+ * are visited, the corner snaps come from the ends of the horizontal
+ * edges, which are the corners of the static rectangles */
+static void
+xfce_layout_snapper_list_snaps (XfceLayoutSnapper    *snapper,
+                                const XfceLayoutRect *rect,
+                                gint                  min_distance,
+                                gint                  max_distance)
+{
+    gint  xs[2] = { rect->x, rect->x + rect->width };
+    gint  ys[2] = { rect->y, rect->y + rect->height };
+    gint  dx, dy;
+    guint i, j, k;
+    Edge *e;
+
+    g_array_set_size (snapper->snaps, 0);
+
+    for (j = 0; j < G_N_ELEMENTS (ys); ++j)
+    {
+        for (i = xfce_layout_lower_bound (snapper->h_edges, FALSE, ys[j] - max_distance);
+             i < snapper->h_edges->len; ++i)
+        {
+            e = &g_array_index (snapper->h_edges, Edge, i);
+            dy = e->y1 - ys[j];
+            if (dy > max_distance)
+                break;
+
+            if (xfce_layout_overlap (xs[0], xs[1], e->x1, e->x2))
+                xfce_layout_add_snap (snapper->snaps, 0, dy, min_distance, max_distance);
+
+            for (k = 0; k < G_N_ELEMENTS (xs); ++k)
+            {
+                xfce_layout_add_snap (snapper->snaps, e->x1 - xs[k], dy, min_distance, max_distance);
+                xfce_layout_add_snap (snapper->snaps, e->x2 - xs[k], dy, min_distance, max_distance);
+            }
+        }
+    }
+
+    for (k = 0; k < G_N_ELEMENTS (xs); ++k)
+    {
+        for (i = xfce_layout_lower_bound (snapper->v_edges, TRUE, xs[k] - max_distance);
+             i < snapper->v_edges->len; ++i)
+        {
+            e = &g_array_index (snapper->v_edges, Edge, i);
+            dx = e->x1 - xs[k];
+            if (dx > max_distance)
+                break;
+
+            if (xfce_layout_overlap (ys[0], ys[1], e->y1, e->y2))
+                xfce_layout_add_snap (snapper->snaps, dx, 0, min_distance, max_distance);
+        }
+    }
+
+    g_array_sort (snapper->snaps, xfce_layout_compare_snaps);
+}
+
+
+
+/* whether the corner lies on one of the sorted edges */
+static gboolean
+xfce_layout_corner_on_edges (GArray   *edges,
+                             gboolean  by_x,
+                             gint      x,
+                             gint      y)
+{
+    gint  key = by_x ? x : y;
+    guint i;
+    Edge *e;
+
+    for (i = xfce_layout_lower_bound (edges, by_x, key); i < edges->len; ++i)
+    {
+        e = &g_array_index (edges, Edge, i);
+
+        if ((by_x ? e->x1 : e->y1) != key)
+            break;
+
+        if (xfce_layout_corner_on_edge (x, y, e))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+
+/* whether the first corner of one of the sorted edges lies on edge */
+static gboolean
+xfce_layout_corners_on_edge (GArray     *corners,
+                             gboolean    by_x,
+                             const Edge *edge)
+{
+    gint  key = by_x ? edge->x1 : edge->y1;
+    guint i;
+    Edge *c;
+
+    for (i = xfce_layout_lower_bound (corners, by_x, key); i < corners->len; ++i)
+    {
+        c = &g_array_index (corners, Edge, i);
+
+        if ((by_x ? c->x1 : c->y1) != key)
+            break;
+
+        if (xfce_layout_corner_on_edge (c->x1, c->y1, edge))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+
+/* xfce_layout_edges_align() against every static edge, by range lookups */
+static gboolean
+xfce_layout_snapper_edge_aligned (XfceLayoutSnapper *snapper,
+                                  const Edge        *edge)
+{
+    if (xfce_layout_corner_on_edges (snapper->v_edges, TRUE, edge->x1, edge->y1)
+        || xfce_layout_corner_on_edges (snapper->h_edges, FALSE, edge->x1, edge->y1))
+        return TRUE;
+
+    if (edge->x1 == edge->x2
+        && xfce_layout_corners_on_edge (snapper->corners_x, TRUE, edge))
+        return TRUE;
+
+    if (edge->y1 == edge->y2
+        && xfce_layout_corners_on_edge (snapper->corners_y, FALSE, edge))
+        return TRUE;
+
+    return FALSE;
+}
+
+
+
+/* whether the layout is aligned and free of overlaps with the dragged
+ * rectangle at rect, whose edges are in snapper->rect_edges */
+static gboolean
+xfce_layout_snapper_is_aligned (XfceLayoutSnapper    *snapper,
+                                const XfceLayoutRect *rect)
+{
+    gboolean aligned = FALSE;
+    guint    i, j, k;
+    gint     n;
+
+    if (snapper->overlapping)
+        return FALSE;
+
+    for (i = 0; i < snapper->rects->len; ++i)
+    {
+        if (xfce_layout_rect_intersects (rect, &g_array_index (snapper->rects, XfceLayoutRect, i)))
+            return FALSE;
+    }
+
+    for (i = 0; i < snapper->rect_edges->len && !aligned; ++i)
+    {
+        aligned = xfce_layout_snapper_edge_aligned (snapper,
+                                                    &g_array_index (snapper->rect_edges, Edge, i));
+    }
+
+    if (!aligned)
+        return FALSE;
+
+    for (i = 0; i < snapper->unaligned->len; ++i)
+    {
+        n = g_array_index (snapper->unaligned, gint, i);
+
+        g_array_set_size (snapper->scratch, 0);
+        xfce_layout_list_edges (&g_array_index (snapper->rects, XfceLayoutRect, n),
+                                n, snapper->scratch);
+
+        aligned = FALSE;
+        for (j = 0; j < snapper->scratch->len && !aligned; ++j)
+        {
+            for (k = 0; k < snapper->rect_edges->len && !aligned; ++k)
+            {
+                aligned = xfce_layout_edges_align (&g_array_index (snapper->scratch, Edge, j),
+                                                   &g_array_index (snapper->rect_edges, Edge, k));
+            }
+        }
+
+        if (!aligned)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+
+/**
+ * xfce_layout_snapper_new:
+ * @rects   : the outputs that stay in place.
+ * @n_rects : number of rectangles in @rects.
+ *
+ * Indexes the edges of @rects, so one output can be snapped against
+ * them repeatedly while it is dragged.
+ *
+ * Returns: a new #XfceLayoutSnapper, free with xfce_layout_snapper_free().
+ **/
+XfceLayoutSnapper *
+xfce_layout_snapper_new (const XfceLayoutRect *rects,
+                         guint                 n_rects)
+{
+    XfceLayoutSnapper *snapper;
+    GArray            *edges;
+    Edge              *e;
+    guint              i, j;
+    gint               n;
+
+    snapper = g_slice_new0 (XfceLayoutSnapper);
+    snapper->rects = g_array_sized_new (FALSE, FALSE, sizeof (XfceLayoutRect), n_rects);
+    snapper->h_edges = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 2 * n_rects);
+    snapper->v_edges = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 2 * n_rects);
+    snapper->corners_x = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 4 * n_rects);
+    snapper->corners_y = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 4 * n_rects);
+    snapper->unaligned = g_array_new (FALSE, FALSE, sizeof (gint));
+    snapper->rect_edges = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 4);
+    snapper->scratch = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 4);
+    snapper->snaps = g_array_new (FALSE, FALSE, sizeof (Snap));
+
+    g_array_append_vals (snapper->rects, rects, n_rects);
+
+    edges = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 4 * n_rects);
+    for (i = 0; i < n_rects; ++i)
+        xfce_layout_list_edges (&rects[i], i, edges);
+
+    for (i = 0; i < edges->len; ++i)
+    {
+        e = &g_array_index (edges, Edge, i);
+
+        if (e->y1 == e->y2)
+            g_array_append_val (snapper->h_edges, *e);
+        if (e->x1 == e->x2)
+            g_array_append_val (snapper->v_edges, *e);
+    }
+
+    g_array_append_vals (snapper->corners_x, edges->data, edges->len);
+    g_array_append_vals (snapper->corners_y, edges->data, edges->len);
+
+    g_array_sort (snapper->h_edges, xfce_layout_compare_edges_y);
+    g_array_sort (snapper->v_edges, xfce_layout_compare_edges_x);
+    g_array_sort (snapper->corners_x, xfce_layout_compare_edges_x);
+    g_array_sort (snapper->corners_y, xfce_layout_compare_edges_y);
+
+    /* the static rectangles cannot move relative to each other, so check
+     * them against each other only once */
+    for (i = 0; i < n_rects; ++i)
+    {
+        n = i;
+        if (!xfce_layout_rect_is_aligned (n, edges))
+            g_array_append_val (snapper->unaligned, n);
+
+        for (j = i + 1; j < n_rects && !snapper->overlapping; ++j)
+            snapper->overlapping = xfce_layout_rect_intersects (&rects[i], &rects[j]);
+
+        if (i == 0)
+        {
+            snapper->x1 = rects[i].x;
+            snapper->y1 = rects[i].y;
+            snapper->x2 = rects[i].x + rects[i].width;
+            snapper->y2 = rects[i].y + rects[i].height;
+        }
+        else
+        {
+            snapper->x1 = MIN (snapper->x1, rects[i].x);
+            snapper->y1 = MIN (snapper->y1, rects[i].y);
+            snapper->x2 = MAX (snapper->x2, rects[i].x + rects[i].width);
+            snapper->y2 = MAX (snapper->y2, rects[i].y + rects[i].height);
+        }
+    }
+
+    g_array_free (edges, TRUE);
+
+    return snapper;
+}
+
+
+
+/**
+ * xfce_layout_snapper_free:
+ * @snapper : a #XfceLayoutSnapper.
+ *
+ * Frees @snapper.
+ **/
+void
+xfce_layout_snapper_free (XfceLayoutSnapper *snapper)
+{
+    g_array_free (snapper->rects, TRUE);
+    g_array_free (snapper->h_edges, TRUE);
+    g_array_free (snapper->v_edges, TRUE);
+    g_array_free (snapper->corners_x, TRUE);
+    g_array_free (snapper->corners_y, TRUE);
+    g_array_free (snapper->unaligned, TRUE);
+    g_array_free (snapper->rect_edges, TRUE);
+    g_array_free (snapper->scratch, TRUE);
+    g_array_free (snapper->snaps, TRUE);
+
+    g_slice_free (XfceLayoutSnapper, snapper);
+}
+
+
+
+/**
+ * xfce_layout_snapper_snap:
+ * @snapper : a #XfceLayoutSnapper.
+ * @rect    : the dragged output at the position it was dragged to.
+ *
+ * Moves @rect to the nearest position where it touches the static
+ * outputs, overlaps none of them and leaves no output detached from
+ * the others.
+ *
+ * Returns: %TRUE if @rect was snapped, %FALSE if no such position is
+ *          within reach, @rect is left unchanged then.
+ **/
+gboolean
+xfce_layout_snapper_snap (XfceLayoutSnapper *snapper,
+                          XfceLayoutRect    *rect)
+{
+    XfceLayoutRect candidate;
+    Snap          *snap;
+    gint           min_distance = -1;
+    gint           max_distance = XFCE_LAYOUT_SNAP_DISTANCE;
+    gint           span;
+    guint          i;
+
+    g_return_val_if_fail (snapper != NULL, FALSE);
+    g_return_val_if_fail (rect != NULL, FALSE);
+
+    if (snapper->rects->len == 0)
+        return FALSE;
+
+    /* no snap is further away than the size of the whole layout */
+    span = MAX (MAX (snapper->x2, rect->x + rect->width) - MIN (snapper->x1, rect->x),
+                MAX (snapper->y2, rect->y + rect->height) - MIN (snapper->y1, rect->y));
+
+    /* look for the nearest snaps first, they are nearly always within
+     * the snap distance, and only widen the range if none fits */
+    while (min_distance < span)
+    {
+        xfce_layout_snapper_list_snaps (snapper, rect, min_distance, max_distance);
+
+        for (i = 0; i < snapper->snaps->len; ++i)
+        {
+            snap = &g_array_index (snapper->snaps, Snap, i);
+
+            candidate = *rect;
+            candidate.x += snap->dx;
+            candidate.y += snap->dy;
+
+            /* only the dragged rectangle moves, so only its edges are new */
+            g_array_set_size (snapper->rect_edges, 0);
+            xfce_layout_list_edges (&candidate, -1, snapper->rect_edges);
+
+            if (xfce_layout_snapper_is_aligned (snapper, &candidate))
+            {
+                *rect = candidate;
+                return TRUE;
+            }
+        }
+
+        min_distance = max_distance;
+        max_distance *= 2;
+    }
+
+    return FALSE;
+}
+
+
+
+/**
+ * xfce_layout_is_aligned:
+ * @rects   : the outputs.
+ * @n_rects : number of rectangles in @rects.
+ *
+ * Checks the layout the snapper leaves behind: no output overlaps
+ * another and every output shares an edge or a corner with another.
+ *
+ * Returns: %TRUE if the layout is aligned.
+ **/
+gboolean
+xfce_layout_is_aligned (const XfceLayoutRect *rects,
+                        guint                 n_rects)
+{
+    GArray   *edges;
+    gboolean  aligned = TRUE;
+    guint     i, j;
+
+    if (n_rects <= 1)
+        return TRUE;
+
+    edges = g_array_sized_new (FALSE, FALSE, sizeof (Edge), 4 * n_rects);
+
+    for (i = 0; i < n_rects; ++i)
+        xfce_layout_list_edges (&rects[i], i, edges);
+
+    for (i = 0; i < n_rects && aligned; ++i)
+    {
+        aligned = xfce_layout_rect_is_aligned (i, edges);
+
+        for (j = i + 1; j < n_rects && aligned; ++j)
+            aligned = !xfce_layout_rect_intersects (&rects[i], &rects[j]);
+    }
+
+    g_array_free (edges, TRUE);
+
+    return aligned;
+}
+
+
+
+/**
+ * xfce_layout_get_mirror_state:
+ * @modes         : the mode of every output, 0 for the outputs that are off.
+ * @mirrored      : whether every output is set to mirror the others.
+ * @n_outputs     : number of outputs in @modes and @mirrored.
+ * @clonable_mode : the mode all active outputs support, 0 if there is
+ *                  none or less than two outputs are active.
+ *
+ * Returns: %XFCE_LAYOUT_CLONED if the active outputs mirror each other
+ *          in @clonable_mode, %XFCE_LAYOUT_MIRRORED if they mirror each
+ *          other in different modes and %XFCE_LAYOUT_NOT_MIRRORED
+ *          otherwise.
+ **/
+XfceLayoutMirrorState
+xfce_layout_get_mirror_state (const gulong   *modes,
+                              const gboolean *mirrored,
+                              guint           n_outputs,
+                              gulong          clonable_mode)
+{
+    gboolean cloned = TRUE;
+    gboolean is_mirrored = FALSE;
+    guint    n;
+
+    if (n_outputs <= 1 || clonable_mode == 0)
+        return XFCE_LAYOUT_NOT_MIRRORED;
+
+    for (n = 0; n < n_outputs; n++)
+    {
+        if (modes[n] == 0)
+            continue;
+
+        cloned &= (modes[n] == clonable_mode && mirrored[n]);
+        is_mirrored = mirrored[n];
+
+        if (!cloned)
+            break;
+    }
+
+    if (is_mirrored && !cloned)
+        return XFCE_LAYOUT_MIRRORED;
+
+    return cloned ? XFCE_LAYOUT_CLONED : XFCE_LAYOUT_NOT_MIRRORED;
+}
+
+
+
+/**
+ * xfce_layout_lay_out_horizontally:
+ * @rects   : the outputs.
+ * @on      : whether each output in @rects is on.
+ * @n_rects : number of rectangles in @rects and @on.
+ *
+ * Puts the outputs that are off next to each other on the right-hand
+ * side of the outputs that are on, so they do not all overlap at the
+ * origin initially.
+ **/
+void
+xfce_layout_lay_out_horizontally (XfceLayoutRect *rects,
+                                  const gboolean *on,
+                                  guint           n_rects)
+{
+    gint  x = 0, y = 0;
+    guint i;
+
+    /* first pass, all "on" outputs */
+    for (i = 0; i < n_rects; ++i)
+    {
+        if (on[i] && (rects[i].x + rects[i].width > x || rects[i].y > y))
+        {
+            y = rects[i].y;
+            x = rects[i].x + rects[i].width;
+        }
+    }
+
+    /* second pass, all the black screens */
+    for (i = 0; i < n_rects; ++i)
+    {
+        if (!on[i])
+        {
+            rects[i].x = x;
+            rects[i].y = y;
+            x += rects[i].width;
+        }
+    }
+}
+
+
+
+/**
+ * xfce_layout_normalize:
+ * @rects   : the outputs.
+ * @n_rects : number of rectangles in @rects.
+ * @width   : return location for the width of the layout or %NULL.
+ * @height  : return location for the height of the layout or %NULL.
+ *
+ * Moves the outputs, so the top-left-most corner of the layout is at
+ * (0,0), and computes the size of the layout afterwards.
+ *
+ * Returns: %TRUE if the outputs were moved.
+ **/
+gboolean
+xfce_layout_normalize (XfceLayoutRect *rects,
+                       guint           n_rects,
+                       gint           *width,
+                       gint           *height)
+{
+    gint     min_x = G_MAXINT, min_y = G_MAXINT;
+    gint     w = 0, h = 0;
+    gboolean moved;
+    guint    i;
+
+    for (i = 0; i < n_rects; ++i)
+    {
+        min_x = MIN (min_x, rects[i].x);
+        min_y = MIN (min_y, rects[i].y);
+    }
+
+    moved = n_rects > 0 && (min_x != 0 || min_y != 0);
+
+    for (i = 0; i < n_rects; ++i)
+    {
+        if (moved)
+        {
+            rects[i].x -= min_x;
+            rects[i].y -= min_y;
+        }
+
+        w = MAX (w, rects[i].x + rects[i].width);
+        h = MAX (h, rects[i].y + rects[i].height);
+    }
+
+    if (width != NULL)
+        *width = w;
+    if (height != NULL)
+        *height = h;
+
+    return moved;
+}
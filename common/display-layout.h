@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2026 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __DISPLAY_LAYOUT_H__
+#define __DISPLAY_LAYOUT_H__
+
+#include <glib.h>
+
+/* distance in pixels within which a dragged output snaps */
+#define XFCE_LAYOUT_SNAP_DISTANCE (200)
+
+typedef struct _XfceLayoutRect    XfceLayoutRect;
+typedef struct _XfceLayoutSnapper XfceLayoutSnapper;
+
+typedef enum
+{
+    XFCE_LAYOUT_NOT_MIRRORED,
+    XFCE_LAYOUT_CLONED,
+    XFCE_LAYOUT_MIRRORED
+}
+XfceLayoutMirrorState;
+
+struct _XfceLayoutRect
+{
+    gint x;
+    gint y;
+    gint width;
+    gint height;
+};
+
+
+
+XfceLayoutSnapper     *xfce_layout_snapper_new          (const XfceLayoutRect *rects,
+                                                         guint                 n_rects);
+
+void                   xfce_layout_snapper_free         (XfceLayoutSnapper    *snapper);
+
+gboolean               xfce_layout_snapper_snap         (XfceLayoutSnapper    *snapper,
+                                                         XfceLayoutRect       *rect);
+
+gboolean               xfce_layout_is_aligned           (const XfceLayoutRect *rects,
+                                                         guint                 n_rects);
+
+XfceLayoutMirrorState  xfce_layout_get_mirror_state     (const gulong         *modes,
+                                                         const gboolean       *mirrored,
+                                                         guint                 n_outputs,
+                                                         gulong                clonable_mode);
+
+void                   xfce_layout_lay_out_horizontally (XfceLayoutRect       *rects,
+                                                         const gboolean       *on,
+                                                         guint                 n_rects);
+
+gboolean               xfce_layout_normalize            (XfceLayoutRect       *rects,
+                                                         guint                 n_rects,
+                                                         gint                 *width,
+                                                         gint                 *height);
+
+#endif /* !__DISPLAY_LAYOUT_H__ */
@@ -43,6 +43,8 @@
 #include <X11/Xlib.h>
 #include <X11/extensions/Xrandr.h>
 
+#include <common/display-layout.h>
+
 #include "xfce-randr.h"
 #include "display-dialog_ui.h"
 #include "confirmation-dialog_ui.h"
@@ -136,7 +138,26 @@ static XfceRandr *xfce_randr = NULL;
 static gint randr_event_base;
 
 /* Used to identify the display */
+typedef struct _IdentityPopup IdentityPopup;
+struct _IdentityPopup
+{
+    GtkWidget       *window;
+    gint             display_id;
+
+    /* geometry and name the popup was built for */
+    gint             x, y;
+    gint             width, height;
+    gchar           *name;
+
+    /* rendered backgrounds, unselected and selected */
+    cairo_surface_t *background[2];
+    gint             background_width;
+    gint             background_height;
+    gboolean         background_alpha;
+};
+
 static GHashTable *display_popups = NULL;
+static gboolean display_popups_visible = FALSE;
 gboolean show_popups = FALSE;
 
 gboolean supports_alpha = FALSE;
@@ -667,15 +688,13 @@ display_setting_screen_changed (GtkWidget *widget,
     gtk_widget_set_colormap (widget, colormap);
 }
 
-static gboolean
-display_setting_identity_popup_expose (GtkWidget      *popup,
-                                       GdkEventExpose *event,
-                                       GtkBuilder     *builder)
+static void
+display_setting_identity_popup_render (GtkWidget *popup,
+                                       cairo_t   *cr,
+                                       gboolean   selected)
 {
-    cairo_t         *cr = gdk_cairo_create (popup->window);
     cairo_pattern_t *vertical_gradient, *innerstroke_gradient, *selected_gradient, *selected_innerstroke_gradient;
     gint             radius;
-    gboolean         selected = (g_hash_table_lookup (display_popups, GINT_TO_POINTER (active_output)) == popup);
 
     radius = 10;
     cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
@@ -773,80 +792,150 @@ display_setting_identity_popup_expose (GtkWidget      *popup,
         cairo_close_path (cr);
     }
 
-    cairo_destroy (cr);
     cairo_pattern_destroy (vertical_gradient);
     cairo_pattern_destroy (innerstroke_gradient);
     cairo_pattern_destroy (selected_gradient);
     cairo_pattern_destroy (selected_innerstroke_gradient);
+}
+
+static void
+display_setting_identity_popup_clear (IdentityPopup *popup)
+{
+    guint n;
+
+    for (n = 0; n < G_N_ELEMENTS (popup->background); ++n)
+    {
+        if (popup->background[n] != NULL)
+        {
+            cairo_surface_destroy (popup->background[n]);
+            popup->background[n] = NULL;
+        }
+    }
+}
+
+static gboolean
+display_setting_identity_popup_expose (GtkWidget      *widget,
+                                       GdkEventExpose *event,
+                                       IdentityPopup  *popup)
+{
+    cairo_t  *cr;
+    cairo_t  *background_cr;
+    gint      selected = (popup->display_id == (gint) active_output) ? 1 : 0;
+
+    /* The backgrounds only depend on the size and compositing */
+    if (popup->background_width != widget->allocation.width
+        || popup->background_height != widget->allocation.height
+        || popup->background_alpha != supports_alpha)
+    {
+        display_setting_identity_popup_clear (popup);
+
+        popup->background_width = widget->allocation.width;
+        popup->background_height = widget->allocation.height;
+        popup->background_alpha = supports_alpha;
+    }
+
+    cr = gdk_cairo_create (widget->window);
+
+    if (popup->background[selected] == NULL)
+    {
+        popup->background[selected] =
+            cairo_surface_create_similar (cairo_get_target (cr),
+                                          CAIRO_CONTENT_COLOR_ALPHA,
+                                          popup->background_width,
+                                          popup->background_height);
+
+        background_cr = cairo_create (popup->background[selected]);
+        display_setting_identity_popup_render (widget, background_cr, selected);
+        cairo_destroy (background_cr);
+    }
+
+    cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface (cr, popup->background[selected], 0, 0);
+    cairo_paint (cr);
+    cairo_destroy (cr);
 
     return FALSE;
 }
 
-static GtkWidget *
+static void
+display_setting_identity_geometry (gint  display_id,
+                                   gint *x,
+                                   gint *y,
+                                   gint *width,
+                                   gint *height)
+{
+    const XfceRRMode *current_mode;
+
+    if (display_settings_get_n_active_outputs() > 1)
+    {
+        current_mode = xfce_randr_find_mode_by_id (xfce_randr, display_id,
+                                                   xfce_randr->mode[display_id]);
+        if (!xfce_randr_get_positions (xfce_randr, display_id, x, y))
+        {
+            *x = 0;
+            *y = 0;
+        }
+        *width = xfce_randr_mode_width (current_mode, xfce_randr->rotation[display_id]);
+        *height = xfce_randr_mode_height (current_mode, xfce_randr->rotation[display_id]);
+    }
+    else
+    {
+        *x = 0;
+        *y = 0;
+        *width = gdk_screen_width ();
+        *height = gdk_screen_height ();
+    }
+}
+
+static IdentityPopup *
 display_setting_identity_display (gint display_id)
 {
     GtkBuilder       *builder;
-    GtkWidget        *popup = NULL;
+    IdentityPopup    *popup = NULL;
     GObject          *display_name, *display_details;
-    const XfceRRMode *current_mode;
     gchar            *color_hex = "#FFFFFF", *name_label, *details_label;
-    gint              screen_pos_x, screen_pos_y;
-    gint              window_width, window_height, screen_width, screen_height;
+    gint              window_width, window_height;
 
     builder = gtk_builder_new ();
     if (gtk_builder_add_from_string (builder, identity_popup_ui,
                                      identity_popup_ui_length, NULL) != 0)
     {
-        popup = GTK_WIDGET (gtk_builder_get_object (builder, "popup"));
-        gtk_widget_set_name (popup, "XfceDisplayDialogPopup");
+        popup = g_slice_new0 (IdentityPopup);
+        popup->display_id = display_id;
+        popup->name = g_strdup (xfce_randr->friendly_name[display_id]);
+        display_setting_identity_geometry (display_id, &popup->x, &popup->y,
+                                           &popup->width, &popup->height);
+
+        popup->window = GTK_WIDGET (gtk_builder_get_object (builder, "popup"));
+        gtk_widget_set_name (popup->window, "XfceDisplayDialogPopup");
 
-        gtk_widget_set_app_paintable (popup, TRUE);
-        g_signal_connect (G_OBJECT (popup), "expose-event", G_CALLBACK (display_setting_identity_popup_expose), builder);
-        g_signal_connect (G_OBJECT (popup), "screen-changed", G_CALLBACK (display_setting_screen_changed), NULL);
+        gtk_widget_set_app_paintable (popup->window, TRUE);
+        g_signal_connect (G_OBJECT (popup->window), "expose-event", G_CALLBACK (display_setting_identity_popup_expose), popup);
+        g_signal_connect (G_OBJECT (popup->window), "screen-changed", G_CALLBACK (display_setting_screen_changed), NULL);
 
         display_name = gtk_builder_get_object (builder, "display_name");
         display_details = gtk_builder_get_object (builder, "display_details");
 
-        if (display_settings_get_n_active_outputs() > 1)
-        {
-            current_mode = xfce_randr_find_mode_by_id (xfce_randr, display_id,
-                                                       xfce_randr->mode[display_id]);
-            if (!xfce_randr_get_positions (xfce_randr, display_id,
-                                           &screen_pos_x, &screen_pos_y))
-            {
-                screen_pos_x = 0;
-                screen_pos_y = 0;
-            }
-            screen_width = xfce_randr_mode_width (current_mode, xfce_randr->rotation[display_id]);
-            screen_height = xfce_randr_mode_height (current_mode, xfce_randr->rotation[display_id]);
-        }
-        else
-        {
-            screen_pos_x = 0;
-            screen_pos_y = 0;
-            screen_width = gdk_screen_width ();
-            screen_height = gdk_screen_height ();
-        }
-
         name_label = g_markup_printf_escaped ("<span foreground='%s'><big><b>%s %s</b></big></span>",
-                                              color_hex, _("Display:"), xfce_randr->friendly_name[display_id]);
+                                              color_hex, _("Display:"), popup->name);
         gtk_label_set_markup (GTK_LABEL (display_name), name_label);
         g_free (name_label);
 
         details_label = g_markup_printf_escaped ("<span foreground='%s'>%s %i x %i</span>", color_hex,
-                                                 _("Resolution:"), screen_width, screen_height);
+                                                 _("Resolution:"), popup->width, popup->height);
         gtk_label_set_markup (GTK_LABEL (display_details), details_label);
         g_free (details_label);
 
-        gtk_window_get_size (GTK_WINDOW(popup), &window_width, &window_height);
+        gtk_window_get_size (GTK_WINDOW (popup->window), &window_width, &window_height);
 
-        gtk_window_move (GTK_WINDOW (popup),
-                         screen_pos_x + (screen_width - window_width)/2,
-                         screen_pos_y + screen_height - window_height);
+        gtk_window_move (GTK_WINDOW (popup->window),
+                         popup->x + (popup->width - window_width)/2,
+                         popup->y + popup->height - window_height);
 
-        display_setting_screen_changed (GTK_WIDGET (popup), NULL, NULL);
+        display_setting_screen_changed (popup->window, NULL, NULL);
 
-        gtk_window_present (GTK_WINDOW (popup));
+        /* Join the other popups */
+        gtk_widget_set_visible (popup->window, display_popups_visible);
     }
 
     /* Release the builder */
@@ -855,24 +944,67 @@ display_setting_identity_display (gint display_id)
     return popup;
 }
 
+static void
+display_setting_identity_popup_free (IdentityPopup *popup)
+{
+    display_setting_identity_popup_clear (popup);
+    gtk_widget_destroy (popup->window);
+    g_free (popup->name);
+
+    g_slice_free (IdentityPopup, popup);
+}
+
 static void
 display_setting_identity_popups_populate (void)
 {
-    guint n;
+    GHashTableIter  iter;
+    gpointer        key, value;
+    IdentityPopup  *popup;
+    gint            x, y, width, height;
+    guint           n;
 
     g_assert (xfce_randr);
 
-    display_popups = g_hash_table_new_full (g_direct_hash,
-                                            g_direct_equal,
-                                            NULL,
-                                            (GDestroyNotify) gtk_widget_destroy);
+    if (display_popups == NULL)
+    {
+        display_popups = g_hash_table_new_full (g_direct_hash,
+                                                g_direct_equal,
+                                                NULL,
+                                                (GDestroyNotify) display_setting_identity_popup_free);
+    }
+
+    /* Drop the popups of outputs that are gone */
+    g_hash_table_iter_init (&iter, display_popups);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        if (GPOINTER_TO_UINT (key) >= xfce_randr->noutput)
+            g_hash_table_iter_remove (&iter);
+    }
 
     for (n = 0; n < xfce_randr->noutput; ++n)
     {
-        if (xfce_randr->mode[n] != None)
-            g_hash_table_insert (display_popups,
-                                 GINT_TO_POINTER (n),
-                                 display_setting_identity_display (n));
+        if (xfce_randr->mode[n] == None)
+        {
+            g_hash_table_remove (display_popups, GINT_TO_POINTER (n));
+            continue;
+        }
+
+        /* Keep the popup if the output looks the same */
+        popup = g_hash_table_lookup (display_popups, GINT_TO_POINTER (n));
+        if (popup != NULL)
+        {
+            display_setting_identity_geometry (n, &x, &y, &width, &height);
+            if (popup->x == x && popup->y == y
+                && popup->width == width && popup->height == height
+                && g_strcmp0 (popup->name, xfce_randr->friendly_name[n]) == 0)
+                continue;
+        }
+
+        popup = display_setting_identity_display (n);
+        if (popup != NULL)
+            g_hash_table_replace (display_popups, GINT_TO_POINTER (n), popup);
+        else
+            g_hash_table_remove (display_popups, GINT_TO_POINTER (n));
     }
 }
 
@@ -1162,9 +1294,9 @@ display_settings_combobox_selection_changed (GtkComboBox *combobox,
                                              GtkBuilder  *builder)
 {
     GtkTreeModel *model;
-    GtkTreeIter   iter;
-    GtkWidget    *popup;
-    gint          active_id, previous_id;
+    GtkTreeIter    iter;
+    IdentityPopup *popup;
+    gint           active_id, previous_id;
 
     if (gtk_combo_box_get_active_iter (combobox, &iter))
     {
@@ -1188,10 +1320,10 @@ display_settings_combobox_selection_changed (GtkComboBox *combobox,
         /* redraw the two (old active, new active) popups */
         popup = g_hash_table_lookup (display_popups, GINT_TO_POINTER (previous_id));
         if (popup)
-            gtk_widget_queue_draw (popup);
+            gtk_widget_queue_draw (popup->window);
         popup = g_hash_table_lookup (display_popups, GINT_TO_POINTER (active_id));
         if (popup)
-            gtk_widget_queue_draw (popup);
+            gtk_widget_queue_draw (popup->window);
 
         if (randr_gui_area)
             foo_scroll_area_invalidate (FOO_SCROLL_AREA (randr_gui_area));
@@ -1277,13 +1409,20 @@ set_display_popups_visible(gboolean visible)
 {
     GHashTableIter iter;
     gpointer key, value;
-    GtkWidget *popup;
+    IdentityPopup *popup;
+
+    /* Popups are kept while hidden, so only toggle them on a change */
+    visible = !!visible;
+    if (visible == display_popups_visible)
+        return;
+
+    display_popups_visible = visible;
 
     g_hash_table_iter_init (&iter, display_popups);
     while (g_hash_table_iter_next (&iter, &key, &value))
     {
-        popup = (GtkWidget *) value;
-        gtk_widget_set_visible(popup, visible);
+        popup = value;
+        gtk_widget_set_visible (popup->window, visible);
     }
 }
 
@@ -1565,15 +1704,16 @@ screen_on_event (GdkXEvent *xevent,
 
     event_num = e->type - randr_event_base;
 
-    if (event_num == RRScreenChangeNotify)
+    /* the edid of an output can change without a screen change */
+    if (event_num == RRScreenChangeNotify
+        || (event_num == RRNotify
+            && xfce_randr_output_notify (xfce_randr, (XRRNotifyEvent *) e)))
     {
         xfce_randr_reload (xfce_randr);
         display_settings_combobox_populate (builder);
 
-        /* recreate the identify display popups */
-        g_hash_table_destroy (display_popups);
+        /* rebuild the identify display popups of the changed outputs */
         display_setting_identity_popups_populate ();
-        set_display_popups_visible(show_popups);
     }
 
     initialize_connected_outputs();
@@ -1593,42 +1733,19 @@ screen_on_event (GdkXEvent *xevent,
 static gint
 get_mirrored_configuration (void)
 {
-    gboolean cloned = TRUE;
-    RRMode   mode = None;
-    guint    n;
-    gint     mirrored;
+    RRMode mode = None;
 
     if (!xfce_randr)
-        return FALSE;
-
-    if (xfce_randr->noutput <= 1)
-        return FALSE;
+        return XFCE_LAYOUT_NOT_MIRRORED;
 
     /* Can outputs be cloned? */
     if (display_settings_get_n_active_outputs () > 1)
         mode = xfce_randr_clonable_mode (xfce_randr);
 
-    if (mode == None)
-        return 0;
-
-    /* Check if mirror settings are on */
-    for (n = 0; n < xfce_randr->noutput; n++)
-    {
-        if (xfce_randr->mode[n] == None)
-            continue;
-
-        cloned &= (xfce_randr->mode[n] == mode &&
-                   xfce_randr->mirrored[n]);
-        mirrored = xfce_randr->mirrored[n];
-
-        if (!cloned)
-            break;
-    }
-
-    if (mirrored == TRUE && cloned == FALSE)
-        return 2;
-    else
-        return cloned;
+    return xfce_layout_get_mirror_state ((const gulong *) xfce_randr->mode,
+                                         xfce_randr->mirrored,
+                                         xfce_randr->noutput,
+                                         mode);
 }
 
 static XfceOutputInfo *convert_xfce_output_info (gint output_id)
@@ -1688,52 +1805,47 @@ struct App
     GtkWidget          *dialog;
 };
 
-static gboolean output_overlaps (XfceOutputInfo *output);
 static void get_geometry (XfceOutputInfo *output, int *w, int *h);
 
 static void
 lay_out_outputs_horizontally (void)
 {
-    gint x, y;
+    XfceLayoutRect *rects;
+    gboolean *on;
+    guint n, n_outputs;
     GList *list;
 
+    n_outputs = g_list_length (current_outputs);
+    rects = g_new (XfceLayoutRect, n_outputs);
+    on = g_new (gboolean, n_outputs);
+
+    for (list = current_outputs, n = 0; list != NULL; list = list->next, n++)
+    {
+        XfceOutputInfo *output = list->data;
+
+        rects[n].x = output->x;
+        rects[n].y = output->y;
+        rects[n].width = output->width;
+        rects[n].height = output->height;
+        on[n] = output->connected && output->on;
+    }
+
     /* Lay out all the monitors horizontally when "mirror screens" is turned
      * off, to avoid having all of them overlapped initially.  We put the
      * outputs turned off on the right-hand side.
      */
+    xfce_layout_lay_out_horizontally (rects, on, n_outputs);
 
-    x = 0;
-    y = 0;
-
-    /* First pass, all "on" outputs */
-    for (list = current_outputs; list != NULL; list = list->next)
+    for (list = current_outputs, n = 0; list != NULL; list = list->next, n++)
     {
-        XfceOutputInfo *output;
+        XfceOutputInfo *output = list->data;
 
-        output = list->data;
-        if (output->connected && output->on)
-        {
-            if ((gint)output->x + (gint)output->width > x || output->y > y)
-            {
-                y = output->y;
-                x = output->x + output->width;
-            }
-        }
+        output->x = rects[n].x;
+        output->y = rects[n].y;
     }
 
-    /* Second pass, all the black screens */
-    for (list = current_outputs; list != NULL; list = list->next)
-    {
-        XfceOutputInfo *output;
-
-        output = list->data;
-        if (!(output->connected && output->on))
-        {
-            output->x = x;
-            output->y = y;
-            x += output->width;
-        }
-    }
+    g_free (rects);
+    g_free (on);
 }
 
 static void
@@ -1787,33 +1899,39 @@ get_geometry (XfceOutputInfo *output, int *w, int *h)
 static void
 initialize_connected_outputs_at_zero(void)
 {
-    GList *list = NULL;
-    gint start_x, start_y;
+    XfceLayoutRect *rects;
+    guint n, n_outputs;
+    GList *list;
 
-    start_x = G_MAXINT;
-    start_y = G_MAXINT;
+    n_outputs = g_list_length (current_outputs);
+    rects = g_new (XfceLayoutRect, n_outputs);
 
-    /* Get the left-most and top-most coordinates */
-    for (list = current_outputs; list != NULL; list = list->next)
+    for (list = current_outputs, n = 0; list != NULL; list = list->next, n++)
     {
         XfceOutputInfo *output = list->data;
 
-        start_x = MIN(start_x, output->x);
-        start_y = MIN(start_y, output->y);
+        rects[n].x = output->x;
+        rects[n].y = output->y;
+        rects[n].width = output->width;
+        rects[n].height = output->height;
     }
 
-    /* Realign at zero */
-    for (list = current_outputs; list != NULL; list = list->next)
+    /* Realign the left-most and top-most coordinates at zero */
+    xfce_layout_normalize (rects, n_outputs, NULL, NULL);
+
+    for (list = current_outputs, n = 0; list != NULL; list = list->next, n++)
     {
         XfceOutputInfo *output = list->data;
 
-        output->y = output->y - start_y;
-        output->x = output->x - start_x;
+        output->x = rects[n].x;
+        output->y = rects[n].y;
 
         /* Update the Xfce Randr */
         xfce_randr->position[output->id].x = output->x;
         xfce_randr->position[output->id].y = output->y;
     }
+
+    g_free (rects);
 }
 
 static GList *
@@ -1883,495 +2001,238 @@ compute_scale (void)
     return MIN ((double)available_w / (double)total_w, (double)available_h / (double)total_h);
 }
 
-typedef struct Edge
-{
-    XfceOutputInfo *output;
-    int x1, y1;
-    int x2, y2;
-} Edge;
-
-typedef struct Snap
-{
-    Edge *snapper;      /* Edge that should be snapped */
-    Edge *snappee;
-    int dy, dx;
-} Snap;
-
 static void
-add_edge (XfceOutputInfo *output, int x1, int y1, int x2, int y2, GArray *edges)
+get_output_origin (XfceOutputInfo *output,
+                   double          scale,
+                   gint            total_w,
+                   gint            total_h,
+                   double         *x,
+                   double         *y)
 {
-    Edge e;
+    GdkRectangle viewport;
+
+    foo_scroll_area_get_viewport (FOO_SCROLL_AREA (randr_gui_area), &viewport);
 
-    e.x1 = x1;
-    e.x2 = x2;
-    e.y1 = y1;
-    e.y2 = y2;
-    e.output = output;
+    viewport.height -= 2 * MARGIN;
+    viewport.width -= 2 * MARGIN;
 
-    g_array_append_val (edges, e);
+    /* Center the displayed outputs in the viewport */
+    *x = ceil (output->x * scale + MARGIN + (viewport.width - total_w * scale) / 2.0);
+    *y = ceil (output->y * scale + MARGIN + (viewport.height - total_h * scale) / 2.0);
 }
 
 static void
-list_edges_for_output (XfceOutputInfo *output, GArray *edges)
+get_output_canvas_rect (XfceOutputInfo *output,
+                        GdkRectangle   *rect)
 {
-    int x, y, w, h;
+    int w, h;
+    double scale = compute_scale ();
+    double x, y;
+    gint total_w, total_h;
 
-    x = output->x;
-    y = output->y;
+    list_connected_outputs (&total_w, &total_h);
     get_geometry (output, &w, &h);
+    get_output_origin (output, scale, total_w, total_h, &x, &y);
 
-    /* Top, Bottom, Left, Right */
-    add_edge (output, x, y, x + w, y, edges);
-    add_edge (output, x, y + h, x + w, y + h, edges);
-    add_edge (output, x, y, x, y + h, edges);
-    add_edge (output, x + w, y, x + w, y + h, edges);
+    /* Leave room for the endpoint alignment in paint_output() */
+    rect->x = x - 2;
+    rect->y = y - 2;
+    rect->width = ceil (w * scale) + 4;
+    rect->height = ceil (h * scale) + 4;
 }
 
 static void
-list_edges (GArray *edges)
+get_output_layout_rect (XfceOutputInfo *output, XfceLayoutRect *rect)
 {
-    GList *connected_outputs = NULL;
+    get_geometry (output, &rect->width, &rect->height);
+
+    rect->x = output->x;
+    rect->y = output->y;
+}
+
+static XfceLayoutSnapper *
+output_snapper_new (XfceOutputInfo *dragged)
+{
+    XfceLayoutSnapper *snapper;
+    XfceLayoutRect rect;
+    GArray *rects;
     GList *list;
 
-    connected_outputs = list_connected_outputs (NULL, NULL);
+    rects = g_array_new (FALSE, FALSE, sizeof (XfceLayoutRect));
 
-    for (list = connected_outputs; list != NULL; list = list->next)
+    /* The other outputs stay put for the whole drag */
+    for (list = list_connected_outputs (NULL, NULL); list != NULL; list = list->next)
     {
-        list_edges_for_output (list->data, edges);
+        if (list->data == dragged)
+            continue;
+
+        get_output_layout_rect (list->data, &rect);
+        g_array_append_val (rects, rect);
     }
-}
 
-static gboolean
-overlap (int s1, int e1, int s2, int e2)
-{
-    return (!(e1 < s2 || s1 >= e2));
+    snapper = xfce_layout_snapper_new ((XfceLayoutRect *) rects->data, rects->len);
+    g_array_free (rects, TRUE);
+
+    return snapper;
 }
 
-static gboolean
-horizontal_overlap (Edge *snapper, Edge *snappee)
+struct GrabInfo
 {
-    if (snapper->y1 != snapper->y2 || snappee->y1 != snappee->y2)
-        return FALSE;
+    int grab_x;
+    int grab_y;
+    int output_x;
+    int output_y;
 
-    return overlap (snapper->x1, snapper->x2, snappee->x1, snappee->x2);
-}
+    XfceLayoutSnapper *snapper;
+};
 
-static gboolean
-vertical_overlap (Edge *snapper, Edge *snappee)
+/* Sets a mouse cursor for a widget's window.  As a hack, you can pass
+ * GDK_BLANK_CURSOR to mean "set the cursor to NULL" (i.e. reset the widget's
+ * window's cursor to its default).
+ */
+static void
+set_cursor (GtkWidget *widget, GdkCursorType type)
 {
-    if (snapper->x1 != snapper->x2 || snappee->x1 != snappee->x2)
-        return FALSE;
+    GdkCursor *cursor;
+    GdkWindow *window;
+
+    if (type == GDK_BLANK_CURSOR)
+        cursor = NULL;
+    else
+        cursor = gdk_cursor_new_for_display (gtk_widget_get_display (widget), type);
+
+    window = gtk_widget_get_window (widget);
+
+    if (window)
+        gdk_window_set_cursor (window, cursor);
 
-    return overlap (snapper->y1, snapper->y2, snappee->y1, snappee->y2);
+    if (cursor)
+        gdk_cursor_unref (cursor);
 }
 
 static void
-add_snap (GArray *snaps, Snap snap)
+set_monitors_tooltip (gchar *tooltip_text)
 {
-    if (ABS (snap.dx) <= 200 || ABS (snap.dy) <= 200)
-        g_array_append_val (snaps, snap);
+    const char *text;
+
+    if (tooltip_text)
+        text = g_strdup(tooltip_text);
+
+    else
+        text = _("Select a monitor to change its properties; drag it to rearrange its placement.");
+
+    gtk_widget_set_tooltip_text (randr_gui_area, text);
 }
 
 static void
-add_edge_snaps (Edge *snapper, Edge *snappee, GArray *snaps)
+on_output_event (FooScrollArea      *area,
+                 FooScrollAreaEvent *event,
+                 gpointer            data)
 {
-    Snap snap;
+    XfceOutputInfo *output = data;
+    gint            mirrored;
 
-    snap.snapper = snapper;
-    snap.snappee = snappee;
+    //App *app = g_object_get_data (G_OBJECT (area), "app");
 
-    if (horizontal_overlap (snapper, snappee))
-    {
-        snap.dx = 0;
-        snap.dy = snappee->y1 - snapper->y1;
+    mirrored = get_mirrored_configuration();
+    /* If the mouse is inside the outputs, set the cursor to "you can move me".  See
+     * on_canvas_event() for where we reset the cursor to the default if it
+     * exits the outputs' area.
+     */
+    if (!mirrored == 1 && get_n_connected() > 1)
+        set_cursor (GTK_WIDGET (area), GDK_FLEUR);
 
-        add_snap (snaps, snap);
-    }
-    else if (vertical_overlap (snapper, snappee))
+    if (event->type == FOO_BUTTON_PRESS)
     {
-        snap.dy = 0;
-        snap.dx = snappee->x1 - snapper->x1;
+        GrabInfo *info;
 
-        add_snap (snaps, snap);
-    }
+        gtk_combo_box_set_active (GTK_COMBO_BOX(randr_outputs_combobox), output->id);
 
-    /* Corner snaps */
-    /* 1->1 */
-    snap.dx = snappee->x1 - snapper->x1;
-    snap.dy = snappee->y1 - snapper->y1;
+        if (!mirrored == 1 && get_n_connected() > 1)
+        {
+            foo_scroll_area_begin_grab (area, on_output_event, data);
 
-    add_snap (snaps, snap);
+            info = g_new0 (GrabInfo, 1);
+            info->grab_x = event->x;
+            info->grab_y = event->y;
+            info->output_x = output->x;
+            info->output_y = output->y;
+            info->snapper = output_snapper_new (output);
 
-    /* 1->2 */
-    snap.dx = snappee->x2 - snapper->x1;
-    snap.dy = snappee->y2 - snapper->y1;
+            set_monitors_tooltip (g_strdup_printf(_("(%i, %i)"), output->x, output->y) );
 
-    add_snap (snaps, snap);
+            output->user_data = info;
+        }
 
-    /* 2->2 */
-    snap.dx = snappee->x2 - snapper->x2;
-    snap.dy = snappee->y2 - snapper->y2;
+        foo_scroll_area_invalidate (area);
+    }
+    else
+    {
+        if (foo_scroll_area_is_grabbed (area))
+        {
+            GrabInfo *info = output->user_data;
+            double scale = compute_scale();
+            int new_x, new_y;
+            XfceLayoutRect rect;
+            GdkRectangle old_rect, new_rect;
+            gint old_total_w, old_total_h, total_w, total_h;
 
-    add_snap (snaps, snap);
+            /* Where the output was painted last */
+            list_connected_outputs (&old_total_w, &old_total_h);
+            get_output_canvas_rect (output, &old_rect);
 
-    /* 2->1 */
-    snap.dx = snappee->x1 - snapper->x2;
-    snap.dy = snappee->y1 - snapper->y2;
+            new_x = info->output_x + (event->x - info->grab_x) / scale;
+            new_y = info->output_y + (event->y - info->grab_y) / scale;
 
-    add_snap (snaps, snap);
-}
+            output->x = new_x;
+            output->y = new_y;
 
-static void
-list_snaps (XfceOutputInfo *output, GArray *edges, GArray *snaps)
-{
-    guint i;
+            get_output_layout_rect (output, &rect);
 
-    for (i = 0; i < edges->len; ++i)
-    {
-        Edge *output_edge = &(g_array_index (edges, Edge, i));
-
-        if (output_edge->output == output)
-        {
-            guint j;
-
-            for (j = 0; j < edges->len; ++j)
-            {
-                Edge *edge = &(g_array_index (edges, Edge, j));
-
-                if (edge->output != output)
-                    add_edge_snaps (output_edge, edge, snaps);
-            }
-        }
-    }
-}
-
-static gboolean
-corner_on_edge (int x, int y, Edge *e)
-{
-    if (x == e->x1 && x == e->x2 && y >= e->y1 && y <= e->y2)
-        return TRUE;
-
-    if (y == e->y1 && y == e->y2 && x >= e->x1 && x <= e->x2)
-        return TRUE;
-
-    return FALSE;
-}
-
-static gboolean
-edges_align (Edge *e1, Edge *e2)
-{
-    if (corner_on_edge (e1->x1, e1->y1, e2))
-        return TRUE;
-
-    if (corner_on_edge (e2->x1, e2->y1, e1))
-        return TRUE;
-
-    return FALSE;
-}
-
-static gboolean
-output_is_aligned (XfceOutputInfo *output, GArray *edges)
-{
-    gboolean result = FALSE;
-    guint i;
-
-    for (i = 0; i < edges->len; ++i)
-    {
-        Edge *output_edge = &(g_array_index (edges, Edge, i));
-
-        if (output_edge->output == output)
-        {
-            guint j;
-
-            for (j = 0; j < edges->len; ++j)
+            if (xfce_layout_snapper_snap (info->snapper, &rect))
             {
-                Edge *edge = &(g_array_index (edges, Edge, j));
-
-                /* We are aligned if an output edge matches
-                 * an edge of another output
-                 */
-                if (edge->output != output_edge->output)
-                {
-                    if (edges_align (output_edge, edge))
-                    {
-                        result = TRUE;
-                        goto done;
-                    }
-                }
+                output->x = rect.x;
+                output->y = rect.y;
             }
-        }
-    }
-done:
-    return result;
-}
-
-static void
-get_output_rect (XfceOutputInfo *output, GdkRectangle *rect)
-{
-    int w, h;
-
-    get_geometry (output, &w, &h);
-
-    rect->width = w;
-    rect->height = h;
-    rect->x = output->x;
-    rect->y = output->y;
-}
-
-static gboolean
-output_overlaps (XfceOutputInfo *output)
-{
-    GList         *connected_outputs = NULL;
-    GList         *list;
-    gboolean       overlaps = FALSE;
-    GdkRectangle   output_rect;
-
-    get_output_rect (output, &output_rect);
-
-    connected_outputs = list_connected_outputs (NULL, NULL);
-
-    for (list = connected_outputs; list != NULL; list = list->next)
-    {
-        XfceOutputInfo *other = list->data;
-        if (other != output)
-        {
-            GdkRectangle other_rect;
-
-            get_output_rect (other, &other_rect);
-            if (gdk_rectangle_intersect (&output_rect, &other_rect, NULL))
-            {
-                overlaps = TRUE;
-                break;
-            }
-        }
-    }
-
-    return overlaps;
-}
-
-static gboolean
-xfce_rr_config_is_aligned (GArray *edges)
-{
-    GList     *connected_outputs = NULL;
-    GList     *list;
-    gboolean   aligned = TRUE;
-
-    connected_outputs = list_connected_outputs (NULL, NULL);
-
-    for (list = connected_outputs; list != NULL; list = list->next)
-    {
-        XfceOutputInfo *output = list->data;
-        if (!output_is_aligned (output, edges) || output_overlaps (output))
-        {
-            aligned = FALSE;
-            break;
-        }
-    }
-
-    return aligned;
-}
-
-struct GrabInfo
-{
-    int grab_x;
-    int grab_y;
-    int output_x;
-    int output_y;
-};
-
-static gboolean
-is_corner_snap (const Snap *s)
-{
-    return s->dx != 0 && s->dy != 0;
-}
-
-static int
-compare_snaps (gconstpointer v1, gconstpointer v2)
-{
-    const Snap *s1 = v1;
-    const Snap *s2 = v2;
-    int sv1 = MAX (ABS (s1->dx), ABS (s1->dy));
-    int sv2 = MAX (ABS (s2->dx), ABS (s2->dy));
-    int d;
-
-    d = sv1 - sv2;
-
-    /* This snapping algorithm is good enough for rock'n'roll, but
-     * this is probably a better:
-     *
-     *    First do a horizontal/vertical snap, then
-     *    with the new coordinates from that snap,
-     *    do a corner snap.
-     *
-     * Right now, it's confusing that corner snapping
-     * depends on the distance in an axis that you can't actually see.
-     *
-     */
-    if (d == 0)
-    {
-        if (is_corner_snap (s1) && !is_corner_snap (s2))
-            return -1;
-        else if (is_corner_snap (s2) && !is_corner_snap (s1))
-            return 1;
-        else
-            return 0;
-    }
-    else
-    {
-        return d;
-    }
-}
-
-/* Sets a mouse cursor for a widget's window.  As a hack, you can pass
- * GDK_BLANK_CURSOR to mean "set the cursor to NULL" (i.e. reset the widget's
- * window's cursor to its default).
- */
-static void
-set_cursor (GtkWidget *widget, GdkCursorType type)
-{
-    GdkCursor *cursor;
-    GdkWindow *window;
-
-    if (type == GDK_BLANK_CURSOR)
-        cursor = NULL;
-    else
-        cursor = gdk_cursor_new_for_display (gtk_widget_get_display (widget), type);
-
-    window = gtk_widget_get_window (widget);
-
-    if (window)
-        gdk_window_set_cursor (window, cursor);
-
-    if (cursor)
-        gdk_cursor_unref (cursor);
-}
-
-static void
-set_monitors_tooltip (gchar *tooltip_text)
-{
-    const char *text;
-
-    if (tooltip_text)
-        text = g_strdup(tooltip_text);
-
-    else
-        text = _("Select a monitor to change its properties; drag it to rearrange its placement.");
-
-    gtk_widget_set_tooltip_text (randr_gui_area, text);
-}
-
-static void
-on_output_event (FooScrollArea      *area,
-                 FooScrollAreaEvent *event,
-                 gpointer            data)
-{
-    XfceOutputInfo *output = data;
-    gint            mirrored;
-
-    //App *app = g_object_get_data (G_OBJECT (area), "app");
-
-    mirrored = get_mirrored_configuration();
-    /* If the mouse is inside the outputs, set the cursor to "you can move me".  See
-     * on_canvas_event() for where we reset the cursor to the default if it
-     * exits the outputs' area.
-     */
-    if (!mirrored == 1 && get_n_connected() > 1)
-        set_cursor (GTK_WIDGET (area), GDK_FLEUR);
-
-    if (event->type == FOO_BUTTON_PRESS)
-    {
-        GrabInfo *info;
-
-        gtk_combo_box_set_active (GTK_COMBO_BOX(randr_outputs_combobox), output->id);
-
-        if (!mirrored == 1 && get_n_connected() > 1)
-        {
-            foo_scroll_area_begin_grab (area, on_output_event, data);
-
-            info = g_new0 (GrabInfo, 1);
-            info->grab_x = event->x;
-            info->grab_y = event->y;
-            info->output_x = output->x;
-            info->output_y = output->y;
-
-            set_monitors_tooltip (g_strdup_printf(_("(%i, %i)"), output->x, output->y) );
-
-            output->user_data = info;
-        }
-
-        foo_scroll_area_invalidate (area);
-    }
-    else
-    {
-        if (foo_scroll_area_is_grabbed (area))
-        {
-            GrabInfo *info = output->user_data;
-            double scale = compute_scale();
-            int new_x, new_y;
-            guint i;
-            GArray *edges, *snaps;
-
-            new_x = info->output_x + (event->x - info->grab_x) / scale;
-            new_y = info->output_y + (event->y - info->grab_y) / scale;
-
-            output->x = new_x;
-            output->y = new_y;
-
-            edges = g_array_new (TRUE, TRUE, sizeof (Edge));
-            snaps = g_array_new (TRUE, TRUE, sizeof (Snap));
-
-            list_edges (edges);
-            list_snaps (output, edges, snaps);
-
-            g_array_sort (snaps, compare_snaps);
-
-            output->x = info->output_x;
-            output->y = info->output_y;
-
-            for (i = 0; i < snaps->len; ++i)
+            else
             {
-                Snap *snap = &(g_array_index (snaps, Snap, i));
-                GArray *new_edges = g_array_new (TRUE, TRUE, sizeof (Edge));
-
-                output->x = new_x + snap->dx;
-                output->y = new_y + snap->dy;
-
-                g_array_set_size (new_edges, 0);
-                list_edges (new_edges);
-
-                if (xfce_rr_config_is_aligned (new_edges))
-                {
-                    g_array_free (new_edges, TRUE);
-                    break;
-                }
-                else
-                {
-                    output->x = info->output_x;
-                    output->y = info->output_y;
-                    g_array_free (new_edges, TRUE);
-                }
+                output->x = info->output_x;
+                output->y = info->output_y;
             }
 
-            g_array_free (snaps, TRUE);
-            g_array_free (edges, TRUE);
-
             if (event->type == FOO_BUTTON_RELEASE)
             {
                 foo_scroll_area_end_grab (area);
                 set_monitors_tooltip (NULL);
 
+                xfce_layout_snapper_free (info->snapper);
                 g_free (output->user_data);
                 output->user_data = NULL;
 
                 initialize_connected_outputs_at_zero();
                 display_settings_changed ();
+
+                foo_scroll_area_invalidate (area);
             }
             else
             {
                 set_monitors_tooltip (g_strdup_printf(_("(%i, %i)"), output->x, output->y) );
-            }
 
-            foo_scroll_area_invalidate (area);
+                list_connected_outputs (&total_w, &total_h);
+                if (total_w == old_total_w && total_h == old_total_h)
+                {
+                    /* The scale did not change, so only the dragged
+                     * output moved on the canvas */
+                    get_output_canvas_rect (output, &new_rect);
+                    gdk_rectangle_union (&old_rect, &new_rect, &new_rect);
+                    foo_scroll_area_invalidate_rect (area, new_rect.x, new_rect.y,
+                                                     new_rect.width, new_rect.height);
+                }
+                else
+                {
+                    foo_scroll_area_invalidate (area);
+                }
+            }
         }
     }
 }
@@ -2422,102 +2283,61 @@ paint_background (FooScrollArea *area,
     cairo_stroke (cr);
 }
 
+typedef struct OutputTile OutputTile;
+
+struct OutputTile
+{
+    cairo_surface_t *surface;
+
+    /* What the tile was rendered for */
+    int              width;
+    int              height;
+    double           scale;
+    double           alpha;
+    gboolean         on;
+    gboolean         highlight;
+    gchar           *text;
+};
+
+/* Rendered outputs by output id, moved around instead of redrawn */
+static GHashTable *output_tiles = NULL;
+
 static void
-paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
+output_tile_free (gpointer data)
 {
-    int w, h;
-    double scale = compute_scale();
-    double x, y, end_x, end_y;
-    gint total_w, total_h;
-    GList *connected_outputs = list_connected_outputs (&total_w, &total_h);
-    XfceOutputInfo *output = NULL;
-    GList *entry = NULL;
+    OutputTile *tile = data;
+
+    cairo_surface_destroy (tile->surface);
+    g_free (tile->text);
+    g_slice_free (OutputTile, tile);
+}
+
+static void
+render_output_tile (cairo_t        *cr,
+                    XfceOutputInfo *output,
+                    int             width,
+                    int             height,
+                    double          scaled_w,
+                    double          scaled_h,
+                    double          alpha,
+                    const char     *text,
+                    gboolean        highlight)
+{
+    double x = 0.0, y = 0.0, end_x = width, end_y = height;
     PangoLayout *layout;
     PangoRectangle ink_extent, log_extent;
-    GdkRectangle viewport;
     cairo_pattern_t *pat_lin = NULL, *pat_radial = NULL;
-    double alpha = 1.0;
     double available_w;
     double factor = 1.0;
-    const char *text;
-    gint    mirrored;
-
-    mirrored = get_mirrored_configuration();
-
-    cairo_save (cr);
-
-    foo_scroll_area_get_viewport (FOO_SCROLL_AREA (randr_gui_area), &viewport);
-
-    entry = g_list_nth (connected_outputs, i);
-    if (entry)
-        output = entry->data;
-    if (output)
-        get_geometry (output, &w, &h);
-    else
-        return;
-
-    viewport.height -= 2 * MARGIN;
-    viewport.width -= 2 * MARGIN;
-
-    /* Center the displayed outputs in the viewport */
-    x = ceil (output->x * scale + MARGIN + (viewport.width - total_w * scale) / 2.0);
-    y = ceil (output->y * scale + MARGIN + (viewport.height - total_h * scale) / 2.0);
-
-    /* Align endpoints */
-    end_x = x + ceil (w * scale);
-    end_y = y + ceil (h * scale);
-    if ( abs((int)end_x-(int)*snap_x) <= 1 )
-    {
-        end_x = *snap_x;
-    }
-    if ( abs((int)end_y-(int)*snap_y) <= 1 )
-    {
-        end_y = *snap_y;
-    }
-    *snap_x = end_x;
-    *snap_y = end_y;
-
-    cairo_translate (cr,
-                     x + (w * scale) / 2,
-                     y + (h * scale) / 2);
-
-    /* rotation is already applied in get_geometry */
-
-    if (output->rotation == RR_Reflect_X)
-        cairo_scale (cr, -1, 1);
-
-    if (output->rotation == RR_Reflect_Y)
-        cairo_scale (cr, 1, -1);
-
-    cairo_translate (cr,
-                     - x - (w * scale) / 2,
-                     - y - (h * scale) / 2);
 
     cairo_rectangle (cr, x, y, end_x - x, end_y - y);
-    cairo_clip_preserve (cr);
-
-    foo_scroll_area_add_input_from_fill (FOO_SCROLL_AREA (randr_gui_area),
-                                         cr, on_output_event, output);
 
     cairo_set_line_width (cr, 1.0);
 
-    /* Make overlapping displays ('mirrored') more transparent so both displays can
-       be recognized more easily */
-    if (output->id != active_output && mirrored == 2)
-        alpha = 0.5;
-    /* When displays are mirrored it makes no sense to make them semi-transparent
-       because they overlay each other completely */
-    else if (mirrored == 1)
-        alpha = 1.0;
-    /* the inactive display should be more transparent and the overlapping one as
-       well */
-    else if (output->id != active_output || mirrored == 2)
-        alpha = 0.7;
-
     if (output->on)
     {
         /* Background gradient for active display */
-        pat_lin = cairo_pattern_create_linear(x, y, x, y + (h * scale));
+        pat_lin = cairo_pattern_create_linear(x, y, x, y + scaled_h);
         cairo_pattern_add_color_stop_rgba(pat_lin, 0.0, 0.56, 0.85, 0.92, alpha);
         cairo_pattern_add_color_stop_rgba(pat_lin, 0.2, 0.33, 0.75, 0.92, alpha);
         cairo_pattern_add_color_stop_rgba(pat_lin, 0.7, 0.25, 0.57, 0.77, alpha);
@@ -2531,7 +2351,7 @@ paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
     else
     {
         /* Background gradient for disabled display */
-        pat_lin = cairo_pattern_create_linear(x, y, x, y + (h * scale));
+        pat_lin = cairo_pattern_create_linear(x, y, x, y + scaled_h);
         cairo_pattern_add_color_stop_rgba(pat_lin, 0.0, 0.24, 0.3, 0.31, alpha);
         cairo_pattern_add_color_stop_rgba(pat_lin, 0.2, 0.17, 0.20, 0.22, alpha);
         cairo_pattern_add_color_stop_rgba(pat_lin, 0.7, 0.14, 0.16, 0.18, alpha);
@@ -2549,7 +2369,7 @@ paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
     cairo_stroke (cr);
 
     /* Draw reflection as radial gradient on a polygon */
-    pat_radial = cairo_pattern_create_radial ((end_x -x) /2 + x, y, 1, (end_x -x) /2 + x, y, h * scale);
+    pat_radial = cairo_pattern_create_radial ((end_x -x) /2 + x, y, 1, (end_x -x) /2 + x, y, scaled_h);
     cairo_pattern_add_color_stop_rgba(pat_radial, 0.0, 1.0, 1.0, 1.0, 0.4);
     cairo_pattern_add_color_stop_rgba(pat_radial, 0.5, 1.0, 1.0, 1.0, 0.15);
     cairo_pattern_add_color_stop_rgba(pat_radial, 0.8, 1.0, 1.0, 1.0, 0.0);
@@ -2563,24 +2383,11 @@ paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
     cairo_fill (cr);
 
     /* Display name label*/
-    if (mirrored == 1)
-    {
-    /* Translators:  this is the feature where what you see on your laptop's
-     * screen is the same as your external monitor.  Here, "Mirror" is being
-     * used as an adjective, not as a verb.  For example, the Spanish
-     * translation could be "Pantallas en Espejo", *not* "Espejar Pantallas".
-     */
-        text = _("Mirror Screens");
-    }
-    else
-    {
-        text = output->display_name;
-    }
     layout = gtk_widget_create_pango_layout (GTK_WIDGET (randr_gui_area), text);
     layout_set_font (layout, "Sans Bold 12");
     pango_layout_get_pixel_extents (layout, &ink_extent, &log_extent);
 
-    available_w = w * scale + 0.5 - 6; /* Same as the inner rectangle's width, minus 1 pixel of padding on each side */
+    available_w = scaled_w + 0.5 - 6; /* Same as the inner rectangle's width, minus 1 pixel of padding on each side */
 
     cairo_scale (cr, factor, factor);
 
@@ -2592,10 +2399,10 @@ paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
     }
 
     cairo_move_to (cr,
-                   x + ((w * scale + 0.5) - factor * log_extent.width) / 2,
-                   y + ((h * scale + 0.5) - factor * log_extent.height) / 2 - 1);
+                   x + ((scaled_w + 0.5) - factor * log_extent.width) / 2,
+                   y + ((scaled_h + 0.5) - factor * log_extent.height) / 2 - 1);
     /* Try to make the text as readable as possible for overlapping displays */
-    if (output->id == active_output && mirrored == 2)
+    if (highlight)
        cairo_set_source_rgba (cr, 0.0, 0.0, 0.0, alpha);
     else
         cairo_set_source_rgba (cr, 0.0, 0.0, 0.0, alpha - 0.6);
@@ -2603,12 +2410,12 @@ paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
     pango_cairo_show_layout (cr, layout);
 
     cairo_move_to (cr,
-                   x + ((w * scale + 0.5) - factor * log_extent.width) / 2,
-                   y + ((h * scale + 0.5) - factor * log_extent.height) / 2);
+                   x + ((scaled_w + 0.5) - factor * log_extent.width) / 2,
+                   y + ((scaled_h + 0.5) - factor * log_extent.height) / 2);
 
     /* Try to make the text as readable as possible for overlapping displays - the
        currently selected one could be painted below the other display*/
-    if (output->id == active_output && mirrored == 2)
+    if (highlight)
         cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
     else
         cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, alpha);
@@ -2623,21 +2430,19 @@ paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
         layout_set_font (display_state, "Sans 9");
         pango_layout_get_pixel_extents (display_state, &ink_extent, &log_extent);
 
-        available_w = w * scale + 0.5 - 6;
+        available_w = scaled_w + 0.5 - 6;
         if (available_w < ink_extent.width)
             factor = available_w / ink_extent.width;
         else
             factor = 1.0;
         cairo_move_to (cr,
-                       x + ((w * scale + 0.5) - factor * log_extent.width) / 2,
-                       y + ((h * scale + 0.5) - factor * log_extent.height) / 2 + 18);
+                       x + ((scaled_w + 0.5) - factor * log_extent.width) / 2,
+                       y + ((scaled_h + 0.5) - factor * log_extent.height) / 2 + 18);
         cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 0.75);
         pango_cairo_show_layout (cr, display_state);
         g_object_unref (display_state);
     }
 
-    cairo_restore (cr);
-
     if (pat_lin)
         cairo_pattern_destroy(pat_lin);
     if (pat_radial)
@@ -2646,6 +2451,182 @@ paint_output (cairo_t *cr, int i, double *snap_x, double *snap_y)
     g_object_unref (layout);
 }
 
+static cairo_surface_t *
+get_output_tile (cairo_t        *cr,
+                 XfceOutputInfo *output,
+                 int             width,
+                 int             height,
+                 double          scale,
+                 double          alpha,
+                 const char     *text,
+                 gboolean        highlight)
+{
+    OutputTile *tile;
+    cairo_t *tile_cr;
+    int w, h;
+
+    if (output_tiles == NULL)
+        output_tiles = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                              NULL, output_tile_free);
+
+    /* Reuse the tile if the output looks the same */
+    tile = g_hash_table_lookup (output_tiles, GUINT_TO_POINTER (output->id));
+    if (tile != NULL
+        && tile->width == width
+        && tile->height == height
+        && tile->scale == scale
+        && tile->alpha == alpha
+        && tile->on == output->on
+        && tile->highlight == highlight
+        && g_strcmp0 (tile->text, text) == 0)
+        return tile->surface;
+
+    if (tile == NULL)
+    {
+        tile = g_slice_new0 (OutputTile);
+        g_hash_table_insert (output_tiles, GUINT_TO_POINTER (output->id), tile);
+    }
+    else
+    {
+        cairo_surface_destroy (tile->surface);
+        g_free (tile->text);
+    }
+
+    tile->width = width;
+    tile->height = height;
+    tile->scale = scale;
+    tile->alpha = alpha;
+    tile->on = output->on;
+    tile->highlight = highlight;
+    tile->text = g_strdup (text);
+
+    get_geometry (output, &w, &h);
+
+    tile->surface = cairo_surface_create_similar (cairo_get_target (cr),
+                                                  CAIRO_CONTENT_COLOR_ALPHA,
+                                                  width, height);
+    tile_cr = cairo_create (tile->surface);
+    render_output_tile (tile_cr, output, width, height, w * scale, h * scale,
+                        alpha, text, highlight);
+    cairo_destroy (tile_cr);
+
+    return tile->surface;
+}
+
+static void
+paint_output (cairo_t *cr, GdkRegion *region, int i, double *snap_x, double *snap_y)
+{
+    int w, h;
+    double scale = compute_scale();
+    double x, y, end_x, end_y;
+    gint total_w, total_h;
+    GList *connected_outputs = list_connected_outputs (&total_w, &total_h);
+    XfceOutputInfo *output = NULL;
+    GList *entry = NULL;
+    GdkRectangle rect;
+    cairo_surface_t *tile;
+    double alpha = 1.0;
+    const char *text;
+    gint    mirrored;
+
+    mirrored = get_mirrored_configuration();
+
+    entry = g_list_nth (connected_outputs, i);
+    if (entry)
+        output = entry->data;
+    if (output)
+        get_geometry (output, &w, &h);
+    else
+        return;
+
+    get_output_origin (output, scale, total_w, total_h, &x, &y);
+
+    /* Align endpoints */
+    end_x = x + ceil (w * scale);
+    end_y = y + ceil (h * scale);
+    if ( abs((int)end_x-(int)*snap_x) <= 1 )
+    {
+        end_x = *snap_x;
+    }
+    if ( abs((int)end_y-(int)*snap_y) <= 1 )
+    {
+        end_y = *snap_y;
+    }
+    *snap_x = end_x;
+    *snap_y = end_y;
+
+    /* Outputs outside of the damaged area keep their pixels and input paths */
+    rect.x = x - 1;
+    rect.y = y - 1;
+    rect.width = end_x - x + 2;
+    rect.height = end_y - y + 2;
+    if (region != NULL && gdk_region_rect_in (region, &rect) == GDK_OVERLAP_RECTANGLE_OUT)
+        return;
+
+    cairo_save (cr);
+
+    cairo_translate (cr,
+                     x + (w * scale) / 2,
+                     y + (h * scale) / 2);
+
+    /* rotation is already applied in get_geometry */
+
+    if (output->rotation == RR_Reflect_X)
+        cairo_scale (cr, -1, 1);
+
+    if (output->rotation == RR_Reflect_Y)
+        cairo_scale (cr, 1, -1);
+
+    cairo_translate (cr,
+                     - x - (w * scale) / 2,
+                     - y - (h * scale) / 2);
+
+    cairo_rectangle (cr, x, y, end_x - x, end_y - y);
+    cairo_clip_preserve (cr);
+
+    foo_scroll_area_add_input_from_fill (FOO_SCROLL_AREA (randr_gui_area),
+                                         cr, on_output_event, output);
+
+    cairo_new_path (cr);
+
+    /* Make overlapping displays ('mirrored') more transparent so both displays can
+       be recognized more easily */
+    if (output->id != active_output && mirrored == 2)
+        alpha = 0.5;
+    /* When displays are mirrored it makes no sense to make them semi-transparent
+       because they overlay each other completely */
+    else if (mirrored == 1)
+        alpha = 1.0;
+    /* the inactive display should be more transparent and the overlapping one as
+       well */
+    else if (output->id != active_output || mirrored == 2)
+        alpha = 0.7;
+
+    /* Display name label*/
+    if (mirrored == 1)
+    {
+    /* Translators:  this is the feature where what you see on your laptop's
+     * screen is the same as your external monitor.  Here, "Mirror" is being
+     * used as an adjective, not as a verb.  For example, the Spanish
+     * translation could be "Pantallas en Espejo", *not* "Espejar Pantallas".
+     */
+        text = _("Mirror Screens");
+    }
+    else
+    {
+        text = output->display_name;
+    }
+
+    /* The bezel and labels are only rendered again when they change,
+     * dragging an output just paints the tile somewhere else */
+    tile = get_output_tile (cr, output, end_x - x, end_y - y, scale, alpha, text,
+                            output->id == active_output && mirrored == 2);
+    cairo_set_source_surface (cr, tile, x, y);
+    cairo_paint (cr);
+
+    cairo_restore (cr);
+}
+
 static void
 on_area_paint (FooScrollArea *area,
                cairo_t       *cr,
@@ -2671,13 +2652,13 @@ on_area_paint (FooScrollArea *area,
         if (i == active_output) {
             continue;
         }
-        paint_output (cr, i, &x, &y);
+        paint_output (cr, region, i, &x, &y);
 
         if (get_mirrored_configuration() == 1)
             break;
     }
     /* Finally also paint the active output */
-    paint_output (cr, active_output, &x, &y);
+    paint_output (cr, region, active_output, &x, &y);
 }
 
 static XfceOutputInfo *
@@ -2833,7 +2814,9 @@ display_settings_show_main_dialog (GdkDisplay *display)
         /* Set up notifications */
         XRRSelectInput (gdk_x11_display_get_xdisplay (display),
                         GDK_WINDOW_XID (gdk_get_default_root_window ()),
-                        RRScreenChangeNotifyMask);
+                        RRScreenChangeNotifyMask
+                        | RROutputChangeNotifyMask
+                        | RROutputPropertyNotifyMask);
         gdk_x11_register_standard_event_type (display,
                                               randr_event_base,
                                               RRNotify + 1);
@@ -3207,6 +3190,10 @@ cleanup:
         g_object_unref (G_OBJECT (display_channel));
     }
 
+    /* Free the rendered outputs */
+    if (output_tiles)
+        g_hash_table_destroy (output_tiles);
+
     /* Free the randr 1.2 backend */
     if (xfce_randr)
         xfce_randr_free (xfce_randr);
@@ -97,6 +97,13 @@ struct FooScrollAreaPrivate
 
     GdkPixmap              *pixmap;
     GdkRegion              *update_region;      /* In canvas coordinates */
+
+    /* Motion events are compressed, only the last one
+     * before the next repaint is processed
+     */
+    guint                   motion_idle_id;
+    int                     motion_x;
+    int                     motion_y;
 };
 
 enum
@@ -160,6 +167,9 @@ foo_scroll_area_finalize (GObject *object)
 {
     FooScrollArea *scroll_area = FOO_SCROLL_AREA (object);
 
+    if (scroll_area->priv->motion_idle_id != 0)
+        g_source_remove (scroll_area->priv->motion_idle_id);
+
     g_object_unref (scroll_area->priv->hadj);
     g_object_unref (scroll_area->priv->vadj);
 
@@ -673,6 +683,12 @@ foo_scroll_area_unrealize (GtkWidget *widget)
 {
     FooScrollArea *area = FOO_SCROLL_AREA (widget);
 
+    if (area->priv->motion_idle_id != 0)
+    {
+        g_source_remove (area->priv->motion_idle_id);
+        area->priv->motion_idle_id = 0;
+    }
+
     if (area->priv->input_window)
     {
         gdk_window_set_user_data (area->priv->input_window, NULL);
@@ -871,12 +887,37 @@ process_gdk_event (FooScrollArea *scroll_area,
     process_event (scroll_area, input_type, x, y);
 }
 
+static gboolean
+motion_idle (gpointer data)
+{
+    FooScrollArea *area = data;
+
+    area->priv->motion_idle_id = 0;
+
+    process_event (area, FOO_MOTION,
+                   area->priv->motion_x, area->priv->motion_y);
+
+    return FALSE;
+}
+
+static void
+flush_motion (FooScrollArea *area)
+{
+    /* Deliver a pending motion before any other event */
+    if (area->priv->motion_idle_id != 0)
+    {
+        g_source_remove (area->priv->motion_idle_id);
+        motion_idle (area);
+    }
+}
+
 static gboolean
 foo_scroll_area_button_press (GtkWidget *widget,
                               GdkEventButton *event)
 {
     FooScrollArea *area = FOO_SCROLL_AREA (widget);
 
+    flush_motion (area);
     process_gdk_event (area, event->x, event->y, (GdkEvent *)event);
 
     return TRUE;
@@ -888,6 +929,7 @@ foo_scroll_area_button_release (GtkWidget      *widget,
 {
     FooScrollArea *area = FOO_SCROLL_AREA (widget);
 
+    flush_motion (area);
     process_gdk_event (area, event->x, event->y, (GdkEvent *)event);
 
     return FALSE;
@@ -899,7 +941,17 @@ foo_scroll_area_motion (GtkWidget      *widget,
 {
     FooScrollArea *area = FOO_SCROLL_AREA (widget);
 
-    process_gdk_event (area, event->x, event->y, (GdkEvent *)event);
+    /* The events queued before the next repaint are all handled
+     * before this idle runs, so at most one motion is processed
+     * per repaint
+     */
+    area->priv->motion_x = event->x;
+    area->priv->motion_y = event->y;
+
+    if (area->priv->motion_idle_id == 0)
+        area->priv->motion_idle_id =
+            g_idle_add_full (GDK_PRIORITY_REDRAW - 1, motion_idle, area, NULL);
+
     return TRUE;
 }
 
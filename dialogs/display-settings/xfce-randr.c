@@ -37,6 +37,8 @@
 
 
 
+typedef struct _XfceRandrOutput XfceRandrOutput;
+
 struct _XfceRandrPrivate
 {
     /* xrandr 1.3 capable */
@@ -48,6 +50,49 @@ struct _XfceRandrPrivate
     /* cache for the output/mode info */
     XRROutputInfo      **output_info;
     XfceRRMode         **modes;
+    XfceRandrOutput    **outputs;
+
+    /* per-output state kept between reloads, RROutput to XfceRandrOutput */
+    GHashTable          *output_cache;
+    guint                serial;
+
+    /* configuration timestamp of the last reload */
+    Time                 timestamp;
+    guint                has_timestamp : 1;
+};
+
+struct _XfceRandrOutput
+{
+    /* reload in which the output was last connected */
+    guint            serial;
+
+    /* supported modes, rebuilt when the mode list of the output changes */
+    guint            has_modes : 1;
+    RRMode          *mode_ids;
+    gint             nmode;
+    XfceRRMode      *modes;
+
+    /* name from the edid, read again if the monitor might have changed */
+    gchar           *friendly_name;
+    guint            name_stale : 1;
+    Connection       connection;
+
+    /* crtc state, queried again when the configuration changed */
+    guint            has_crtc : 1;
+    RRCrtc           crtc;
+    RRMode           mode;
+    Rotation         rotation;
+    Rotation         rotations;
+    gint             x;
+    gint             y;
+
+    /* last state written to the default scheme */
+    guint            saved : 1;
+    RRMode           saved_mode;
+    Rotation         saved_rotation;
+    gint             saved_x;
+    gint             saved_y;
+    XfceOutputStatus saved_status;
 };
 
 
@@ -151,19 +196,78 @@ xfce_randr_guess_relations (XfceRandr *randr)
 }
 
 
+static void
+xfce_randr_output_free (gpointer data)
+{
+    XfceRandrOutput *cache = data;
+
+    g_free (cache->mode_ids);
+    g_free (cache->modes);
+    g_free (cache->friendly_name);
+    g_slice_free (XfceRandrOutput, cache);
+}
+
+
+
+static gboolean
+xfce_randr_output_is_stale (gpointer key,
+                            gpointer value,
+                            gpointer user_data)
+{
+    XfceRandrOutput *cache = value;
+
+    /* drop the outputs that got disconnected */
+    return cache->serial != GPOINTER_TO_UINT (user_data);
+}
+
+
+
+static gboolean
+xfce_randr_output_modes_changed (XfceRandrOutput *cache,
+                                 XRROutputInfo   *output_info)
+{
+    if (!cache->has_modes || cache->nmode != output_info->nmode)
+        return TRUE;
+
+    return output_info->nmode > 0 && memcmp (cache->mode_ids, output_info->modes,
+                   output_info->nmode * sizeof (RRMode)) != 0;
+}
+
+
+
+static gboolean
+xfce_randr_output_is_saved (XfceRandr *randr,
+                            guint      output)
+{
+    XfceRandrOutput *cache = randr->priv->outputs[output];
+
+    return cache->saved
+           && cache->saved_mode == randr->mode[output]
+           && cache->saved_rotation == randr->rotation[output]
+           && cache->saved_x == randr->position[output].x
+           && cache->saved_y == randr->position[output].y
+           && cache->saved_status == randr->status[output];
+}
+
+
+
 static void
 xfce_randr_populate (XfceRandr *randr,
                      Display   *xdisplay,
                      GdkWindow *root_window)
 {
-    GPtrArray      *outputs;
-    XRROutputInfo  *output_info;
-    XRRCrtcInfo    *crtc_info;
-    gint            n;
-    guint           m, connected;
-    guint          *output_ids = NULL;
-
-    XfconfChannel *display_channel = xfconf_channel_new ("displays");
+    GPtrArray       *outputs;
+    XRROutputInfo   *output_info;
+    XRRCrtcInfo     *crtc_info;
+    XfceRandrOutput *cache;
+    RROutput         output_id;
+    RROutput         primary = None;
+    gboolean         same_config;
+    gint             n;
+    guint            m, connected;
+    guint           *output_ids = NULL;
+
+    XfconfChannel *display_channel = xfconf_channel_get ("displays");
 
     g_return_if_fail (randr != NULL);
     g_return_if_fail (randr->priv != NULL);
@@ -204,6 +308,7 @@ xfce_randr_populate (XfceRandr *randr,
     /* allocate final space for the settings */
     randr->mode = g_new0 (RRMode, randr->noutput);
     randr->priv->modes = g_new0 (XfceRRMode *, randr->noutput);
+    randr->priv->outputs = g_new0 (XfceRandrOutput *, randr->noutput);
     randr->position = g_new0 (XfceOutputPosition, randr->noutput);
     randr->rotation = g_new0 (Rotation, randr->noutput);
     randr->rotations = g_new0 (Rotation, randr->noutput);
@@ -211,48 +316,110 @@ xfce_randr_populate (XfceRandr *randr,
     randr->status = g_new0 (XfceOutputStatus, randr->noutput);
     randr->friendly_name = g_new0 (gchar *, randr->noutput);
 
+#ifdef HAS_RANDR_ONE_POINT_THREE
+    /* find the primary screen if supported */
+    if (randr->priv->has_1_3)
+        primary = XRRGetOutputPrimary (xdisplay, GDK_WINDOW_XID (root_window));
+#endif
+
+    /* if the crtcs were not reconfigured, their cached state is valid */
+    same_config = randr->priv->has_timestamp
+                  && randr->priv->timestamp == randr->priv->resources->timestamp;
+    randr->priv->timestamp = randr->priv->resources->timestamp;
+    randr->priv->has_timestamp = TRUE;
+    randr->priv->serial++;
+
     /* walk the connected outputs */
     for (m = 0; m < randr->noutput; ++m)
     {
-        /* fill in supported modes */
-        randr->priv->modes[m] = xfce_randr_list_supported_modes (randr->priv->resources, randr->priv->output_info[m]);
+        output_info = randr->priv->output_info[m];
+        output_id = randr->priv->resources->outputs[output_ids[m]];
 
-#ifdef HAS_RANDR_ONE_POINT_THREE
-        /* find the primary screen if supported */
-        if (randr->priv->has_1_3 && XRRGetOutputPrimary (xdisplay, GDK_WINDOW_XID (root_window)) == randr->priv->resources->outputs[output_ids[m]])
-            randr->status[m] = XFCE_OUTPUT_STATUS_PRIMARY;
-        else
-#endif
-            randr->status[m] = XFCE_OUTPUT_STATUS_SECONDARY;
+        /* lookup the state of the previous reload */
+        cache = g_hash_table_lookup (randr->priv->output_cache, GUINT_TO_POINTER (output_id));
+        if (cache == NULL)
+        {
+            cache = g_slice_new0 (XfceRandrOutput);
+            g_hash_table_insert (randr->priv->output_cache, GUINT_TO_POINTER (output_id), cache);
+        }
+        cache->serial = randr->priv->serial;
+        cache->connection = RR_Connected;
+        randr->priv->outputs[m] = cache;
 
-        if (randr->priv->output_info[m]->crtc != None)
+        /* fill in supported modes, a new mode list might also be a new monitor */
+        if (xfce_randr_output_modes_changed (cache, output_info))
         {
-            crtc_info = XRRGetCrtcInfo (xdisplay, randr->priv->resources,
-                                        randr->priv->output_info[m]->crtc);
-            randr->mode[m] = crtc_info->mode;
-            randr->rotation[m] = crtc_info->rotation;
-            randr->rotations[m] = crtc_info->rotations;
-            randr->position[m].x = crtc_info->x;
-            randr->position[m].y = crtc_info->y;
-            XRRFreeCrtcInfo (crtc_info);
+            g_free (cache->modes);
+            g_free (cache->mode_ids);
+            cache->modes = xfce_randr_list_supported_modes (randr->priv->resources, output_info);
+            cache->mode_ids = g_memdup (output_info->modes, output_info->nmode * sizeof (RRMode));
+            cache->nmode = output_info->nmode;
+            cache->has_modes = TRUE;
+
+            cache->name_stale = TRUE;
         }
+        randr->priv->modes[m] = cache->modes;
+
+        if (primary != None && primary == output_id)
+            randr->status[m] = XFCE_OUTPUT_STATUS_PRIMARY;
         else
+            randr->status[m] = XFCE_OUTPUT_STATUS_SECONDARY;
+
+        if (!same_config || !cache->has_crtc || cache->crtc != output_info->crtc)
         {
-            /* output disabled */
-            randr->mode[m] = None;
-            randr->rotation[m] = RR_Rotate_0;
-            randr->rotations[m] = xfce_randr_get_safe_rotations (randr, xdisplay, m);
+            cache->crtc = output_info->crtc;
+            cache->has_crtc = TRUE;
+
+            if (output_info->crtc != None)
+            {
+                crtc_info = XRRGetCrtcInfo (xdisplay, randr->priv->resources,
+                                            output_info->crtc);
+                cache->mode = crtc_info->mode;
+                cache->rotation = crtc_info->rotation;
+                cache->rotations = crtc_info->rotations;
+                cache->x = crtc_info->x;
+                cache->y = crtc_info->y;
+                XRRFreeCrtcInfo (crtc_info);
+            }
+            else
+            {
+                /* output disabled */
+                cache->mode = None;
+                cache->rotation = RR_Rotate_0;
+                cache->rotations = xfce_randr_get_safe_rotations (randr, xdisplay, m);
+                cache->x = 0;
+                cache->y = 0;
+            }
         }
 
+        randr->mode[m] = cache->mode;
+        randr->rotation[m] = cache->rotation;
+        randr->rotations[m] = cache->rotations;
+        randr->position[m].x = cache->x;
+        randr->position[m].y = cache->y;
+
         /* fill in the name used by the UI */
-        randr->friendly_name[m] = xfce_randr_friendly_name (randr, m, output_ids[m]);
+        if (cache->friendly_name == NULL || cache->name_stale)
+        {
+            g_free (cache->friendly_name);
+            cache->friendly_name = xfce_randr_friendly_name (randr, m, output_ids[m]);
+            cache->name_stale = FALSE;
+            cache->saved = FALSE;
+        }
+        randr->friendly_name[m] = cache->friendly_name;
 
         /* Update display info, primary display may have changed. */
-        xfce_randr_save_output (randr, "Default", display_channel, m);
-        
+        if (!xfce_randr_output_is_saved (randr, m))
+            xfce_randr_save_output (randr, "Default", display_channel, m);
+
         /* Replace spaces with underscore in name for xfconf compatibility */
         g_strcanon(randr->priv->output_info[m]->name, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_<>", '_');
     }
+
+    /* forget the outputs that are not connected anymore */
+    g_hash_table_foreach_remove (randr->priv->output_cache, xfce_randr_output_is_stale,
+                                 GUINT_TO_POINTER (randr->priv->serial));
+
     /* populate mirrored details */
     xfce_randr_guess_relations (randr);
 
@@ -301,6 +468,10 @@ xfce_randr_new (GdkDisplay  *display,
     /* set display */
     randr->priv->display = display;
 
+    /* outputs state between reloads */
+    randr->priv->output_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                       NULL, xfce_randr_output_free);
+
     /* get the root window */
     root_window = gdk_get_default_root_window ();
 
@@ -319,15 +490,11 @@ xfce_randr_cleanup (XfceRandr *randr)
 {
     guint n;
 
-    /* free the output/mode info cache */
+    /* free the output info, the modes and names are owned by the output cache */
     for (n = 0; n < randr->noutput; ++n)
     {
         if (G_LIKELY (randr->priv->output_info[n]))
             XRRFreeOutputInfo (randr->priv->output_info[n]);
-        if (G_LIKELY (randr->priv->modes[n]))
-            g_free (randr->priv->modes[n]);
-        if (G_LIKELY (randr->friendly_name[n]))
-            g_free (randr->friendly_name[n]);
     }
 
     /* free the screen resources */
@@ -337,6 +504,7 @@ xfce_randr_cleanup (XfceRandr *randr)
     g_free (randr->friendly_name);
     g_free (randr->mode);
     g_free (randr->priv->modes);
+    g_free (randr->priv->outputs);
     g_free (randr->rotation);
     g_free (randr->rotations);
     g_free (randr->status);
@@ -352,6 +520,9 @@ xfce_randr_free (XfceRandr *randr)
 {
     xfce_randr_cleanup (randr);
 
+    /* free the outputs state */
+    g_hash_table_destroy (randr->priv->output_cache);
+
     /* free the structure */
     g_slice_free (XfceRandrPrivate, randr->priv);
     g_slice_free (XfceRandr, randr);
@@ -390,6 +561,54 @@ xfce_randr_reload (XfceRandr *randr)
 
 
 
+/* Marks the name of an output for reading again when its connection state
+ * or its EDID changed, a monitor swapped on the same connector may keep the
+ * mode list. Returns TRUE when the caller has to reload, as no screen change
+ * notification follows an EDID change. */
+gboolean
+xfce_randr_output_notify (XfceRandr            *randr,
+                          const XRRNotifyEvent *event)
+{
+    const XRROutputChangeNotifyEvent   *output_event;
+    const XRROutputPropertyNotifyEvent *property_event;
+    XfceRandrOutput                    *cache;
+
+    g_return_val_if_fail (randr != NULL, FALSE);
+    g_return_val_if_fail (event != NULL, FALSE);
+
+    if (event->subtype == RRNotify_OutputChange)
+    {
+        output_event = (const XRROutputChangeNotifyEvent *) event;
+        cache = g_hash_table_lookup (randr->priv->output_cache,
+                                     GUINT_TO_POINTER (output_event->output));
+
+        /* a screen change notification follows and reloads */
+        if (cache != NULL && cache->connection != output_event->connection)
+        {
+            cache->connection = output_event->connection;
+            cache->name_stale = TRUE;
+        }
+    }
+    else if (event->subtype == RRNotify_OutputProperty)
+    {
+        property_event = (const XRROutputPropertyNotifyEvent *) event;
+        if (property_event->property != gdk_x11_get_xatom_by_name (RR_PROPERTY_RANDR_EDID))
+            return FALSE;
+
+        cache = g_hash_table_lookup (randr->priv->output_cache,
+                                     GUINT_TO_POINTER (property_event->output));
+        if (cache != NULL)
+        {
+            cache->name_stale = TRUE;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+
+
 void
 xfce_randr_save_output (XfceRandr     *randr,
                         const gchar   *scheme,
@@ -400,11 +619,24 @@ xfce_randr_save_output (XfceRandr     *randr,
     gchar            *str_value;
     const XfceRRMode *mode;
     gint              degrees;
+    XfceRandrOutput  *cache;
 
     g_return_if_fail (randr != NULL && scheme != NULL);
     g_return_if_fail (XFCONF_IS_CHANNEL (channel));
     g_return_if_fail (output < randr->noutput);
 
+    /* remember the state, so reloads do not write it again */
+    if (strcmp (scheme, "Default") == 0)
+    {
+        cache = randr->priv->outputs[output];
+        cache->saved = TRUE;
+        cache->saved_mode = randr->mode[output];
+        cache->saved_rotation = randr->rotation[output];
+        cache->saved_x = randr->position[output].x;
+        cache->saved_y = randr->position[output].y;
+        cache->saved_status = randr->status[output];
+    }
+
     /* save the device name */
     g_snprintf (property, sizeof (property), "/%s/%s", scheme,
                 randr->priv->output_info[output]->name);
@@ -115,6 +115,9 @@ void              xfce_randr_free            (XfceRandr        *randr);
 
 void              xfce_randr_reload          (XfceRandr        *randr);
 
+gboolean          xfce_randr_output_notify   (XfceRandr            *randr,
+                                              const XRRNotifyEvent *event);
+
 void              xfce_randr_save_output     (XfceRandr        *randr,
                                               const gchar      *scheme,
                                               XfconfChannel    *channel,
@@ -40,6 +40,7 @@
 #include "keyboard-dialog_ui.h"
 #include "xfce-keyboard-settings.h"
 #include "command-dialog.h"
+#include "xfce-xkb-registry.h"
 
 #ifdef HAVE_LIBXKLAVIER
 #include <libxklavier/xklavier.h>
@@ -82,6 +83,7 @@ enum
 {
     XKB_AVAIL_LAYOUTS_TREE_DESCRIPTION = 0,
     XKB_AVAIL_LAYOUTS_TREE_ID,
+    XKB_AVAIL_LAYOUTS_TREE_SEARCH_INDEX,
     XKB_AVAIL_LAYOUTS_TREE_NUM_COLUMNS
 };
 
@@ -93,6 +95,7 @@ typedef enum
 
 
 typedef struct _XfceKeyboardShortcutInfo    XfceKeyboardShortcutInfo;
+typedef struct _XfceKeyboardLayoutSearch    XfceKeyboardLayoutSearch;
 
 typedef
 void (*XfceKeyboardLayoutsComboInitFunc) (XfceKeyboardSettings *settings);
@@ -109,6 +112,14 @@ static void                      xfce_keyboard_settings_row_activated         (G
                                                                                GtkTreeViewColumn         *column,
                                                                                XfceKeyboardSettings      *settings);
 static void                      xfce_keyboard_settings_initialize_shortcuts  (XfceKeyboardSettings      *settings);
+static const gchar              *xfce_keyboard_settings_shortcut_label        (XfceKeyboardSettings      *settings,
+                                                                               const gchar               *shortcut);
+static void                      xfce_keyboard_settings_set_row               (XfceKeyboardSettings      *settings,
+                                                                               const gchar               *shortcut,
+                                                                               const gchar               *command,
+                                                                               gboolean                   snotify);
+static void                      xfce_keyboard_settings_remove_row            (XfceKeyboardSettings      *settings,
+                                                                               const gchar               *shortcut);
 static void                      xfce_keyboard_settings_load_shortcuts        (XfceKeyboardSettings      *settings);
 static void                      xfce_keyboard_settings_edit_shortcut         (XfceKeyboardSettings      *settings,
                                                                                GtkTreeView               *tree_view,
@@ -142,6 +153,8 @@ static void                      xfce_keyboard_settings_system_default_cb     (G
                                                                                XfceKeyboardSettings      *settings);
 static void                      xfce_keyboard_settings_set_layout            (XfceKeyboardSettings      *settings);
 static void                      xfce_keyboard_settings_init_layout           (XfceKeyboardSettings      *settings);
+static void                      xfce_keyboard_settings_xkb_registry_ready    (XfceKeyboardSettings      *settings);
+static gboolean                  xfce_keyboard_settings_xkb_registry_load     (gpointer                   user_data);
 
 static void                      xfce_keyboard_settings_layouts_combo_populate(XfceKeyboardSettings     *settings,
                                                                                const gchar              *combo_name,
@@ -152,8 +165,8 @@ static void                      xfce_keyboard_settings_layouts_combo_init    (X
                                                                                const gchar               *combo_name,
                                                                                const gchar               *xfconf_prop_name,
                                                                                const gchar               *default_value);
-static void                      xfce_keyboard_settings_layouts_combo_add     (XklConfigRegistry         *config_registry,
-                                                                               const XklConfigItem       *config_item,
+static void                      xfce_keyboard_settings_layouts_combo_add     (const gchar               *name,
+                                                                               const gchar               *description,
                                                                                gpointer                   user_data);
 static void                      xfce_keyboard_settings_layouts_combo_changed (GtkComboBox               *combo,
                                                                                XfceKeyboardSettings      *settings,
@@ -189,11 +202,22 @@ static void                      xfce_keyboard_settings_up_layout_button_cb   (G
                                                                                XfceKeyboardSettings      *settings);
 static void                      xfce_keyboard_settings_down_layout_button_cb (GtkWidget                 *widget,
                                                                                XfceKeyboardSettings      *settings);
-static void                      xfce_keyboard_settings_add_variant_to_list   (XklConfigRegistry         *config_registry,
-                                                                               XklConfigItem             *config_item,
+static void                      xfce_keyboard_settings_add_variant_to_list   (const gchar               *name,
+                                                                               const gchar               *description,
                                                                                XfceKeyboardSettings      *settings);
-static void                      xfce_keyboard_settings_add_layout_to_list    (XklConfigRegistry         *config_registry,
-                                                                               XklConfigItem             *config_item,
+static void                      xfce_keyboard_settings_add_layout_to_list    (const gchar               *name,
+                                                                               const gchar               *description,
+                                                                               XfceKeyboardSettings      *settings);
+static void                      xfce_keyboard_settings_layout_search_add     (XfceKeyboardSettings      *settings,
+                                                                               GtkTreeIter               *iter,
+                                                                               gchar                     *key,
+                                                                               const gchar               *name,
+                                                                               const gchar               *description,
+                                                                               gint                       parent);
+static gboolean                  xfce_keyboard_settings_layout_visible        (GtkTreeModel              *model,
+                                                                               GtkTreeIter               *iter,
+                                                                               gpointer                   user_data);
+static void                      xfce_keyboard_settings_layout_search_changed (GtkEditable               *editable,
                                                                                XfceKeyboardSettings      *settings);
 static gchar**                   xfce_keyboard_settings_layout_selection      (XfceKeyboardSettings      *settings,
                                                                                const gchar               *layout,
@@ -207,12 +231,31 @@ struct _XfceKeyboardSettingsPrivate
 {
   XfceShortcutsProvider *provider;
 
+  /* shortcuts list, its rows by shortcut and the
+   * accelerator labels shown in the list */
+  GtkListStore          *shortcuts_store;
+  GHashTable            *shortcuts_rows;
+  GHashTable            *shortcuts_labels;
+
 #ifdef HAVE_LIBXKLAVIER
   XklEngine             *xkl_engine;
   XklConfigRegistry     *xkl_registry;
+  XfceXkbRegistry       *xkb_registry;
+  XfceXkbRegistryLoader *xkb_registry_loader;
+  guint                  xkb_registry_idle_id;
   XklConfigRec          *xkl_rec_config;
   GtkTreeIter            layout_selection_iter;
   GtkTreeStore          *layout_selection_treestore;
+  GtkTreeModel          *layout_selection_filter;
+
+  /* "layout" and "layout(variant)" -> iter in the treestore */
+  GHashTable            *layout_selection_rows;
+
+  /* folded descriptions of the treestore rows, the
+   * rows store their index in this array */
+  GArray                *layout_search;
+  gchar                 *layout_search_query;
+  GtkWidget             *layout_search_entry;
 #endif
 
   XfconfChannel         *keyboards_channel;
@@ -226,6 +269,17 @@ struct _XfceKeyboardShortcutInfo
   XfceShortcut          *shortcut;
 };
 
+struct _XfceKeyboardLayoutSearch
+{
+  gchar *text;
+
+  /* index of the layout row for variants, -1 for layouts */
+  gint   parent;
+
+  guint  matched : 1;
+  guint  visible : 1;
+};
+
 
 
 G_DEFINE_TYPE (XfceKeyboardSettings, xfce_keyboard_settings, GTK_TYPE_BUILDER)
@@ -257,6 +311,10 @@ xfce_keyboard_settings_init (XfceKeyboardSettings *settings)
   settings->priv->keyboard_layout_channel = xfconf_channel_new ("keyboard-layout");
   settings->priv->xsettings_channel = xfconf_channel_new ("xsettings");
 
+  settings->priv->shortcuts_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                          (GDestroyNotify) gtk_tree_iter_free);
+  settings->priv->shortcuts_labels = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
   settings->priv->provider = xfce_shortcuts_provider_new ("commands");
   g_signal_connect (settings->priv->provider, "shortcut-added",
                     G_CALLBACK (xfce_keyboard_settings_shortcut_added), settings);
@@ -301,16 +359,16 @@ xfce_keyboard_settings_layouts_combo_populate (XfceKeyboardSettings *settings,
 
   if (option_group_name != NULL)
   {
-    xkl_config_registry_foreach_option (settings->priv->xkl_registry,
-                                        option_group_name,
-                                        xfce_keyboard_settings_layouts_combo_add,
-                                        list_store);
+    xfce_xkb_registry_foreach_option (settings->priv->xkb_registry,
+                                      option_group_name,
+                                      xfce_keyboard_settings_layouts_combo_add,
+                                      list_store);
   }
   else
   {
-    xkl_config_registry_foreach_model (settings->priv->xkl_registry,
-                                       xfce_keyboard_settings_layouts_combo_add,
-                                       list_store);
+    xfce_xkb_registry_foreach_model (settings->priv->xkb_registry,
+                                     xfce_keyboard_settings_layouts_combo_add,
+                                     list_store);
   }
 
   xkb_combo = gtk_builder_get_object (GTK_BUILDER (settings), combo_name);
@@ -391,6 +449,7 @@ xfce_keyboard_settings_constructed (GObject *object)
   list_store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_BOOLEAN, G_TYPE_STRING);
   gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (list_store), COMMAND_COLUMN, GTK_SORT_ASCENDING);
   gtk_tree_view_set_model (GTK_TREE_VIEW (kbd_shortcuts_view), GTK_TREE_MODEL (list_store));
+  settings->priv->shortcuts_store = list_store;
 
   /* Create command column */
   renderer = gtk_cell_renderer_text_new ();
@@ -430,11 +489,9 @@ xfce_keyboard_settings_constructed (GObject *object)
   xkl_config_rec_get_from_server (settings->priv->xkl_rec_config, settings->priv->xkl_engine);
 
   settings->priv->xkl_registry = xkl_config_registry_get_instance (settings->priv->xkl_engine);
-#ifdef HAVE_LIBXKLAVIER4
-  xkl_config_registry_load (settings->priv->xkl_registry, FALSE);
-#else
-  xkl_config_registry_load (settings->priv->xkl_registry);
-#endif
+
+  /* Parsing the rules database is slow, use the snapshot from the previous run if it is still valid */
+  settings->priv->xkb_registry = xfce_xkb_registry_load_cache ();
 
   /* Tab */
   xkb_tab_layout_vbox = gtk_builder_get_object (GTK_BUILDER (settings), "xkb_tab_layout_vbox");
@@ -450,25 +507,6 @@ xfce_keyboard_settings_constructed (GObject *object)
                     G_CALLBACK (xfce_keyboard_settings_system_default_cb),
                     settings);
 
-  /* Keyboard model combo */
-  xfce_keyboard_settings_layouts_combo_populate (settings,
-                                                 "xkb_model_combo",
-                                                 NULL,
-                                                 xfce_keyboard_settings_init_model,
-                                                 xfce_keyboard_settings_model_changed_cb);
-  /* Group key combo */
-  xfce_keyboard_settings_layouts_combo_populate (settings,
-                                                 "xkb_grpkey_combo",
-                                                 "grp",
-                                                 xfce_keyboard_settings_init_grpkey,
-                                                 xfce_keyboard_settings_grpkey_changed_cb);
-  /* Compose key combo */
-  xfce_keyboard_settings_layouts_combo_populate (settings,
-                                                 "xkb_composekey_combo",
-                                                 "Compose key",
-                                                 xfce_keyboard_settings_init_compkey,
-                                                 xfce_keyboard_settings_compkey_changed_cb);
-
   /* Keyboard layout/variant treeview */
   settings->priv->layout_selection_treestore = NULL;
   xkb_layout_view = gtk_builder_get_object (GTK_BUILDER (settings), "xkb_layout_view");
@@ -480,7 +518,6 @@ xfce_keyboard_settings_constructed (GObject *object)
 
   list_store = gtk_list_store_new (XKB_TREE_NUM_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
   gtk_tree_view_set_model (GTK_TREE_VIEW (xkb_layout_view), GTK_TREE_MODEL (list_store));
-  xfce_keyboard_settings_init_layout (settings);
   g_signal_connect (G_OBJECT (xkb_layout_view), "row-activated", G_CALLBACK (xfce_keyboard_settings_row_activated_cb), settings);
 
   /* Layout buttons */
@@ -496,7 +533,19 @@ xfce_keyboard_settings_constructed (GObject *object)
   g_signal_connect (G_OBJECT (xkb_layout_up_button),     "clicked", G_CALLBACK (xfce_keyboard_settings_up_layout_button_cb), settings);
   g_signal_connect (G_OBJECT (xkb_layout_down_button),   "clicked", G_CALLBACK (xfce_keyboard_settings_down_layout_button_cb), settings);
 
-  xfce_keyboard_settings_update_layout_buttons (settings);
+  if (settings->priv->xkb_registry != NULL)
+    {
+      xfce_keyboard_settings_xkb_registry_ready (settings);
+    }
+  else
+    {
+      /* Read the rules database in small steps once the dialog is on screen */
+      gtk_widget_set_sensitive (GTK_WIDGET (xkb_tab_layout_vbox), FALSE);
+      xfce_keyboard_settings_update_layout_buttons (settings);
+      settings->priv->xkb_registry_loader = xfce_xkb_registry_loader_new (settings->priv->xkl_registry);
+      settings->priv->xkb_registry_idle_id =
+        g_idle_add_full (G_PRIORITY_LOW, xfce_keyboard_settings_xkb_registry_load, settings, NULL);
+    }
 #endif /* HAVE_LIBXKLAVIER */
 }
 
@@ -515,6 +564,27 @@ xfce_keyboard_settings_finalize (GObject *object)
   xkl_engine_stop_listen (settings->priv->xkl_engine);
 #endif /* HAVE_LIBXKLAVIER5 */
 
+  if (settings->priv->xkb_registry_idle_id != 0)
+    g_source_remove (settings->priv->xkb_registry_idle_id);
+  if (settings->priv->xkb_registry_loader != NULL)
+    xfce_xkb_registry_loader_free (settings->priv->xkb_registry_loader);
+  if (settings->priv->xkb_registry != NULL)
+    xfce_xkb_registry_unref (settings->priv->xkb_registry);
+
+  if (settings->priv->layout_selection_treestore != NULL)
+    {
+      guint i;
+
+      for (i = 0; i < settings->priv->layout_search->len; i++)
+        g_free (g_array_index (settings->priv->layout_search, XfceKeyboardLayoutSearch, i).text);
+      g_array_free (settings->priv->layout_search, TRUE);
+      g_free (settings->priv->layout_search_query);
+
+      g_hash_table_destroy (settings->priv->layout_selection_rows);
+      g_object_unref (G_OBJECT (settings->priv->layout_selection_filter));
+      g_object_unref (G_OBJECT (settings->priv->layout_selection_treestore));
+    }
+
   g_object_unref (settings->priv->xkl_rec_config);
   g_object_unref (settings->priv->xkl_registry);
   g_object_unref (settings->priv->xkl_engine);
@@ -522,6 +592,10 @@ xfce_keyboard_settings_finalize (GObject *object)
 
   g_object_unref (G_OBJECT (settings->priv->provider));
 
+  g_hash_table_destroy (settings->priv->shortcuts_rows);
+  g_hash_table_destroy (settings->priv->shortcuts_labels);
+  g_object_unref (G_OBJECT (settings->priv->shortcuts_store));
+
   (*G_OBJECT_CLASS (xfce_keyboard_settings_parent_class)->finalize) (object);
 }
 
@@ -587,17 +661,86 @@ xfce_keyboard_settings_initialize_shortcuts (XfceKeyboardSettings *settings)
 
 
 
-static void
-_xfce_keyboard_settings_load_shortcut (XfceShortcut         *shortcut,
-                                       XfceKeyboardSettings *settings)
+static const gchar *
+xfce_keyboard_settings_shortcut_label (XfceKeyboardSettings *settings,
+                                       const gchar          *shortcut)
 {
   GdkModifierType  modifiers;
-  GtkTreeModel    *tree_model;
-  GtkTreeIter      iter;
-  GObject         *tree_view;
   guint            keyval;
   gchar           *label;
 
+  label = g_hash_table_lookup (settings->priv->shortcuts_labels, shortcut);
+  if (G_UNLIKELY (label == NULL))
+    {
+      /* Get the shortcut label */
+      gtk_accelerator_parse (shortcut, &keyval, &modifiers);
+      label = gtk_accelerator_get_label (keyval, modifiers);
+
+      g_hash_table_insert (settings->priv->shortcuts_labels, g_strdup (shortcut), label);
+    }
+
+  return label;
+}
+
+
+
+static void
+xfce_keyboard_settings_set_row (XfceKeyboardSettings *settings,
+                                const gchar          *shortcut,
+                                const gchar          *command,
+                                gboolean              snotify)
+{
+  GtkTreeIter *row;
+  GtkTreeIter  iter;
+  const gchar *label;
+
+  label = xfce_keyboard_settings_shortcut_label (settings, shortcut);
+
+  row = g_hash_table_lookup (settings->priv->shortcuts_rows, shortcut);
+  if (row != NULL)
+    {
+      /* Update the existing row of this shortcut */
+      gtk_list_store_set (settings->priv->shortcuts_store, row,
+                          COMMAND_COLUMN, command,
+                          SNOTIFY_COLUMN, snotify,
+                          SHORTCUT_LABEL_COLUMN, label, -1);
+    }
+  else
+    {
+      gtk_list_store_insert_with_values (settings->priv->shortcuts_store, &iter, 0,
+                                         COMMAND_COLUMN, command,
+                                         SHORTCUT_COLUMN, shortcut,
+                                         SNOTIFY_COLUMN, snotify,
+                                         SHORTCUT_LABEL_COLUMN, label, -1);
+
+      /* List store iters persist, so we can keep them around */
+      g_hash_table_insert (settings->priv->shortcuts_rows, g_strdup (shortcut),
+                           gtk_tree_iter_copy (&iter));
+    }
+}
+
+
+
+static void
+xfce_keyboard_settings_remove_row (XfceKeyboardSettings *settings,
+                                   const gchar          *shortcut)
+{
+  GtkTreeIter *row;
+
+  row = g_hash_table_lookup (settings->priv->shortcuts_rows, shortcut);
+  if (G_LIKELY (row != NULL))
+    {
+      gtk_list_store_remove (settings->priv->shortcuts_store, row);
+      g_hash_table_remove (settings->priv->shortcuts_rows, shortcut);
+    }
+}
+
+
+
+static void
+_xfce_keyboard_settings_load_shortcut (XfceShortcut         *shortcut,
+                                       XfceKeyboardSettings *settings)
+{
   g_return_if_fail (XFCE_IS_KEYBOARD_SETTINGS (settings));
   g_return_if_fail (shortcut != NULL);
 
@@ -605,21 +748,8 @@ _xfce_keyboard_settings_load_shortcut (XfceShortcut         *shortcut,
        shortcut->property_name, shortcut->shortcut,
        shortcut->command, shortcut->snotify ? "true" : "false");
 
-  tree_view = gtk_builder_get_object (GTK_BUILDER (settings), "kbd_shortcuts_view");
-  tree_model = gtk_tree_view_get_model (GTK_TREE_VIEW (tree_view));
-
-  /* Get the shortcut label */
-  gtk_accelerator_parse (shortcut->shortcut, &keyval, &modifiers);
-  label = gtk_accelerator_get_label (keyval, modifiers);
-
-  gtk_list_store_append (GTK_LIST_STORE (tree_model), &iter);
-  gtk_list_store_set (GTK_LIST_STORE (tree_model), &iter,
-                      COMMAND_COLUMN, shortcut->command,
-                      SHORTCUT_COLUMN, shortcut->shortcut,
-                      SNOTIFY_COLUMN, shortcut->snotify,
-                      SHORTCUT_LABEL_COLUMN, label, -1);
-
-  g_free (label);
+  xfce_keyboard_settings_set_row (settings, shortcut->shortcut,
+                                  shortcut->command, shortcut->snotify);
 }
 
 
@@ -627,7 +757,8 @@ _xfce_keyboard_settings_load_shortcut (XfceShortcut         *shortcut,
 static void
 xfce_keyboard_settings_load_shortcuts (XfceKeyboardSettings *settings)
 {
-  GList *shortcuts;
+  GList   *shortcuts;
+  GObject *tree_view;
 
   g_return_if_fail (XFCE_IS_KEYBOARD_SETTINGS (settings));
   g_return_if_fail (XFCE_IS_SHORTCUTS_PROVIDER (settings->priv->provider));
@@ -635,9 +766,15 @@ xfce_keyboard_settings_load_shortcuts (XfceKeyboardSettings *settings)
   /* Get all (custom) command shortcuts */
   shortcuts = xfce_shortcuts_provider_get_shortcuts (settings->priv->provider);
 
+  /* Detach the model so the view does not follow every insert */
+  tree_view = gtk_builder_get_object (GTK_BUILDER (settings), "kbd_shortcuts_view");
+  gtk_tree_view_set_model (GTK_TREE_VIEW (tree_view), NULL);
+
   /* Load shortcuts one by one */
   g_list_foreach (shortcuts, (GFunc) _xfce_keyboard_settings_load_shortcut, settings);
 
+  gtk_tree_view_set_model (GTK_TREE_VIEW (tree_view), GTK_TREE_MODEL (settings->priv->shortcuts_store));
+
   xfce_shortcuts_free (shortcuts);
 }
 
@@ -682,7 +819,7 @@ xfce_keyboard_settings_edit_shortcut (XfceKeyboardSettings *settings,
       if (G_LIKELY (response == GTK_RESPONSE_OK))
         {
           /* Remove old shortcut from the settings */
-          gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
+          xfce_keyboard_settings_remove_row (settings, shortcut);
           xfce_shortcuts_provider_reset_shortcut (settings->priv->provider, shortcut);
 
           /* Get the shortcut entered by the user */
@@ -749,9 +886,6 @@ xfce_keyboard_settings_edit_command (XfceKeyboardSettings *settings,
           if (g_strcmp0 (command, new_command) != 0
               || snotify != new_snotify)
             {
-              /* Remove the row because we add new one from the shortcut-added signal */
-              gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
-
               /* Save settings */
               xfce_shortcuts_provider_set_shortcut (settings->priv->provider, shortcut,
                                                     new_command, new_snotify);
@@ -889,38 +1023,17 @@ xfce_keyboard_settings_shortcut_added (XfceShortcutsProvider *provider,
                                        XfceKeyboardSettings  *settings)
 {
   XfceShortcut *sc;
-  GtkTreeModel *model;
-  GObject      *view;
-  GtkTreeIter   iter;
 
   g_return_if_fail (XFCE_IS_KEYBOARD_SETTINGS (settings));
 
-  view = gtk_builder_get_object (GTK_BUILDER (settings), "kbd_shortcuts_view");
-  model = gtk_tree_view_get_model (GTK_TREE_VIEW (view));
-
   sc = xfce_shortcuts_provider_get_shortcut (settings->priv->provider, shortcut);
 
   if (G_LIKELY (sc != NULL))
     {
-      GdkModifierType  modifiers;
-      guint            keyval;
-      gchar           *label;
-
-      gtk_list_store_append (GTK_LIST_STORE (model), &iter);
-
-      /* Get the shortcut label */
-      gtk_accelerator_parse (sc->shortcut, &keyval, &modifiers);
-      label = gtk_accelerator_get_label (keyval, modifiers);
-
       DBG ("Add shortcut %s for command %s", shortcut, sc->command);
 
-      gtk_list_store_set (GTK_LIST_STORE (model), &iter,
-                          SHORTCUT_COLUMN, shortcut,
-                          COMMAND_COLUMN, sc->command,
-                          SNOTIFY_COLUMN, sc->snotify,
-                          SHORTCUT_LABEL_COLUMN, label, -1);
-
-      g_free (label);
+      /* Updates the row in place if the shortcut is already listed */
+      xfce_keyboard_settings_set_row (settings, shortcut, sc->command, sc->snotify);
 
       xfce_shortcut_free (sc);
     }
@@ -928,48 +1041,16 @@ xfce_keyboard_settings_shortcut_added (XfceShortcutsProvider *provider,
 
 
 
-
-static gboolean
-_xfce_keyboard_settings_remove_shortcut (GtkTreeModel *model,
-                                         GtkTreePath  *path,
-                                         GtkTreeIter  *iter,
-                                         const gchar  *shortcut)
-{
-  gboolean finished = FALSE;
-  gchar   *row_shortcut;
-
-  gtk_tree_model_get (model, iter, SHORTCUT_COLUMN, &row_shortcut, -1);
-
-  if (G_UNLIKELY (g_utf8_collate (row_shortcut, shortcut) == 0))
-    {
-      gtk_list_store_remove (GTK_LIST_STORE (model), iter);
-      finished = TRUE;
-    }
-
-  g_free (row_shortcut);
-
-  return finished;
-}
-
-
-
 static void
 xfce_keyboard_settings_shortcut_removed (XfceShortcutsProvider *provider,
                                          const gchar           *shortcut,
                                          XfceKeyboardSettings  *settings)
 {
-  GtkTreeModel *model;
-  GObject      *view;
-
   g_return_if_fail (XFCE_IS_KEYBOARD_SETTINGS (settings));
 
-  view = gtk_builder_get_object (GTK_BUILDER (settings), "kbd_shortcuts_view");
-  model = gtk_tree_view_get_model (GTK_TREE_VIEW (view));
-
   DBG ("Remove shortcut %s from treeview", shortcut);
 
-  gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) _xfce_keyboard_settings_remove_shortcut,
-                          (gpointer) shortcut);
+  xfce_keyboard_settings_remove_row (settings, shortcut);
 }
 
 
@@ -1159,14 +1240,16 @@ xfce_keyboard_settings_edit_button_clicked (XfceKeyboardSettings *settings)
                   test_new_shortcut = (g_strcmp0 (shortcut, new_shortcut) != 0);
                   if (g_strcmp0 (command, new_command) != 0 || (test_new_shortcut) || snotify != new_snotify)
                     {
-                      /* Remove the row because we add new one from the
-                       * shortcut-added signal */
-                      gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
-
                       if (test_new_shortcut)
-                        /* Remove old keyboard shortcut via xfconf */
-                        xfce_shortcuts_provider_reset_shortcut (settings->priv->provider,
-                                                                shortcut);
+                        {
+                          /* Remove the row because we add new one from the
+                           * shortcut-added signal */
+                          xfce_keyboard_settings_remove_row (settings, shortcut);
+
+                          /* Remove old keyboard shortcut via xfconf */
+                          xfce_shortcuts_provider_reset_shortcut (settings->priv->provider,
+                                                                  shortcut);
+                        }
 
                       /* Save settings */
                       xfce_shortcuts_provider_set_shortcut (settings->priv->provider,
@@ -1262,8 +1345,6 @@ static void
 xfce_keyboard_settings_reset_button_clicked (XfceKeyboardSettings *settings)
 {
   gint          response;
-  GObject      *view;
-  GtkListStore *store;
 
   g_return_if_fail (XFCE_IS_KEYBOARD_SETTINGS (settings));
 
@@ -1277,11 +1358,9 @@ xfce_keyboard_settings_reset_button_clicked (XfceKeyboardSettings *settings)
 
   if (G_LIKELY (response == GTK_RESPONSE_YES))
     {
-      view = gtk_builder_get_object (GTK_BUILDER (settings), "kbd_shortcuts_view");
-
       /* Clear out all the previous entries */
-      store = GTK_LIST_STORE (gtk_tree_view_get_model (GTK_TREE_VIEW (view)));
-      gtk_list_store_clear (store);
+      g_hash_table_remove_all (settings->priv->shortcuts_rows);
+      gtk_list_store_clear (settings->priv->shortcuts_store);
 
       xfce_shortcuts_provider_reset_to_defaults (settings->priv->provider);
     }
@@ -1291,24 +1370,6 @@ xfce_keyboard_settings_reset_button_clicked (XfceKeyboardSettings *settings)
 
 #ifdef HAVE_LIBXKLAVIER
 
-static gchar *
-xfce_keyboard_settings_xkb_description (XklConfigItem *config_item)
-{
-  gchar *ci_description;
-  gchar *description;
-
-  ci_description = g_strstrip (config_item->description);
-
-  if (ci_description[0] == 0)
-    description = g_strdup (config_item->name);
-  else
-    description = g_strdup (ci_description);
-
-  return description;
-}
-
-
-
 static gboolean
 xfce_keyboard_settings_update_sensitive (GtkToggleButton *toggle, XfceKeyboardSettings *settings)
 {
@@ -1473,25 +1534,16 @@ xfce_keyboard_settings_init_layout (XfceKeyboardSettings *settings)
 
   for (layout = layouts, variant = variants, group_id = 0; *layout != NULL; ++layout, ++group_id)
     {
-      XklConfigItem *litem;
-      XklConfigItem *vitem;
-      gchar         *layout_desc;
-      gchar         *variant_desc;
-
-      litem = xkl_config_item_new ();
-      vitem = xkl_config_item_new ();
-
-      g_snprintf (litem->name, sizeof litem->name, "%s", *layout);
-      g_snprintf (vitem->name, sizeof vitem->name, "%s", *variant);
+      const gchar *layout_desc;
+      const gchar *variant_desc = NULL;
 
-      if (xkl_config_registry_find_layout (settings->priv->xkl_registry, litem))
-        layout_desc = litem->description;
-      else
+      layout_desc = xfce_xkb_registry_find_layout (settings->priv->xkb_registry, *layout);
+      if (layout_desc == NULL)
         layout_desc = *layout;
 
-      if (xkl_config_registry_find_variant (settings->priv->xkl_registry, *layout, vitem))
-        variant_desc = vitem->description;
-      else
+      if (*variant != NULL)
+        variant_desc = xfce_xkb_registry_find_variant (settings->priv->xkb_registry, *layout, *variant);
+      if (variant_desc == NULL)
         variant_desc = *variant;
 
       gtk_list_store_append (GTK_LIST_STORE (model), &iter);
@@ -1505,9 +1557,6 @@ xfce_keyboard_settings_init_layout (XfceKeyboardSettings *settings)
 
       if (*variant)
         variant++;
-
-      g_object_unref (litem);
-      g_object_unref (vitem);
     }
 
   g_strfreev (layouts);
@@ -1521,21 +1570,73 @@ xfce_keyboard_settings_init_layout (XfceKeyboardSettings *settings)
 
 
 static void
-xfce_keyboard_settings_layouts_combo_add (XklConfigRegistry    *config_registry,
-                                          const XklConfigItem  *config_item,
-                                          gpointer              user_data)
+xfce_keyboard_settings_xkb_registry_ready (XfceKeyboardSettings *settings)
+{
+  GObject *xkb_tab_layout_vbox;
+
+  /* Keyboard model combo */
+  xfce_keyboard_settings_layouts_combo_populate (settings,
+                                                 "xkb_model_combo",
+                                                 NULL,
+                                                 xfce_keyboard_settings_init_model,
+                                                 xfce_keyboard_settings_model_changed_cb);
+  /* Group key combo */
+  xfce_keyboard_settings_layouts_combo_populate (settings,
+                                                 "xkb_grpkey_combo",
+                                                 "grp",
+                                                 xfce_keyboard_settings_init_grpkey,
+                                                 xfce_keyboard_settings_grpkey_changed_cb);
+  /* Compose key combo */
+  xfce_keyboard_settings_layouts_combo_populate (settings,
+                                                 "xkb_composekey_combo",
+                                                 "Compose key",
+                                                 xfce_keyboard_settings_init_compkey,
+                                                 xfce_keyboard_settings_compkey_changed_cb);
+
+  xfce_keyboard_settings_init_layout (settings);
+  xfce_keyboard_settings_update_layout_buttons (settings);
+
+  xkb_tab_layout_vbox = gtk_builder_get_object (GTK_BUILDER (settings), "xkb_tab_layout_vbox");
+  gtk_widget_set_sensitive (GTK_WIDGET (xkb_tab_layout_vbox), TRUE);
+}
+
+
+
+static gboolean
+xfce_keyboard_settings_xkb_registry_load (gpointer user_data)
+{
+  XfceKeyboardSettings *settings = XFCE_KEYBOARD_SETTINGS (user_data);
+
+  /* Give the main loop a chance to run between the steps */
+  if (xfce_xkb_registry_loader_step (settings->priv->xkb_registry_loader))
+    return TRUE;
+
+  settings->priv->xkb_registry_idle_id = 0;
+
+  /* Keep a snapshot of the rules database for the next time */
+  settings->priv->xkb_registry = xfce_xkb_registry_loader_finish (settings->priv->xkb_registry_loader);
+  settings->priv->xkb_registry_loader = NULL;
+  xfce_xkb_registry_save_cache (settings->priv->xkb_registry);
+
+  xfce_keyboard_settings_xkb_registry_ready (settings);
+
+  return FALSE;
+}
+
+
+
+static void
+xfce_keyboard_settings_layouts_combo_add (const gchar *name,
+                                          const gchar *description,
+                                          gpointer     user_data)
 {
   GtkListStore *store = GTK_LIST_STORE (user_data);
   GtkTreeIter   iter;
-  gchar        *description;
-
-  description = xfce_keyboard_settings_xkb_description ((XklConfigItem *) config_item);
 
   gtk_list_store_append (store, &iter);
   gtk_list_store_set (store, &iter,
                       XKB_LAYOUTS_COMBO_DESCRIPTION, description,
-                      XKB_LAYOUTS_COMBO_VALUE, config_item->name, -1);
-  g_free (description);
+                      XKB_LAYOUTS_COMBO_VALUE, name, -1);
 }
 
 static void
@@ -1869,47 +1970,158 @@ xfce_keyboard_settings_layout_move (GtkWidget *widget,
 
 
 static void
-xfce_keyboard_settings_add_variant_to_list (XklConfigRegistry    *config_registry,
-                                            XklConfigItem        *config_item,
+xfce_keyboard_settings_add_variant_to_list (const gchar          *name,
+                                            const gchar          *description,
                                             XfceKeyboardSettings *settings)
 {
-  GtkTreeStore *treestore;
+  GtkTreeStore *treestore = settings->priv->layout_selection_treestore;
   GtkTreeIter   iter;
-  GObject      *treeview;
-  gchar        *variant;
+  gchar        *layout;
+  gchar        *key;
+  gint          parent;
+
+  gtk_tree_model_get (GTK_TREE_MODEL (treestore), &settings->priv->layout_selection_iter,
+                      XKB_AVAIL_LAYOUTS_TREE_ID, &layout,
+                      XKB_AVAIL_LAYOUTS_TREE_SEARCH_INDEX, &parent, -1);
 
-  variant = xfce_keyboard_settings_xkb_description (config_item);
-  treeview = gtk_builder_get_object (GTK_BUILDER (settings), "layout_selection_view");
-  treestore = GTK_TREE_STORE (gtk_tree_view_get_model (GTK_TREE_VIEW (treeview)));
   gtk_tree_store_append (treestore, &iter, &settings->priv->layout_selection_iter);
-  gtk_tree_store_set (treestore, &iter,
-                      XKB_AVAIL_LAYOUTS_TREE_DESCRIPTION, variant,
-                      XKB_AVAIL_LAYOUTS_TREE_ID, config_item->name, -1);
-  g_free (variant);
+
+  key = g_strdup_printf ("%s(%s)", layout, name);
+  xfce_keyboard_settings_layout_search_add (settings, &iter, key, name, description, parent);
+
+  g_free (layout);
 }
 
 
 
 static void
-xfce_keyboard_settings_add_layout_to_list (XklConfigRegistry    *config_registry,
-                                           XklConfigItem        *config_item,
+xfce_keyboard_settings_add_layout_to_list (const gchar          *name,
+                                           const gchar          *description,
                                            XfceKeyboardSettings *settings)
 {
-  GtkTreeStore *treestore;
-  GObject      *treeview;
-  gchar        *layout;
+  GtkTreeStore *treestore = settings->priv->layout_selection_treestore;
 
-  layout = xfce_keyboard_settings_xkb_description (config_item);
-  treeview = gtk_builder_get_object (GTK_BUILDER (settings), "layout_selection_view");
-  treestore = GTK_TREE_STORE (gtk_tree_view_get_model (GTK_TREE_VIEW (treeview)));
   gtk_tree_store_append (treestore, &settings->priv->layout_selection_iter, NULL);
-  gtk_tree_store_set (treestore, &settings->priv->layout_selection_iter,
-                      XKB_AVAIL_LAYOUTS_TREE_DESCRIPTION, layout,
-                      XKB_AVAIL_LAYOUTS_TREE_ID, config_item->name, -1);
-  g_free (layout);
+  xfce_keyboard_settings_layout_search_add (settings, &settings->priv->layout_selection_iter,
+                                            g_strdup (name), name, description, -1);
 
-  xkl_config_registry_foreach_layout_variant (config_registry, config_item->name,
-      (ConfigItemProcessFunc)xfce_keyboard_settings_add_variant_to_list, settings);
+  xfce_xkb_registry_foreach_layout_variant (settings->priv->xkb_registry, name,
+      (XfceXkbRegistryFunc) xfce_keyboard_settings_add_variant_to_list, settings);
+}
+
+
+
+static void
+xfce_keyboard_settings_layout_search_add (XfceKeyboardSettings *settings,
+                                          GtkTreeIter          *iter,
+                                          gchar                *key,
+                                          const gchar          *name,
+                                          const gchar          *description,
+                                          gint                  parent)
+{
+  XfceKeyboardLayoutSearch  item;
+  gchar                    *normalized;
+  gchar                    *text;
+
+  /* Fold the description and the id once so searching is a plain substring match */
+  text = g_strconcat (description, "\n", name, NULL);
+  normalized = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+  item.text = g_utf8_casefold (normalized, -1);
+  item.parent = parent;
+  item.matched = TRUE;
+  item.visible = TRUE;
+  g_free (normalized);
+  g_free (text);
+
+  g_array_append_val (settings->priv->layout_search, item);
+
+  gtk_tree_store_set (settings->priv->layout_selection_treestore, iter,
+                      XKB_AVAIL_LAYOUTS_TREE_DESCRIPTION, description,
+                      XKB_AVAIL_LAYOUTS_TREE_ID, name,
+                      XKB_AVAIL_LAYOUTS_TREE_SEARCH_INDEX, settings->priv->layout_search->len - 1, -1);
+
+  /* Tree store iters persist, so we can keep them around */
+  g_hash_table_insert (settings->priv->layout_selection_rows, key, gtk_tree_iter_copy (iter));
+}
+
+
+
+static gboolean
+xfce_keyboard_settings_layout_visible (GtkTreeModel *model,
+                                       GtkTreeIter  *iter,
+                                       gpointer      user_data)
+{
+  XfceKeyboardSettings *settings = XFCE_KEYBOARD_SETTINGS (user_data);
+  gint                  index;
+
+  gtk_tree_model_get (model, iter, XKB_AVAIL_LAYOUTS_TREE_SEARCH_INDEX, &index, -1);
+  if (G_UNLIKELY (index < 0 || (guint) index >= settings->priv->layout_search->len))
+    return TRUE;
+
+  return g_array_index (settings->priv->layout_search, XfceKeyboardLayoutSearch, index).visible;
+}
+
+
+
+static void
+xfce_keyboard_settings_layout_search_changed (GtkEditable          *editable,
+                                              XfceKeyboardSettings *settings)
+{
+  XfceKeyboardLayoutSearch *items = (XfceKeyboardLayoutSearch *) settings->priv->layout_search->data;
+  GObject                  *layout_selection_view;
+  GtkTreeSelection         *selection;
+  GtkTreeIter               iter;
+  GtkTreePath              *path;
+  gboolean                  narrowing;
+  gchar                    *normalized;
+  gchar                    *query;
+  guint                     i, n_items = settings->priv->layout_search->len;
+
+  normalized = g_utf8_normalize (gtk_entry_get_text (GTK_ENTRY (editable)), -1, G_NORMALIZE_ALL);
+  query = g_utf8_casefold (normalized, -1);
+  g_free (normalized);
+
+  /* When the query only got longer, rows that did not match before cannot match now */
+  narrowing = (settings->priv->layout_search_query != NULL
+               && g_str_has_prefix (query, settings->priv->layout_search_query));
+
+  for (i = 0; i < n_items; i++)
+    if (!narrowing || items[i].matched)
+      items[i].matched = (*query == '\0' || strstr (items[i].text, query) != NULL);
+
+  /* Variants of a matching layout stay visible and a matching
+   * variant keeps its layout visible */
+  for (i = 0; i < n_items; i++)
+    items[i].visible = items[i].matched || (items[i].parent >= 0 && items[items[i].parent].matched);
+  for (i = 0; i < n_items; i++)
+    if (items[i].visible && items[i].parent >= 0)
+      items[items[i].parent].visible = TRUE;
+
+  gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (settings->priv->layout_selection_filter));
+
+  layout_selection_view = gtk_builder_get_object (GTK_BUILDER (settings), "layout_selection_view");
+  if (*query != '\0')
+    {
+      gtk_tree_view_expand_all (GTK_TREE_VIEW (layout_selection_view));
+
+      /* Select the first match */
+      if (gtk_tree_model_get_iter_first (settings->priv->layout_selection_filter, &iter))
+        {
+          selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (layout_selection_view));
+          gtk_tree_selection_select_iter (selection, &iter);
+
+          path = gtk_tree_model_get_path (settings->priv->layout_selection_filter, &iter);
+          gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (layout_selection_view), path, NULL, FALSE, 0, 0);
+          gtk_tree_path_free (path);
+        }
+    }
+  else
+    {
+      gtk_tree_view_collapse_all (GTK_TREE_VIEW (layout_selection_view));
+    }
+
+  g_free (settings->priv->layout_search_query);
+  settings->priv->layout_search_query = query;
 }
 
 
@@ -1932,10 +2144,13 @@ xfce_keyboard_settings_layout_selection (XfceKeyboardSettings *settings,
 {
   GObject           *keyboard_layout_selection_dialog;
   GObject           *layout_selection_view;
+  GObject           *scrolled_window;
+  GtkWidget         *box;
   GtkTreePath       *path;
   GtkCellRenderer   *renderer;
   GtkTreeModel      *model;
   GtkTreeIter        iter;
+  GtkTreeIter       *row = NULL;
   GtkTreeViewColumn *column;
   GtkTreeSelection  *selection;
   gchar            **val_layout;
@@ -1943,6 +2158,7 @@ xfce_keyboard_settings_layout_selection (XfceKeyboardSettings *settings,
   gchar             *variant_desc;
   gchar             *layout;
   gchar             *variant;
+  gchar             *key;
   gint               result;
 
   keyboard_layout_selection_dialog = gtk_builder_get_object (GTK_BUILDER (settings), "keyboard-layout-selection-dialog");
@@ -1952,130 +2168,80 @@ xfce_keyboard_settings_layout_selection (XfceKeyboardSettings *settings,
 
   if (!settings->priv->layout_selection_treestore)
     {
-      settings->priv->layout_selection_treestore = gtk_tree_store_new (XKB_AVAIL_LAYOUTS_TREE_NUM_COLUMNS, G_TYPE_STRING, G_TYPE_STRING);
+      settings->priv->layout_selection_treestore = gtk_tree_store_new (XKB_AVAIL_LAYOUTS_TREE_NUM_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT);
+      settings->priv->layout_selection_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                                     (GDestroyNotify) gtk_tree_iter_free);
+      settings->priv->layout_search = g_array_new (FALSE, FALSE, sizeof (XfceKeyboardLayoutSearch));
+      gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (settings->priv->layout_selection_treestore), 0, GTK_SORT_ASCENDING);
+      xfce_xkb_registry_foreach_layout (settings->priv->xkb_registry,
+          (XfceXkbRegistryFunc) xfce_keyboard_settings_add_layout_to_list, settings);
+
+      /* Only filter once the store is complete */
+      settings->priv->layout_selection_filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (settings->priv->layout_selection_treestore), NULL);
+      gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (settings->priv->layout_selection_filter),
+                                              xfce_keyboard_settings_layout_visible, settings, NULL);
+
       renderer = gtk_cell_renderer_text_new ();
       column   = gtk_tree_view_column_new_with_attributes (NULL, renderer, "text",
                                         XKB_AVAIL_LAYOUTS_TREE_DESCRIPTION, NULL);
-      gtk_tree_view_set_model (GTK_TREE_VIEW (layout_selection_view), GTK_TREE_MODEL (settings->priv->layout_selection_treestore));
+      gtk_tree_view_set_model (GTK_TREE_VIEW (layout_selection_view), settings->priv->layout_selection_filter);
       gtk_tree_view_append_column (GTK_TREE_VIEW (layout_selection_view), column);
-      gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (settings->priv->layout_selection_treestore), 0, GTK_SORT_ASCENDING);
-      xkl_config_registry_foreach_layout (settings->priv->xkl_registry,
-          (ConfigItemProcessFunc) xfce_keyboard_settings_add_layout_to_list, settings);
       g_signal_connect (GTK_TREE_VIEW (layout_selection_view), "row-activated", G_CALLBACK (xfce_keyboard_settings_layout_activate_cb), keyboard_layout_selection_dialog);
       gtk_dialog_set_default_response (GTK_DIALOG (keyboard_layout_selection_dialog), GTK_RESPONSE_OK);
+
+      /* Search entry above the layouts */
+      scrolled_window = gtk_builder_get_object (GTK_BUILDER (settings), "scrolledwindow3");
+      box = gtk_hbox_new (FALSE, 0);
+      gtk_container_set_border_width (GTK_CONTAINER (box), 6);
+      gtk_box_pack_start (GTK_BOX (gtk_widget_get_parent (GTK_WIDGET (scrolled_window))), box, FALSE, TRUE, 0);
+      gtk_box_reorder_child (GTK_BOX (gtk_widget_get_parent (GTK_WIDGET (scrolled_window))), box, 0);
+      gtk_widget_show (box);
+
+      settings->priv->layout_search_entry = gtk_entry_new ();
+      gtk_entry_set_icon_from_stock (GTK_ENTRY (settings->priv->layout_search_entry), GTK_ENTRY_ICON_PRIMARY, GTK_STOCK_FIND);
+      gtk_entry_set_activates_default (GTK_ENTRY (settings->priv->layout_search_entry), TRUE);
+      gtk_box_pack_start (GTK_BOX (box), settings->priv->layout_search_entry, TRUE, TRUE, 0);
+      g_signal_connect (G_OBJECT (settings->priv->layout_search_entry), "changed",
+                        G_CALLBACK (xfce_keyboard_settings_layout_search_changed), settings);
+      gtk_widget_show (settings->priv->layout_search_entry);
     }
 
+  /* Start with all the layouts */
+  gtk_entry_set_text (GTK_ENTRY (settings->priv->layout_search_entry), "");
+  gtk_widget_grab_focus (settings->priv->layout_search_entry);
+
   model = gtk_tree_view_get_model (GTK_TREE_VIEW (layout_selection_view));
   gtk_tree_view_collapse_all (GTK_TREE_VIEW (layout_selection_view));
 
   /* Selected and expand the layout/variant to be edited */
   if (edit_layout && g_strcmp0 (edit_layout, ""))
     {
-      gboolean found;
-
-      if (gtk_tree_model_get_iter_first (model, &iter))
+      if (edit_variant && g_strcmp0 (edit_variant, ""))
         {
-          gchar *tmp_layout;
-          found = FALSE;
-
-          do
-            {
-              gtk_tree_model_get (model, &iter, XKB_AVAIL_LAYOUTS_TREE_ID, &tmp_layout, -1);
-              path = gtk_tree_model_get_path (model, &iter);
-
-              if (found)
-                break;
-
-              if (g_strcmp0 (tmp_layout, edit_layout) == 0 )
-                {
-                  if (edit_variant && g_strcmp0 (edit_variant, "") && gtk_tree_model_iter_has_child (model, &iter))
-                    {
-                      GtkTreeIter iter2;
-                      gint n, i;
-
-                      n = gtk_tree_model_iter_n_children (model, &iter);
-
-                      for (i = 0; i < n; i ++)
-                        {
-                          if (gtk_tree_model_iter_nth_child (model, &iter2, &iter, i))
-                            {
-                              gchar *tmp_variant;
-
-                              gtk_tree_model_get (model, &iter2, XKB_AVAIL_LAYOUTS_TREE_ID, &tmp_variant, -1);
-
-                              if (g_strcmp0 (tmp_variant, edit_variant) == 0)
-                                {
-                                  GtkTreePath *path2;
-
-                                  path2 = gtk_tree_model_get_path (model, &iter2);
-
-                                  gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (layout_selection_view),
-                                                                               path2, NULL,
-                                                                               TRUE, 0.5, 0);
-                                  gtk_tree_view_expand_row (GTK_TREE_VIEW (layout_selection_view),
-                                                            path,
-                                                            TRUE);
-                                  gtk_tree_selection_select_iter (selection, &iter2);
-
-                                  found = TRUE;
-                                  g_free (tmp_variant);
-                                  gtk_tree_path_free (path2);
-                                  break;
-                                }
-
-                              g_free (tmp_variant);
-                            }
-                        }
-                    }
-                else
-                  {
-                    gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (layout_selection_view),
-                                                                 path, NULL,
-                                                                 TRUE, 0.5, 0);
-                    gtk_tree_selection_select_iter (selection, &iter);
-                    found = TRUE;
-                    break;
-                  }
-              }
+          key = g_strdup_printf ("%s(%s)", edit_layout, edit_variant);
+          row = g_hash_table_lookup (settings->priv->layout_selection_rows, key);
+          g_free (key);
+        }
 
-              gtk_tree_path_free (path);
-              path = NULL;
-              g_free (tmp_layout);
-              tmp_layout = NULL;
-            }
-          while (gtk_tree_model_iter_next (model, &iter));
-          g_free (tmp_layout);
-          if (path)
-            gtk_tree_path_free (path);
+      if (row == NULL)
+        row = g_hash_table_lookup (settings->priv->layout_selection_rows, edit_layout);
+    }
 
-          if (!found)
-            {
-              /* We did not find the iter to be edited, fallback to the first one */
-              if (gtk_tree_model_get_iter_first (model, &iter))
-                {
-                  path = gtk_tree_model_get_path (model, &iter);
-                  gtk_tree_selection_select_iter (selection, &iter);
+  if (row != NULL)
+    gtk_tree_model_filter_convert_child_iter_to_iter (GTK_TREE_MODEL_FILTER (model), &iter, row);
 
-                  gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (layout_selection_view),
-                                                path, NULL,
-                                                TRUE, 0.5, 0);
-                  gtk_tree_path_free (path);
-                }
-            }
-        }
-    }
-  else
+  /* Fallback to the first one if there is nothing to edit or we did not find it */
+  if (row != NULL || gtk_tree_model_get_iter_first (model, &iter))
     {
-      if (gtk_tree_model_get_iter_first (model, &iter))
-        {
-          path = gtk_tree_model_get_path (model, &iter);
-          gtk_tree_selection_select_iter (selection, &iter);
-
-          gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (layout_selection_view),
-                                        path, NULL,
-                                        TRUE, 0.5, 0);
-          gtk_tree_path_free (path);
-        }
+      path = gtk_tree_model_get_path (model, &iter);
+      if (gtk_tree_path_get_depth (path) > 1)
+        gtk_tree_view_expand_to_path (GTK_TREE_VIEW (layout_selection_view), path);
+      gtk_tree_selection_select_iter (selection, &iter);
+
+      gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (layout_selection_view),
+                                    path, NULL,
+                                    TRUE, 0.5, 0);
+      gtk_tree_path_free (path);
     }
 
   val_layout = NULL;
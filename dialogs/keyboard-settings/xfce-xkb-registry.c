@@ -0,0 +1,750 @@
+/* vi:set sw=2 sts=2 ts=2 et ai: */
+/*-
+ * Copyright (C) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_LIBXKLAVIER
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include "xfce-xkb-registry.h"
+
+
+
+/* bump this when the layout of the cache file changes */
+#define XKB_CACHE_VERSION (1)
+#define XKB_CACHE_FILE    "xfce4" G_DIR_SEPARATOR_S "keyboard-settings" G_DIR_SEPARATOR_S "xkb-registry.cache"
+
+/* version, stamp, models, layouts with their variants and
+ * option groups with their options */
+#define XKB_CACHE_TYPE    "(usa(ss)a(ssa(ss))a(ssa(ss)))"
+
+#ifndef XKB_RULES_DIR
+#define XKB_RULES_DIR     "/usr/share/X11/xkb/rules"
+#endif
+
+/* catalog libxklavier translates the descriptions with */
+#define XKB_DOMAIN        "xkeyboard-config"
+
+/* number of layouts or option groups added in one loader step */
+#define XKB_LOAD_CHUNK    (16)
+
+
+
+typedef enum
+{
+  XKB_LOAD_PARSE,
+  XKB_LOAD_LAYOUTS,
+  XKB_LOAD_OPTION_GROUPS,
+  XKB_LOAD_DONE
+}
+XfceXkbLoadStep;
+
+
+
+struct _XfceXkbRegistry
+{
+  gint        ref_count;
+
+  /* serialized registry, either built from the rules
+   * database or mapped from the cache file */
+  GVariant   *data;
+
+  /* name -> (ssa(ss)) child of data */
+  GHashTable *layouts;
+  GHashTable *option_groups;
+};
+
+struct _XfceXkbRegistryLoader
+{
+  XklConfigRegistry *config_registry;
+  XfceXkbLoadStep    step;
+
+  GVariantBuilder   *builder;
+
+  /* name and description pairs of the layouts or
+   * option groups that are added in the current step */
+  GPtrArray         *groups;
+  guint              group;
+};
+
+
+
+static void
+xfce_xkb_registry_stamp_catalog (GString *stamp)
+{
+  const gchar * const *languages;
+  const gchar         *localedir;
+  gchar               *filename;
+  struct stat          statb;
+  guint                i;
+
+#ifdef ENABLE_NLS
+  localedir = bindtextdomain (XKB_DOMAIN, NULL);
+#else
+  localedir = LOCALEDIR;
+#endif
+
+  /* the first catalog gettext finds for the user's languages */
+  languages = g_get_language_names ();
+  for (i = 0; languages[i] != NULL; i++)
+    {
+      if (strcmp (languages[i], "C") == 0)
+        break;
+
+      filename = g_build_filename (localedir, languages[i], "LC_MESSAGES",
+                                   XKB_DOMAIN ".mo", NULL);
+      if (g_stat (filename, &statb) == 0)
+        {
+          g_string_append_printf (stamp, "%s=%" G_GINT64_FORMAT ";",
+                                  filename, (gint64) statb.st_mtime);
+          g_free (filename);
+          break;
+        }
+      g_free (filename);
+    }
+}
+
+
+
+static gchar *
+xfce_xkb_registry_stamp (void)
+{
+  GString     *stamp;
+  GDir        *dir;
+  const gchar *name;
+  gchar       *filename;
+  struct stat  statb;
+  gchar       *checksum;
+
+  stamp = g_string_new (NULL);
+
+  /* descriptions are localized */
+  g_string_append (stamp, g_get_language_names ()[0]);
+  g_string_append_c (stamp, ';');
+  xfce_xkb_registry_stamp_catalog (stamp);
+
+  /* the rules database libxklavier parses */
+  if (g_stat (XKB_RULES_DIR, &statb) == 0)
+    g_string_append_printf (stamp, "%s=%" G_GINT64_FORMAT ";",
+                            XKB_RULES_DIR, (gint64) statb.st_mtime);
+
+  dir = g_dir_open (XKB_RULES_DIR, 0, NULL);
+  if (G_LIKELY (dir != NULL))
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          if (!g_str_has_suffix (name, ".xml"))
+            continue;
+
+          filename = g_build_filename (XKB_RULES_DIR, name, NULL);
+          if (g_stat (filename, &statb) == 0)
+            g_string_append_printf (stamp, "%s=%" G_GINT64_FORMAT ";",
+                                    name, (gint64) statb.st_mtime);
+          g_free (filename);
+        }
+
+      g_dir_close (dir);
+    }
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, stamp->str, stamp->len);
+  g_string_free (stamp, TRUE);
+
+  return checksum;
+}
+
+
+
+static GHashTable *
+xfce_xkb_registry_index (GVariant *items)
+{
+  GHashTable   *index;
+  GVariant     *child;
+  const gchar  *name;
+  gsize         i, n_children;
+
+  index = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                 (GDestroyNotify) g_variant_unref);
+
+  /* the keys point into the children they belong to */
+  n_children = g_variant_n_children (items);
+  for (i = 0; i < n_children; i++)
+    {
+      child = g_variant_get_child_value (items, i);
+      g_variant_get_child (child, 0, "&s", &name);
+      g_hash_table_insert (index, (gpointer) name, child);
+    }
+
+  return index;
+}
+
+
+
+static XfceXkbRegistry *
+xfce_xkb_registry_new (GVariant *data)
+{
+  XfceXkbRegistry *registry;
+  GVariant        *items;
+
+  registry = g_slice_new0 (XfceXkbRegistry);
+  registry->ref_count = 1;
+  registry->data = g_variant_ref_sink (data);
+
+  items = g_variant_get_child_value (data, 3);
+  registry->layouts = xfce_xkb_registry_index (items);
+  g_variant_unref (items);
+
+  items = g_variant_get_child_value (data, 4);
+  registry->option_groups = xfce_xkb_registry_index (items);
+  g_variant_unref (items);
+
+  return registry;
+}
+
+
+
+static void
+xfce_xkb_registry_add_item (XklConfigRegistry   *config_registry,
+                            const XklConfigItem *config_item,
+                            gpointer             user_data)
+{
+  GVariantBuilder *builder = user_data;
+  gchar           *description;
+
+  /* fall back to the name for items without a description */
+  description = g_strstrip (g_strdup (config_item->description));
+  g_variant_builder_add (builder, "(ss)", config_item->name,
+                         *description != '\0' ? description : config_item->name);
+  g_free (description);
+}
+
+
+
+static void
+xfce_xkb_registry_add_group_name (XklConfigRegistry   *config_registry,
+                                  const XklConfigItem *config_item,
+                                  gpointer             user_data)
+{
+  GPtrArray *groups = user_data;
+  gchar     *description;
+
+  /* the items of the group are queried in later steps */
+  description = g_strstrip (g_strdup (config_item->description));
+  if (*description == '\0')
+    {
+      g_free (description);
+      description = g_strdup (config_item->name);
+    }
+
+  g_ptr_array_add (groups, g_strdup (config_item->name));
+  g_ptr_array_add (groups, description);
+}
+
+
+
+static gboolean
+xfce_xkb_registry_loader_add_groups (XfceXkbRegistryLoader *loader)
+{
+  const gchar *name;
+  guint        n;
+
+  for (n = 0; n < XKB_LOAD_CHUNK && loader->group < loader->groups->len; n++)
+    {
+      name = g_ptr_array_index (loader->groups, loader->group);
+
+      g_variant_builder_open (loader->builder, G_VARIANT_TYPE ("(ssa(ss))"));
+      g_variant_builder_add (loader->builder, "s", name);
+      g_variant_builder_add (loader->builder, "s", g_ptr_array_index (loader->groups, loader->group + 1));
+
+      g_variant_builder_open (loader->builder, G_VARIANT_TYPE ("a(ss)"));
+      if (loader->step == XKB_LOAD_LAYOUTS)
+        xkl_config_registry_foreach_layout_variant (loader->config_registry, name,
+                                                    xfce_xkb_registry_add_item, loader->builder);
+      else
+        xkl_config_registry_foreach_option (loader->config_registry, name,
+                                            xfce_xkb_registry_add_item, loader->builder);
+      g_variant_builder_close (loader->builder);
+
+      g_variant_builder_close (loader->builder);
+
+      loader->group += 2;
+    }
+
+  if (loader->group < loader->groups->len)
+    return FALSE;
+
+  /* close the array of this step */
+  g_variant_builder_close (loader->builder);
+
+  g_ptr_array_set_size (loader->groups, 0);
+  loader->group = 0;
+
+  return TRUE;
+}
+
+
+
+/**
+ * xfce_xkb_registry_load_cache:
+ *
+ * Maps the registry snapshot written by xfce_xkb_registry_save_cache().
+ *
+ * Return value: the snapshot or %NULL if there is no cache or the
+ *               rules database, its translations or the locale
+ *               changed since.
+ **/
+XfceXkbRegistry *
+xfce_xkb_registry_load_cache (void)
+{
+  XfceXkbRegistry *registry;
+  GMappedFile     *mapped;
+  GVariant        *data;
+  gchar           *filename;
+  gchar           *stamp;
+  const gchar     *cache_stamp;
+  guint32          version;
+  gboolean         valid;
+
+  filename = xfce_resource_save_location (XFCE_RESOURCE_CACHE, XKB_CACHE_FILE, FALSE);
+  if (G_UNLIKELY (filename == NULL))
+    return NULL;
+
+  mapped = g_mapped_file_new (filename, FALSE, NULL);
+  g_free (filename);
+  if (mapped == NULL)
+    return NULL;
+
+  /* the file is not trusted, so a broken cache only yields
+   * default values and fails the version check below */
+  data = g_variant_new_from_data (G_VARIANT_TYPE (XKB_CACHE_TYPE),
+                                  g_mapped_file_get_contents (mapped),
+                                  g_mapped_file_get_length (mapped),
+                                  FALSE,
+                                  (GDestroyNotify) g_mapped_file_unref,
+                                  mapped);
+  g_variant_ref_sink (data);
+
+  g_variant_get_child (data, 0, "u", &version);
+  g_variant_get_child (data, 1, "&s", &cache_stamp);
+
+  stamp = xfce_xkb_registry_stamp ();
+  valid = (version == XKB_CACHE_VERSION && g_strcmp0 (cache_stamp, stamp) == 0);
+  g_free (stamp);
+
+  if (G_UNLIKELY (!valid))
+    {
+      g_variant_unref (data);
+      return NULL;
+    }
+
+  registry = xfce_xkb_registry_new (data);
+  g_variant_unref (data);
+
+  return registry;
+}
+
+
+
+/**
+ * xfce_xkb_registry_loader_new:
+ * @config_registry : the libxklavier registry.
+ *
+ * Prepares a snapshot of the models, layouts, variants and options in
+ * the rules database. The database is read in small steps with
+ * xfce_xkb_registry_loader_step(), so the caller can keep the user
+ * interface responsive in between.
+ *
+ * Return value: a new loader.
+ **/
+XfceXkbRegistryLoader *
+xfce_xkb_registry_loader_new (XklConfigRegistry *config_registry)
+{
+  XfceXkbRegistryLoader *loader;
+
+  g_return_val_if_fail (XKL_IS_CONFIG_REGISTRY (config_registry), NULL);
+
+  loader = g_slice_new0 (XfceXkbRegistryLoader);
+  loader->config_registry = g_object_ref (config_registry);
+  loader->step = XKB_LOAD_PARSE;
+  loader->groups = g_ptr_array_new_with_free_func (g_free);
+
+  return loader;
+}
+
+
+
+/**
+ * xfce_xkb_registry_loader_step:
+ * @loader : a #XfceXkbRegistryLoader.
+ *
+ * Reads the next part of the rules database. The first step parses
+ * the database and adds the models, every following step adds the
+ * variants or options of a few layouts or option groups.
+ *
+ * Return value: %TRUE if there is more to read, %FALSE once the
+ *               snapshot is complete.
+ **/
+gboolean
+xfce_xkb_registry_loader_step (XfceXkbRegistryLoader *loader)
+{
+  gchar *stamp;
+
+  g_return_val_if_fail (loader != NULL, FALSE);
+
+  switch (loader->step)
+    {
+    case XKB_LOAD_PARSE:
+      /* stamp before parsing, a change during the parse invalidates the cache */
+      stamp = xfce_xkb_registry_stamp ();
+
+      /* libxklavier queries the rules name from the server here,
+       * so this has to run in the main loop */
+#ifdef HAVE_LIBXKLAVIER4
+      xkl_config_registry_load (loader->config_registry, FALSE);
+#else
+      xkl_config_registry_load (loader->config_registry);
+#endif
+
+      loader->builder = g_variant_builder_new (G_VARIANT_TYPE (XKB_CACHE_TYPE));
+      g_variant_builder_add (loader->builder, "u", (guint32) XKB_CACHE_VERSION);
+      g_variant_builder_add (loader->builder, "s", stamp);
+      g_free (stamp);
+
+      g_variant_builder_open (loader->builder, G_VARIANT_TYPE ("a(ss)"));
+      xkl_config_registry_foreach_model (loader->config_registry,
+                                         xfce_xkb_registry_add_item, loader->builder);
+      g_variant_builder_close (loader->builder);
+
+      g_variant_builder_open (loader->builder, G_VARIANT_TYPE ("a(ssa(ss))"));
+      xkl_config_registry_foreach_layout (loader->config_registry,
+                                          xfce_xkb_registry_add_group_name, loader->groups);
+      loader->step = XKB_LOAD_LAYOUTS;
+      break;
+
+    case XKB_LOAD_LAYOUTS:
+      if (!xfce_xkb_registry_loader_add_groups (loader))
+        break;
+
+      g_variant_builder_open (loader->builder, G_VARIANT_TYPE ("a(ssa(ss))"));
+      xkl_config_registry_foreach_option_group (loader->config_registry,
+                                                xfce_xkb_registry_add_group_name, loader->groups);
+      loader->step = XKB_LOAD_OPTION_GROUPS;
+      break;
+
+    case XKB_LOAD_OPTION_GROUPS:
+      if (xfce_xkb_registry_loader_add_groups (loader))
+        loader->step = XKB_LOAD_DONE;
+      break;
+
+    case XKB_LOAD_DONE:
+      break;
+    }
+
+  return loader->step != XKB_LOAD_DONE;
+}
+
+
+
+/**
+ * xfce_xkb_registry_loader_finish:
+ * @loader : a #XfceXkbRegistryLoader that completed all steps.
+ *
+ * Takes the snapshot out of @loader and frees the loader.
+ *
+ * Return value: the snapshot.
+ **/
+XfceXkbRegistry *
+xfce_xkb_registry_loader_finish (XfceXkbRegistryLoader *loader)
+{
+  XfceXkbRegistry *registry;
+
+  g_return_val_if_fail (loader != NULL, NULL);
+  g_return_val_if_fail (loader->step == XKB_LOAD_DONE, NULL);
+
+  registry = xfce_xkb_registry_new (g_variant_builder_end (loader->builder));
+  xfce_xkb_registry_loader_free (loader);
+
+  return registry;
+}
+
+
+
+/**
+ * xfce_xkb_registry_loader_free:
+ * @loader : a #XfceXkbRegistryLoader.
+ *
+ * Frees @loader, a partially read snapshot is dropped.
+ **/
+void
+xfce_xkb_registry_loader_free (XfceXkbRegistryLoader *loader)
+{
+  g_return_if_fail (loader != NULL);
+
+  if (loader->builder != NULL)
+    g_variant_builder_unref (loader->builder);
+  g_ptr_array_free (loader->groups, TRUE);
+  g_object_unref (loader->config_registry);
+
+  g_slice_free (XfceXkbRegistryLoader, loader);
+}
+
+
+
+/**
+ * xfce_xkb_registry_save_cache:
+ * @registry : a #XfceXkbRegistry.
+ *
+ * Writes the serialized @registry to the user's cache directory.
+ **/
+void
+xfce_xkb_registry_save_cache (XfceXkbRegistry *registry)
+{
+  gchar  *filename;
+  GError *error = NULL;
+
+  g_return_if_fail (registry != NULL);
+
+  filename = xfce_resource_save_location (XFCE_RESOURCE_CACHE, XKB_CACHE_FILE, TRUE);
+  if (G_UNLIKELY (filename == NULL))
+    return;
+
+  /* the data is in host byte order, a cache from another
+   * architecture fails the version check */
+  if (!g_file_set_contents (filename, g_variant_get_data (registry->data),
+                            g_variant_get_size (registry->data), &error))
+    {
+      g_warning ("Failed to write the keyboard layouts cache: %s", error->message);
+      g_error_free (error);
+    }
+
+  g_free (filename);
+}
+
+
+
+XfceXkbRegistry *
+xfce_xkb_registry_ref (XfceXkbRegistry *registry)
+{
+  g_return_val_if_fail (registry != NULL, NULL);
+
+  g_atomic_int_inc (&registry->ref_count);
+
+  return registry;
+}
+
+
+
+void
+xfce_xkb_registry_unref (XfceXkbRegistry *registry)
+{
+  g_return_if_fail (registry != NULL);
+
+  if (g_atomic_int_dec_and_test (&registry->ref_count))
+    {
+      g_hash_table_destroy (registry->layouts);
+      g_hash_table_destroy (registry->option_groups);
+      g_variant_unref (registry->data);
+
+      g_slice_free (XfceXkbRegistry, registry);
+    }
+}
+
+
+
+static void
+xfce_xkb_registry_foreach (GVariant            *items,
+                           XfceXkbRegistryFunc  func,
+                           gpointer             user_data)
+{
+  GVariantIter  iter;
+  const gchar  *name;
+  const gchar  *description;
+
+  g_variant_iter_init (&iter, items);
+  while (g_variant_iter_next (&iter, "(&s&s)", &name, &description))
+    func (name, description, user_data);
+}
+
+
+
+static void
+xfce_xkb_registry_foreach_group (GVariant            *items,
+                                 XfceXkbRegistryFunc  func,
+                                 gpointer             user_data)
+{
+  GVariantIter  iter;
+  const gchar  *name;
+  const gchar  *description;
+
+  g_variant_iter_init (&iter, items);
+  while (g_variant_iter_next (&iter, "(&s&sa(ss))", &name, &description, NULL))
+    func (name, description, user_data);
+}
+
+
+
+void
+xfce_xkb_registry_foreach_model (XfceXkbRegistry     *registry,
+                                 XfceXkbRegistryFunc  func,
+                                 gpointer             user_data)
+{
+  GVariant *items;
+
+  g_return_if_fail (registry != NULL);
+  g_return_if_fail (func != NULL);
+
+  items = g_variant_get_child_value (registry->data, 2);
+  xfce_xkb_registry_foreach (items, func, user_data);
+  g_variant_unref (items);
+}
+
+
+
+void
+xfce_xkb_registry_foreach_layout (XfceXkbRegistry     *registry,
+                                  XfceXkbRegistryFunc  func,
+                                  gpointer             user_data)
+{
+  GVariant *items;
+
+  g_return_if_fail (registry != NULL);
+  g_return_if_fail (func != NULL);
+
+  items = g_variant_get_child_value (registry->data, 3);
+  xfce_xkb_registry_foreach_group (items, func, user_data);
+  g_variant_unref (items);
+}
+
+
+
+void
+xfce_xkb_registry_foreach_layout_variant (XfceXkbRegistry     *registry,
+                                          const gchar         *layout,
+                                          XfceXkbRegistryFunc  func,
+                                          gpointer             user_data)
+{
+  GVariant *group;
+  GVariant *items;
+
+  g_return_if_fail (registry != NULL);
+  g_return_if_fail (layout != NULL);
+  g_return_if_fail (func != NULL);
+
+  group = g_hash_table_lookup (registry->layouts, layout);
+  if (G_UNLIKELY (group == NULL))
+    return;
+
+  items = g_variant_get_child_value (group, 2);
+  xfce_xkb_registry_foreach (items, func, user_data);
+  g_variant_unref (items);
+}
+
+
+
+void
+xfce_xkb_registry_foreach_option (XfceXkbRegistry     *registry,
+                                  const gchar         *option_group,
+                                  XfceXkbRegistryFunc  func,
+                                  gpointer             user_data)
+{
+  GVariant *group;
+  GVariant *items;
+
+  g_return_if_fail (registry != NULL);
+  g_return_if_fail (option_group != NULL);
+  g_return_if_fail (func != NULL);
+
+  group = g_hash_table_lookup (registry->option_groups, option_group);
+  if (G_UNLIKELY (group == NULL))
+    return;
+
+  items = g_variant_get_child_value (group, 2);
+  xfce_xkb_registry_foreach (items, func, user_data);
+  g_variant_unref (items);
+}
+
+
+
+const gchar *
+xfce_xkb_registry_find_layout (XfceXkbRegistry *registry,
+                               const gchar     *layout)
+{
+  GVariant    *group;
+  const gchar *description;
+
+  g_return_val_if_fail (registry != NULL, NULL);
+  g_return_val_if_fail (layout != NULL, NULL);
+
+  group = g_hash_table_lookup (registry->layouts, layout);
+  if (G_UNLIKELY (group == NULL))
+    return NULL;
+
+  g_variant_get_child (group, 1, "&s", &description);
+
+  return description;
+}
+
+
+
+const gchar *
+xfce_xkb_registry_find_variant (XfceXkbRegistry *registry,
+                                const gchar     *layout,
+                                const gchar     *variant)
+{
+  GVariant     *group;
+  GVariant     *items;
+  GVariantIter  iter;
+  const gchar  *name;
+  const gchar  *description;
+  const gchar  *result = NULL;
+
+  g_return_val_if_fail (registry != NULL, NULL);
+  g_return_val_if_fail (layout != NULL, NULL);
+  g_return_val_if_fail (variant != NULL, NULL);
+
+  group = g_hash_table_lookup (registry->layouts, layout);
+  if (G_UNLIKELY (group == NULL))
+    return NULL;
+
+  /* a layout only has a few dozen variants at most */
+  items = g_variant_get_child_value (group, 2);
+  g_variant_iter_init (&iter, items);
+  while (result == NULL && g_variant_iter_next (&iter, "(&s&s)", &name, &description))
+    if (strcmp (name, variant) == 0)
+      result = description;
+  g_variant_unref (items);
+
+  return result;
+}
+
+#endif /* HAVE_LIBXKLAVIER */
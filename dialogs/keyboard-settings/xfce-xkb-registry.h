@@ -0,0 +1,82 @@
+/* vi:set sw=2 sts=2 ts=2 et ai: */
+/*-
+ * Copyright (C) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XFCE_XKB_REGISTRY_H__
+#define __XFCE_XKB_REGISTRY_H__
+
+#ifdef HAVE_LIBXKLAVIER
+
+#include <glib.h>
+#include <libxklavier/xklavier.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfceXkbRegistry       XfceXkbRegistry;
+typedef struct _XfceXkbRegistryLoader XfceXkbRegistryLoader;
+
+typedef void (*XfceXkbRegistryFunc) (const gchar *name,
+                                     const gchar  *description,
+                                     gpointer      user_data);
+
+XfceXkbRegistry       *xfce_xkb_registry_load_cache             (void);
+
+XfceXkbRegistryLoader *xfce_xkb_registry_loader_new             (XklConfigRegistry     *config_registry);
+
+gboolean               xfce_xkb_registry_loader_step            (XfceXkbRegistryLoader *loader);
+
+XfceXkbRegistry       *xfce_xkb_registry_loader_finish          (XfceXkbRegistryLoader *loader);
+
+void                   xfce_xkb_registry_loader_free            (XfceXkbRegistryLoader *loader);
+
+void                   xfce_xkb_registry_save_cache             (XfceXkbRegistry       *registry);
+
+XfceXkbRegistry       *xfce_xkb_registry_ref                    (XfceXkbRegistry       *registry);
+
+void                   xfce_xkb_registry_unref                  (XfceXkbRegistry       *registry);
+
+void                   xfce_xkb_registry_foreach_model          (XfceXkbRegistry       *registry,
+                                                                 XfceXkbRegistryFunc    func,
+                                                                 gpointer               user_data);
+
+void                   xfce_xkb_registry_foreach_layout         (XfceXkbRegistry       *registry,
+                                                                 XfceXkbRegistryFunc    func,
+                                                                 gpointer               user_data);
+
+void                   xfce_xkb_registry_foreach_layout_variant (XfceXkbRegistry       *registry,
+                                                                 const gchar           *layout,
+                                                                 XfceXkbRegistryFunc    func,
+                                                                 gpointer               user_data);
+
+void                   xfce_xkb_registry_foreach_option         (XfceXkbRegistry       *registry,
+                                                                 const gchar           *option_group,
+                                                                 XfceXkbRegistryFunc    func,
+                                                                 gpointer               user_data);
+
+const gchar           *xfce_xkb_registry_find_layout            (XfceXkbRegistry       *registry,
+                                                                 const gchar           *layout);
+
+const gchar           *xfce_xkb_registry_find_variant           (XfceXkbRegistry       *registry,
+                                                                 const gchar           *layout,
+                                                                 const gchar           *variant);
+
+G_END_DECLS
+
+#endif /* HAVE_LIBXKLAVIER */
+
+#endif /* !__XFCE_XKB_REGISTRY_H__ */
@@ -35,6 +35,7 @@
 #include <gio/gdesktopappinfo.h>
 
 #include "xfce-mime-chooser.h"
+#include "xfce-mime-index.h"
 
 
 
@@ -66,14 +67,17 @@ struct _XfceMimeChooser
 {
     GtkDialog  __parent__;
 
-    GtkTreeStore *model;
+    GtkTreeStore  *model;
 
-    GtkWidget    *button;
-    GtkWidget    *image;
-    GtkWidget    *label;
-    GtkWidget    *treeview;
-    GtkWidget    *expander;
-    GtkWidget    *entry;
+    /* shared application lists */
+    XfceMimeIndex *index;
+
+    GtkWidget     *button;
+    GtkWidget     *image;
+    GtkWidget     *label;
+    GtkWidget     *treeview;
+    GtkWidget     *expander;
+    GtkWidget     *entry;
 };
 
 enum
@@ -119,6 +123,8 @@ xfce_mime_chooser_init (XfceMimeChooser *chooser)
     GtkTreeSelection  *selection;
     GtkCellRenderer   *renderer;
 
+    chooser->index = xfce_mime_index_get ();
+
     chooser->model = gtk_tree_store_new (N_CHOOSER_COLUMNS,
                                          G_TYPE_STRING,
                                          G_TYPE_APP_INFO,
@@ -235,6 +241,7 @@ xfce_mime_chooser_finalize (GObject *object)
     XfceMimeChooser *chooser = XFCE_MIME_CHOOSER (object);
 
     g_object_unref (G_OBJECT (chooser->model));
+    g_object_unref (G_OBJECT (chooser->index));
 
     (*G_OBJECT_CLASS (xfce_mime_chooser_parent_class)->finalize) (object);
 }
@@ -533,15 +540,6 @@ xfce_mime_chooser_model_append (GtkTreeStore *model,
 
 
 
-static gint
-xfce_mime_chooser_compare_app_info (gconstpointer a,
-                                    gconstpointer b)
-{
-    return !g_app_info_equal (G_APP_INFO (a), G_APP_INFO (b));
-}
-
-
-
 static gint
 xfce_mime_chooser_sort_app_info (gconstpointer a,
                                  gconstpointer b)
@@ -556,12 +554,13 @@ void
 xfce_mime_chooser_set_mime_type (XfceMimeChooser *chooser,
                                  const gchar     *mime_type)
 {
-    GList *recommended;
-    GList *all, *li;
-    GList *other = NULL;
-    GIcon *icon;
-    gchar *label;
-    gchar *description;
+    GList      *recommended;
+    GList      *all, *li;
+    GList      *other = NULL;
+    GIcon      *icon;
+    gchar      *label;
+    gchar      *description;
+    GHashTable *seen;
 
     g_return_if_fail (XFCE_IS_MIME_CHOOSER (chooser));
     g_return_if_fail (mime_type != NULL);
@@ -570,23 +569,27 @@ xfce_mime_chooser_set_mime_type (XfceMimeChooser *chooser,
     gtk_tree_store_clear (chooser->model);
 
     /* add recommended types */
-    recommended = g_app_info_get_all_for_type (mime_type);
+    recommended = xfce_mime_index_get_candidates (chooser->index, mime_type);
     xfce_mime_chooser_model_append (chooser->model,
                                     _("Recommended Applications"),
                                     "preferences-desktop-default-applications",
                                     recommended);
 
-    /* filter out recommended apps from all apps */
-    all = g_app_info_get_all ();
+    /* filter out recommended apps from all apps, the index
+     * hands out the same instance for each application */
+    seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (li = recommended; li != NULL; li = li->next)
+        g_hash_table_insert (seen, li->data, li->data);
+
+    all = xfce_mime_index_get_all (chooser->index);
     for (li = all; li != NULL; li = li->next)
     {
-        if (g_list_find_custom (recommended, li->data,
-                                xfce_mime_chooser_compare_app_info) == NULL)
-        {
+        if (g_hash_table_lookup (seen, li->data) == NULL)
             other = g_list_prepend (other, li->data);
-        }
     }
 
+    g_hash_table_destroy (seen);
+
     /* add the other applications */
     other = g_list_sort (other, xfce_mime_chooser_sort_app_info);
     xfce_mime_chooser_model_append (chooser->model,
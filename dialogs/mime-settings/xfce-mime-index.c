@@ -0,0 +1,1303 @@
+/*
+ * Copyright (C) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <gio/gdesktopappinfo.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include "xfce-mime-index.h"
+
+
+
+/* bump this when the layout of the cache file changes */
+#define INDEX_CACHE_VERSION (1)
+#define INDEX_CACHE_FILE    "xfce4" G_DIR_SEPARATOR_S "mime-settings" G_DIR_SEPARATOR_S "applications.cache"
+
+
+
+static void          xfce_mime_index_finalize    (GObject       *object);
+static void          xfce_mime_index_ensure      (XfceMimeIndex *index);
+
+
+
+struct _XfceMimeIndexClass
+{
+    GObjectClass __parent__;
+};
+
+struct _XfceMimeIndex
+{
+    GObject __parent__;
+
+    /* MimeIndexDir, in the lookup order of gio */
+    GPtrArray  *dirs;
+
+    /* desktop id -> MimeIndexApp, the first directory wins */
+    GHashTable *apps;
+
+    /* shared-mime-info subclasses and aliases */
+    GHashTable *parents;
+    GHashTable *aliases;
+
+    /* mime type -> resolved default MimeIndexApp (or NULL) */
+    GHashTable *defaults;
+
+    /* mime type -> GList of MimeIndexApp that can open it */
+    GHashTable *candidates;
+
+    guint       dirs_loaded : 1;
+    guint       apps_loaded : 1;
+    guint       associations_loaded : 1;
+};
+
+typedef struct
+{
+    gchar      *path;
+
+    /* whether desktop files are installed in this directory */
+    guint       has_apps : 1;
+
+    /* mime type -> desktop ids from the mimeapps.list files */
+    GHashTable *defaults;
+    GHashTable *added;
+    GHashTable *removed;
+
+    /* mime type -> GPtrArray of MimeIndexApp declaring it */
+    GHashTable *mime_apps;
+}
+MimeIndexDir;
+
+typedef struct
+{
+    gchar     *desktop_id;
+    gchar     *name;
+    gchar    **mime_types;
+
+    /* position of the directory in index->dirs */
+    guint      dir;
+
+    /* hidden entries only mask apps in later directories */
+    guint      valid : 1;
+
+    /* created when the application is actually needed */
+    GAppInfo  *app_info;
+}
+MimeIndexApp;
+
+
+
+G_DEFINE_TYPE (XfceMimeIndex, xfce_mime_index, G_TYPE_OBJECT)
+
+
+
+static void
+xfce_mime_index_class_init (XfceMimeIndexClass *klass)
+{
+    GObjectClass *gobject_class;
+
+    gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->finalize = xfce_mime_index_finalize;
+}
+
+
+
+static void
+xfce_mime_index_app_free (gpointer data)
+{
+    MimeIndexApp *app = data;
+
+    if (app->app_info != NULL)
+        g_object_unref (G_OBJECT (app->app_info));
+
+    g_free (app->desktop_id);
+    g_free (app->name);
+    g_strfreev (app->mime_types);
+    g_slice_free (MimeIndexApp, app);
+}
+
+
+
+static void
+xfce_mime_index_dir_free (gpointer data)
+{
+    MimeIndexDir *dir = data;
+
+    g_hash_table_destroy (dir->defaults);
+    g_hash_table_destroy (dir->added);
+    g_hash_table_destroy (dir->removed);
+    g_hash_table_destroy (dir->mime_apps);
+    g_free (dir->path);
+    g_slice_free (MimeIndexDir, dir);
+}
+
+
+
+static void
+xfce_mime_index_init (XfceMimeIndex *index)
+{
+    index->dirs = g_ptr_array_new_with_free_func (xfce_mime_index_dir_free);
+    index->apps = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, xfce_mime_index_app_free);
+    index->parents = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify) g_ptr_array_unref);
+    index->aliases = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    index->defaults = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    index->candidates = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify) g_list_free);
+}
+
+
+
+static void
+xfce_mime_index_finalize (GObject *object)
+{
+    XfceMimeIndex *index = XFCE_MIME_INDEX (object);
+
+    g_hash_table_destroy (index->candidates);
+    g_hash_table_destroy (index->defaults);
+    g_hash_table_destroy (index->aliases);
+    g_hash_table_destroy (index->parents);
+    g_hash_table_destroy (index->apps);
+    g_ptr_array_free (index->dirs, TRUE);
+
+    (*G_OBJECT_CLASS (xfce_mime_index_parent_class)->finalize) (object);
+}
+
+
+
+static gchar **
+xfce_mime_index_strv_concat (gchar **first,
+                             gchar **second)
+{
+    gchar **result;
+    guint   n_first, n_second, i;
+
+    n_first = g_strv_length (first);
+    n_second = g_strv_length (second);
+
+    result = g_new (gchar *, n_first + n_second + 1);
+    for (i = 0; i < n_first; i++)
+        result[i] = g_strdup (first[i]);
+    for (i = 0; i < n_second; i++)
+        result[n_first + i] = g_strdup (second[i]);
+    result[n_first + n_second] = NULL;
+
+    return result;
+}
+
+
+
+static void
+xfce_mime_index_load_group (GKeyFile    *key_file,
+                            const gchar *group,
+                            GHashTable  *table)
+{
+    gchar **keys;
+    gchar **ids, **old_ids;
+    guint   i;
+
+    keys = g_key_file_get_keys (key_file, group, NULL, NULL);
+    if (G_UNLIKELY (keys == NULL))
+        return;
+
+    for (i = 0; keys[i] != NULL; i++)
+    {
+        ids = g_key_file_get_string_list (key_file, group, keys[i], NULL, NULL);
+        if (G_UNLIKELY (ids == NULL))
+            continue;
+
+        /* files loaded earlier in the same directory have precedence */
+        old_ids = g_hash_table_lookup (table, keys[i]);
+        if (old_ids != NULL)
+        {
+            g_hash_table_replace (table, g_strdup (keys[i]),
+                                  xfce_mime_index_strv_concat (old_ids, ids));
+            g_strfreev (ids);
+        }
+        else
+        {
+            g_hash_table_insert (table, g_strdup (keys[i]), ids);
+        }
+    }
+
+    g_strfreev (keys);
+}
+
+
+
+static void
+xfce_mime_index_dir_load_list (MimeIndexDir *dir,
+                               const gchar  *basename,
+                               gboolean      defaults_only)
+{
+    GKeyFile *key_file;
+    gchar    *filename;
+
+    filename = g_build_filename (dir->path, basename, NULL);
+    key_file = g_key_file_new ();
+
+    if (g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL))
+    {
+        xfce_mime_index_load_group (key_file, "Default Applications", dir->defaults);
+
+        if (!defaults_only)
+        {
+            xfce_mime_index_load_group (key_file, "Added Associations", dir->added);
+            xfce_mime_index_load_group (key_file, "Removed Associations", dir->removed);
+        }
+    }
+
+    g_key_file_free (key_file);
+    g_free (filename);
+}
+
+
+
+static void
+xfce_mime_index_load_associations (XfceMimeIndex *index)
+{
+    MimeIndexDir  *dir;
+    const gchar   *current_desktop;
+    gchar        **desktops = NULL;
+    gchar         *basename;
+    guint          i, n;
+
+    /* desktop specific lists go before the generic ones */
+    current_desktop = g_getenv ("XDG_CURRENT_DESKTOP");
+    if (current_desktop != NULL)
+        desktops = g_strsplit (current_desktop, G_SEARCHPATH_SEPARATOR_S, -1);
+
+    for (i = 0; i < index->dirs->len; i++)
+    {
+        dir = g_ptr_array_index (index->dirs, i);
+
+        g_hash_table_remove_all (dir->defaults);
+        g_hash_table_remove_all (dir->added);
+        g_hash_table_remove_all (dir->removed);
+
+        for (n = 0; desktops != NULL && desktops[n] != NULL; n++)
+        {
+            basename = g_strdup_printf ("%s-mimeapps.list", desktops[n]);
+            xfce_mime_index_dir_load_list (dir, g_strdown (basename), FALSE);
+            g_free (basename);
+        }
+
+        xfce_mime_index_dir_load_list (dir, "mimeapps.list", FALSE);
+
+        /* the old defaults.list only exists in the application dirs */
+        if (dir->has_apps)
+            xfce_mime_index_dir_load_list (dir, "defaults.list", TRUE);
+    }
+
+    g_strfreev (desktops);
+
+    g_hash_table_remove_all (index->defaults);
+    g_hash_table_remove_all (index->candidates);
+    index->associations_loaded = TRUE;
+}
+
+
+
+static void
+xfce_mime_index_add_dir (XfceMimeIndex *index,
+                         const gchar   *path,
+                         gboolean       has_apps)
+{
+    MimeIndexDir *dir;
+
+    dir = g_slice_new0 (MimeIndexDir);
+    dir->path = g_strdup (path);
+    dir->has_apps = has_apps;
+    dir->defaults = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+    dir->added = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+    dir->removed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+    dir->mime_apps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify) g_ptr_array_unref);
+
+    g_ptr_array_add (index->dirs, dir);
+}
+
+
+
+static void
+xfce_mime_index_load_dirs (XfceMimeIndex *index)
+{
+    const gchar * const *dirs;
+    gchar               *path;
+    guint                i;
+
+    /* the same search order gio uses: first the config
+     * directories, then the application directories */
+    xfce_mime_index_add_dir (index, g_get_user_config_dir (), FALSE);
+
+    dirs = g_get_system_config_dirs ();
+    for (i = 0; dirs[i] != NULL; i++)
+        xfce_mime_index_add_dir (index, dirs[i], FALSE);
+
+    path = g_build_filename (g_get_user_data_dir (), "applications", NULL);
+    xfce_mime_index_add_dir (index, path, TRUE);
+    g_free (path);
+
+    dirs = g_get_system_data_dirs ();
+    for (i = 0; dirs[i] != NULL; i++)
+    {
+        path = g_build_filename (dirs[i], "applications", NULL);
+        xfce_mime_index_add_dir (index, path, TRUE);
+        g_free (path);
+    }
+}
+
+
+
+static void
+xfce_mime_index_load_mime_file (const gchar *data_dir,
+                                const gchar *basename,
+                                GHashTable  *parents,
+                                GHashTable  *aliases)
+{
+    gchar      *filename;
+    gchar      *contents;
+    gchar     **lines;
+    gchar      *sep;
+    guint       i;
+    GPtrArray  *array;
+
+    filename = g_build_filename (data_dir, "mime", basename, NULL);
+    if (g_file_get_contents (filename, &contents, NULL, NULL))
+    {
+        /* every line has the form "mime-type other-type" */
+        lines = g_strsplit (contents, "\n", -1);
+        for (i = 0; lines[i] != NULL; i++)
+        {
+            sep = strchr (lines[i], ' ');
+            if (sep == NULL || sep == lines[i] || sep[1] == '\0')
+                continue;
+
+            *sep++ = '\0';
+
+            if (parents != NULL)
+            {
+                array = g_hash_table_lookup (parents, lines[i]);
+                if (array == NULL)
+                {
+                    array = g_ptr_array_new_with_free_func (g_free);
+                    g_hash_table_insert (parents, g_strdup (lines[i]), array);
+                }
+                g_ptr_array_add (array, g_strdup (sep));
+            }
+            else if (g_hash_table_lookup (aliases, lines[i]) == NULL)
+            {
+                g_hash_table_insert (aliases, g_strdup (lines[i]), g_strdup (sep));
+            }
+        }
+
+        g_strfreev (lines);
+        g_free (contents);
+    }
+
+    g_free (filename);
+}
+
+
+
+static void
+xfce_mime_index_load_mime_database (XfceMimeIndex *index)
+{
+    const gchar * const *dirs;
+    guint                i;
+
+    xfce_mime_index_load_mime_file (g_get_user_data_dir (), "subclasses", index->parents, NULL);
+    xfce_mime_index_load_mime_file (g_get_user_data_dir (), "aliases", NULL, index->aliases);
+
+    dirs = g_get_system_data_dirs ();
+    for (i = 0; dirs[i] != NULL; i++)
+    {
+        xfce_mime_index_load_mime_file (dirs[i], "subclasses", index->parents, NULL);
+        xfce_mime_index_load_mime_file (dirs[i], "aliases", NULL, index->aliases);
+    }
+}
+
+
+
+static void
+xfce_mime_index_insert_app (XfceMimeIndex *index,
+                            MimeIndexApp  *app)
+{
+    MimeIndexDir *dir;
+    GPtrArray    *array;
+    guint         i;
+
+    g_hash_table_insert (index->apps, app->desktop_id, app);
+
+    if (!app->valid || app->mime_types == NULL)
+        return;
+
+    /* reverse index from the mime type to the apps in this directory */
+    dir = g_ptr_array_index (index->dirs, app->dir);
+    for (i = 0; app->mime_types[i] != NULL; i++)
+    {
+        if (*app->mime_types[i] == '\0')
+            continue;
+
+        array = g_hash_table_lookup (dir->mime_apps, app->mime_types[i]);
+        if (array == NULL)
+        {
+            array = g_ptr_array_new ();
+            g_hash_table_insert (dir->mime_apps, g_strdup (app->mime_types[i]), array);
+        }
+        g_ptr_array_add (array, app);
+    }
+}
+
+
+
+static gboolean
+xfce_mime_index_app_is_valid (GKeyFile *key_file)
+{
+    gchar    *type;
+    gchar    *try_exec;
+    gchar    *path;
+    gboolean  valid;
+
+    /* same checks as g_desktop_app_info_new () */
+    if (!g_key_file_has_group (key_file, G_KEY_FILE_DESKTOP_GROUP))
+        return FALSE;
+
+    type = g_key_file_get_string (key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                  G_KEY_FILE_DESKTOP_KEY_TYPE, NULL);
+    valid = g_strcmp0 (type, G_KEY_FILE_DESKTOP_TYPE_APPLICATION) == 0;
+    g_free (type);
+
+    if (valid && g_key_file_get_boolean (key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                         G_KEY_FILE_DESKTOP_KEY_HIDDEN, NULL))
+        valid = FALSE;
+
+    if (valid)
+    {
+        try_exec = g_key_file_get_string (key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                          G_KEY_FILE_DESKTOP_KEY_TRY_EXEC, NULL);
+        if (try_exec != NULL && *try_exec != '\0')
+        {
+            path = g_find_program_in_path (try_exec);
+            valid = path != NULL;
+            g_free (path);
+        }
+        g_free (try_exec);
+    }
+
+    return valid;
+}
+
+
+
+static void
+xfce_mime_index_scan_dir (XfceMimeIndex *index,
+                          guint          dir_num,
+                          const gchar   *path,
+                          const gchar   *prefix)
+{
+    GDir         *dir;
+    const gchar  *name;
+    gchar        *filename;
+    gchar        *desktop_id;
+    gchar        *sub_prefix;
+    GKeyFile     *key_file;
+    MimeIndexApp *app;
+
+    dir = g_dir_open (path, 0, NULL);
+    if (G_UNLIKELY (dir == NULL))
+        return;
+
+    while ((name = g_dir_read_name (dir)) != NULL)
+    {
+        filename = g_build_filename (path, name, NULL);
+
+        if (g_str_has_suffix (name, ".desktop"))
+        {
+            /* files in subdirectories get the directory name as prefix */
+            if (prefix != NULL)
+                desktop_id = g_strconcat (prefix, "-", name, NULL);
+            else
+                desktop_id = g_strdup (name);
+
+            /* skip ids masked by a directory with a higher precedence */
+            key_file = g_key_file_new ();
+            if (g_hash_table_lookup (index->apps, desktop_id) == NULL
+                && g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL))
+            {
+                app = g_slice_new0 (MimeIndexApp);
+                app->desktop_id = desktop_id;
+                app->dir = dir_num;
+                app->valid = xfce_mime_index_app_is_valid (key_file);
+                if (app->valid)
+                {
+                    app->name = g_key_file_get_locale_string (key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                                              G_KEY_FILE_DESKTOP_KEY_NAME, NULL, NULL);
+                    app->mime_types = g_key_file_get_string_list (key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                                                  G_KEY_FILE_DESKTOP_KEY_MIME_TYPE, NULL, NULL);
+                }
+
+                xfce_mime_index_insert_app (index, app);
+            }
+            else
+            {
+                g_free (desktop_id);
+            }
+            g_key_file_free (key_file);
+        }
+        else if (g_file_test (filename, G_FILE_TEST_IS_DIR)
+                 && !g_file_test (filename, G_FILE_TEST_IS_SYMLINK))
+        {
+            /* symlinked directories are skipped, they could loop */
+            if (prefix != NULL)
+                sub_prefix = g_strconcat (prefix, "-", name, NULL);
+            else
+                sub_prefix = g_strdup (name);
+
+            xfce_mime_index_scan_dir (index, dir_num, filename, sub_prefix);
+            g_free (sub_prefix);
+        }
+
+        g_free (filename);
+    }
+
+    g_dir_close (dir);
+}
+
+
+
+static void
+xfce_mime_index_stamp_dir (const gchar *path,
+                           GString     *stamp)
+{
+    GDir        *dir;
+    const gchar *name;
+    gchar       *filename;
+    struct stat  statb;
+
+    if (g_stat (path, &statb) != 0 || !S_ISDIR (statb.st_mode))
+        return;
+
+    g_string_append_printf (stamp, "%s=%" G_GINT64_FORMAT ";",
+                            path, (gint64) statb.st_mtime);
+
+    /* adding or removing a desktop file only changes
+     * the mtime of the directory it lives in */
+    dir = g_dir_open (path, 0, NULL);
+    if (G_LIKELY (dir != NULL))
+    {
+        while ((name = g_dir_read_name (dir)) != NULL)
+        {
+            if (g_str_has_suffix (name, ".desktop"))
+                continue;
+
+            /* like the scan, do not follow symlinked directories */
+            filename = g_build_filename (path, name, NULL);
+            if (g_lstat (filename, &statb) == 0 && S_ISDIR (statb.st_mode))
+                xfce_mime_index_stamp_dir (filename, stamp);
+            g_free (filename);
+        }
+
+        g_dir_close (dir);
+    }
+}
+
+
+
+static gchar *
+xfce_mime_index_cache_stamp (XfceMimeIndex *index)
+{
+    GString      *stamp;
+    MimeIndexDir *dir;
+    guint         i;
+    gchar        *checksum;
+
+    stamp = g_string_new (NULL);
+
+    /* names are localized */
+    g_string_append (stamp, g_get_language_names ()[0]);
+    g_string_append_c (stamp, ';');
+
+    for (i = 0; i < index->dirs->len; i++)
+    {
+        dir = g_ptr_array_index (index->dirs, i);
+
+        /* the position is stored for each app */
+        g_string_append_printf (stamp, "%u:%s;", i, dir->path);
+
+        if (dir->has_apps)
+            xfce_mime_index_stamp_dir (dir->path, stamp);
+    }
+
+    checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, stamp->str, stamp->len);
+    g_string_free (stamp, TRUE);
+
+    return checksum;
+}
+
+
+
+static gboolean
+xfce_mime_index_cache_load (XfceMimeIndex *index,
+                            const gchar   *filename,
+                            const gchar   *stamp)
+{
+    GKeyFile      *key_file;
+    gchar        **groups;
+    gchar         *cache_stamp;
+    gboolean       succeed = FALSE;
+    MimeIndexApp  *app;
+    guint          i;
+    gint           dir;
+
+    key_file = g_key_file_new ();
+    if (!g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL))
+        goto bailout;
+
+    if (g_key_file_get_integer (key_file, "Index", "Version", NULL) != INDEX_CACHE_VERSION)
+        goto bailout;
+
+    cache_stamp = g_key_file_get_string (key_file, "Index", "Stamp", NULL);
+    succeed = g_strcmp0 (cache_stamp, stamp) == 0;
+    g_free (cache_stamp);
+
+    if (!succeed)
+        goto bailout;
+
+    /* the groups are in the order they were scanned */
+    groups = g_key_file_get_groups (key_file, NULL);
+    for (i = 0; groups[i] != NULL; i++)
+    {
+        if (!g_str_has_prefix (groups[i], "App "))
+            continue;
+
+        dir = g_key_file_get_integer (key_file, groups[i], "Dir", NULL);
+        if (G_UNLIKELY (dir < 0 || (guint) dir >= index->dirs->len))
+            continue;
+
+        app = g_slice_new0 (MimeIndexApp);
+        app->desktop_id = g_key_file_get_string (key_file, groups[i], "Id", NULL);
+        app->dir = dir;
+        app->valid = g_key_file_get_boolean (key_file, groups[i], "Valid", NULL);
+        app->name = g_key_file_get_string (key_file, groups[i], "Name", NULL);
+        app->mime_types = g_key_file_get_string_list (key_file, groups[i], "MimeType", NULL, NULL);
+
+        if (G_UNLIKELY (app->desktop_id == NULL
+            || g_hash_table_lookup (index->apps, app->desktop_id) != NULL))
+        {
+            xfce_mime_index_app_free (app);
+            continue;
+        }
+
+        xfce_mime_index_insert_app (index, app);
+    }
+    g_strfreev (groups);
+
+    bailout:
+
+    g_key_file_free (key_file);
+
+    return succeed;
+}
+
+
+
+static void
+xfce_mime_index_cache_save_app (gpointer key,
+                                gpointer value,
+                                gpointer user_data)
+{
+    MimeIndexApp *app = value;
+    GPtrArray    *apps = user_data;
+
+    g_ptr_array_add (apps, app);
+}
+
+
+
+static gint
+xfce_mime_index_cache_compare_app (gconstpointer a,
+                                   gconstpointer b)
+{
+    const MimeIndexApp *app_a = *(MimeIndexApp **) a;
+    const MimeIndexApp *app_b = *(MimeIndexApp **) b;
+
+    if (app_a->dir != app_b->dir)
+        return app_a->dir < app_b->dir ? -1 : 1;
+
+    return strcmp (app_a->desktop_id, app_b->desktop_id);
+}
+
+
+
+static void
+xfce_mime_index_cache_save (XfceMimeIndex *index,
+                            const gchar   *filename,
+                            const gchar   *stamp)
+{
+    GKeyFile     *key_file;
+    GPtrArray    *apps;
+    MimeIndexApp *app;
+    guint         i;
+    gchar         group[32];
+    gchar        *data;
+    gsize         length;
+
+    key_file = g_key_file_new ();
+    g_key_file_set_integer (key_file, "Index", "Version", INDEX_CACHE_VERSION);
+    g_key_file_set_string (key_file, "Index", "Stamp", stamp);
+
+    /* save the apps in directory order */
+    apps = g_ptr_array_sized_new (g_hash_table_size (index->apps));
+    g_hash_table_foreach (index->apps, xfce_mime_index_cache_save_app, apps);
+    g_ptr_array_sort (apps, xfce_mime_index_cache_compare_app);
+
+    for (i = 0; i < apps->len; i++)
+    {
+        app = g_ptr_array_index (apps, i);
+
+        g_snprintf (group, sizeof (group), "App %u", i);
+        g_key_file_set_string (key_file, group, "Id", app->desktop_id);
+        g_key_file_set_integer (key_file, group, "Dir", app->dir);
+        g_key_file_set_boolean (key_file, group, "Valid", app->valid);
+        if (app->name != NULL)
+            g_key_file_set_string (key_file, group, "Name", app->name);
+        if (app->mime_types != NULL)
+            g_key_file_set_string_list (key_file, group, "MimeType",
+                                        (const gchar * const *) app->mime_types,
+                                        g_strv_length (app->mime_types));
+    }
+
+    g_ptr_array_free (apps, TRUE);
+
+    data = g_key_file_to_data (key_file, &length, NULL);
+    if (!g_file_set_contents (filename, data, length, NULL))
+        g_warning ("Failed to write the application cache \"%s\"", filename);
+
+    g_free (data);
+    g_key_file_free (key_file);
+}
+
+
+
+static void
+xfce_mime_index_clear_apps (XfceMimeIndex *index)
+{
+    MimeIndexDir *dir;
+    guint         i;
+
+    /* the resolved lookups point to the apps */
+    g_hash_table_remove_all (index->defaults);
+    g_hash_table_remove_all (index->candidates);
+
+    for (i = 0; i < index->dirs->len; i++)
+    {
+        dir = g_ptr_array_index (index->dirs, i);
+        g_hash_table_remove_all (dir->mime_apps);
+    }
+
+    g_hash_table_remove_all (index->apps);
+}
+
+
+
+static void
+xfce_mime_index_load_apps (XfceMimeIndex *index)
+{
+    gchar        *filename;
+    gchar        *stamp;
+    MimeIndexDir *dir;
+    guint         i;
+
+    /* drop the apps of an earlier load */
+    xfce_mime_index_clear_apps (index);
+
+    stamp = xfce_mime_index_cache_stamp (index);
+    filename = xfce_resource_save_location (XFCE_RESOURCE_CACHE, INDEX_CACHE_FILE, TRUE);
+
+    if (filename == NULL
+        || !xfce_mime_index_cache_load (index, filename, stamp))
+    {
+        /* drop partially loaded data */
+        xfce_mime_index_clear_apps (index);
+
+        /* one pass over all the desktop files */
+        for (i = 0; i < index->dirs->len; i++)
+        {
+            dir = g_ptr_array_index (index->dirs, i);
+            if (dir->has_apps)
+                xfce_mime_index_scan_dir (index, i, dir->path, NULL);
+        }
+
+        if (filename != NULL)
+            xfce_mime_index_cache_save (index, filename, stamp);
+    }
+
+    g_free (filename);
+    g_free (stamp);
+}
+
+
+
+static void
+xfce_mime_index_ensure (XfceMimeIndex *index)
+{
+    if (G_UNLIKELY (!index->dirs_loaded))
+    {
+        xfce_mime_index_load_dirs (index);
+        xfce_mime_index_load_mime_database (index);
+
+        index->dirs_loaded = TRUE;
+    }
+
+    if (!index->apps_loaded)
+    {
+        xfce_mime_index_load_apps (index);
+
+        index->apps_loaded = TRUE;
+    }
+
+    if (!index->associations_loaded)
+        xfce_mime_index_load_associations (index);
+}
+
+
+
+static GPtrArray *
+xfce_mime_index_get_types (XfceMimeIndex *index,
+                           const gchar   *mime_type)
+{
+    GPtrArray   *types;
+    GPtrArray   *parents;
+    const gchar *alias;
+    guint        i, n, k;
+
+    types = g_ptr_array_new ();
+    g_ptr_array_add (types, (gpointer) mime_type);
+
+    alias = g_hash_table_lookup (index->aliases, mime_type);
+    if (alias != NULL)
+        g_ptr_array_add (types, (gpointer) alias);
+
+    /* breadth-first walk over the parent types, the lists are
+     * short so a linear duplicate check is fine */
+    for (i = 0; i < types->len; i++)
+    {
+        parents = g_hash_table_lookup (index->parents, g_ptr_array_index (types, i));
+        if (parents == NULL)
+            continue;
+
+        for (n = 0; n < parents->len; n++)
+        {
+            for (k = 0; k < types->len; k++)
+                if (strcmp (g_ptr_array_index (types, k), g_ptr_array_index (parents, n)) == 0)
+                    break;
+
+            if (k == types->len)
+                g_ptr_array_add (types, g_ptr_array_index (parents, n));
+        }
+    }
+
+    return types;
+}
+
+
+
+static MimeIndexApp *
+xfce_mime_index_lookup_app (XfceMimeIndex *index,
+                            const gchar   *desktop_id,
+                            GHashTable    *blacklist)
+{
+    MimeIndexApp *app;
+
+    if (blacklist != NULL
+        && g_hash_table_lookup (blacklist, desktop_id) != NULL)
+        return NULL;
+
+    app = g_hash_table_lookup (index->apps, desktop_id);
+    if (app != NULL && app->valid)
+        return app;
+
+    return NULL;
+}
+
+
+
+static MimeIndexApp *
+xfce_mime_index_resolve_default (XfceMimeIndex *index,
+                                 const gchar   *mime_type)
+{
+    GPtrArray     *types;
+    GHashTable    *blacklist;
+    MimeIndexDir  *dir;
+    MimeIndexApp  *app = NULL;
+    GPtrArray     *apps;
+    gchar        **ids;
+    const gchar   *type;
+    guint          i, n, k;
+
+    types = xfce_mime_index_get_types (index, mime_type);
+
+    /* the explicit defaults of the type and its parents win */
+    for (i = 0; app == NULL && i < types->len; i++)
+    {
+        type = g_ptr_array_index (types, i);
+        for (n = 0; app == NULL && n < index->dirs->len; n++)
+        {
+            dir = g_ptr_array_index (index->dirs, n);
+            ids = g_hash_table_lookup (dir->defaults, type);
+            for (k = 0; app == NULL && ids != NULL && ids[k] != NULL; k++)
+                app = xfce_mime_index_lookup_app (index, ids[k], NULL);
+        }
+    }
+
+    /* then the added associations and installed apps, skipping
+     * everything that was removed in a directory before */
+    blacklist = g_hash_table_new (g_str_hash, g_str_equal);
+    for (i = 0; app == NULL && i < types->len; i++)
+    {
+        type = g_ptr_array_index (types, i);
+        for (n = 0; app == NULL && n < index->dirs->len; n++)
+        {
+            dir = g_ptr_array_index (index->dirs, n);
+
+            ids = g_hash_table_lookup (dir->added, type);
+            for (k = 0; app == NULL && ids != NULL && ids[k] != NULL; k++)
+                app = xfce_mime_index_lookup_app (index, ids[k], blacklist);
+
+            ids = g_hash_table_lookup (dir->removed, type);
+            for (k = 0; ids != NULL && ids[k] != NULL; k++)
+                g_hash_table_insert (blacklist, ids[k], GINT_TO_POINTER (TRUE));
+
+            apps = g_hash_table_lookup (dir->mime_apps, type);
+            for (k = 0; app == NULL && apps != NULL && k < apps->len; k++)
+                app = xfce_mime_index_lookup_app (index,
+                    ((MimeIndexApp *) g_ptr_array_index (apps, k))->desktop_id, blacklist);
+        }
+    }
+
+    g_hash_table_destroy (blacklist);
+    g_ptr_array_free (types, TRUE);
+
+    return app;
+}
+
+
+
+static MimeIndexApp *
+xfce_mime_index_get_default_app (XfceMimeIndex *index,
+                                 const gchar   *mime_type)
+{
+    gpointer app;
+
+    xfce_mime_index_ensure (index);
+
+    /* resolve each type once, misses are stored as NULL */
+    if (!g_hash_table_lookup_extended (index->defaults, mime_type, NULL, &app))
+    {
+        app = xfce_mime_index_resolve_default (index, mime_type);
+        g_hash_table_insert (index->defaults, g_strdup (mime_type), app);
+    }
+
+    return app;
+}
+
+
+
+static GList *
+xfce_mime_index_resolve_candidates (XfceMimeIndex *index,
+                                    const gchar   *mime_type)
+{
+    GPtrArray     *types;
+    GHashTable    *blacklist;
+    GHashTable    *seen;
+    GList         *result = NULL;
+    MimeIndexDir  *dir;
+    MimeIndexApp  *app;
+    GPtrArray     *apps;
+    gchar        **ids;
+    const gchar   *type;
+    guint          i, n, k;
+
+    types = xfce_mime_index_get_types (index, mime_type);
+    blacklist = g_hash_table_new (g_str_hash, g_str_equal);
+    seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    /* same order as g_app_info_get_all_for_type (): for the type and
+     * then its parents, the added associations and installed apps of
+     * every directory, minus the removed associations */
+    for (i = 0; i < types->len; i++)
+    {
+        type = g_ptr_array_index (types, i);
+        for (n = 0; n < index->dirs->len; n++)
+        {
+            dir = g_ptr_array_index (index->dirs, n);
+
+            ids = g_hash_table_lookup (dir->added, type);
+            for (k = 0; ids != NULL && ids[k] != NULL; k++)
+            {
+                app = xfce_mime_index_lookup_app (index, ids[k], blacklist);
+                if (app != NULL && g_hash_table_lookup (seen, app) == NULL)
+                {
+                    g_hash_table_insert (seen, app, app);
+                    result = g_list_prepend (result, app);
+                }
+            }
+
+            ids = g_hash_table_lookup (dir->removed, type);
+            for (k = 0; ids != NULL && ids[k] != NULL; k++)
+                g_hash_table_insert (blacklist, ids[k], GINT_TO_POINTER (TRUE));
+
+            apps = g_hash_table_lookup (dir->mime_apps, type);
+            for (k = 0; apps != NULL && k < apps->len; k++)
+            {
+                app = g_ptr_array_index (apps, k);
+                app = xfce_mime_index_lookup_app (index, app->desktop_id, blacklist);
+                if (app != NULL && g_hash_table_lookup (seen, app) == NULL)
+                {
+                    g_hash_table_insert (seen, app, app);
+                    result = g_list_prepend (result, app);
+                }
+            }
+        }
+    }
+
+    g_hash_table_destroy (seen);
+    g_hash_table_destroy (blacklist);
+    g_ptr_array_free (types, TRUE);
+
+    return g_list_reverse (result);
+}
+
+
+
+static GAppInfo *
+xfce_mime_index_app_get_info (MimeIndexApp *app)
+{
+    if (app->app_info == NULL)
+        app->app_info = (GAppInfo *) g_desktop_app_info_new (app->desktop_id);
+
+    return app->app_info;
+}
+
+
+
+static GList *
+xfce_mime_index_app_infos (GList *apps)
+{
+    GList    *li;
+    GList    *app_infos = NULL;
+    GAppInfo *app_info;
+
+    for (li = apps; li != NULL; li = li->next)
+    {
+        app_info = xfce_mime_index_app_get_info (li->data);
+        if (G_LIKELY (app_info != NULL))
+            app_infos = g_list_prepend (app_infos, g_object_ref (G_OBJECT (app_info)));
+    }
+
+    return g_list_reverse (app_infos);
+}
+
+
+
+/**
+ * xfce_mime_index_get:
+ *
+ * Returns the index shared by all windows of the process. The
+ * applications are read from the disk cache when none of the
+ * application directories changed, otherwise all desktop files
+ * are parsed once and the cache is rewritten.
+ *
+ * Return value: a new reference on the shared index.
+ **/
+XfceMimeIndex *
+xfce_mime_index_get (void)
+{
+    static XfceMimeIndex *shared = NULL;
+
+    if (shared == NULL)
+    {
+        shared = g_object_new (XFCE_TYPE_MIME_INDEX, NULL);
+        g_object_add_weak_pointer (G_OBJECT (shared), (gpointer) &shared);
+    }
+    else
+    {
+        g_object_ref (G_OBJECT (shared));
+    }
+
+    return shared;
+}
+
+
+
+/**
+ * xfce_mime_index_invalidate:
+ * @index : an #XfceMimeIndex.
+ *
+ * Drop the resolved defaults and candidates, and re-read the
+ * applications and the mimeapps.list files on the next lookup.
+ * Call this after changing an association or creating an
+ * application. Unchanged applications are read from the cache.
+ **/
+void
+xfce_mime_index_invalidate (XfceMimeIndex *index)
+{
+    g_return_if_fail (XFCE_IS_MIME_INDEX (index));
+
+    index->apps_loaded = FALSE;
+    index->associations_loaded = FALSE;
+}
+
+
+
+/**
+ * xfce_mime_index_get_default_name:
+ * @index     : an #XfceMimeIndex.
+ * @mime_type : a content type.
+ *
+ * Return value: the name of the default application for @mime_type,
+ *               or %NULL. The string is owned by the index.
+ **/
+const gchar *
+xfce_mime_index_get_default_name (XfceMimeIndex *index,
+                                  const gchar   *mime_type)
+{
+    MimeIndexApp *app;
+
+    g_return_val_if_fail (XFCE_IS_MIME_INDEX (index), NULL);
+    g_return_val_if_fail (mime_type != NULL, NULL);
+
+    app = xfce_mime_index_get_default_app (index, mime_type);
+    if (app == NULL)
+        return NULL;
+
+    return app->name != NULL ? app->name : app->desktop_id;
+}
+
+
+
+/**
+ * xfce_mime_index_get_default:
+ * @index     : an #XfceMimeIndex.
+ * @mime_type : a content type.
+ *
+ * Same as g_app_info_get_default_for_type(), but answered from the
+ * index. The #GAppInfo is only created when it is requested.
+ *
+ * Return value: the default application for @mime_type or %NULL.
+ *               Release with g_object_unref().
+ **/
+GAppInfo *
+xfce_mime_index_get_default (XfceMimeIndex *index,
+                             const gchar   *mime_type)
+{
+    MimeIndexApp *app;
+
+    g_return_val_if_fail (XFCE_IS_MIME_INDEX (index), NULL);
+    g_return_val_if_fail (mime_type != NULL, NULL);
+
+    app = xfce_mime_index_get_default_app (index, mime_type);
+    if (app == NULL || xfce_mime_index_app_get_info (app) == NULL)
+        return NULL;
+
+    return g_object_ref (G_OBJECT (app->app_info));
+}
+
+
+
+/**
+ * xfce_mime_index_get_candidates:
+ * @index     : an #XfceMimeIndex.
+ * @mime_type : a content type.
+ *
+ * Same as g_app_info_get_all_for_type (), but answered from the index.
+ * The list for each type is kept until the associations change, and
+ * all callers share the same #GAppInfo instances.
+ *
+ * Return value: list of #GAppInfo. Release with g_object_unref()
+ *               on each item and g_list_free().
+ **/
+GList *
+xfce_mime_index_get_candidates (XfceMimeIndex *index,
+                                const gchar   *mime_type)
+{
+    GList *apps;
+
+    g_return_val_if_fail (XFCE_IS_MIME_INDEX (index), NULL);
+    g_return_val_if_fail (mime_type != NULL, NULL);
+
+    xfce_mime_index_ensure (index);
+
+    if (!g_hash_table_lookup_extended (index->candidates, mime_type, NULL, (gpointer *) &apps))
+    {
+        apps = xfce_mime_index_resolve_candidates (index, mime_type);
+        g_hash_table_insert (index->candidates, g_strdup (mime_type), apps);
+    }
+
+    return xfce_mime_index_app_infos (apps);
+}
+
+
+
+/**
+ * xfce_mime_index_get_all:
+ * @index : an #XfceMimeIndex.
+ *
+ * Same as g_app_info_get_all (), from the desktop files
+ * in the index.
+ *
+ * Return value: list of #GAppInfo. Release with g_object_unref()
+ *               on each item and g_list_free().
+ **/
+GList *
+xfce_mime_index_get_all (XfceMimeIndex *index)
+{
+    GHashTableIter  iter;
+    gpointer        app;
+    GList          *apps = NULL;
+    GList          *app_infos;
+
+    g_return_val_if_fail (XFCE_IS_MIME_INDEX (index), NULL);
+
+    xfce_mime_index_ensure (index);
+
+    g_hash_table_iter_init (&iter, index->apps);
+    while (g_hash_table_iter_next (&iter, NULL, &app))
+        if (((MimeIndexApp *) app)->valid)
+            apps = g_list_prepend (apps, app);
+
+    app_infos = xfce_mime_index_app_infos (apps);
+    g_list_free (apps);
+
+    return app_infos;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XFCE_MIME_INDEX_H__
+#define __XFCE_MIME_INDEX_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfceMimeIndexClass XfceMimeIndexClass;
+typedef struct _XfceMimeIndex      XfceMimeIndex;
+
+#define XFCE_TYPE_MIME_INDEX            (xfce_mime_index_get_type ())
+#define XFCE_MIME_INDEX(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), XFCE_TYPE_MIME_INDEX, XfceMimeIndex))
+#define XFCE_MIME_INDEX_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), XFCE_TYPE_MIME_INDEX, XfceMimeIndexClass))
+#define XFCE_IS_MIME_INDEX(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), XFCE_TYPE_MIME_INDEX))
+#define XFCE_IS_MIME_INDEX_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), XFCE_TYPE_MIME_INDEX))
+#define XFCE_MIME_INDEX_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), XFCE_TYPE_MIME_INDEX, XfceMimeIndexClass))
+
+GType          xfce_mime_index_get_type         (void) G_GNUC_CONST;
+
+XfceMimeIndex *xfce_mime_index_get              (void);
+
+void           xfce_mime_index_invalidate       (XfceMimeIndex *index);
+
+const gchar   *xfce_mime_index_get_default_name (XfceMimeIndex *index,
+                                                 const gchar   *mime_type);
+
+GAppInfo      *xfce_mime_index_get_default      (XfceMimeIndex *index,
+                                                 const gchar   *mime_type);
+
+GList         *xfce_mime_index_get_candidates   (XfceMimeIndex *index,
+                                                 const gchar   *mime_type);
+
+GList         *xfce_mime_index_get_all          (XfceMimeIndex *index);
+
+G_END_DECLS
+
+#endif /* !__XFCE_MIME_INDEX_H__ */
@@ -33,6 +33,15 @@
 
 #include "xfce-mime-window.h"
 #include "xfce-mime-chooser.h"
+#include "xfce-mime-index.h"
+
+
+
+/* delay before a change in the filter entry is applied */
+#define FILTER_DELAY (150)
+
+/* pack three bytes of a string into a trigram key */
+#define TRIGRAM(s) ((((guint) (guchar) (s)[0]) << 16) | (((guint) (guchar) (s)[1]) << 8) | ((guint) (guchar) (s)[2]))
 
 
 
@@ -40,6 +49,13 @@ static void     xfce_mime_window_finalize          (GObject              *object
 static gboolean xfce_mime_window_delete_event      (GtkWidget            *widget,
                                                     GdkEventAny          *event);
 static gint     xfce_mime_window_mime_model        (XfceMimeWindow       *window);
+static gchar   *xfce_mime_window_haystack          (const gchar          *mime_type,
+                                                    const gchar          *app_name);
+static void     xfce_mime_window_icon_data_func    (GtkTreeViewColumn    *column,
+                                                    GtkCellRenderer      *renderer,
+                                                    GtkTreeModel         *model,
+                                                    GtkTreeIter          *iter,
+                                                    gpointer              data);
 static void     xfce_mime_window_filter_changed    (GtkEntry             *entry,
                                                     XfceMimeWindow       *window);
 static void     xfce_mime_window_filter_clear      (GtkEntry             *entry,
@@ -48,9 +64,6 @@ static void     xfce_mime_window_filter_clear      (GtkEntry             *entry,
                                                     gpointer              user_data);
 static void     xfce_mime_window_statusbar_count   (XfceMimeWindow       *window,
                                                     gint                 n_mime_types);
-static gboolean xfce_mime_window_row_visible_func  (GtkTreeModel         *model,
-                                                    GtkTreeIter          *iter,
-                                                    gpointer              data);
 static void     xfce_mime_window_row_activated     (GtkTreeView          *tree_view,
                                                     GtkTreePath          *path,
                                                     GtkTreeViewColumn    *column,
@@ -71,12 +84,31 @@ struct _XfceMimeWindowClass
     XfceTitledDialogClass __parent__;
 };
 
+typedef struct
+{
+    /* list store iters persist */
+    GtkTreeIter  iter;
+
+    /* casefolded mime type and default application */
+    gchar       *haystack;
+
+    guint        visible : 1;
+    guint        match : 1;
+}
+MimeRow;
+
 struct _XfceMimeWindow
 {
     XfceTitledDialog  __parent__;
 
     XfconfChannel *channel;
 
+    /* shared lookup table for the default applications */
+    XfceMimeIndex *index;
+
+    /* mime type -> GIcon, filled when a row is drawn */
+    GHashTable    *icons;
+
     GtkWidget     *treeview;
 
     PangoAttrList *attrs_bold;
@@ -84,6 +116,18 @@ struct _XfceMimeWindow
 
     GtkTreeModel  *filter_model;
     gchar         *filter_text;
+    GtkWidget     *filter_entry;
+    guint          filter_timeout_id;
+
+    /* MimeRow for each row in the mime model */
+    GArray        *rows;
+
+    /* trigram -> GArray of row numbers, built on the first search */
+    GHashTable    *trigrams;
+
+    /* sorted row numbers matching filter_text, NULL if all rows match */
+    GArray        *matches;
+    guint          n_matches;
 
     /* status bar stuff */
     GtkWidget     *statusbar;
@@ -98,8 +142,9 @@ enum
     COLUMN_MIME_TYPE,
     COLUMN_MIME_STATUS,
     COLUMN_MIME_DEFAULT,
-    COLUMN_MIME_GICON,
     COLUMN_MIME_ATTRS,
+    COLUMN_MIME_VISIBLE,
+    COLUMN_MIME_ROW,
     N_MIME_COLUMNS
 };
 
@@ -165,6 +210,8 @@ xfce_mime_window_init (XfceMimeWindow *window)
     GtkCellRenderer   *renderer;
 
     window->channel = xfconf_channel_new ("xfce4-mime-settings");
+    window->index = xfce_mime_index_get ();
+    window->icons = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
     window->attrs_bold = pango_attr_list_new ();
     pango_attr_list_insert (window->attrs_bold, pango_attr_weight_new (PANGO_WEIGHT_BOLD));
@@ -204,7 +251,7 @@ xfce_mime_window_init (XfceMimeWindow *window)
     gtk_box_pack_start (GTK_BOX (hbox), label, FALSE, TRUE, 0);
     gtk_widget_show (label);
 
-    entry = gtk_entry_new ();
+    window->filter_entry = entry = gtk_entry_new ();
     gtk_box_pack_start (GTK_BOX (hbox), entry, TRUE, TRUE, 0);
     gtk_label_set_mnemonic_widget (GTK_LABEL (label), entry);
     gtk_entry_set_icon_from_stock (GTK_ENTRY (entry), GTK_ENTRY_ICON_SECONDARY, GTK_STOCK_CLEAR);
@@ -234,9 +281,8 @@ xfce_mime_window_init (XfceMimeWindow *window)
     gtk_widget_show (statusbar);
 
     window->filter_model = gtk_tree_model_filter_new (window->mime_model, NULL);
-    gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (window->filter_model),
-                                            xfce_mime_window_row_visible_func,
-                                            window, NULL);
+    gtk_tree_model_filter_set_visible_column (GTK_TREE_MODEL_FILTER (window->filter_model),
+                                              COLUMN_MIME_VISIBLE);
 
     treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (window->filter_model));
     gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (treeview), TRUE);
@@ -273,8 +319,9 @@ xfce_mime_window_init (XfceMimeWindow *window)
     renderer = gtk_cell_renderer_pixbuf_new ();
     gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (column), renderer, FALSE);
     g_object_set (renderer, "stock-size", GTK_ICON_SIZE_MENU, NULL);
-    gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (column), renderer,
-                                    "gicon", COLUMN_MIME_GICON, NULL);
+    gtk_tree_view_column_set_cell_data_func (column, renderer,
+                                             xfce_mime_window_icon_data_func,
+                                             window, NULL);
 
     renderer = gtk_cell_renderer_text_new ();
     gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (column), renderer, TRUE);
@@ -339,12 +386,32 @@ static void
 xfce_mime_window_finalize (GObject *object)
 {
     XfceMimeWindow *window = XFCE_MIME_WINDOW (object);
+    MimeRow        *row;
+    guint           i;
+
+    if (window->filter_timeout_id != 0)
+        g_source_remove (window->filter_timeout_id);
 
     g_free (window->filter_text);
 
+    for (i = 0; i < window->rows->len; i++)
+    {
+        row = &g_array_index (window->rows, MimeRow, i);
+        g_free (row->haystack);
+    }
+    g_array_free (window->rows, TRUE);
+
+    if (window->trigrams != NULL)
+        g_hash_table_destroy (window->trigrams);
+    if (window->matches != NULL)
+        g_array_free (window->matches, TRUE);
+
     g_object_unref (G_OBJECT (window->filter_model));
     g_object_unref (G_OBJECT (window->mime_model));
     g_object_unref (G_OBJECT (window->channel));
+    g_object_unref (G_OBJECT (window->index));
+
+    g_hash_table_destroy (window->icons);
 
     pango_attr_list_unref (window->attrs_bold);
 
@@ -447,18 +514,21 @@ xfce_mime_window_mime_model (XfceMimeWindow *window)
     GList        *mime_types, *li;
     gchar        *mime_type;
     const gchar  *app_name;
-    GAppInfo     *app_default;
     GHashTable   *user_mime;
     gboolean      is_user_set;
     gint          n;
     const gchar  *status;
+    MimeRow       row;
 
     model = gtk_list_store_new (N_MIME_COLUMNS,
                                 G_TYPE_STRING,
                                 G_TYPE_STRING,
                                 G_TYPE_STRING,
-                                G_TYPE_ICON,
-                                PANGO_TYPE_ATTR_LIST);
+                                PANGO_TYPE_ATTR_LIST,
+                                G_TYPE_BOOLEAN,
+                                G_TYPE_UINT);
+
+    window->rows = g_array_new (FALSE, TRUE, sizeof (MimeRow));
 
     /* get sorted list of known mime types */
     mime_types = g_content_types_get_registered ();
@@ -471,12 +541,8 @@ xfce_mime_window_mime_model (XfceMimeWindow *window)
     {
         mime_type = li->data;
 
-        app_default = g_app_info_get_default_for_type (mime_type, FALSE);
-
-        if (G_LIKELY (app_default != NULL))
-            app_name = g_app_info_get_name (app_default);
-        else
-            app_name = NULL;
+        /* only the name, the GAppInfo is created when it's used */
+        app_name = xfce_mime_index_get_default_name (window->index, mime_type);
 
         /* check if the user locally override this mime handler */
         is_user_set = g_hash_table_remove (user_mime, mime_type);
@@ -485,18 +551,24 @@ xfce_mime_window_mime_model (XfceMimeWindow *window)
         else
             status = _("Default");
 
-        gtk_list_store_insert_with_values (model, NULL, n++,
+        gtk_list_store_insert_with_values (model, &row.iter, n,
                                            COLUMN_MIME_TYPE, mime_type,
                                            COLUMN_MIME_DEFAULT, app_name,
                                            COLUMN_MIME_STATUS, status,
-                                           COLUMN_MIME_GICON, g_content_type_get_icon (mime_type),
                                            COLUMN_MIME_ATTRS,
                                                is_user_set ? window->attrs_bold : NULL,
+                                           COLUMN_MIME_VISIBLE, TRUE,
+                                           COLUMN_MIME_ROW, n,
                                            -1);
 
+        /* text searched by the filter entry */
+        row.haystack = xfce_mime_window_haystack (mime_type, app_name);
+        row.visible = TRUE;
+        row.match = FALSE;
+        g_array_append_val (window->rows, row);
+        n++;
+
         g_free (mime_type);
-        if (G_LIKELY (app_default != NULL))
-          g_object_unref (app_default);
     }
 
     g_list_free (mime_types);
@@ -510,24 +582,278 @@ xfce_mime_window_mime_model (XfceMimeWindow *window)
 
 
 static void
-xfce_mime_window_filter_changed (GtkEntry       *entry,
-                                   XfceMimeWindow *window)
+xfce_mime_window_icon_data_func (GtkTreeViewColumn *column,
+                                 GtkCellRenderer   *renderer,
+                                 GtkTreeModel      *model,
+                                 GtkTreeIter       *iter,
+                                 gpointer           data)
+{
+    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
+    gchar          *mime_type;
+    GIcon          *icon;
+
+    gtk_tree_model_get (model, iter, COLUMN_MIME_TYPE, &mime_type, -1);
+    if (G_UNLIKELY (mime_type == NULL))
+    {
+        g_object_set (G_OBJECT (renderer), "gicon", NULL, NULL);
+        return;
+    }
+
+    /* the treeview is in fixed height mode, so this only runs
+     * for rows that are actually on the screen */
+    icon = g_hash_table_lookup (window->icons, mime_type);
+    if (icon == NULL)
+    {
+        icon = g_content_type_get_icon (mime_type);
+        g_hash_table_insert (window->icons, mime_type, icon);
+    }
+    else
+    {
+        g_free (mime_type);
+    }
+
+    g_object_set (G_OBJECT (renderer), "gicon", icon, NULL);
+}
+
+
+
+static gchar *
+xfce_mime_window_haystack (const gchar *mime_type,
+                           const gchar *app_name)
+{
+    gchar *text;
+    gchar *haystack;
+
+    /* the entry never contains a newline, so a match can't
+     * cross from the type into the application name */
+    text = g_strconcat (mime_type, "\n", app_name, NULL);
+    haystack = g_utf8_casefold (text, -1);
+    g_free (text);
+
+    return haystack;
+}
+
+
+
+static void
+xfce_mime_window_search_index (XfceMimeWindow *window)
+{
+    MimeRow     *row;
+    guint        i;
+    const gchar *p;
+    GArray      *postings;
+    gpointer     key;
+
+    window->trigrams = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                              (GDestroyNotify) g_array_unref);
+
+    for (i = 0; i < window->rows->len; i++)
+    {
+        row = &g_array_index (window->rows, MimeRow, i);
+
+        for (p = row->haystack; p[0] != '\0' && p[1] != '\0' && p[2] != '\0'; p++)
+        {
+            key = GUINT_TO_POINTER (TRIGRAM (p));
+            postings = g_hash_table_lookup (window->trigrams, key);
+            if (postings == NULL)
+            {
+                postings = g_array_new (FALSE, FALSE, sizeof (guint));
+                g_hash_table_insert (window->trigrams, key, postings);
+            }
+
+            /* rows are visited in order, so the lists stay sorted
+             * and a repeated trigram is always the last entry */
+            if (postings->len == 0
+                || g_array_index (postings, guint, postings->len - 1) != i)
+                g_array_append_val (postings, i);
+        }
+    }
+}
+
+
+
+static gboolean
+xfce_mime_window_search_candidates (XfceMimeWindow  *window,
+                                    const gchar     *filter_text,
+                                    GArray         **candidates)
+{
+    GArray      *postings;
+    const gchar *p;
+
+    /* NULL means all rows are candidates */
+    *candidates = NULL;
+
+    /* typing more characters only narrows the previous matches */
+    if (window->filter_text != NULL
+        && window->matches != NULL
+        && strstr (filter_text, window->filter_text) != NULL)
+    {
+        *candidates = window->matches;
+        return TRUE;
+    }
+
+    /* too short for a trigram, check all rows */
+    if (strlen (filter_text) < 3)
+        return TRUE;
+
+    if (window->trigrams == NULL)
+        xfce_mime_window_search_index (window);
+
+    /* every match contains all trigrams of the filter, the rarest
+     * one gives the shortest list of rows to check */
+    for (p = filter_text; p[0] != '\0' && p[1] != '\0' && p[2] != '\0'; p++)
+    {
+        postings = g_hash_table_lookup (window->trigrams, GUINT_TO_POINTER (TRIGRAM (p)));
+
+        /* a trigram that is nowhere in the model */
+        if (postings == NULL)
+            return FALSE;
+
+        if (*candidates == NULL || postings->len < (*candidates)->len)
+            *candidates = postings;
+    }
+
+    return TRUE;
+}
+
+
+
+static void
+xfce_mime_window_row_set_visible (XfceMimeWindow *window,
+                                  MimeRow        *row,
+                                  gboolean        visible)
+{
+    if (row->visible == !!visible)
+        return;
+
+    /* the filter model only re-checks this row */
+    row->visible = !!visible;
+    gtk_list_store_set (GTK_LIST_STORE (window->mime_model), &row->iter,
+                        COLUMN_MIME_VISIBLE, row->visible, -1);
+}
+
+
+
+static void
+xfce_mime_window_filter_apply (XfceMimeWindow *window)
 {
     const gchar *text;
-    gint         count;
+    gchar       *filter_text = NULL;
+    GArray      *candidates;
+    GArray      *matches = NULL;
+    MimeRow     *row;
+    guint        i, n, idx;
 
-    g_free (window->filter_text);
+    text = gtk_entry_get_text (GTK_ENTRY (window->filter_entry));
+    if (text != NULL && *text != '\0')
+        filter_text = g_utf8_casefold (text, -1);
 
-    text = gtk_entry_get_text (GTK_ENTRY (entry));
-    if (text == NULL || *text == '\0')
-        window->filter_text = NULL;
+    if (g_strcmp0 (filter_text, window->filter_text) == 0)
+    {
+        g_free (filter_text);
+        return;
+    }
+
+    if (filter_text != NULL)
+    {
+        /* collect the sorted row numbers that match the new filter */
+        matches = g_array_new (FALSE, FALSE, sizeof (guint));
+        if (xfce_mime_window_search_candidates (window, filter_text, &candidates))
+        {
+            n = candidates != NULL ? candidates->len : window->rows->len;
+            for (i = 0; i < n; i++)
+            {
+                idx = candidates != NULL ? g_array_index (candidates, guint, i) : i;
+                row = &g_array_index (window->rows, MimeRow, idx);
+                if (strstr (row->haystack, filter_text) != NULL)
+                {
+                    row->match = TRUE;
+                    g_array_append_val (matches, idx);
+                }
+            }
+        }
+    }
+
+    if (window->matches == NULL || matches == NULL)
+    {
+        /* from or to the unfiltered list, every row is involved */
+        for (i = 0; i < window->rows->len; i++)
+        {
+            row = &g_array_index (window->rows, MimeRow, i);
+            xfce_mime_window_row_set_visible (window, row, matches == NULL || row->match);
+            row->match = FALSE;
+        }
+    }
     else
-        window->filter_text = g_utf8_casefold (text, -1);
+    {
+        /* only touch rows in the old or the new result set */
+        for (i = 0; i < window->matches->len; i++)
+        {
+            row = &g_array_index (window->rows, MimeRow, g_array_index (window->matches, guint, i));
+            if (!row->match)
+                xfce_mime_window_row_set_visible (window, row, FALSE);
+        }
 
-    gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (window->filter_model));
+        for (i = 0; i < matches->len; i++)
+        {
+            row = &g_array_index (window->rows, MimeRow, g_array_index (matches, guint, i));
+            xfce_mime_window_row_set_visible (window, row, TRUE);
+            row->match = FALSE;
+        }
+    }
+
+    if (window->matches != NULL)
+        g_array_free (window->matches, TRUE);
+    window->matches = matches;
+    window->n_matches = matches != NULL ? matches->len : window->rows->len;
+
+    g_free (window->filter_text);
+    window->filter_text = filter_text;
 
-    count = gtk_tree_model_iter_n_children (window->filter_model, NULL);
-    xfce_mime_window_statusbar_count (window, count);
+    xfce_mime_window_statusbar_count (window, window->n_matches);
+}
+
+
+
+static gboolean
+xfce_mime_window_filter_timeout (gpointer data)
+{
+    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
+
+    GDK_THREADS_ENTER ();
+    xfce_mime_window_filter_apply (window);
+    GDK_THREADS_LEAVE ();
+
+    return FALSE;
+}
+
+
+
+static void
+xfce_mime_window_filter_timeout_destroyed (gpointer data)
+{
+    XFCE_MIME_WINDOW (data)->filter_timeout_id = 0;
+}
+
+
+
+static void
+xfce_mime_window_filter_changed (GtkEntry       *entry,
+                                 XfceMimeWindow *window)
+{
+    const gchar *text;
+
+    if (window->filter_timeout_id != 0)
+        g_source_remove (window->filter_timeout_id);
+
+    /* clearing the filter is instant, typing is collected first */
+    text = gtk_entry_get_text (entry);
+    if (text == NULL || *text == '\0')
+        xfce_mime_window_filter_apply (window);
+    else
+        window->filter_timeout_id = g_timeout_add_full (G_PRIORITY_DEFAULT, FILTER_DELAY,
+                                                        xfce_mime_window_filter_timeout, window,
+                                                        xfce_mime_window_filter_timeout_destroyed);
 }
 
 
@@ -561,32 +887,6 @@ xfce_mime_window_statusbar_count (XfceMimeWindow *window,
 
 
 
-static gboolean
-xfce_mime_window_row_visible_func (GtkTreeModel *model,
-                                     GtkTreeIter  *iter,
-                                     gpointer      data)
-{
-    XfceMimeWindow *window = XFCE_MIME_WINDOW (data);
-    const gchar    *mime_type;
-    GValue          value = { 0, };
-    gboolean        visible;
-
-    if (window->filter_text == NULL)
-        return TRUE;
-
-    gtk_tree_model_get_value (model, iter, COLUMN_MIME_TYPE, &value);
-
-    mime_type = g_value_get_string (&value);
-    visible = mime_type != NULL
-        && strstr (mime_type, window->filter_text) != NULL;
-
-    g_value_unset (&value);
-
-    return visible;
-}
-
-
-
 static void
 xfce_mime_window_set_filter_model (XfceMimeWindow *window,
                                    GtkTreePath    *filter_path,
@@ -596,6 +896,9 @@ xfce_mime_window_set_filter_model (XfceMimeWindow *window,
     GtkTreePath *path;
     GtkTreeIter  filter_iter;
     GtkTreeIter  mime_iter;
+    guint        n;
+    gchar       *mime_type;
+    MimeRow     *row;
 
     if (!gtk_tree_model_get_iter (window->filter_model, &filter_iter, filter_path))
         return;
@@ -604,6 +907,21 @@ xfce_mime_window_set_filter_model (XfceMimeWindow *window,
         GTK_TREE_MODEL_FILTER (window->filter_model),
         &mime_iter, &filter_iter);
 
+    /* update the search text, the trigrams are rebuilt on the next search */
+    gtk_tree_model_get (window->mime_model, &mime_iter,
+                        COLUMN_MIME_TYPE, &mime_type,
+                        COLUMN_MIME_ROW, &n, -1);
+    row = &g_array_index (window->rows, MimeRow, n);
+    g_free (row->haystack);
+    row->haystack = xfce_mime_window_haystack (mime_type, app_name);
+    g_free (mime_type);
+
+    if (window->trigrams != NULL)
+    {
+        g_hash_table_destroy (window->trigrams);
+        window->trigrams = NULL;
+    }
+
     gtk_list_store_set (GTK_LIST_STORE (window->mime_model), &mime_iter,
                         COLUMN_MIME_DEFAULT, app_name,
                         COLUMN_MIME_STATUS, user_set ? _("User Set") : _("Default"),
@@ -621,6 +939,15 @@ xfce_mime_window_set_filter_model (XfceMimeWindow *window,
         gtk_tree_view_set_cursor (GTK_TREE_VIEW (window->treeview), path, NULL, FALSE);
         gtk_tree_path_free (path);
     }
+
+    /* the previous matches do not account for the new search text,
+     * so forget the filter and check all the candidates again */
+    if (window->filter_text != NULL)
+    {
+        g_free (window->filter_text);
+        window->filter_text = NULL;
+        xfce_mime_window_filter_apply (window);
+    }
 }
 
 
@@ -639,12 +966,13 @@ xfce_mime_window_set_default_for_type (XfceMimeWindow *window,
     g_return_if_fail (mime_type != NULL);
 
     /* do nothing if the new app is the same as the default */
-    app_default = g_app_info_get_default_for_type (mime_type, FALSE);
+    app_default = xfce_mime_index_get_default (window->index, mime_type);
     if (app_default == NULL
         || !g_app_info_equal (app_default, app_info))
     {
         if (g_app_info_set_as_default_for_type (app_info, mime_type, &error))
         {
+            xfce_mime_index_invalidate (window->index);
             xfce_mime_window_set_filter_model (window, filter_path,
                                                g_app_info_get_name (app_info), TRUE);
         }
@@ -837,7 +1165,6 @@ xfce_mime_window_reset_response (GtkWidget       *dialog,
                                  gint             response_id,
                                  MimeChangedData *data)
 {
-    GAppInfo    *app_default;
     const gchar *app_name;
 
     gtk_widget_destroy (dialog);
@@ -846,18 +1173,11 @@ xfce_mime_window_reset_response (GtkWidget       *dialog,
     {
         /* reset the user's default */
         g_app_info_reset_type_associations (data->mime_type);
+        xfce_mime_index_invalidate (data->window->index);
 
         /* restore the system default */
-        app_default = g_app_info_get_default_for_type (data->mime_type, FALSE);
-        if (app_default != NULL)
-          app_name = g_app_info_get_name (app_default);
-        else
-          app_name = NULL;
-
+        app_name = xfce_mime_index_get_default_name (data->window->index, data->mime_type);
         xfce_mime_window_set_filter_model (data->window, data->filter_path, app_name, FALSE);
-
-        if (app_default != NULL)
-            g_object_unref (app_default);
     }
 
     xfce_mime_window_combo_unref_data (data);
@@ -959,7 +1279,7 @@ xfce_mime_window_combo_populate (GtkCellRenderer *renderer,
                                 G_TYPE_UINT);
 
     gtk_tree_model_get (window->filter_model, &iter, COLUMN_MIME_TYPE, &mime_type, -1);
-    app_infos = g_app_info_get_all_for_type (mime_type);
+    app_infos = xfce_mime_index_get_candidates (window->index, mime_type);
 
     for (li = app_infos, n = 0; li != NULL; li = li->next)
     {
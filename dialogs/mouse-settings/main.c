@@ -30,6 +30,12 @@
 #ifdef HAVE_MATH_H
 #include <math.h>
 #endif
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
 
 #include <xfsettingsd/pointers-defines.h>
 #ifdef HAVE_XCURSOR
@@ -40,9 +46,14 @@
 #include "libinput-properties.h"
 #endif /* HAVE_LIBINPUT */
 
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <gdk/gdkx.h>
 
+#ifdef HAVE_XI2
+#include <X11/extensions/XInput2.h>
+#endif
+
 #include <xfconf/xfconf.h>
 #include <libxfce4util/libxfce4util.h>
 #include <libxfce4ui/libxfce4ui.h>
@@ -55,8 +66,17 @@
 #define PREVIEW_COLUMNS (6)
 #define PREVIEW_SIZE    (24)
 #define PREVIEW_SPACING (2)
+#define PREVIEW_THREADS (4)
+
+/* previews cache, relative to the user's cache directory */
+#define PREVIEW_CACHE_DIR "xfce4" G_DIR_SEPARATOR_S "mouse-settings"
 #endif /* !HAVE_XCURSOR */
 
+#ifdef DEVICE_HOTPLUGGING
+/* delay in ms for collecting device add/remove events */
+#define DEVICE_CHANGES_DELAY (250)
+#endif
+
 
 /* global setting channels */
 XfconfChannel *xsettings_channel;
@@ -68,11 +88,31 @@ static gint locked = 0;
 /* device update id */
 static guint timeout_id = 0;
 
+/* pointer devices in the combobox, indexed by xid */
+static GHashTable *devices = NULL;
+
+/* idle id for querying the device snapshots */
+static guint device_refresh_id = 0;
+
 #ifdef DEVICE_HOTPLUGGING
 /* event id for device add/remove */
 static gint device_presence_event_type = 0;
+
+/* pending add/remove changes, indexed by xid */
+static GHashTable *device_changes = NULL;
+
+/* timeout id for applying the device changes */
+static guint device_changes_id = 0;
 #endif
 
+#ifdef HAVE_XCURSOR
+/* worker threads decoding the cursor theme previews */
+static GThreadPool *theme_pool = NULL;
+
+/* serial of the most recent preview image request */
+static guint theme_preview_serial = 0;
+#endif /* !HAVE_XCURSOR */
+
 /* option entries */
 static GdkNativeWindow opt_socket_id = 0;
 static gchar *opt_device_name = NULL;
@@ -108,6 +148,35 @@ enum
     COLUMN_THEME_COMMENT,
     N_THEME_COLUMNS
 };
+
+typedef enum
+{
+    THEME_PREVIEW_ICON,  /* left_ptr icon in the theme list */
+    THEME_PREVIEW_IMAGE  /* cursor grid of the selected theme */
+}
+ThemePreviewKind;
+
+typedef struct
+{
+    ThemePreviewKind     kind;
+
+    /* cursors directory of the theme */
+    gchar               *path;
+
+    /* cached png in the user's cache directory */
+    gchar               *cache_file;
+
+    /* queue order for icons, selection serial for images */
+    guint                serial;
+
+    /* where the result goes, only touched in the main thread */
+    GtkTreeRowReference *row;
+    GtkBuilder          *builder;
+
+    /* the result of the job */
+    GdkPixbuf           *pixbuf;
+}
+ThemePreviewJob;
 #endif /* !HAVE_XCURSOR */
 
 enum
@@ -118,6 +187,51 @@ enum
     N_DEVICE_COLUMNS
 };
 
+typedef struct
+{
+    /* button map and feedback */
+    gint         nbuttons;
+    gboolean     left_handed;
+    gboolean     reverse_scrolling;
+    gdouble      acceleration;
+    gint         threshold;
+
+    /* driver of the device */
+    gboolean     is_libinput;
+    gboolean     is_synaptics;
+    gboolean     is_wacom;
+
+    /* device properties, -1 if unsupported */
+    gint         is_enabled;
+    gint         synaptics_tap_to_click;
+    gint         synaptics_edge_scroll;
+    gint         synaptics_edge_hscroll;
+    gint         synaptics_two_scroll;
+    gint         synaptics_two_hscroll;
+    gint         synaptics_circ_scroll;
+    gint         wacom_rotation;
+    gint         wacom_mode;
+}
+MouseDeviceState;
+
+typedef struct
+{
+    XID               xid;
+
+    /* row in the device store */
+    GtkTreeIter       iter;
+
+    gchar            *xfconf_name;
+
+    /* from the device info, kept for the next query */
+    gint              nbuttons;
+    gint              wacom_mode;
+
+    /* property snapshot, NULL when stale */
+    MouseDeviceState *state;
+}
+MouseDevice;
+
 typedef union
 {
     gchar   c;
@@ -164,14 +278,38 @@ mouse_settings_format_value_s (GtkScale *scale,
 
 
 #ifdef HAVE_XCURSOR
+static void
+mouse_settings_themes_swizzle (guint32            *dest,
+                               const XcursorPixel *src,
+                               gsize               n_pixels)
+{
+    gsize   i;
+    guint32 pixel;
+
+    /* convert the native-endian ARGB words of xcursor to the RGBA byte
+     * order of a GdkPixbuf; this is a plain shift-and-mask loop without
+     * dependencies between the iterations, so the compiler can turn it
+     * into vector instructions */
+    for (i = 0; i < n_pixels; i++)
+    {
+        pixel = src[i];
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+        dest[i] = (pixel & 0xff00ff00) | ((pixel >> 16) & 0x000000ff) | ((pixel & 0x000000ff) << 16);
+#else
+        dest[i] = (pixel << 8) | (pixel >> 24);
+#endif
+    }
+}
+
+
+
 static GdkPixbuf *
 mouse_settings_themes_pixbuf_from_filename (const gchar *filename,
                                             guint        size)
 {
     XcursorImage *image;
     GdkPixbuf    *scaled, *pixbuf = NULL;
-    gsize         bsize;
-    guchar       *buffer, *p, tmp;
+    guint32      *buffer;
     gdouble       wratio, hratio;
     gint          dest_width, dest_height;
 
@@ -179,25 +317,12 @@ mouse_settings_themes_pixbuf_from_filename (const gchar *filename,
     image = XcursorFilenameLoadImage (filename, size);
     if (G_LIKELY (image))
     {
-        /* buffer size */
-        bsize = image->width * image->height * 4;
-
-        /* allocate buffer */
-        buffer = g_malloc (bsize);
-
-        /* copy pixel data to buffer */
-        memcpy (buffer, image->pixels, bsize);
-
-        /* swap bits */
-        for (p = buffer; p < buffer + bsize; p += 4)
-        {
-            tmp = p[0];
-            p[0] = p[2];
-            p[2] = tmp;
-        }
+        /* allocate buffer and convert the pixel data into it */
+        buffer = g_new (guint32, image->width * image->height);
+        mouse_settings_themes_swizzle (buffer, image->pixels, image->width * image->height);
 
         /* create pixbuf */
-        pixbuf = gdk_pixbuf_new_from_data (buffer, GDK_COLORSPACE_RGB, TRUE,
+        pixbuf = gdk_pixbuf_new_from_data ((guchar *) buffer, GDK_COLORSPACE_RGB, TRUE,
                                            8, image->width, image->height,
                                            4 * image->width,
                                            (GdkPixbufDestroyNotify) g_free, NULL);
@@ -239,6 +364,144 @@ mouse_settings_themes_pixbuf_from_filename (const gchar *filename,
 
 
 
+static gchar *
+mouse_settings_themes_cache_basename (const gchar *path,
+                                      const gchar *kind)
+{
+    gchar *checksum;
+    gchar *basename;
+
+    /* one file per theme directory and preview kind, the preview
+     * dimensions are part of the name so a changed layout never
+     * picks up an old image */
+    checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, path, -1);
+    basename = g_strdup_printf ("%s-%s-%dx%dx%d.png", checksum, kind,
+                                PREVIEW_SIZE, PREVIEW_COLUMNS, PREVIEW_ROWS);
+    g_free (checksum);
+
+    return basename;
+}
+
+
+
+static gchar *
+mouse_settings_themes_cache_filename (const gchar *path,
+                                      const gchar *kind)
+{
+    gchar *basename;
+    gchar *resource;
+    gchar *filename;
+
+    basename = mouse_settings_themes_cache_basename (path, kind);
+    resource = g_build_filename (PREVIEW_CACHE_DIR, basename, NULL);
+    filename = xfce_resource_save_location (XFCE_RESOURCE_CACHE, resource, TRUE);
+    g_free (resource);
+    g_free (basename);
+
+    return filename;
+}
+
+
+
+static void
+mouse_settings_themes_cache_add_valid (GHashTable  *valid,
+                                       const gchar *path)
+{
+    g_hash_table_insert (valid, mouse_settings_themes_cache_basename (path, "icon"), NULL);
+    g_hash_table_insert (valid, mouse_settings_themes_cache_basename (path, "preview"), NULL);
+}
+
+
+
+static void
+mouse_settings_themes_cache_prune (GHashTable *valid)
+{
+    gchar       *cache_dir;
+    GDir        *dir;
+    const gchar *name;
+    gchar       *filename;
+
+    cache_dir = xfce_resource_save_location (XFCE_RESOURCE_CACHE, PREVIEW_CACHE_DIR, FALSE);
+    if (cache_dir == NULL)
+        return;
+
+    /* remove the previews of themes that are no longer installed, or
+     * that were rendered with other dimensions; temporary files are
+     * left alone since the workers may be writing them */
+    dir = g_dir_open (cache_dir, 0, NULL);
+    if (G_LIKELY (dir != NULL))
+    {
+        while ((name = g_dir_read_name (dir)) != NULL)
+        {
+            if (g_str_has_suffix (name, ".png")
+                && !g_hash_table_lookup_extended (valid, name, NULL, NULL))
+            {
+                filename = g_build_filename (cache_dir, name, NULL);
+                g_unlink (filename);
+                g_free (filename);
+            }
+        }
+
+        g_dir_close (dir);
+    }
+
+    g_free (cache_dir);
+}
+
+
+
+static GdkPixbuf *
+mouse_settings_themes_cache_load (const gchar *cache_file,
+                                  const gchar *mtime)
+{
+    GdkPixbuf   *pixbuf;
+    const gchar *cached_mtime;
+
+    if (cache_file == NULL
+        || !g_file_test (cache_file, G_FILE_TEST_IS_REGULAR))
+        return NULL;
+
+    pixbuf = gdk_pixbuf_new_from_file (cache_file, NULL);
+    if (G_LIKELY (pixbuf != NULL))
+    {
+        /* only use the image if the theme did not change since it was saved */
+        cached_mtime = gdk_pixbuf_get_option (pixbuf, "tEXt::X-Xfce-Mtime");
+        if (g_strcmp0 (cached_mtime, mtime) != 0)
+        {
+            g_object_unref (G_OBJECT (pixbuf));
+            pixbuf = NULL;
+        }
+    }
+
+    return pixbuf;
+}
+
+
+
+static void
+mouse_settings_themes_cache_save (const gchar *cache_file,
+                                  const gchar *mtime,
+                                  GdkPixbuf   *pixbuf)
+{
+    gchar *tmp_file;
+
+    if (cache_file == NULL)
+        return;
+
+    /* write to a temporary file first, so a concurrent reader never
+     * sees a half-written image */
+    tmp_file = g_strconcat (cache_file, ".tmp", NULL);
+    if (gdk_pixbuf_save (pixbuf, tmp_file, "png", NULL,
+                         "tEXt::X-Xfce-Mtime", mtime, NULL))
+    {
+        if (g_rename (tmp_file, cache_file) != 0)
+            g_unlink (tmp_file);
+    }
+    g_free (tmp_file);
+}
+
+
+
 static GdkPixbuf *
 mouse_settings_themes_preview_icon (const gchar *path)
 {
@@ -259,9 +522,8 @@ mouse_settings_themes_preview_icon (const gchar *path)
 
 
 
-static void
-mouse_settings_themes_preview_image (const gchar *path,
-                                     GtkImage    *image)
+static GdkPixbuf *
+mouse_settings_themes_preview_image (const gchar *path)
 {
     GdkPixbuf *pixbuf;
     GdkPixbuf *preview;
@@ -308,18 +570,145 @@ mouse_settings_themes_preview_image (const gchar *path,
                     break;
             }
         }
+    }
+
+    return preview;
+}
+
 
-        /* set the image */
-        gtk_image_set_from_pixbuf (GTK_IMAGE (image), preview);
 
-        /* release the pixbuf */
-        g_object_unref (G_OBJECT (preview));
+static gboolean
+mouse_settings_themes_job_finished (gpointer user_data)
+{
+    ThemePreviewJob *job = user_data;
+    GtkTreeModel    *model;
+    GtkTreePath     *path;
+    GtkTreeIter      iter;
+    GObject         *image;
+
+    GDK_THREADS_ENTER ();
+
+    if (job->kind == THEME_PREVIEW_ICON)
+    {
+        /* set the icon in the row, if it still exists */
+        if (job->pixbuf != NULL
+            && gtk_tree_row_reference_valid (job->row))
+        {
+            model = gtk_tree_row_reference_get_model (job->row);
+            path = gtk_tree_row_reference_get_path (job->row);
+            if (gtk_tree_model_get_iter (model, &iter, path))
+                gtk_list_store_set (GTK_LIST_STORE (model), &iter,
+                                    COLUMN_THEME_PIXBUF, job->pixbuf, -1);
+            gtk_tree_path_free (path);
+        }
     }
+    else if (job->serial == theme_preview_serial)
+    {
+        /* only the most recent selection updates the preview widget */
+        image = gtk_builder_get_object (job->builder, "theme-preview");
+        if (G_LIKELY (job->pixbuf != NULL))
+            gtk_image_set_from_pixbuf (GTK_IMAGE (image), job->pixbuf);
+        else
+            gtk_image_clear (GTK_IMAGE (image));
+    }
+
+    GDK_THREADS_LEAVE ();
+
+    return FALSE;
+}
+
+
+
+static void
+mouse_settings_themes_job_free (gpointer user_data)
+{
+    ThemePreviewJob *job = user_data;
+
+    if (job->row != NULL)
+        gtk_tree_row_reference_free (job->row);
+    if (job->pixbuf != NULL)
+        g_object_unref (G_OBJECT (job->pixbuf));
+    g_free (job->path);
+    g_free (job->cache_file);
+    g_slice_free (ThemePreviewJob, job);
+}
+
+
+
+static void
+mouse_settings_themes_job_run (gpointer data,
+                               gpointer user_data)
+{
+    ThemePreviewJob *job = data;
+    struct stat      statb;
+    gchar           *mtime;
+
+    /* the mtime of the cursors directory invalidates the cached image */
+    if (g_stat (job->path, &statb) == 0)
+        mtime = g_strdup_printf ("%" G_GINT64_FORMAT, (gint64) statb.st_mtime);
     else
+        mtime = g_strdup ("0");
+
+    job->pixbuf = mouse_settings_themes_cache_load (job->cache_file, mtime);
+    if (job->pixbuf == NULL)
+    {
+        /* decode the cursor files */
+        if (job->kind == THEME_PREVIEW_ICON)
+            job->pixbuf = mouse_settings_themes_preview_icon (job->path);
+        else
+            job->pixbuf = mouse_settings_themes_preview_image (job->path);
+
+        if (G_LIKELY (job->pixbuf != NULL))
+            mouse_settings_themes_cache_save (job->cache_file, mtime, job->pixbuf);
+    }
+
+    g_free (mtime);
+
+    /* hand the result to the main loop */
+    g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, mouse_settings_themes_job_finished,
+                     job, mouse_settings_themes_job_free);
+}
+
+
+
+static gint
+mouse_settings_themes_job_compare (gconstpointer a,
+                                   gconstpointer b,
+                                   gpointer      user_data)
+{
+    const ThemePreviewJob *job_a = a;
+    const ThemePreviewJob *job_b = b;
+
+    /* the preview of the selected theme goes before the list icons */
+    if (job_a->kind != job_b->kind)
+        return job_a->kind == THEME_PREVIEW_IMAGE ? -1 : 1;
+
+    /* otherwise keep the order in which the jobs were queued */
+    return job_a->serial < job_b->serial ? -1 : (job_a->serial > job_b->serial ? 1 : 0);
+}
+
+
+
+static void
+mouse_settings_themes_job_push (ThemePreviewJob *job)
+{
+    static guint job_serial = 0;
+
+    if (G_UNLIKELY (theme_pool == NULL))
     {
-        /* clear the image */
-        gtk_image_clear (GTK_IMAGE (image));
+        theme_pool = g_thread_pool_new (mouse_settings_themes_job_run, NULL,
+                                        PREVIEW_THREADS, FALSE, NULL);
+        g_thread_pool_set_sort_function (theme_pool, mouse_settings_themes_job_compare, NULL);
     }
+
+    /* icon jobs are ordered by the queue serial */
+    if (job->kind == THEME_PREVIEW_ICON)
+        job->serial = ++job_serial;
+
+    job->cache_file = mouse_settings_themes_cache_filename (job->path,
+        job->kind == THEME_PREVIEW_ICON ? "icon" : "preview");
+
+    g_thread_pool_push (theme_pool, job, NULL);
 }
 
 
@@ -328,11 +717,12 @@ static void
 mouse_settings_themes_selection_changed (GtkTreeSelection *selection,
                                          GtkBuilder       *builder)
 {
-    GtkTreeModel *model;
-    GtkTreeIter   iter;
-    gboolean      has_selection;
-    gchar        *path, *name;
-    GObject      *image;
+    GtkTreeModel    *model;
+    GtkTreeIter      iter;
+    gboolean         has_selection;
+    gchar           *path, *name;
+    GObject         *image;
+    ThemePreviewJob *job;
 
     has_selection = gtk_tree_selection_get_selected (selection, &model, &iter);
     if (G_LIKELY (has_selection))
@@ -341,16 +731,31 @@ mouse_settings_themes_selection_changed (GtkTreeSelection *selection,
         gtk_tree_model_get (model, &iter, COLUMN_THEME_PATH, &path,
                             COLUMN_THEME_NAME, &name, -1);
 
-        /* update the preview widget */
-        image = gtk_builder_get_object (builder, "theme-preview");
-        mouse_settings_themes_preview_image (path, GTK_IMAGE (image));
+        /* invalidate pending previews of earlier selections */
+        theme_preview_serial++;
+
+        if (G_LIKELY (path != NULL))
+        {
+            /* render the preview widget in the thread pool */
+            job = g_slice_new0 (ThemePreviewJob);
+            job->kind = THEME_PREVIEW_IMAGE;
+            job->path = path;
+            job->serial = theme_preview_serial;
+            job->builder = builder;
+            mouse_settings_themes_job_push (job);
+        }
+        else
+        {
+            /* the default theme has no cursors to preview */
+            image = gtk_builder_get_object (builder, "theme-preview");
+            gtk_image_clear (GTK_IMAGE (image));
+        }
 
         /* write configuration (not during a lock) */
         if (locked == 0)
             xfconf_channel_set_string (xsettings_channel, "/Gtk/CursorThemeName", name);
 
         /* cleanup */
-        g_free (path);
         g_free (name);
     }
 }
@@ -409,15 +814,18 @@ mouse_settings_themes_populate_store (GtkBuilder *builder)
     const gchar        *comment;
     GtkTreeIter         iter;
     gint                position = 0;
-    GdkPixbuf          *pixbuf;
+    ThemePreviewJob    *job;
     gchar              *active_theme;
     GtkTreePath        *active_path = NULL;
+    GtkTreePath        *tree_path;
+    gint                xpad, ypad;
     GtkListStore       *store;
     GtkCellRenderer    *renderer;
     GtkTreeViewColumn  *column;
     GObject            *treeview;
     GtkTreeSelection   *selection;
     gchar              *comment_escaped;
+    GHashTable         *cache_valid;
 
     /* get the cursor paths */
 #if XCURSOR_LIB_MAJOR == 1 && XCURSOR_LIB_MINOR < 1
@@ -444,6 +852,9 @@ mouse_settings_themes_populate_store (GtkBuilder *builder)
     /* store the default path, so we always select a theme */
     active_path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), &iter);
 
+    /* cached previews of the themes in the list */
+    cache_valid = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
     if (G_LIKELY (basedirs))
     {
         /* walk the base directories */
@@ -475,26 +886,31 @@ mouse_settings_themes_populate_store (GtkBuilder *builder)
                     /* check if it looks like a cursor theme */
                     if (g_file_test (filename, G_FILE_TEST_IS_DIR))
                     {
-                        /* try to load a pixbuf */
-                        pixbuf = mouse_settings_themes_preview_icon (filename);
-
                         /* insert in the store */
                         gtk_list_store_insert_with_values (store, &iter, position++,
-                                                           COLUMN_THEME_PIXBUF, pixbuf,
                                                            COLUMN_THEME_NAME, theme,
                                                            COLUMN_THEME_DISPLAY_NAME, theme,
                                                            COLUMN_THEME_PATH, filename, -1);
 
+                        /* load the icon in the thread pool */
+                        tree_path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), &iter);
+                        job = g_slice_new0 (ThemePreviewJob);
+                        job->kind = THEME_PREVIEW_ICON;
+                        job->path = g_strdup (filename);
+                        job->row = gtk_tree_row_reference_new (GTK_TREE_MODEL (store), tree_path);
+                        mouse_settings_themes_job_push (job);
+                        mouse_settings_themes_cache_add_valid (cache_valid, filename);
+
                         /* check if this is the active theme, set the path */
                         if (strcmp (active_theme, theme) == 0)
                         {
                             gtk_tree_path_free (active_path);
-                            active_path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), &iter);
+                            active_path = tree_path;
+                        }
+                        else
+                        {
+                            gtk_tree_path_free (tree_path);
                         }
-
-                        /* release pixbuf */
-                        if (G_LIKELY (pixbuf))
-                            g_object_unref (G_OBJECT (pixbuf));
 
                         /* check for a index.theme file for additional information */
                         index_file = g_build_filename (path, theme, "index.theme", NULL);
@@ -551,6 +967,10 @@ mouse_settings_themes_populate_store (GtkBuilder *builder)
         g_strfreev (basedirs);
     }
 
+    /* drop the previews that are not in the list anymore */
+    mouse_settings_themes_cache_prune (cache_valid);
+    g_hash_table_destroy (cache_valid);
+
     /* cleanup */
     g_free (active_theme);
 
@@ -562,6 +982,9 @@ mouse_settings_themes_populate_store (GtkBuilder *builder)
     /* setup the columns */
     renderer = gtk_cell_renderer_pixbuf_new ();
     column = gtk_tree_view_column_new_with_attributes ("", renderer, "pixbuf", COLUMN_THEME_PIXBUF, NULL);
+    /* the icons are loaded in the background, keep the rows from jumping */
+    gtk_cell_renderer_get_padding (renderer, &xpad, &ypad);
+    gtk_cell_renderer_set_fixed_size (renderer, PREVIEW_SIZE + 2 * xpad, PREVIEW_SIZE + 2 * ypad);
     gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
 
     renderer = gtk_cell_renderer_text_new ();
@@ -1149,32 +1572,19 @@ mouse_settings_device_set_enabled (GtkToggleButton *button,
 
 
 
-static void
-mouse_settings_device_selection_changed (GtkBuilder *builder)
+static MouseDeviceState *
+mouse_settings_device_query (MouseDevice *mdevice)
 {
-    gint               nbuttons = 0;
     Display           *xdisplay = GDK_DISPLAY ();
+    MouseDeviceState  *state;
     XDevice           *device;
-    XDeviceInfo       *device_info;
     XFeedbackState    *states, *pt;
-    XAnyClassPtr       any;
     gint               nstates;
-    XPtrFeedbackState *state;
-    gint               i, n;
+    XPtrFeedbackState *ptr_state;
+    gint               i;
     guchar            *buttonmap;
     gint               id_1 = 0, id_3 = 0;
     gint               id_4 = 0, id_5 = 0;
-    gdouble            acceleration = -1.00;
-    gint               threshold = -1;
-    GObject           *object;
-    gint               ndevices;
-    gboolean           is_synaptics = FALSE;
-    gboolean           is_wacom = FALSE;
-    gboolean           left_handed = FALSE;
-    gboolean           reverse_scrolling = FALSE;
-#ifdef HAVE_LIBINPUT
-    gboolean           is_libinput = FALSE;
-#endif /* HAVE_LIBINPUT */
 #if defined(DEVICE_PROPERTIES) || defined (HAVE_LIBINPUT)
 #ifdef HAVE_LIBINPUT
     Atom               libinput_tap_prop;
@@ -1188,76 +1598,55 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
     Atom               synaptics_circ_scroll_prop;
     Atom               device_enabled_prop;
     Atom               wacom_rotation_prop;
-    gint               is_enabled = -1;
-    gint               synaptics_tap_to_click = -1;
-    gint               synaptics_edge_scroll = -1;
-    gint               synaptics_edge_hscroll = -1;
-    gint               synaptics_two_scroll = -1;
-    gint               synaptics_two_hscroll = -1;
-    gint               synaptics_circ_scroll = -1;
-    gint               synaptics_scroll_mode = 0;
-    GtkTreeIter        iter;
-    gint               wacom_rotation = -1;
     Atom              *props;
     gint               nprops;
-    gint               wacom_mode = -1;
 #endif /* DEVICE_PROPERTIES || HAVE_LIBINPUT */
 
-    /* lock the dialog */
-    locked++;
-
-    /* get the selected item */
-    if (mouse_settings_device_get_selected (builder, &device, NULL))
+    state = g_slice_new0 (MouseDeviceState);
+    state->nbuttons = mdevice->nbuttons;
+    state->acceleration = -1.00;
+    state->threshold = -1;
+    state->is_enabled = -1;
+    state->synaptics_tap_to_click = -1;
+    state->synaptics_edge_scroll = -1;
+    state->synaptics_edge_hscroll = -1;
+    state->synaptics_two_scroll = -1;
+    state->synaptics_two_hscroll = -1;
+    state->synaptics_circ_scroll = -1;
+    state->wacom_rotation = -1;
+    state->wacom_mode = mdevice->wacom_mode;
+
+    /* open the device */
+    gdk_error_trap_push ();
+    device = XOpenDevice (xdisplay, mdevice->xid);
+    if (gdk_error_trap_pop () != 0 || device == NULL)
     {
-        gdk_error_trap_push ();
-        device_info = XListInputDevices (xdisplay, &ndevices);
-        if (gdk_error_trap_pop () == 0 && device_info != NULL)
-        {
-            /* find mode and number of buttons */
-            for (i = 0; i < ndevices; i++)
-            {
-                if (device_info[i].id != device->device_id)
-                    continue;
-
-                any = device_info[i].inputclassinfo;
-                for (n = 0; n < device_info[i].num_classes; n++)
-                {
-                    if (any->class == ButtonClass)
-                        nbuttons = ((XButtonInfoPtr) any)->num_buttons;
-#ifdef DEVICE_PROPERTIES
-                    else if (any->class == ValuatorClass)
-                        wacom_mode = ((XValuatorInfoPtr) any)->mode == Absolute ? 0 : 1;
-#endif
-
-                    any = (XAnyClassPtr) ((gchar *) any + any->length);
-                }
-
-                break;
-            }
+        g_critical ("Unable to open device %ld", mdevice->xid);
+        return state;
+    }
 
-            XFreeDeviceList (device_info);
-        }
+    {
 #ifdef HAVE_LIBINPUT
-        is_libinput = mouse_settings_get_libinput_boolean (xdisplay, device, LIBINPUT_PROP_LEFT_HANDED, &left_handed);
-        mouse_settings_get_libinput_boolean (xdisplay, device, LIBINPUT_PROP_NATURAL_SCROLL, &reverse_scrolling);
-        if (!is_libinput)
+        state->is_libinput = mouse_settings_get_libinput_boolean (xdisplay, device, LIBINPUT_PROP_LEFT_HANDED, &state->left_handed);
+        mouse_settings_get_libinput_boolean (xdisplay, device, LIBINPUT_PROP_NATURAL_SCROLL, &state->reverse_scrolling);
+        if (!state->is_libinput)
 #endif /* HAVE_LIBINPUT */
         {
             /* get the button mapping */
-            if (nbuttons > 0)
+            if (state->nbuttons > 0)
             {
-                buttonmap = g_new0 (guchar, nbuttons);
+                buttonmap = g_new0 (guchar, state->nbuttons);
                 gdk_error_trap_push ();
-                XGetDeviceButtonMapping (xdisplay, device, buttonmap, nbuttons);
+                XGetDeviceButtonMapping (xdisplay, device, buttonmap, state->nbuttons);
                 if (gdk_error_trap_pop () != 0)
                     g_critical ("Failed to get button map");
 
                 /* figure out the position of the first and second/third button in the map */
-                for (i = 0; i < nbuttons; i++)
+                for (i = 0; i < state->nbuttons; i++)
                 {
                     if (buttonmap[i] == 1)
                         id_1 = i;
-                    else if (buttonmap[i] == (nbuttons < 3 ? 2 : 3))
+                    else if (buttonmap[i] == (state->nbuttons < 3 ? 2 : 3))
                         id_3 = i;
                     else if (buttonmap[i] == 4)
                         id_4 = i;
@@ -1265,8 +1654,8 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
                         id_5 = i;
                 }
                 g_free (buttonmap);
-                left_handed = (id_1 > id_3);
-                reverse_scrolling = !!(id_5 < id_4);
+                state->left_handed = (id_1 > id_3);
+                state->reverse_scrolling = !!(id_5 < id_4);
             }
             else
             {
@@ -1274,7 +1663,7 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
             }
         }
 #ifdef HAVE_LIBINPUT
-        if (!mouse_settings_get_libinput_accel (xdisplay, device, &acceleration))
+        if (!mouse_settings_get_libinput_accel (xdisplay, device, &state->acceleration))
 #endif /* HAVE_LIBINPUT */
         {
             /* get the feedback states for this device */
@@ -1292,9 +1681,9 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
                     if (pt->class == PtrFeedbackClass)
                     {
                         /* get the state */
-                        state = (XPtrFeedbackState *) pt;
-                        acceleration = (gdouble) state->accelNum / (gdouble) state->accelDenom;
-                        threshold = state->threshold;
+                        ptr_state = (XPtrFeedbackState *) pt;
+                        state->acceleration = (gdouble) ptr_state->accelNum / (gdouble) ptr_state->accelDenom;
+                        state->threshold = ptr_state->threshold;
                     }
 
                     /* advance the offset */
@@ -1328,26 +1717,26 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
             for (i = 0; i < nprops; i++)
             {
                 if (props[i] == device_enabled_prop)
-                    is_enabled = mouse_settings_device_get_int_property (device, props[i], 0, NULL);
+                    state->is_enabled = mouse_settings_device_get_int_property (device, props[i], 0, NULL);
                 else if (props[i] == synaptics_prop)
-                    is_synaptics = TRUE;
+                    state->is_synaptics = TRUE;
                 else if (props[i] == wacom_prop)
-                    is_wacom = TRUE;
+                    state->is_wacom = TRUE;
                 else if (props[i] == synaptics_tap_prop)
-                    synaptics_tap_to_click = mouse_settings_device_get_int_property (device, props[i], 4, NULL);
+                    state->synaptics_tap_to_click = mouse_settings_device_get_int_property (device, props[i], 4, NULL);
                 else if (props[i] == synaptics_edge_scroll_prop)
-                    synaptics_edge_scroll = mouse_settings_device_get_int_property (device, props[i], 0, &synaptics_edge_hscroll);
+                    state->synaptics_edge_scroll = mouse_settings_device_get_int_property (device, props[i], 0, &state->synaptics_edge_hscroll);
                 else if (props[i] == synaptics_two_scroll_prop)
-                    synaptics_two_scroll = mouse_settings_device_get_int_property (device, props[i], 0, &synaptics_two_hscroll);
+                    state->synaptics_two_scroll = mouse_settings_device_get_int_property (device, props[i], 0, &state->synaptics_two_hscroll);
                 else if (props[i] == synaptics_circ_scroll_prop)
-                    synaptics_circ_scroll = mouse_settings_device_get_int_property (device, props[i], 0, NULL);
+                    state->synaptics_circ_scroll = mouse_settings_device_get_int_property (device, props[i], 0, NULL);
                 else if (props[i] == wacom_rotation_prop)
-                    wacom_rotation = mouse_settings_device_get_int_property (device, props[i], 0, NULL);
+                    state->wacom_rotation = mouse_settings_device_get_int_property (device, props[i], 0, NULL);
 #ifdef HAVE_LIBINPUT
                 else if (props[i] == libinput_tap_prop)
                 {
-                    is_synaptics = TRUE;
-                    mouse_settings_get_libinput_boolean (xdisplay, device, LIBINPUT_PROP_TAP, &synaptics_tap_to_click);
+                    state->is_synaptics = TRUE;
+                    mouse_settings_get_libinput_boolean (xdisplay, device, LIBINPUT_PROP_TAP, &state->synaptics_tap_to_click);
                 }
                 else if (props[i] == libinput_scroll_methods_prop)
                 {
@@ -1360,9 +1749,9 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
                                                               XA_INTEGER, 3, &pdata[0]);
                     if (success)
                     {
-                        synaptics_two_scroll = (gint) pdata[0].c;
-                        synaptics_edge_scroll = (gint) pdata[1].c;
-                        synaptics_circ_scroll = -1; /* libinput does not expose this method */
+                        state->synaptics_two_scroll = (gint) pdata[0].c;
+                        state->synaptics_edge_scroll = (gint) pdata[1].c;
+                        state->synaptics_circ_scroll = -1; /* libinput does not expose this method */
                     }
 
                     success = mouse_settings_get_device_prop (xdisplay,
@@ -1372,9 +1761,9 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
                     if (success)
                     {
                         if (!pdata[0].c)
-                            synaptics_two_scroll = -1;
+                            state->synaptics_two_scroll = -1;
                         if (!pdata[1].c)
-                            synaptics_edge_scroll = -1;
+                            state->synaptics_edge_scroll = -1;
                     }
                 }
 #endif /* HAVE_LIBINPUT */
@@ -1388,6 +1777,108 @@ mouse_settings_device_selection_changed (GtkBuilder *builder)
         XCloseDevice (xdisplay, device);
     }
 
+    return state;
+}
+
+
+
+static MouseDevice *
+mouse_settings_device_lookup_selected (GtkBuilder *builder)
+{
+    GObject      *combobox;
+    GtkTreeIter   iter;
+    gulong        xid;
+
+    combobox = gtk_builder_get_object (builder, "device-combobox");
+    if (!gtk_combo_box_get_active_iter (GTK_COMBO_BOX (combobox), &iter))
+        return NULL;
+
+    gtk_tree_model_get (gtk_combo_box_get_model (GTK_COMBO_BOX (combobox)), &iter,
+                        COLUMN_DEVICE_XID, &xid, -1);
+
+    return g_hash_table_lookup (devices, GUINT_TO_POINTER (xid));
+}
+
+
+
+static void
+mouse_settings_device_selection_changed (GtkBuilder *builder)
+{
+    MouseDevice       *mdevice;
+    MouseDeviceState   empty_state = { 0, };
+    MouseDeviceState  *state = &empty_state;
+    gint               nbuttons;
+    gdouble            acceleration;
+    gint               threshold;
+    GObject           *object;
+    gboolean           is_synaptics;
+    gboolean           is_wacom;
+    gboolean           left_handed;
+    gboolean           reverse_scrolling;
+#ifdef HAVE_LIBINPUT
+    gboolean           is_libinput;
+#endif /* HAVE_LIBINPUT */
+#if defined(DEVICE_PROPERTIES) || defined (HAVE_LIBINPUT)
+    gint               is_enabled;
+    gint               synaptics_tap_to_click;
+    gint               synaptics_edge_scroll;
+    gint               synaptics_edge_hscroll;
+    gint               synaptics_two_scroll;
+    gint               synaptics_two_hscroll;
+    gint               synaptics_circ_scroll;
+    gint               synaptics_scroll_mode = 0;
+    GtkTreeIter        iter;
+    gint               wacom_rotation;
+    gint               wacom_mode;
+#endif /* DEVICE_PROPERTIES || HAVE_LIBINPUT */
+
+    /* lock the dialog */
+    locked++;
+
+    /* values shown when there is no device */
+    empty_state.acceleration = -1.00;
+    empty_state.threshold = -1;
+    empty_state.is_enabled = -1;
+    empty_state.synaptics_tap_to_click = -1;
+    empty_state.synaptics_edge_scroll = -1;
+    empty_state.synaptics_edge_hscroll = -1;
+    empty_state.synaptics_two_scroll = -1;
+    empty_state.synaptics_two_hscroll = -1;
+    empty_state.synaptics_circ_scroll = -1;
+    empty_state.wacom_rotation = -1;
+    empty_state.wacom_mode = -1;
+
+    /* get the selected item, only query the device if its snapshot is stale */
+    mdevice = mouse_settings_device_lookup_selected (builder);
+    if (mdevice != NULL)
+    {
+        if (mdevice->state == NULL)
+            mdevice->state = mouse_settings_device_query (mdevice);
+        state = mdevice->state;
+    }
+
+    nbuttons = state->nbuttons;
+    left_handed = state->left_handed;
+    reverse_scrolling = state->reverse_scrolling;
+    acceleration = state->acceleration;
+    threshold = state->threshold;
+    is_synaptics = state->is_synaptics;
+    is_wacom = state->is_wacom;
+#ifdef HAVE_LIBINPUT
+    is_libinput = state->is_libinput;
+#endif /* HAVE_LIBINPUT */
+#if defined(DEVICE_PROPERTIES) || defined (HAVE_LIBINPUT)
+    is_enabled = state->is_enabled;
+    synaptics_tap_to_click = state->synaptics_tap_to_click;
+    synaptics_edge_scroll = state->synaptics_edge_scroll;
+    synaptics_edge_hscroll = state->synaptics_edge_hscroll;
+    synaptics_two_scroll = state->synaptics_two_scroll;
+    synaptics_two_hscroll = state->synaptics_two_hscroll;
+    synaptics_circ_scroll = state->synaptics_circ_scroll;
+    wacom_rotation = state->wacom_rotation;
+    wacom_mode = state->wacom_mode;
+#endif /* DEVICE_PROPERTIES || HAVE_LIBINPUT */
+
     /* update button order */
     object = gtk_builder_get_object (builder, left_handed ? "device-left-handed" : "device-right-handed");
     gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (object), TRUE);
@@ -1605,17 +2096,216 @@ mouse_settings_device_xfconf_name (const gchar *name)
 
 
 static void
-mouse_settings_device_populate_store (GtkBuilder *builder,
-                                      gboolean    create_store)
+mouse_settings_device_free (gpointer data)
+{
+    MouseDevice *mdevice = data;
+
+    if (mdevice->state != NULL)
+        g_slice_free (MouseDeviceState, mdevice->state);
+
+    g_free (mdevice->xfconf_name);
+    g_slice_free (MouseDevice, mdevice);
+}
+
+
+
+static void
+mouse_settings_device_invalidate (MouseDevice *mdevice)
+{
+    if (mdevice->state != NULL)
+    {
+        g_slice_free (MouseDeviceState, mdevice->state);
+        mdevice->state = NULL;
+    }
+}
+
+
+
+static gboolean
+mouse_settings_device_info_is_pointer (XDeviceInfo *device_info)
+{
+    /* filter out the pointer and virtual devices, and we
+     * cannot go any further without device name */
+    return device_info->use == IsXExtensionPointer
+           && device_info->name != NULL
+           && !g_str_has_prefix (device_info->name, "Virtual core XTEST");
+}
+
+
+
+static void
+mouse_settings_device_info_update (MouseDevice *mdevice,
+                                   XDeviceInfo *device_info)
+{
+    XAnyClassPtr any;
+    gint         n;
+
+    mdevice->nbuttons = 0;
+    mdevice->wacom_mode = -1;
+
+    /* find mode and number of buttons */
+    any = device_info->inputclassinfo;
+    for (n = 0; n < device_info->num_classes; n++)
+    {
+        if (any->class == ButtonClass)
+            mdevice->nbuttons = ((XButtonInfoPtr) any)->num_buttons;
+#ifdef DEVICE_PROPERTIES
+        else if (any->class == ValuatorClass)
+            mdevice->wacom_mode = ((XValuatorInfoPtr) any)->mode == Absolute ? 0 : 1;
+#endif
+
+        any = (XAnyClassPtr) ((gchar *) any + any->length);
+    }
+}
+
+
+
+static MouseDevice *
+mouse_settings_device_add (GtkListStore *store,
+                           XDeviceInfo  *device_info)
+{
+    MouseDevice *mdevice;
+
+    mdevice = g_hash_table_lookup (devices, GUINT_TO_POINTER (device_info->id));
+    if (mdevice == NULL)
+    {
+        mdevice = g_slice_new0 (MouseDevice);
+        mdevice->xid = device_info->id;
+        gtk_list_store_append (store, &mdevice->iter);
+        g_hash_table_insert (devices, GUINT_TO_POINTER (mdevice->xid), mdevice);
+    }
+    else
+    {
+        /* the xid was reused, drop the old snapshot */
+        mouse_settings_device_invalidate (mdevice);
+        g_free (mdevice->xfconf_name);
+    }
+
+    /* create a valid xfconf device name */
+    mdevice->xfconf_name = mouse_settings_device_xfconf_name (device_info->name);
+    mouse_settings_device_info_update (mdevice, device_info);
+
+    gtk_list_store_set (store, &mdevice->iter,
+                        COLUMN_DEVICE_XFCONF_NAME, mdevice->xfconf_name,
+                        COLUMN_DEVICE_NAME, device_info->name,
+                        COLUMN_DEVICE_XID, device_info->id,
+                        -1);
+
+    return mdevice;
+}
+
+
+
+static void
+mouse_settings_device_remove (GtkListStore *store,
+                              XID           xid)
+{
+    MouseDevice *mdevice;
+
+    mdevice = g_hash_table_lookup (devices, GUINT_TO_POINTER (xid));
+    if (mdevice != NULL)
+    {
+        gtk_list_store_remove (store, &mdevice->iter);
+        g_hash_table_remove (devices, GUINT_TO_POINTER (xid));
+    }
+}
+
+
+
+static gboolean
+mouse_settings_device_refresh (gpointer user_data)
+{
+    GHashTableIter  iter;
+    gpointer        value;
+    MouseDevice    *mdevice;
+    gboolean        stale = FALSE;
+
+    GDK_THREADS_ENTER ();
+
+    /* query one stale device per iteration, so switching
+     * devices in the combobox does not hit the server */
+    g_hash_table_iter_init (&iter, devices);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+        mdevice = value;
+        if (mdevice->state == NULL)
+        {
+            mdevice->state = mouse_settings_device_query (mdevice);
+            stale = TRUE;
+            break;
+        }
+    }
+
+    GDK_THREADS_LEAVE ();
+
+    return stale;
+}
+
+
+
+static void
+mouse_settings_device_refresh_destroyed (gpointer user_data)
+{
+    device_refresh_id = 0;
+}
+
+
+
+static void
+mouse_settings_device_queue_refresh (void)
+{
+    if (device_refresh_id == 0)
+    {
+        device_refresh_id = g_idle_add_full (G_PRIORITY_LOW, mouse_settings_device_refresh,
+                                             NULL, mouse_settings_device_refresh_destroyed);
+    }
+}
+
+
+
+static void
+mouse_settings_device_property_changed (XfconfChannel *channel,
+                                        const gchar   *property,
+                                        const GValue  *value,
+                                        gpointer       user_data)
+{
+    GHashTableIter  iter;
+    gpointer        data;
+    MouseDevice    *mdevice;
+    const gchar    *name, *end;
+
+    /* device properties look like /<xfconf name>/<property> */
+    if (property[0] != '/')
+        return;
+
+    name = property + 1;
+    end = strchr (name, '/');
+    if (end == NULL)
+        return;
+
+    /* the daemon applies the change, so the snapshot is outdated */
+    g_hash_table_iter_init (&iter, devices);
+    while (g_hash_table_iter_next (&iter, NULL, &data))
+    {
+        mdevice = data;
+        if (strncmp (mdevice->xfconf_name, name, end - name) == 0
+            && mdevice->xfconf_name[end - name] == '\0')
+            mouse_settings_device_invalidate (mdevice);
+    }
+}
+
+
+
+static void
+mouse_settings_device_populate_store (GtkBuilder *builder)
 {
     XDeviceInfo     *device_list, *device_info;
     gint             ndevices;
     gint             i;
-    GtkTreeIter      iter;
     GtkListStore    *store;
     GObject         *combobox;
     GtkCellRenderer *renderer;
-    gchar           *xfconf_name;
+    MouseDevice     *mdevice;
     gboolean         has_active_item = FALSE;
 
     /* lock */
@@ -1623,29 +2313,25 @@ mouse_settings_device_populate_store (GtkBuilder *builder,
 
     combobox = gtk_builder_get_object (builder, "device-combobox");
 
-    /* create or get the store */
-    if (G_LIKELY (create_store))
-    {
-        store = gtk_list_store_new (N_DEVICE_COLUMNS,
-                                    G_TYPE_STRING /* COLUMN_DEVICE_NAME */,
-                                    G_TYPE_STRING /* COLUMN_DEVICE_XFCONF_NAME */,
-                                    G_TYPE_ULONG /* COLUMN_DEVICE_XID */);
-        gtk_combo_box_set_model (GTK_COMBO_BOX (combobox), GTK_TREE_MODEL (store));
-
-        /* text renderer */
-        renderer = gtk_cell_renderer_text_new ();
-        gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (combobox), renderer, TRUE);
-        gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (combobox), renderer,
-                                        "text", COLUMN_DEVICE_NAME, NULL);
-
-        g_signal_connect_swapped (G_OBJECT (combobox), "changed",
-            G_CALLBACK (mouse_settings_device_selection_changed), builder);
-    }
-    else
-    {
-        store = GTK_LIST_STORE (gtk_combo_box_get_model (GTK_COMBO_BOX (combobox)));
-        gtk_list_store_clear (store);
-    }
+    /* create the store */
+    store = gtk_list_store_new (N_DEVICE_COLUMNS,
+                                G_TYPE_STRING /* COLUMN_DEVICE_NAME */,
+                                G_TYPE_STRING /* COLUMN_DEVICE_XFCONF_NAME */,
+                                G_TYPE_ULONG /* COLUMN_DEVICE_XID */);
+    gtk_combo_box_set_model (GTK_COMBO_BOX (combobox), GTK_TREE_MODEL (store));
+
+    /* text renderer */
+    renderer = gtk_cell_renderer_text_new ();
+    gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (combobox), renderer, TRUE);
+    gtk_cell_layout_set_attributes (GTK_CELL_LAYOUT (combobox), renderer,
+                                    "text", COLUMN_DEVICE_NAME, NULL);
+
+    g_signal_connect_swapped (G_OBJECT (combobox), "changed",
+        G_CALLBACK (mouse_settings_device_selection_changed), builder);
+
+    /* devices are updated one by one afterwards */
+    devices = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                     NULL, mouse_settings_device_free);
 
     /* get all the registered devices */
     gdk_error_trap_push ();
@@ -1660,38 +2346,21 @@ mouse_settings_device_populate_store (GtkBuilder *builder,
     {
         /* get the device */
         device_info = &device_list[i];
-
-        /* filter out the pointer and virtual devices */
-        if (device_info->use != IsXExtensionPointer
-            || g_str_has_prefix (device_info->name, "Virtual core XTEST"))
+        if (!mouse_settings_device_info_is_pointer (device_info))
             continue;
 
-        /* cannot go any further without device name */
-        if (device_info->name == NULL)
-            continue;
-
-        /* create a valid xfconf device name */
-        xfconf_name = mouse_settings_device_xfconf_name (device_info->name);
-
         /* insert in the store */
-        gtk_list_store_insert_with_values (store, &iter, i,
-                                           COLUMN_DEVICE_XFCONF_NAME, xfconf_name,
-                                           COLUMN_DEVICE_NAME, device_info->name,
-                                           COLUMN_DEVICE_XID, device_info->id,
-                                           -1);
+        mdevice = mouse_settings_device_add (store, device_info);
 
         /* check if we should select this device */
         if (opt_device_name != NULL
             && strcmp (opt_device_name, device_info->name) == 0)
         {
-            gtk_combo_box_set_active_iter (GTK_COMBO_BOX (combobox), &iter);
+            gtk_combo_box_set_active_iter (GTK_COMBO_BOX (combobox), &mdevice->iter);
             g_free (opt_device_name);
             opt_device_name = NULL;
             has_active_item = TRUE;
         }
-
-        g_free (xfconf_name);
-
     }
 
     XFreeDeviceList (device_list);
@@ -1699,8 +2368,13 @@ mouse_settings_device_populate_store (GtkBuilder *builder,
     if (!has_active_item)
         gtk_combo_box_set_active (GTK_COMBO_BOX (combobox), 0);
 
+    /* snapshot the other devices when idle */
+    mouse_settings_device_queue_refresh ();
+
     bailout:
 
+    g_object_unref (G_OBJECT (store));
+
     /* unlock */
     locked--;
 }
@@ -1710,12 +2384,16 @@ mouse_settings_device_populate_store (GtkBuilder *builder,
 static gboolean
 mouse_settings_device_update_sliders (gpointer user_data)
 {
-    GtkBuilder *builder = GTK_BUILDER (user_data);
-    GObject    *button;
+    GtkBuilder  *builder = GTK_BUILDER (user_data);
+    GObject     *button;
+    MouseDevice *mdevice;
 
     GDK_THREADS_ENTER ();
 
-    /* update */
+    /* query the device again and update */
+    mdevice = mouse_settings_device_lookup_selected (builder);
+    if (mdevice != NULL)
+        mouse_settings_device_invalidate (mdevice);
     mouse_settings_device_selection_changed (builder);
 
     /* make the button sensitive again */
@@ -1787,6 +2465,94 @@ mouse_settings_device_reset (GtkWidget  *button,
 
 
 #ifdef DEVICE_HOTPLUGGING
+static gboolean
+mouse_settings_device_changes_apply (gpointer user_data)
+{
+    GtkBuilder     *builder = GTK_BUILDER (user_data);
+    GObject        *combobox;
+    GtkListStore   *store;
+    GHashTableIter  iter;
+    gpointer        key, value;
+    MouseDevice    *mdevice;
+    XID             active_xid = None;
+    gboolean        has_added = FALSE;
+    XDeviceInfo    *device_list, *device_info;
+    gint            ndevices;
+    gint            i;
+
+    GDK_THREADS_ENTER ();
+
+    /* lock */
+    locked++;
+
+    combobox = gtk_builder_get_object (builder, "device-combobox");
+    store = GTK_LIST_STORE (gtk_combo_box_get_model (GTK_COMBO_BOX (combobox)));
+
+    mdevice = mouse_settings_device_lookup_selected (builder);
+    if (mdevice != NULL)
+        active_xid = mdevice->xid;
+
+    /* remove the unplugged devices */
+    g_hash_table_iter_init (&iter, device_changes);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        if (GPOINTER_TO_INT (value) == DeviceRemoved)
+            mouse_settings_device_remove (store, GPOINTER_TO_UINT (key));
+        else
+            has_added = TRUE;
+    }
+
+    /* add the new devices, the other rows are left untouched */
+    if (has_added)
+    {
+        gdk_error_trap_push ();
+        device_list = XListInputDevices (GDK_DISPLAY (), &ndevices);
+        if (gdk_error_trap_pop () == 0 && device_list != NULL)
+        {
+            for (i = 0; i < ndevices; i++)
+            {
+                device_info = &device_list[i];
+                if (g_hash_table_lookup_extended (device_changes, GUINT_TO_POINTER (device_info->id),
+                                                  NULL, &value)
+                    && GPOINTER_TO_INT (value) == DeviceAdded
+                    && mouse_settings_device_info_is_pointer (device_info))
+                    mouse_settings_device_add (store, device_info);
+            }
+
+            XFreeDeviceList (device_list);
+        }
+    }
+
+    g_hash_table_remove_all (device_changes);
+
+    /* unlock */
+    locked--;
+
+    /* keep the active device, or select the first one if it was removed */
+    mdevice = active_xid != None ? g_hash_table_lookup (devices, GUINT_TO_POINTER (active_xid)) : NULL;
+    if (mdevice == NULL)
+        gtk_combo_box_set_active (GTK_COMBO_BOX (combobox), 0);
+    else if (mdevice->state == NULL)
+        mouse_settings_device_selection_changed (builder);
+
+    /* snapshot the added devices when idle */
+    mouse_settings_device_queue_refresh ();
+
+    GDK_THREADS_LEAVE ();
+
+    return FALSE;
+}
+
+
+
+static void
+mouse_settings_device_changes_destroyed (gpointer user_data)
+{
+    device_changes_id = 0;
+}
+
+
+
 static GdkFilterReturn
 mouse_settings_event_filter (GdkXEvent *xevent,
                              GdkEvent  *gdk_event,
@@ -1795,11 +2561,22 @@ mouse_settings_event_filter (GdkXEvent *xevent,
     XEvent                     *event = xevent;
     XDevicePresenceNotifyEvent *dpn_event = xevent;
 
-    /* update on device changes */
+    /* collect device changes, a device plugged in usually
+     * shows up as several devices at once */
     if (event->type == device_presence_event_type
         && (dpn_event->devchange == DeviceAdded
             || dpn_event->devchange == DeviceRemoved))
-        mouse_settings_device_populate_store (GTK_BUILDER (user_data), FALSE);
+    {
+        g_hash_table_insert (device_changes, GUINT_TO_POINTER (dpn_event->deviceid),
+                             GINT_TO_POINTER (dpn_event->devchange));
+
+        if (device_changes_id == 0)
+        {
+            device_changes_id = g_timeout_add_full (G_PRIORITY_DEFAULT, DEVICE_CHANGES_DELAY,
+                                                    mouse_settings_device_changes_apply, user_data,
+                                                    mouse_settings_device_changes_destroyed);
+        }
+    }
 
     return GDK_FILTER_CONTINUE;
 }
@@ -1822,6 +2599,8 @@ mouse_settings_create_event_filter (GtkBuilder *builder)
         return;
     }
 
+    device_changes = g_hash_table_new (g_direct_hash, g_direct_equal);
+
     /* add an event filter */
     gdk_window_add_filter (NULL, mouse_settings_event_filter, builder);
 }
@@ -1829,6 +2608,41 @@ mouse_settings_create_event_filter (GtkBuilder *builder)
 
 
 
+#if defined (DEVICE_PROPERTIES) || defined (HAVE_LIBINPUT)
+static gboolean
+mouse_settings_typing_detection_available (Display *xdisplay)
+{
+    gchar  *syndaemon;
+#ifdef HAVE_XI2
+    gint    opcode, event, error;
+    gint    major = 2, minor = 1;
+    Status  status;
+
+    /* xfsettingsd listens for raw key events itself since xi 2.1 */
+    if (XQueryExtension (xdisplay, INAME, &opcode, &event, &error))
+    {
+        gdk_error_trap_push ();
+        status = XIQueryVersion (xdisplay, &major, &minor);
+        if (gdk_error_trap_pop () == 0
+            && status == Success
+            && (major > 2 || minor >= 1))
+            return TRUE;
+    }
+#endif
+
+    /* otherwise xfsettingsd spawns syndaemon */
+    syndaemon = g_find_program_in_path ("syndaemon");
+    if (syndaemon == NULL)
+        return FALSE;
+
+    g_free (syndaemon);
+
+    return TRUE;
+}
+#endif
+
+
+
 static void
 mouse_settings_dialog_response (GtkWidget *dialog,
                                 gint       response_id)
@@ -1853,11 +2667,16 @@ main (gint argc, gchar **argv)
     GObject           *object;
     XExtensionVersion *version = NULL;
 #ifdef DEVICE_PROPERTIES
-    gchar             *syndaemon;
     GObject           *synaptics_disable_while_type;
     GObject           *synaptics_disable_duration_table;
 #endif
 
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+    /* the cursor previews are decoded in worker threads */
+    if (!g_thread_supported ())
+        g_thread_init (NULL);
+#endif
+
     /* setup translation domain */
     xfce_textdomain (GETTEXT_PACKAGE, LOCALEDIR, "UTF-8");
 
@@ -1941,7 +2760,11 @@ main (gint argc, gchar **argv)
             locked++;
 
             /* populate the devices combobox */
-            mouse_settings_device_populate_store (builder, TRUE);
+            mouse_settings_device_populate_store (builder);
+
+            /* outdate the device snapshots on changes */
+            g_signal_connect (G_OBJECT (pointers_channel), "property-changed",
+                              G_CALLBACK (mouse_settings_device_property_changed), NULL);
 
             /* connect signals */
 #ifdef DEVICE_PROPERTIES
@@ -1978,9 +2801,8 @@ main (gint argc, gchar **argv)
 
 #if defined (DEVICE_PROPERTIES) || defined (HAVE_LIBINPUT)
             synaptics_disable_while_type = gtk_builder_get_object (builder, "synaptics-disable-while-type");
-            syndaemon = g_find_program_in_path ("syndaemon");
-            gtk_widget_set_sensitive (GTK_WIDGET (object), syndaemon != NULL);
-            g_free (syndaemon);
+            gtk_widget_set_sensitive (GTK_WIDGET (synaptics_disable_while_type),
+                                      mouse_settings_typing_detection_available (GDK_DISPLAY ()));
             xfconf_g_property_bind (pointers_channel, "/DisableTouchpadWhileTyping",
                                     G_TYPE_BOOLEAN, G_OBJECT (synaptics_disable_while_type), "active");
 
@@ -2113,6 +2935,24 @@ main (gint argc, gchar **argv)
             g_error_free (error);
         }
 
+#ifdef HAVE_XCURSOR
+        /* drop the queued previews and wait for the running ones */
+        if (theme_pool != NULL)
+            g_thread_pool_free (theme_pool, TRUE, TRUE);
+#endif
+
+        /* stop the device updates */
+        if (device_refresh_id != 0)
+            g_source_remove (device_refresh_id);
+#ifdef DEVICE_HOTPLUGGING
+        if (device_changes_id != 0)
+            g_source_remove (device_changes_id);
+        if (device_changes != NULL)
+            g_hash_table_destroy (device_changes);
+#endif
+        if (devices != NULL)
+            g_hash_table_destroy (devices);
+
         /* release the Gtk+ user-interface file */
         g_object_unref (G_OBJECT (builder));
 
@@ -0,0 +1,550 @@
+/*
+ *  xfce4-settings-editor
+ *
+ *  Copyright (c) 2026 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib-object.h>
+
+#include <libxfce4util/libxfce4util.h>
+#include <xfconf/xfconf.h>
+
+#include "xfce-settings-channel-model.h"
+#include "xfce-settings-marshal.h"
+
+
+
+struct _XfceSettingsChannelModelClass
+{
+    GObjectClass __parent__;
+};
+
+struct _XfceSettingsChannelModel
+{
+    GObject __parent__;
+
+    XfconfChannel    *channel;
+
+    /* snapshot of the channel, by property path */
+    GHashTable       *nodes;
+    XfceSettingsNode *root;
+
+    /* properties with a kiosk lock, NULL if the channel is locked */
+    GHashTable       *locks;
+};
+
+enum
+{
+    PROPERTY_CHANGED,
+    LAST_SIGNAL
+};
+
+typedef struct
+{
+    GString    *path;
+    GArray     *lengths;
+    GHashTable *locks;
+    gboolean    channel_locked;
+}
+LocksParser;
+
+
+
+static void xfce_settings_channel_model_finalize         (GObject                  *object);
+static void xfce_settings_channel_model_property_changed (XfconfChannel            *channel,
+                                                          const gchar              *property,
+                                                          const GValue             *value,
+                                                          XfceSettingsChannelModel *model);
+
+
+
+G_DEFINE_TYPE (XfceSettingsChannelModel, xfce_settings_channel_model, G_TYPE_OBJECT)
+
+
+
+static guint       model_signals[LAST_SIGNAL];
+
+/* one model per channel name while it is used, updated
+ * incrementally, so all views and monitors share the snapshot */
+static GHashTable *channel_models = NULL;
+
+
+
+static void
+xfce_settings_channel_model_class_init (XfceSettingsChannelModelClass *klass)
+{
+    GObjectClass *gobject_class;
+
+    gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->finalize = xfce_settings_channel_model_finalize;
+
+    /* emitted after the snapshot was updated */
+    model_signals[PROPERTY_CHANGED] = g_signal_new (g_intern_static_string ("property-changed"),
+                                                    G_TYPE_FROM_CLASS (klass),
+                                                    G_SIGNAL_RUN_LAST,
+                                                    0, NULL, NULL,
+                                                    _xfce_settings_marshal_VOID__STRING_BOXED,
+                                                    G_TYPE_NONE, 2,
+                                                    G_TYPE_STRING | G_SIGNAL_TYPE_STATIC_SCOPE,
+                                                    G_TYPE_VALUE | G_SIGNAL_TYPE_STATIC_SCOPE);
+}
+
+
+
+static void
+xfce_settings_channel_model_node_free (gpointer data)
+{
+    XfceSettingsNode *node = data;
+
+    if (node->value != NULL)
+    {
+        g_value_unset (node->value);
+        g_free (node->value);
+    }
+
+    if (node->children != NULL)
+        g_hash_table_destroy (node->children);
+
+    g_free (node->path);
+    g_slice_free (XfceSettingsNode, node);
+}
+
+
+
+static void
+xfce_settings_channel_model_init (XfceSettingsChannelModel *model)
+{
+    model->nodes = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                          xfce_settings_channel_model_node_free);
+}
+
+
+
+static void
+xfce_settings_channel_model_finalize (GObject *object)
+{
+    XfceSettingsChannelModel *model = XFCE_SETTINGS_CHANNEL_MODEL (object);
+
+    if (model->channel != NULL)
+    {
+        g_signal_handlers_disconnect_by_func (G_OBJECT (model->channel),
+            G_CALLBACK (xfce_settings_channel_model_property_changed), model);
+        g_object_unref (G_OBJECT (model->channel));
+    }
+
+    g_hash_table_destroy (model->nodes);
+    if (model->locks != NULL)
+        g_hash_table_destroy (model->locks);
+
+    G_OBJECT_CLASS (xfce_settings_channel_model_parent_class)->finalize (object);
+}
+
+
+
+static const gchar *
+xfce_settings_channel_model_locks_attribute (const gchar  *name,
+                                             const gchar **attribute_names,
+                                             const gchar **attribute_values)
+{
+    guint i;
+
+    for (i = 0; attribute_names[i] != NULL; i++)
+        if (strcmp (attribute_names[i], name) == 0)
+            return attribute_values[i];
+
+    return NULL;
+}
+
+
+
+static void
+xfce_settings_channel_model_locks_start (GMarkupParseContext  *context,
+                                         const gchar          *element_name,
+                                         const gchar         **attribute_names,
+                                         const gchar         **attribute_values,
+                                         gpointer              user_data,
+                                         GError              **error)
+{
+    LocksParser *parser = user_data;
+    const gchar *name;
+    const gchar *locked;
+
+    locked = xfce_settings_channel_model_locks_attribute ("locked", attribute_names, attribute_values);
+
+    if (strcmp (element_name, "channel") == 0)
+    {
+        if (locked != NULL && *locked != '\0')
+            parser->channel_locked = TRUE;
+    }
+    else if (strcmp (element_name, "property") == 0)
+    {
+        g_array_append_val (parser->lengths, parser->path->len);
+
+        name = xfce_settings_channel_model_locks_attribute ("name", attribute_names, attribute_values);
+        g_string_append_c (parser->path, '/');
+        if (name != NULL)
+            g_string_append (parser->path, name);
+
+        if (locked != NULL && *locked != '\0')
+            g_hash_table_insert (parser->locks, g_strdup (parser->path->str), GINT_TO_POINTER (TRUE));
+    }
+}
+
+
+
+static void
+xfce_settings_channel_model_locks_end (GMarkupParseContext  *context,
+                                       const gchar          *element_name,
+                                       gpointer              user_data,
+                                       GError              **error)
+{
+    LocksParser *parser = user_data;
+
+    if (strcmp (element_name, "property") == 0
+        && parser->lengths->len > 0)
+    {
+        g_string_truncate (parser->path,
+            g_array_index (parser->lengths, gsize, parser->lengths->len - 1));
+        g_array_set_size (parser->lengths, parser->lengths->len - 1);
+    }
+}
+
+
+
+static const GMarkupParser locks_markup_parser =
+{
+    xfce_settings_channel_model_locks_start,
+    xfce_settings_channel_model_locks_end,
+    NULL,
+    NULL,
+    NULL
+};
+
+
+
+static GHashTable *
+xfce_settings_channel_model_load_locks (const gchar *channel_name)
+{
+    gchar               *filename;
+    gchar              **files;
+    gchar               *contents;
+    gsize                length;
+    guint                i;
+    GMarkupParseContext *context;
+    LocksParser          parser;
+
+    filename = g_strdup_printf ("xfce4" G_DIR_SEPARATOR_S "xfconf" G_DIR_SEPARATOR_S
+                                "xfce-perchannel-xml" G_DIR_SEPARATOR_S "%s.xml",
+                                channel_name);
+    files = xfce_resource_lookup_all (XFCE_RESOURCE_CONFIG, filename);
+    g_free (filename);
+
+    parser.path = g_string_new (NULL);
+    parser.lengths = g_array_new (FALSE, FALSE, sizeof (gsize));
+    parser.locks = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    parser.channel_locked = FALSE;
+
+    /* collect the properties that have a kiosk lock in one of the channel
+     * files, only those can be locked by xfconfd */
+    for (i = 0; files != NULL && files[i] != NULL && !parser.channel_locked; i++)
+    {
+        if (!g_file_get_contents (files[i], &contents, &length, NULL))
+            continue;
+
+        g_string_truncate (parser.path, 0);
+        g_array_set_size (parser.lengths, 0);
+
+        context = g_markup_parse_context_new (&locks_markup_parser, 0, &parser, NULL);
+        if (g_markup_parse_context_parse (context, contents, length, NULL))
+            g_markup_parse_context_end_parse (context, NULL);
+        g_markup_parse_context_free (context);
+
+        g_free (contents);
+    }
+
+    g_strfreev (files);
+    g_string_free (parser.path, TRUE);
+    g_array_free (parser.lengths, TRUE);
+
+    /* the whole channel is locked, ask xfconfd for every property */
+    if (parser.channel_locked)
+    {
+        g_hash_table_destroy (parser.locks);
+        return NULL;
+    }
+
+    return parser.locks;
+}
+
+
+
+static XfceSettingsNode *
+xfce_settings_channel_model_node_new (XfceSettingsChannelModel *model,
+                                      const gchar              *path,
+                                      XfceSettingsNode         *parent)
+{
+    XfceSettingsNode *node;
+
+    node = g_slice_new0 (XfceSettingsNode);
+    node->path = g_strdup (path);
+    node->name = parent != NULL ? strrchr (node->path, '/') + 1 : node->path;
+    node->parent = parent;
+
+    if (parent != NULL)
+    {
+        if (parent->children == NULL)
+            parent->children = g_hash_table_new (g_str_hash, g_str_equal);
+        g_hash_table_insert (parent->children, (gpointer) node->name, node);
+    }
+
+    g_hash_table_insert (model->nodes, node->path, node);
+
+    return node;
+}
+
+
+
+static XfceSettingsNode *
+xfce_settings_channel_model_node_get (XfceSettingsChannelModel *model,
+                                      const gchar              *property)
+{
+    XfceSettingsNode *node;
+    XfceSettingsNode *parent;
+    gchar            *parent_path;
+
+    node = g_hash_table_lookup (model->nodes, property);
+    if (node == NULL)
+    {
+        /* create the parent nodes, up to the root */
+        parent_path = g_strndup (property, strrchr (property, '/') - property);
+        parent = xfce_settings_channel_model_node_get (model, parent_path);
+        g_free (parent_path);
+
+        node = xfce_settings_channel_model_node_new (model, property, parent);
+    }
+
+    return node;
+}
+
+
+
+static void
+xfce_settings_channel_model_node_set_value (XfceSettingsNode *node,
+                                            const GValue     *value)
+{
+    if (node->value != NULL)
+    {
+        g_value_unset (node->value);
+    }
+    else
+    {
+        if (value == NULL)
+            return;
+        node->value = g_new0 (GValue, 1);
+    }
+
+    if (value != NULL)
+    {
+        g_value_init (node->value, G_VALUE_TYPE (value));
+        g_value_copy (value, node->value);
+    }
+    else
+    {
+        g_free (node->value);
+        node->value = NULL;
+    }
+}
+
+
+
+static void
+xfce_settings_channel_model_property_changed (XfconfChannel            *channel,
+                                              const gchar              *property,
+                                              const GValue             *value,
+                                              XfceSettingsChannelModel *model)
+{
+    XfceSettingsNode *node;
+    XfceSettingsNode *parent;
+
+    g_return_if_fail (XFCE_IS_SETTINGS_CHANNEL_MODEL (model));
+
+    if (G_UNLIKELY (property == NULL || *property != '/'))
+        return;
+
+    if (value != NULL && G_IS_VALUE (value))
+    {
+        node = xfce_settings_channel_model_node_get (model, property);
+        xfce_settings_channel_model_node_set_value (node, value);
+    }
+    else
+    {
+        node = g_hash_table_lookup (model->nodes, property);
+        if (node == NULL || node->value == NULL)
+            return;
+
+        xfce_settings_channel_model_node_set_value (node, NULL);
+
+        /* remove the node and the parents that are empty now */
+        while (node->parent != NULL
+               && node->value == NULL
+               && !XFCE_SETTINGS_NODE_HAS_CHILDREN (node))
+        {
+            parent = node->parent;
+            g_hash_table_remove (parent->children, node->name);
+            g_hash_table_remove (model->nodes, node->path);
+            node = parent;
+        }
+    }
+
+    g_signal_emit (G_OBJECT (model), model_signals[PROPERTY_CHANGED], 0, property, value);
+}
+
+
+
+static void
+xfce_settings_channel_model_load (XfceSettingsChannelModel *model,
+                                  const gchar              *channel_name)
+{
+    GHashTable       *props;
+    GHashTableIter    iter;
+    gpointer          key, value;
+    XfceSettingsNode *node;
+
+    model->channel = xfconf_channel_new (channel_name);
+    model->locks = xfce_settings_channel_model_load_locks (channel_name);
+    model->root = xfce_settings_channel_model_node_new (model, "", NULL);
+
+    props = xfconf_channel_get_properties (model->channel, NULL);
+    if (G_LIKELY (props != NULL))
+    {
+        g_hash_table_iter_init (&iter, props);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+            if (G_UNLIKELY (key == NULL || *((gchar *) key) != '/'))
+                continue;
+
+            node = xfce_settings_channel_model_node_get (model, key);
+            xfce_settings_channel_model_node_set_value (node, value);
+        }
+        g_hash_table_destroy (props);
+    }
+
+    /* single handler for all the views on this channel */
+    g_signal_connect (G_OBJECT (model->channel), "property-changed",
+        G_CALLBACK (xfce_settings_channel_model_property_changed), model);
+}
+
+
+
+static void
+xfce_settings_channel_model_weak_notify (gpointer  data,
+                                         GObject  *where_the_object_was)
+{
+    gchar *channel_name = data;
+
+    /* the last view released the model, the property-changed
+     * handler is disconnected when the model is finalized */
+    g_hash_table_remove (channel_models, channel_name);
+}
+
+
+
+/**
+ * xfce_settings_channel_model_get:
+ * @channel_name : name of the xfconf channel.
+ *
+ * Returns the shared model of @channel_name, the properties are
+ * loaded when the channel is requested while no other reference
+ * to its model exists.
+ *
+ * Return value: a new reference, release with g_object_unref().
+ **/
+XfceSettingsChannelModel *
+xfce_settings_channel_model_get (const gchar *channel_name)
+{
+    XfceSettingsChannelModel *model;
+    gchar                    *key;
+
+    g_return_val_if_fail (channel_name != NULL, NULL);
+
+    /* the table does not own the models */
+    if (channel_models == NULL)
+        channel_models = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+    model = g_hash_table_lookup (channel_models, channel_name);
+    if (model != NULL)
+        return g_object_ref (G_OBJECT (model));
+
+    model = g_object_new (XFCE_TYPE_SETTINGS_CHANNEL_MODEL, NULL);
+    xfce_settings_channel_model_load (model, channel_name);
+
+    key = g_strdup (channel_name);
+    g_hash_table_insert (channel_models, key, model);
+    g_object_weak_ref (G_OBJECT (model), xfce_settings_channel_model_weak_notify, key);
+
+    return model;
+}
+
+
+
+XfconfChannel *
+xfce_settings_channel_model_get_channel (XfceSettingsChannelModel *model)
+{
+    g_return_val_if_fail (XFCE_IS_SETTINGS_CHANNEL_MODEL (model), NULL);
+    return model->channel;
+}
+
+
+
+/**
+ * xfce_settings_channel_model_lookup:
+ * @model    : a #XfceSettingsChannelModel.
+ * @property : a property path, or an empty string for the root.
+ *
+ * Return value: the node of @property in the snapshot, owned by
+ *               @model, or %NULL if it does not exist.
+ **/
+XfceSettingsNode *
+xfce_settings_channel_model_lookup (XfceSettingsChannelModel *model,
+                                    const gchar              *property)
+{
+    g_return_val_if_fail (XFCE_IS_SETTINGS_CHANNEL_MODEL (model), NULL);
+    return g_hash_table_lookup (model->nodes, property);
+}
+
+
+
+gboolean
+xfce_settings_channel_model_is_locked (XfceSettingsChannelModel *model,
+                                       const gchar              *property)
+{
+    g_return_val_if_fail (XFCE_IS_SETTINGS_CHANNEL_MODEL (model), FALSE);
+
+    /* properties without a lock in the channel files are never locked */
+    if (model->locks != NULL
+        && !g_hash_table_lookup (model->locks, property))
+        return FALSE;
+
+    return xfconf_channel_is_property_locked (model->channel, property);
+}
@@ -0,0 +1,69 @@
+/*
+ *  xfce4-settings-editor
+ *
+ *  Copyright (c) 2026 The Xfce development team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License ONLY.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __XFCE_SETTINGS_CHANNEL_MODEL_H__
+#define __XFCE_SETTINGS_CHANNEL_MODEL_H__
+
+#include <glib-object.h>
+#include <xfconf/xfconf.h>
+
+#define XFCE_TYPE_SETTINGS_CHANNEL_MODEL            (xfce_settings_channel_model_get_type ())
+#define XFCE_SETTINGS_CHANNEL_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), XFCE_TYPE_SETTINGS_CHANNEL_MODEL, XfceSettingsChannelModel))
+#define XFCE_SETTINGS_CHANNEL_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), XFCE_TYPE_SETTINGS_CHANNEL_MODEL, XfceSettingsChannelModelClass))
+#define XFCE_IS_SETTINGS_CHANNEL_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), XFCE_TYPE_SETTINGS_CHANNEL_MODEL))
+#define XFCE_IS_SETTINGS_CHANNEL_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), XFCE_TYPE_SETTINGS_CHANNEL_MODEL))
+#define XFCE_SETTINGS_CHANNEL_MODEL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), XFCE_TYPE_SETTINGS_CHANNEL_MODEL, XfceSettingsChannelModelClass))
+
+G_BEGIN_DECLS
+
+typedef struct _XfceSettingsChannelModel      XfceSettingsChannelModel;
+typedef struct _XfceSettingsChannelModelClass XfceSettingsChannelModelClass;
+typedef struct _XfceSettingsNode              XfceSettingsNode;
+
+struct _XfceSettingsNode
+{
+    /* full property path, empty for the root node */
+    gchar            *path;
+    const gchar      *name;
+
+    XfceSettingsNode *parent;
+    GHashTable       *children;
+
+    /* NULL if the node is not a real property */
+    GValue           *value;
+};
+
+#define XFCE_SETTINGS_NODE_HAS_CHILDREN(node) \
+    ((node)->children != NULL && g_hash_table_size ((node)->children) > 0)
+
+GType                     xfce_settings_channel_model_get_type    (void) G_GNUC_CONST;
+
+XfceSettingsChannelModel *xfce_settings_channel_model_get         (const gchar              *channel_name);
+
+XfconfChannel            *xfce_settings_channel_model_get_channel (XfceSettingsChannelModel *model);
+
+XfceSettingsNode         *xfce_settings_channel_model_lookup      (XfceSettingsChannelModel *model,
+                                                                   const gchar              *property);
+
+gboolean                  xfce_settings_channel_model_is_locked   (XfceSettingsChannelModel *model,
+                                                                   const gchar              *property);
+
+G_END_DECLS
+
+#endif  /* __XFCE_SETTINGS_CHANNEL_MODEL_H__ */
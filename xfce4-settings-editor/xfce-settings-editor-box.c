@@ -39,6 +39,7 @@
 #include <libxfce4ui/libxfce4ui.h>
 #include <xfconf/xfconf.h>
 
+#include "xfce-settings-channel-model.h"
 #include "xfce-settings-editor-box.h"
 #include "xfce-settings-prop-dialog.h"
 #include "xfce-settings-cell-renderer.h"
@@ -54,20 +55,22 @@ struct _XfceSettingsEditorBox
 {
     GtkBox __parent__;
 
-    GtkWidget         *paned;
+    GtkWidget                *paned;
 
-    GtkListStore      *channels_store;
-    GtkWidget         *channels_treeview;
+    GtkListStore             *channels_store;
+    GtkWidget                *channels_treeview;
 
-    GtkTreeStore      *props_store;
-    XfconfChannel     *props_channel;
-    GtkWidget         *props_treeview;
+    GtkTreeStore             *props_store;
+    GHashTable               *props_index;
+    XfceSettingsChannelModel *props_model;
+    XfconfChannel            *props_channel;
+    GtkWidget                *props_treeview;
 
-    GtkWidget         *button_new;
-    GtkWidget         *button_edit;
-    GtkWidget         *button_reset;
+    GtkWidget                *button_new;
+    GtkWidget                *button_edit;
+    GtkWidget                *button_reset;
 
-    gint			   paned_pos;
+    gint                      paned_pos;
 };
 
 
@@ -133,6 +136,14 @@ static gboolean xfce_settings_editor_box_key_press_event      (GtkTreeView
 static void     xfce_settings_editor_box_property_new         (XfceSettingsEditorBox  *self);
 static void     xfce_settings_editor_box_property_edit        (XfceSettingsEditorBox  *self);
 static void     xfce_settings_editor_box_property_reset       (XfceSettingsEditorBox  *self);
+static void     xfce_settings_editor_box_property_changed     (XfceSettingsChannelModel *model,
+                                                               const gchar            *property,
+                                                               const GValue           *value,
+                                                               XfceSettingsEditorBox  *self);
+static gboolean xfce_settings_editor_box_test_expand_row      (GtkTreeView            *treeview,
+                                                               GtkTreeIter            *iter,
+                                                               GtkTreePath            *path,
+                                                               XfceSettingsEditorBox  *self);
 
 
 
@@ -206,6 +217,10 @@ xfce_settings_editor_box_init (XfceSettingsEditorBox *self)
 											G_TYPE_VALUE);
     gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (self->props_store),
                                           PROP_COLUMN_NAME, GTK_SORT_ASCENDING);
+
+    /* lookup table for the rows by property path, tree store iters persist */
+    self->props_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify) gtk_tree_iter_free);
     self->paned = paned = gtk_hpaned_new ();
 
     gtk_box_pack_start (GTK_BOX (self), paned, TRUE, TRUE, 0);
@@ -268,6 +283,8 @@ xfce_settings_editor_box_init (XfceSettingsEditorBox *self)
         G_CALLBACK (xfce_settings_editor_box_row_activated), self);
     g_signal_connect (G_OBJECT (treeview), "key-press-event",
         G_CALLBACK (xfce_settings_editor_box_key_press_event), self);
+    g_signal_connect (G_OBJECT (treeview), "test-expand-row",
+        G_CALLBACK (xfce_settings_editor_box_test_expand_row), self);
 
     selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (treeview));
     g_signal_connect (G_OBJECT (selection), "changed",
@@ -387,6 +404,13 @@ xfce_settings_editor_box_finalize (GObject *object)
     g_object_unref (G_OBJECT (self->channels_store));
 
     g_object_unref (G_OBJECT (self->props_store));
+    g_hash_table_destroy (self->props_index);
+    if (self->props_model != NULL)
+    {
+        g_signal_handlers_disconnect_by_func (G_OBJECT (self->props_model),
+            G_CALLBACK (xfce_settings_editor_box_property_changed), self);
+        g_object_unref (G_OBJECT (self->props_model));
+    }
     if (self->props_channel != NULL)
         g_object_unref (G_OBJECT (self->props_channel));
 
@@ -472,224 +496,260 @@ xfce_settings_editor_box_type_name (const GValue *value)
 
 
 
-static void
-xfce_settings_editor_box_property_load (const gchar               *property,
-										const GValue              *value,
-										XfceSettingsEditorBox     *self,
-										GtkTreePath              **expand_path)
+static gchar *
+xfce_settings_editor_box_row_path (GtkTreeModel *model,
+                                   GtkTreeIter  *iter)
 {
-    gchar       **paths;
-    guint         i;
-    GtkTreeIter   child_iter;
-    GtkTreeIter   parent_iter;
-    GValue        parent_val = { 0,};
-    gboolean      found_parent;
-    GValue        string_value = { 0, };
-    GtkTreeModel *model = GTK_TREE_MODEL (self->props_store);
+    GString     *string_prop;
+    GtkTreeIter  child_iter = *iter;
+    GtkTreeIter  parent_iter;
+    GValue       name_val = { 0, };
+
+    /* build the property path from the names in the tree */
+    string_prop = g_string_new (NULL);
+    for (;;)
+    {
+        gtk_tree_model_get_value (model, &child_iter, PROP_COLUMN_NAME, &name_val);
+        g_string_prepend (string_prop, g_value_get_string (&name_val));
+        g_string_prepend_c (string_prop, '/');
+        g_value_unset (&name_val);
+
+        if (!gtk_tree_model_iter_parent (model, &parent_iter, &child_iter))
+            break;
+
+        child_iter = parent_iter;
+    }
+
+    return g_string_free (string_prop, FALSE);
+}
 
-    g_return_if_fail (GTK_IS_TREE_STORE (self->props_store));
-    g_return_if_fail (G_IS_VALUE (value));
-    g_return_if_fail (property != NULL && *property == '/');
 
-    paths = g_strsplit (property, "/", -1);
-    if (paths == NULL)
-        return;
 
-    for (i = 1; paths[i] != NULL; i++)
+static void
+xfce_settings_editor_box_row_set_value (XfceSettingsEditorBox *self,
+                                        GtkTreeIter           *iter,
+                                        XfceSettingsNode      *node)
+{
+    /* the value column is converted to text by the cell renderer, so
+     * only for the rows that are drawn */
+    if (node->value != NULL)
+    {
+        gtk_tree_store_set (self->props_store, iter,
+                            PROP_COLUMN_FULL, node->path,
+                            PROP_COLUMN_TYPE, G_VALUE_TYPE_NAME (node->value),
+                            PROP_COLUMN_TYPE_NAME, xfce_settings_editor_box_type_name (node->value),
+                            PROP_COLUMN_LOCKED, xfce_settings_channel_model_is_locked (self->props_model, node->path),
+                            PROP_COLUMN_VALUE, node->value,
+                            -1);
+    }
+    else
     {
-        found_parent = FALSE;
+        gtk_tree_store_set (self->props_store, iter,
+                            PROP_COLUMN_FULL, NULL,
+                            PROP_COLUMN_TYPE, NULL,
+                            PROP_COLUMN_TYPE_NAME, _("Empty"),
+                            PROP_COLUMN_LOCKED, FALSE,
+                            PROP_COLUMN_VALUE, NULL,
+                            -1);
+    }
+}
 
-        if (gtk_tree_model_iter_children (model, &child_iter, i == 1 ? NULL : &parent_iter))
-        {
-            for (;;)
-            {
-                /* look if one of the paths already exists */
-                gtk_tree_model_get_value (model, &child_iter, PROP_COLUMN_NAME, &parent_val);
-                found_parent = g_strcmp0 (g_value_get_string (&parent_val), paths[i]) == 0;
-                g_value_unset (&parent_val);
-
-                /* maybe we still need to set the value */
-                if (found_parent)
-                {
-                    /* set this property in case it is the last value */
-                    if (paths[i + 1] == NULL)
-                        goto set_child_values;
-                    break;
-                }
-
-                /* append at the end of this parent */
-                if (!gtk_tree_model_iter_next (model, &child_iter))
-                   break;
-            }
-        }
 
-        if (!found_parent)
-        {
-            gtk_tree_store_append (GTK_TREE_STORE (model), &child_iter,
-                                   i == 1 ? NULL : &parent_iter);
 
-            if (G_LIKELY (paths[i + 1] != NULL))
-            {
-                gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
-                                    PROP_COLUMN_NAME, paths[i],
-                                    PROP_COLUMN_TYPE_NAME, _("Empty"), -1);
-            }
-            else
-            {
-                set_child_values:
+static void
+xfce_settings_editor_box_row_insert (XfceSettingsEditorBox *self,
+                                     XfceSettingsNode      *node,
+                                     GtkTreeIter           *parent_iter)
+{
+    GtkTreeIter iter;
+    GtkTreeIter dummy_iter;
 
-                g_value_init (&string_value, G_TYPE_STRING);
-                if (!g_value_transform (value, &string_value))
-                    g_value_set_string (&string_value, "Unknown");
+    gtk_tree_store_append (self->props_store, &iter, parent_iter);
+    gtk_tree_store_set (self->props_store, &iter, PROP_COLUMN_NAME, node->name, -1);
+    xfce_settings_editor_box_row_set_value (self, &iter, node);
 
-                gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
-                                    PROP_COLUMN_NAME, paths[i],
-                                    PROP_COLUMN_FULL, property,
-                                    PROP_COLUMN_TYPE, G_VALUE_TYPE_NAME (value),
-                                    PROP_COLUMN_TYPE_NAME, xfce_settings_editor_box_type_name (value),
-                                    PROP_COLUMN_LOCKED, xfconf_channel_is_property_locked (self->props_channel, property),
-                                    PROP_COLUMN_VALUE, value,
-                                    -1);
+    /* placeholder row without a name, so the row can be expanded; it
+     * is replaced with the children in test-expand-row */
+    if (XFCE_SETTINGS_NODE_HAS_CHILDREN (node))
+        gtk_tree_store_append (self->props_store, &dummy_iter, &iter);
 
-                if (expand_path != NULL)
-                    *expand_path = gtk_tree_model_get_path (model, &child_iter);
+    g_hash_table_insert (self->props_index, g_strdup (node->path),
+                         gtk_tree_iter_copy (&iter));
+}
 
-                g_value_unset (&string_value);
-            }
-        }
 
-        parent_iter = child_iter;
-    }
 
-    g_strfreev (paths);
+static gboolean
+xfce_settings_editor_box_row_has_placeholder (XfceSettingsEditorBox *self,
+                                              GtkTreeIter           *iter,
+                                              GtkTreeIter           *child_iter)
+{
+    GtkTreeModel *model = GTK_TREE_MODEL (self->props_store);
+    GValue        name_val = { 0, };
+    gboolean      placeholder;
+
+    if (!gtk_tree_model_iter_children (model, child_iter, iter))
+        return FALSE;
+
+    gtk_tree_model_get_value (model, child_iter, PROP_COLUMN_NAME, &name_val);
+    placeholder = g_value_get_string (&name_val) == NULL;
+    g_value_unset (&name_val);
+
+    return placeholder;
 }
 
 
 
-typedef struct
+static void
+xfce_settings_editor_box_row_load_children (XfceSettingsEditorBox *self,
+                                            GtkTreeIter           *iter,
+                                            XfceSettingsNode      *node)
 {
-    const gchar *prop;
-    GtkTreePath *path;
+    GtkTreeIter     dummy_iter;
+    GHashTableIter  hash_iter;
+    gpointer        child;
+
+    if (!xfce_settings_editor_box_row_has_placeholder (self, iter, &dummy_iter))
+        return;
+
+    if (node->children != NULL)
+    {
+        g_hash_table_iter_init (&hash_iter, node->children);
+        while (g_hash_table_iter_next (&hash_iter, NULL, &child))
+            xfce_settings_editor_box_row_insert (self, child, iter);
+    }
+
+    gtk_tree_store_remove (self->props_store, &dummy_iter);
 }
-DeleteContext;
 
 
 
-static gboolean
-xfce_settings_editor_box_property_find (GtkTreeModel *model,
-										GtkTreePath  *path,
-										GtkTreeIter  *iter,
-										gpointer      data)
+static GtkTreeIter *
+xfce_settings_editor_box_row_ensure (XfceSettingsEditorBox *self,
+                                     XfceSettingsNode      *node)
 {
-    GValue         prop = { 0, };
-    DeleteContext *context = data;
-    gboolean       found = FALSE;
+    GtkTreeIter *iter;
+    GtkTreeIter *parent_iter;
+    GtkTreeIter  dummy_iter;
 
-    gtk_tree_model_get_value (model, iter, PROP_COLUMN_FULL, &prop);
+    iter = g_hash_table_lookup (self->props_index, node->path);
+    if (iter != NULL)
+        return iter;
 
-    if (g_strcmp0 (g_value_get_string (&prop), context->prop) == 0)
+    if (node->parent->parent == NULL)
     {
-        found = TRUE;
-        context->path = gtk_tree_path_copy (path);
+        /* toplevel rows are always loaded */
+        xfce_settings_editor_box_row_insert (self, node, NULL);
+    }
+    else
+    {
+        parent_iter = xfce_settings_editor_box_row_ensure (self, node->parent);
+        if (xfce_settings_editor_box_row_has_placeholder (self, parent_iter, &dummy_iter))
+            xfce_settings_editor_box_row_load_children (self, parent_iter, node->parent);
+        else
+            xfce_settings_editor_box_row_insert (self, node, parent_iter);
     }
 
-    g_value_unset (&prop);
+    return g_hash_table_lookup (self->props_index, node->path);
+}
+
+
 
-    return found;
+static gboolean
+xfce_settings_editor_box_test_expand_row (GtkTreeView           *treeview,
+                                          GtkTreeIter           *iter,
+                                          GtkTreePath           *path,
+                                          XfceSettingsEditorBox *self)
+{
+    gchar            *property;
+    XfceSettingsNode *node;
+
+    property = xfce_settings_editor_box_row_path (GTK_TREE_MODEL (self->props_store), iter);
+    node = xfce_settings_channel_model_lookup (self->props_model, property);
+    if (G_LIKELY (node != NULL))
+        xfce_settings_editor_box_row_load_children (self, iter, node);
+    g_free (property);
+
+    /* allow the expand */
+    return FALSE;
 }
 
 
 
 static void
-xfce_settings_editor_box_property_changed (XfconfChannel            *channel,
+xfce_settings_editor_box_property_changed (XfceSettingsChannelModel *model,
 										   const gchar              *property,
 										   const GValue             *value,
 										   XfceSettingsEditorBox    *self)
 {
-    GtkTreePath      *path = NULL;
-    DeleteContext    *context;
+    GtkTreePath      *path;
+    GtkTreeIter      *iter;
     GtkTreeIter       child_iter;
-    GtkTreeModel     *model;
-    GValue            parent_val = { 0, };
-    GtkTreeIter       parent_iter;
-    gboolean          empty_prop;
-    gboolean          has_parent;
+    XfceSettingsNode *node;
+    gchar            *parent_prop;
     GtkTreeSelection *selection;
 
     g_return_if_fail (GTK_IS_TREE_STORE (self->props_store));
-    g_return_if_fail (XFCONF_IS_CHANNEL (channel));
-    g_return_if_fail (self->props_channel == channel);
+    g_return_if_fail (XFCE_IS_SETTINGS_CHANNEL_MODEL (model));
+    g_return_if_fail (self->props_model == model);
+
+    /* the model snapshot is already updated, sync the loaded rows */
+    node = xfce_settings_channel_model_lookup (model, property);
 
     if (value != NULL && G_IS_VALUE (value))
     {
-        xfce_settings_editor_box_property_load (property, value, self, &path);
+        g_return_if_fail (node != NULL);
 
-        if (path != NULL)
-        {
-            /* show the new value */
-            gtk_tree_view_expand_to_path (GTK_TREE_VIEW (self->props_treeview), path);
-            gtk_tree_path_free (path);
-        }
+        /* load the parent rows and update the value */
+        iter = xfce_settings_editor_box_row_ensure (self, node);
+        xfce_settings_editor_box_row_set_value (self, iter, node);
+
+        /* show the new value */
+        path = gtk_tree_model_get_path (GTK_TREE_MODEL (self->props_store), iter);
+        gtk_tree_view_expand_to_path (GTK_TREE_VIEW (self->props_treeview), path);
+        gtk_tree_path_free (path);
+    }
+    else if (node != NULL)
+    {
+        /* the node has children, so only unset it */
+        iter = g_hash_table_lookup (self->props_index, property);
+        if (iter != NULL)
+            xfce_settings_editor_box_row_set_value (self, iter, node);
     }
     else
     {
         /* we only get here when the property must be deleted, this means there
-         * is also no reset value in one of the xdg channels */
-        context = g_slice_new0 (DeleteContext);
-        context->prop = property;
-
-        model = GTK_TREE_MODEL (self->props_store);
-        gtk_tree_model_foreach (model, xfce_settings_editor_box_property_find, context);
-
-        if (context->path != NULL)
+         * is also no reset value in one of the xdg channels; remove the rows
+         * of the property and its parents that left the snapshot */
+        parent_prop = g_strdup (property);
+        for (;;)
         {
-            if (gtk_tree_model_get_iter (model, &child_iter, context->path))
+            iter = g_hash_table_lookup (self->props_index, parent_prop);
+            if (iter != NULL)
             {
-                if (gtk_tree_model_iter_has_child (model, &child_iter))
-                {
-                    /* the node has children, so only unset it */
-                    gtk_tree_store_set (GTK_TREE_STORE (model), &child_iter,
-                                        PROP_COLUMN_FULL, NULL,
-                                        PROP_COLUMN_TYPE, NULL,
-                                        PROP_COLUMN_TYPE_NAME, _("Empty"),
-                                        PROP_COLUMN_LOCKED, FALSE,
-                                        PROP_COLUMN_VALUE, NULL,
-                                        -1);
-                }
-                else
-                {
-                    /* delete the node */
-                    has_parent = gtk_tree_model_iter_parent (model, &parent_iter, &child_iter);
-                    gtk_tree_store_remove (GTK_TREE_STORE (model), &child_iter);
-
-                    /* remove the parent nodes if they are empty */
-                    while (has_parent)
-                    {
-                        /* if the parent still has children, stop cleaning */
-                        if (gtk_tree_model_iter_has_child (model, &parent_iter))
-                            break;
-
-                        /* maybe the parent has a value */
-                        gtk_tree_model_get_value (model, &parent_iter, PROP_COLUMN_FULL, &parent_val);
-                        empty_prop = g_value_get_string (&parent_val) == NULL;
-                        g_value_unset (&parent_val);
-
-                        /* nope it points to a real xfconf property */
-                        if (!empty_prop)
-                            break;
-
-                        /* get the parent and remove the empty row */
-                        child_iter = parent_iter;
-                        has_parent = gtk_tree_model_iter_parent (model, &parent_iter, &child_iter);
-                        gtk_tree_store_remove (GTK_TREE_STORE (model), &child_iter);
-                    }
-                }
+                child_iter = *iter;
+                g_hash_table_remove (self->props_index, parent_prop);
+                gtk_tree_store_remove (self->props_store, &child_iter);
             }
 
-            gtk_tree_path_free (context->path);
-        }
+            /* path of the parent row */
+            *strrchr (parent_prop, '/') = '\0';
+            if (*parent_prop == '\0')
+                break;
 
-        g_slice_free (DeleteContext, context);
+            node = xfce_settings_channel_model_lookup (model, parent_prop);
+            if (node != NULL)
+            {
+                /* a collapsed parent without children has no expander */
+                iter = g_hash_table_lookup (self->props_index, parent_prop);
+                if (iter != NULL
+                    && !XFCE_SETTINGS_NODE_HAS_CHILDREN (node)
+                    && xfce_settings_editor_box_row_has_placeholder (self, iter, &child_iter))
+                    gtk_tree_store_remove (self->props_store, &child_iter);
+                break;
+            }
+        }
+        g_free (parent_prop);
     }
 
     /* update button sensitivity */
@@ -700,46 +760,59 @@ xfce_settings_editor_box_property_changed (XfconfChannel            *channel,
 
 
 static void
-xfce_settings_editor_box_property_load_hash (gpointer key,
-											 gpointer value,
-											 gpointer data)
-{
-    xfce_settings_editor_box_property_load (key, value, data, NULL);
-}
-
-
-
-static void
-xfce_settings_editor_box_properties_load (XfceSettingsEditorBox *self,
-										  XfconfChannel            *channel)
+xfce_settings_editor_box_properties_load (XfceSettingsEditorBox    *self,
+										  XfceSettingsChannelModel *model)
 {
-    GHashTable *props;
+    GHashTableIter    hash_iter;
+    gpointer          child;
+    XfceSettingsNode *root;
 
     g_return_if_fail (GTK_IS_TREE_STORE (self->props_store));
-    g_return_if_fail (XFCONF_IS_CHANNEL (channel));
+    g_return_if_fail (XFCE_IS_SETTINGS_CHANNEL_MODEL (model));
 
-    if (self->props_channel != NULL)
+    if (self->props_model != NULL)
     {
-        g_signal_handlers_block_by_func (G_OBJECT (self->props_channel),
+        g_signal_handlers_disconnect_by_func (G_OBJECT (self->props_model),
             G_CALLBACK (xfce_settings_editor_box_property_changed), self);
+        g_object_unref (G_OBJECT (self->props_model));
+        self->props_model = NULL;
+    }
+
+    if (self->props_channel != NULL)
+    {
         g_object_unref (G_OBJECT (self->props_channel));
         self->props_channel = NULL;
     }
 
+    /* fill the store detached from the view and unsorted, so the rows
+     * are not sorted and the view is not updated on every insert */
+    gtk_tree_view_set_model (GTK_TREE_VIEW (self->props_treeview), NULL);
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (self->props_store),
+                                          GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+                                          GTK_SORT_ASCENDING);
+
+    g_hash_table_remove_all (self->props_index);
     gtk_tree_store_clear (self->props_store);
 
-    self->props_channel = (XfconfChannel *) g_object_ref (G_OBJECT (channel));
+    self->props_model = g_object_ref (G_OBJECT (model));
+    self->props_channel = g_object_ref (G_OBJECT (xfce_settings_channel_model_get_channel (model)));
 
-    props = xfconf_channel_get_properties (channel, NULL);
-    if (G_LIKELY (props != NULL))
+    /* rows are only created for the toplevel properties, the others
+     * are loaded from the snapshot when their parent is expanded */
+    root = xfce_settings_channel_model_lookup (model, "");
+    if (root->children != NULL)
     {
-        g_hash_table_foreach (props, xfce_settings_editor_box_property_load_hash, self);
-        g_hash_table_destroy (props);
+        g_hash_table_iter_init (&hash_iter, root->children);
+        while (g_hash_table_iter_next (&hash_iter, NULL, &child))
+            xfce_settings_editor_box_row_insert (self, child, NULL);
     }
 
-    gtk_tree_view_expand_all (GTK_TREE_VIEW (self->props_treeview));
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (self->props_store),
+                                          PROP_COLUMN_NAME, GTK_SORT_ASCENDING);
+    gtk_tree_view_set_model (GTK_TREE_VIEW (self->props_treeview),
+                             GTK_TREE_MODEL (self->props_store));
 
-    g_signal_connect (G_OBJECT (self->props_channel), "property-changed",
+    g_signal_connect (G_OBJECT (self->props_model), "property-changed",
         G_CALLBACK (xfce_settings_editor_box_property_changed), self);
 }
 
@@ -749,30 +822,31 @@ static void
 xfce_settings_editor_box_channel_changed (GtkTreeSelection         *selection,
 										  XfceSettingsEditorBox *self)
 {
-    GtkTreeIter    iter;
-    GValue         value = { 0, };
-    XfconfChannel *channel;
-    gboolean       locked;
+    GtkTreeIter               iter;
+    GValue                    value = { 0, };
+    XfceSettingsChannelModel *model;
+    gboolean                  locked;
 
     if (gtk_tree_selection_get_selected (selection, NULL, &iter))
     {
         gtk_tree_model_get_value (GTK_TREE_MODEL (self->channels_store), &iter,
                                   CHANNEL_COLUMN_NAME, &value);
 
-        channel = xfconf_channel_new (g_value_get_string (&value));
+        model = xfce_settings_channel_model_get (g_value_get_string (&value));
 
-        locked = xfconf_channel_is_property_locked (channel, "/");
+        locked = xfconf_channel_is_property_locked (xfce_settings_channel_model_get_channel (model), "/");
         gtk_widget_set_sensitive (self->button_new, !locked);
 
-        xfce_settings_editor_box_properties_load (self, channel);
+        xfce_settings_editor_box_properties_load (self, model);
 
-        g_object_unref (G_OBJECT (channel));
+        g_object_unref (G_OBJECT (model));
 
         g_value_unset (&value);
     }
     else
     {
         gtk_widget_set_sensitive (self->button_new, FALSE);
+        g_hash_table_remove_all (self->props_index);
         gtk_tree_store_clear (self->props_store);
     }
 }
@@ -835,97 +909,503 @@ xfce_settings_editor_box_channel_reset (XfceSettingsEditorBox *self)
 
 
 
-static void
-xfce_settings_editor_box_channel_monitor_changed (XfconfChannel *channel,
-												  const gchar   *property,
-												  const GValue  *value,
-												  GtkWidget     *window)
+/* number of events kept in the monitor ring buffer */
+#define MONITOR_BUFFER_SIZE     (10000)
+#define MONITOR_REFRESH         (250)
+#define MONITOR_RESPONSE_EXPORT (1)
+
+enum
+{
+    MONITOR_COLUMN_SEQ,
+    N_MONITOR_COLUMNS
+};
+
+enum
+{
+    STATS_COLUMN_PROPERTY,
+    STATS_COLUMN_COUNT,
+    STATS_COLUMN_RATE,
+    N_STATS_COLUMNS
+};
+
+enum
+{
+    MONITOR_CELL_TIME,
+    MONITOR_CELL_PROPERTY,
+    MONITOR_CELL_TYPE,
+    MONITOR_CELL_VALUE
+};
+
+typedef struct
 {
-    GtkTextBuffer *buffer;
-    GTimeVal       timeval;
-    gchar         *str;
-    GValue         str_value = { 0, };
-    GtkTextIter    iter;
+    gchar       *property;
+    guint        count;
+    guint        window_count;
+    gint64       window_start;
+    gdouble      rate;
+    GtkTreeIter  iter;
+    guint        has_iter : 1;
+
+    /* count or rate differ from the row in the stats store */
+    guint        changed : 1;
+}
+MonitorStats;
+
+typedef struct
+{
+    /* wall clock, for the time column and the export */
+    gint64        time;
+    MonitorStats *stats;
+    GValue        value;
+}
+MonitorEvent;
+
+typedef struct
+{
+    GtkWidget                *window;
+    XfceSettingsChannelModel *model;
+
+    /* ring buffer, the slot of event n is n % MONITOR_BUFFER_SIZE */
+    MonitorEvent             *events;
+    guint64                   n_events;
+    guint64                   n_shown;
+    guint                     n_rows;
+
+    GHashTable               *stats;
+
+    GtkListStore             *events_store;
+    GtkListStore             *stats_store;
+
+    guint                     refresh_timeout_id;
+}
+MonitorData;
+
 
-    buffer = g_object_get_data (G_OBJECT (window), "buffer");
-    g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+
+static gint64
+xfce_settings_editor_box_channel_monitor_time (void)
+{
+    GTimeVal timeval;
 
     g_get_current_time (&timeval);
 
+    return (gint64) timeval.tv_sec * G_USEC_PER_SEC + timeval.tv_usec;
+}
+
+
+
+static gint64
+xfce_settings_editor_box_channel_monitor_clock (void)
+{
+#if GLIB_CHECK_VERSION (2, 28, 0)
+    /* the rates must not jump when the wall clock is set */
+    return g_get_monotonic_time ();
+#else
+    return xfce_settings_editor_box_channel_monitor_time ();
+#endif
+}
+
+
+
+static void
+xfce_settings_editor_box_channel_monitor_stats_free (gpointer data)
+{
+    MonitorStats *stats = data;
+
+    g_free (stats->property);
+    g_slice_free (MonitorStats, stats);
+}
+
+
+
+static void
+xfce_settings_editor_box_channel_monitor_stats_roll (MonitorStats *stats,
+                                                     gint64        now)
+{
+    gint64  elapsed = now - stats->window_start;
+    gdouble rate;
+
+    /* events per second over the last window of at least a second */
+    if (elapsed >= G_USEC_PER_SEC)
+    {
+        rate = (gdouble) stats->window_count * G_USEC_PER_SEC / elapsed;
+        if (rate != stats->rate)
+        {
+            stats->rate = rate;
+            stats->changed = TRUE;
+        }
+
+        stats->window_count = 0;
+        stats->window_start = now;
+    }
+}
+
+
+
+static void
+xfce_settings_editor_box_channel_monitor_clear (MonitorData *data)
+{
+    guint i;
+
+    for (i = 0; i < MONITOR_BUFFER_SIZE; i++)
+    {
+        if (G_IS_VALUE (&data->events[i].value))
+            g_value_unset (&data->events[i].value);
+        data->events[i].stats = NULL;
+    }
+
+    data->n_events = 0;
+    data->n_shown = 0;
+    data->n_rows = 0;
+
+    g_hash_table_remove_all (data->stats);
+    gtk_list_store_clear (data->events_store);
+    gtk_list_store_clear (data->stats_store);
+}
+
+
+
+static void
+xfce_settings_editor_box_channel_monitor_changed (XfceSettingsChannelModel *model,
+												  const gchar              *property,
+												  const GValue             *value,
+												  MonitorData              *data)
+{
+    MonitorStats *stats;
+    MonitorEvent *event;
+    gint64        now;
+
+    now = xfce_settings_editor_box_channel_monitor_clock ();
+
+    stats = g_hash_table_lookup (data->stats, property);
+    if (G_UNLIKELY (stats == NULL))
+    {
+        stats = g_slice_new0 (MonitorStats);
+        stats->property = g_strdup (property);
+        stats->window_start = now;
+        g_hash_table_insert (data->stats, stats->property, stats);
+    }
+
+    stats->count++;
+    stats->window_count++;
+    stats->changed = TRUE;
+    xfce_settings_editor_box_channel_monitor_stats_roll (stats, now);
+
+    /* only store the event, the views are updated in the refresh timeout */
+    event = &data->events[data->n_events % MONITOR_BUFFER_SIZE];
+    event->time = xfce_settings_editor_box_channel_monitor_time ();
+    event->stats = stats;
+
+    if (G_IS_VALUE (&event->value))
+        g_value_unset (&event->value);
     if (value != NULL && G_IS_VALUE (value))
     {
-        g_value_init (&str_value, G_TYPE_STRING);
-        if (g_value_transform (value, &str_value))
+        g_value_init (&event->value, G_VALUE_TYPE (value));
+        g_value_copy (value, &event->value);
+    }
+
+    data->n_events++;
+}
+
+
+
+static gboolean
+xfce_settings_editor_box_channel_monitor_refresh (gpointer user_data)
+{
+    MonitorData    *data = user_data;
+    guint64         seq;
+    GtkTreeIter     iter;
+    GHashTableIter  hash_iter;
+    gpointer        value;
+    MonitorStats   *stats;
+    gint64          now;
+
+    /* prepend the new events, older ones were overwritten in the ring */
+    seq = data->n_shown;
+    if (data->n_events - seq > MONITOR_BUFFER_SIZE)
+        seq = data->n_events - MONITOR_BUFFER_SIZE;
+
+    for (; seq < data->n_events; seq++)
+    {
+        gtk_list_store_insert_with_values (data->events_store, NULL, 0,
+                                           MONITOR_COLUMN_SEQ, seq, -1);
+        data->n_rows++;
+    }
+    data->n_shown = data->n_events;
+
+    /* drop the rows of the events that are not in the ring anymore */
+    while (data->n_rows > MONITOR_BUFFER_SIZE
+           && gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (data->events_store),
+                                             &iter, NULL, data->n_rows - 1))
+    {
+        gtk_list_store_remove (data->events_store, &iter);
+        data->n_rows--;
+    }
+
+    /* update the counters, rates also drop when no events arrive */
+    now = xfce_settings_editor_box_channel_monitor_clock ();
+    g_hash_table_iter_init (&hash_iter, data->stats);
+    while (g_hash_table_iter_next (&hash_iter, NULL, &value))
+    {
+        stats = value;
+        xfce_settings_editor_box_channel_monitor_stats_roll (stats, now);
+
+        /* setting a row re-sorts the store, skip the unchanged ones */
+        if (!stats->changed)
+            continue;
+        stats->changed = FALSE;
+
+        if (!stats->has_iter)
         {
-            str = g_strdup_printf ("%ld: %s (%s: %s)\n",
-                                   timeval.tv_sec, property,
-                                   G_VALUE_TYPE_NAME (value),
-                                   g_value_get_string (&str_value));
+            gtk_list_store_insert_with_values (data->stats_store, &stats->iter, -1,
+                                               STATS_COLUMN_PROPERTY, stats->property,
+                                               STATS_COLUMN_COUNT, stats->count,
+                                               STATS_COLUMN_RATE, stats->rate, -1);
+            stats->has_iter = TRUE;
         }
         else
         {
-            str = g_strdup_printf ("%ld: %s (%s)\n",
-                                   timeval.tv_sec, property,
-                                   G_VALUE_TYPE_NAME (value));
+            gtk_list_store_set (data->stats_store, &stats->iter,
+                                STATS_COLUMN_COUNT, stats->count,
+                                STATS_COLUMN_RATE, stats->rate, -1);
         }
-        g_value_unset (&str_value);
     }
-    else
+
+    return TRUE;
+}
+
+
+
+static void
+xfce_settings_editor_box_channel_monitor_cell_data (GtkTreeViewColumn *column,
+                                                    GtkCellRenderer   *renderer,
+                                                    GtkTreeModel      *model,
+                                                    GtkTreeIter       *iter,
+                                                    gpointer           user_data)
+{
+    MonitorData  *data = user_data;
+    MonitorEvent *event;
+    guint64       seq;
+    gchar         buf[64];
+    GValue        str_value = { 0, };
+
+    gtk_tree_model_get (model, iter, MONITOR_COLUMN_SEQ, &seq, -1);
+
+    /* the event was overwritten in the ring before the row was dropped */
+    if (seq + MONITOR_BUFFER_SIZE < data->n_events)
     {
-        /* I18N: if a property is removed from the channel */
-        str = g_strdup_printf ("%ld: %s (%s)\n", timeval.tv_sec,
-                               property, _("reset"));
+        g_object_set (G_OBJECT (renderer), "text", NULL, NULL);
+        return;
     }
 
-    /* prepend to the buffer */
-    gtk_text_buffer_get_start_iter (buffer, &iter);
-    gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, str, -1, "monospace", NULL);
-    g_free (str);
+    /* only the visible rows are formatted */
+    event = &data->events[seq % MONITOR_BUFFER_SIZE];
+    switch (GPOINTER_TO_INT (g_object_get_data (G_OBJECT (renderer), "monitor-cell")))
+    {
+        case MONITOR_CELL_TIME:
+            g_snprintf (buf, sizeof (buf), "%" G_GINT64_FORMAT ".%06d",
+                        event->time / G_USEC_PER_SEC,
+                        (gint) (event->time % G_USEC_PER_SEC));
+            g_object_set (G_OBJECT (renderer), "text", buf, NULL);
+            break;
+
+        case MONITOR_CELL_PROPERTY:
+            g_object_set (G_OBJECT (renderer), "text", event->stats->property, NULL);
+            break;
+
+        case MONITOR_CELL_TYPE:
+            /* I18N: if a property is removed from the channel */
+            g_object_set (G_OBJECT (renderer), "text",
+                          G_IS_VALUE (&event->value) ? G_VALUE_TYPE_NAME (&event->value) : _("reset"),
+                          NULL);
+            break;
+
+        case MONITOR_CELL_VALUE:
+            g_value_init (&str_value, G_TYPE_STRING);
+            if (G_IS_VALUE (&event->value)
+                && g_value_transform (&event->value, &str_value))
+                g_object_set (G_OBJECT (renderer), "text", g_value_get_string (&str_value), NULL);
+            else
+                g_object_set (G_OBJECT (renderer), "text", NULL, NULL);
+            g_value_unset (&str_value);
+            break;
+    }
 }
 
 
 
 static void
-xfce_settings_editor_box_channel_monitor_response (GtkWidget     *window,
-												   gint           response_id,
-												   XfconfChannel *channel)
+xfce_settings_editor_box_channel_monitor_rate_data (GtkTreeViewColumn *column,
+                                                    GtkCellRenderer   *renderer,
+                                                    GtkTreeModel      *model,
+                                                    GtkTreeIter       *iter,
+                                                    gpointer           user_data)
 {
-    GtkTextBuffer *buffer;
+    gdouble rate;
+    gchar   buf[32];
+
+    gtk_tree_model_get (model, iter, STATS_COLUMN_RATE, &rate, -1);
+    g_snprintf (buf, sizeof (buf), _("%.1f/s"), rate);
+    g_object_set (G_OBJECT (renderer), "text", buf, NULL);
+}
+
+
+
+static void
+xfce_settings_editor_box_channel_monitor_export (MonitorData *data)
+{
+    GtkWidget    *chooser;
+    gchar        *channel_name;
+    gchar        *filename;
+    gchar        *name;
+    GString      *contents;
+    guint64       seq;
+    MonitorEvent *event;
+    GValue        str_value = { 0, };
+    GError       *error = NULL;
+
+    g_object_get (xfce_settings_channel_model_get_channel (data->model),
+                  "channel-name", &channel_name, NULL);
+
+    chooser = gtk_file_chooser_dialog_new (_("Export Monitor Log"),
+                                           GTK_WINDOW (data->window),
+                                           GTK_FILE_CHOOSER_ACTION_SAVE,
+                                           GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+                                           GTK_STOCK_SAVE, GTK_RESPONSE_ACCEPT,
+                                           NULL);
+    gtk_dialog_set_default_response (GTK_DIALOG (chooser), GTK_RESPONSE_ACCEPT);
+    gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (chooser), TRUE);
+    name = g_strconcat (channel_name, ".log", NULL);
+    gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (chooser), name);
+    g_free (name);
+
+    if (gtk_dialog_run (GTK_DIALOG (chooser)) == GTK_RESPONSE_ACCEPT)
+    {
+        filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (chooser));
+
+        /* write the events in the ring from old to new */
+        contents = g_string_new (NULL);
+        seq = data->n_events > MONITOR_BUFFER_SIZE ? data->n_events - MONITOR_BUFFER_SIZE : 0;
+        for (; seq < data->n_events; seq++)
+        {
+            event = &data->events[seq % MONITOR_BUFFER_SIZE];
+            g_string_append_printf (contents, "%" G_GINT64_FORMAT ".%06d\t%s",
+                                    event->time / G_USEC_PER_SEC,
+                                    (gint) (event->time % G_USEC_PER_SEC),
+                                    event->stats->property);
+
+            if (G_IS_VALUE (&event->value))
+            {
+                g_string_append_printf (contents, "\t%s", G_VALUE_TYPE_NAME (&event->value));
 
+                g_value_init (&str_value, G_TYPE_STRING);
+                if (g_value_transform (&event->value, &str_value))
+                    g_string_append_printf (contents, "\t%s", g_value_get_string (&str_value));
+                g_value_unset (&str_value);
+            }
+            else
+            {
+                g_string_append (contents, "\treset");
+            }
+
+            g_string_append_c (contents, '\n');
+        }
+
+        if (!g_file_set_contents (filename, contents->str, contents->len, &error))
+        {
+            xfce_dialog_show_error (GTK_WINDOW (data->window), error,
+                                    _("Failed to export the monitor log of channel \"%s\""),
+                                    channel_name);
+            g_error_free (error);
+        }
+
+        g_string_free (contents, TRUE);
+        g_free (filename);
+    }
+
+    gtk_widget_destroy (chooser);
+    g_free (channel_name);
+}
+
+
+
+static void
+xfce_settings_editor_box_channel_monitor_response (GtkWidget   *window,
+												   gint         response_id,
+												   MonitorData *data)
+{
     if (response_id == GTK_RESPONSE_REJECT)
     {
-        buffer = g_object_get_data (G_OBJECT (window), "buffer");
-        g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
-        gtk_text_buffer_set_text (buffer, "", 0);
+        xfce_settings_editor_box_channel_monitor_clear (data);
+    }
+    else if (response_id == MONITOR_RESPONSE_EXPORT)
+    {
+        xfce_settings_editor_box_channel_monitor_export (data);
     }
     else
     {
-        g_signal_handlers_disconnect_by_func (G_OBJECT (channel),
-            G_CALLBACK (xfce_settings_editor_box_channel_monitor_changed), window);
-
-        g_object_unref (G_OBJECT (channel));
+        g_signal_handlers_disconnect_by_func (G_OBJECT (data->model),
+            G_CALLBACK (xfce_settings_editor_box_channel_monitor_changed), data);
+        g_source_remove (data->refresh_timeout_id);
 
         monitor_dialogs = g_slist_remove (monitor_dialogs, window);
 
         gtk_widget_destroy (window);
+
+        xfce_settings_editor_box_channel_monitor_clear (data);
+        g_free (data->events);
+        g_hash_table_destroy (data->stats);
+        g_object_unref (G_OBJECT (data->events_store));
+        g_object_unref (G_OBJECT (data->stats_store));
+        g_object_unref (G_OBJECT (data->model));
+        g_slice_free (MonitorData, data);
     }
 }
 
 
 
+static void
+xfce_settings_editor_box_channel_monitor_column (GtkWidget   *treeview,
+                                                 const gchar *title,
+                                                 gint         cell,
+                                                 gint         width,
+                                                 MonitorData *data)
+{
+    GtkCellRenderer   *render;
+    GtkTreeViewColumn *column;
+
+    render = gtk_cell_renderer_text_new ();
+    g_object_set (G_OBJECT (render), "font", "monospace", NULL);
+    g_object_set_data (G_OBJECT (render), "monitor-cell", GINT_TO_POINTER (cell));
+
+    column = gtk_tree_view_column_new ();
+    gtk_tree_view_column_set_title (column, title);
+    gtk_tree_view_column_pack_start (column, render, TRUE);
+    gtk_tree_view_column_set_cell_data_func (column, render,
+        xfce_settings_editor_box_channel_monitor_cell_data, data, NULL);
+
+    /* fixed sizing, so only the visible rows are measured */
+    gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width (column, width);
+    gtk_tree_view_column_set_resizable (column, TRUE);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+}
+
+
+
 static void
 xfce_settings_editor_box_channel_monitor (XfceSettingsEditorBox *self)
 {
-    GtkWidget     *window;
-    gchar         *channel_name;
-    gchar         *title;
-    GtkWidget     *scroll;
-    GtkWidget     *textview;
-    GtkWidget     *content_area;
-    GtkTextBuffer *buffer;
-    GTimeVal       timeval;
-    gchar         *str;
-    GtkTextIter    iter;
+    GtkWidget         *window;
+    gchar             *channel_name;
+    gchar             *title;
+    GtkWidget         *paned;
+    GtkWidget         *scroll;
+    GtkWidget         *treeview;
+    GtkWidget         *content_area;
+    GtkCellRenderer   *render;
+    GtkTreeViewColumn *column;
+    MonitorData       *data;
 
     if (self->props_channel == NULL)
         return;
@@ -933,19 +1413,30 @@ xfce_settings_editor_box_channel_monitor (XfceSettingsEditorBox *self)
     g_object_get (self->props_channel, "channel-name", &channel_name, NULL);
     title = g_strdup_printf (_("Monitor %s"), channel_name);
 
-    window = xfce_titled_dialog_new ();
+    data = g_slice_new0 (MonitorData);
+    data->model = g_object_ref (G_OBJECT (self->props_model));
+    data->events = g_new0 (MonitorEvent, MONITOR_BUFFER_SIZE);
+    data->stats = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                         xfce_settings_editor_box_channel_monitor_stats_free);
+    data->events_store = gtk_list_store_new (N_MONITOR_COLUMNS, G_TYPE_UINT64);
+    data->stats_store = gtk_list_store_new (N_STATS_COLUMNS, G_TYPE_STRING,
+                                            G_TYPE_UINT, G_TYPE_DOUBLE);
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (data->stats_store),
+                                          STATS_COLUMN_COUNT, GTK_SORT_DESCENDING);
+
+    data->window = window = xfce_titled_dialog_new ();
     gtk_window_set_title (GTK_WINDOW (window), title);
     gtk_window_set_icon_name (GTK_WINDOW (window), "utilities-system-monitor");
-    gtk_window_set_default_size (GTK_WINDOW (window), 600, 400);
+    gtk_window_set_default_size (GTK_WINDOW (window), 700, 500);
     gtk_window_set_type_hint (GTK_WINDOW (window), GDK_WINDOW_TYPE_HINT_NORMAL);
     xfce_titled_dialog_set_subtitle (XFCE_TITLED_DIALOG (window),
         _("Watch an Xfconf channel for property changes"));
     gtk_dialog_add_buttons (GTK_DIALOG (window),
+                            GTK_STOCK_SAVE_AS, MONITOR_RESPONSE_EXPORT,
                             GTK_STOCK_CLEAR, GTK_RESPONSE_REJECT,
                             GTK_STOCK_CLOSE, GTK_RESPONSE_CLOSE, NULL);
     g_signal_connect (G_OBJECT (window), "response",
-        G_CALLBACK (xfce_settings_editor_box_channel_monitor_response),
-        g_object_ref (G_OBJECT (self->props_channel)));
+        G_CALLBACK (xfce_settings_editor_box_channel_monitor_response), data);
     gtk_dialog_set_default_response (GTK_DIALOG (window), GTK_RESPONSE_CLOSE);
     g_free (title);
 
@@ -955,36 +1446,69 @@ xfce_settings_editor_box_channel_monitor (XfceSettingsEditorBox *self)
         monitor_group = gtk_window_group_new ();
     gtk_window_group_add_window (monitor_group, GTK_WINDOW (window));
 
-    scroll = gtk_scrolled_window_new (NULL, NULL);
+    paned = gtk_vpaned_new ();
     content_area = gtk_dialog_get_content_area (GTK_DIALOG (window));
-    gtk_box_pack_start (GTK_BOX (content_area), scroll, TRUE, TRUE, 0);
-    gtk_container_set_border_width (GTK_CONTAINER (scroll), 6);
+    gtk_box_pack_start (GTK_BOX (content_area), paned, TRUE, TRUE, 0);
+    gtk_container_set_border_width (GTK_CONTAINER (paned), 6);
+    gtk_widget_show (paned);
+
+    /* events, newest first */
+    scroll = gtk_scrolled_window_new (NULL, NULL);
+    gtk_paned_pack1 (GTK_PANED (paned), scroll, TRUE, FALSE);
     gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scroll), GTK_SHADOW_ETCHED_IN);
     gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
     gtk_widget_show (scroll);
 
-    buffer = gtk_text_buffer_new (NULL);
-    g_object_set_data_full (G_OBJECT (window), "buffer", buffer, g_object_unref);
-    gtk_text_buffer_create_tag (buffer, "monospace", "font", "monospace", NULL);
-    g_signal_connect (G_OBJECT (self->props_channel), "property-changed",
-        G_CALLBACK (xfce_settings_editor_box_channel_monitor_changed), window);
+    treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (data->events_store));
+    gtk_tree_view_set_enable_search (GTK_TREE_VIEW (treeview), FALSE);
+    gtk_container_add (GTK_CONTAINER (scroll), treeview);
+    gtk_widget_show (treeview);
 
-    g_get_current_time (&timeval);
-    gtk_text_buffer_get_start_iter (buffer, &iter);
-    str = g_strdup_printf ("%ld: ", timeval.tv_sec);
-    gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, str, -1, "monospace", NULL);
-    g_free (str);
-
-    str = g_strdup_printf (_("start monitoring channel \"%s\""), channel_name);
-    gtk_text_buffer_insert_with_tags_by_name (buffer, &iter, str, -1, "monospace", NULL);
-    g_free (str);
-
-    textview = gtk_text_view_new_with_buffer (buffer);
-    gtk_container_add (GTK_CONTAINER (scroll), textview);
-    gtk_text_view_set_editable (GTK_TEXT_VIEW (textview), FALSE);
-    gtk_text_view_set_cursor_visible (GTK_TEXT_VIEW (textview), FALSE);
-    gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (textview), GTK_WRAP_NONE);
-    gtk_widget_show (textview);
+    xfce_settings_editor_box_channel_monitor_column (treeview, _("Time"), MONITOR_CELL_TIME, 150, data);
+    xfce_settings_editor_box_channel_monitor_column (treeview, _("Property"), MONITOR_CELL_PROPERTY, 250, data);
+    xfce_settings_editor_box_channel_monitor_column (treeview, _("Type"), MONITOR_CELL_TYPE, 80, data);
+    xfce_settings_editor_box_channel_monitor_column (treeview, _("Value"), MONITOR_CELL_VALUE, 200, data);
+    gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (treeview), TRUE);
+
+    /* counters per property */
+    scroll = gtk_scrolled_window_new (NULL, NULL);
+    gtk_paned_pack2 (GTK_PANED (paned), scroll, FALSE, FALSE);
+    gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scroll), GTK_SHADOW_ETCHED_IN);
+    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scroll), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_widget_set_size_request (scroll, -1, 120);
+    gtk_widget_show (scroll);
+
+    treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (data->stats_store));
+    gtk_tree_view_set_enable_search (GTK_TREE_VIEW (treeview), FALSE);
+    gtk_container_add (GTK_CONTAINER (scroll), treeview);
+    gtk_widget_show (treeview);
+
+    render = gtk_cell_renderer_text_new ();
+    column = gtk_tree_view_column_new_with_attributes (_("Property"), render,
+                                                       "text", STATS_COLUMN_PROPERTY,
+                                                       NULL);
+    gtk_tree_view_column_set_sort_column_id (column, STATS_COLUMN_PROPERTY);
+    gtk_tree_view_column_set_expand (column, TRUE);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+
+    render = gtk_cell_renderer_text_new ();
+    column = gtk_tree_view_column_new_with_attributes (_("Events"), render,
+                                                       "text", STATS_COLUMN_COUNT,
+                                                       NULL);
+    gtk_tree_view_column_set_sort_column_id (column, STATS_COLUMN_COUNT);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+
+    render = gtk_cell_renderer_text_new ();
+    column = gtk_tree_view_column_new_with_attributes (_("Rate"), render, NULL);
+    gtk_tree_view_column_set_cell_data_func (column, render,
+        xfce_settings_editor_box_channel_monitor_rate_data, NULL, NULL);
+    gtk_tree_view_column_set_sort_column_id (column, STATS_COLUMN_RATE);
+    gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+
+    g_signal_connect (G_OBJECT (data->model), "property-changed",
+        G_CALLBACK (xfce_settings_editor_box_channel_monitor_changed), data);
+    data->refresh_timeout_id = g_timeout_add (MONITOR_REFRESH,
+        xfce_settings_editor_box_channel_monitor_refresh, data);
 
     gtk_window_present_with_time (GTK_WINDOW (window), gtk_get_current_event_time ());
 
@@ -1096,9 +1620,6 @@ xfce_settings_editor_box_selected (XfceSettingsEditorBox    *self,
     GtkTreeIter       iter;
     gchar            *property = NULL;
     GtkTreeModel     *model;
-    GtkTreeIter       parent_iter;
-    GValue            name_val = { 0, };
-    GString          *string_prop;
     gboolean          property_real = TRUE;
     gchar            *type_name;
 
@@ -1111,20 +1632,7 @@ xfce_settings_editor_box_selected (XfceSettingsEditorBox    *self,
         /* if this is not a real property, look it up by the tree structure */
         if (property == NULL)
         {
-            string_prop = g_string_new (NULL);
-            for (;;)
-            {
-                gtk_tree_model_get_value (model, &iter, PROP_COLUMN_NAME, &name_val);
-                g_string_prepend (string_prop, g_value_get_string (&name_val));
-                g_string_prepend_c (string_prop, '/');
-                g_value_unset (&name_val);
-
-                if (!gtk_tree_model_iter_parent (model, &parent_iter, &iter))
-                    break;
-
-                iter = parent_iter;
-            }
-            property = g_string_free (string_prop, FALSE);
+            property = xfce_settings_editor_box_row_path (model, &iter);
             property_real = FALSE;
         }
         else if (is_array != NULL)
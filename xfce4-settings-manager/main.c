@@ -51,6 +51,12 @@ main(int argc,
     GtkWidget *dialog;
     GError    *error = NULL;
 
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+    /* the menu is reloaded in a worker thread */
+    if (!g_thread_supported ())
+        g_thread_init (NULL);
+#endif
+
     xfce_textdomain(GETTEXT_PACKAGE, LOCALEDIR, "UTF-8");
 
     if (!gtk_init_with_args (&argc, &argv, NULL, option_entries, GETTEXT_PACKAGE, &error))
@@ -40,11 +40,24 @@
 #include <exo/exo.h>
 
 #include "xfce-settings-manager-dialog.h"
+#include "xfce-settings-menu.h"
 #include "xfce-text-renderer.h"
 
 #define TEXT_WIDTH (128)
 #define ICON_WIDTH (48)
 
+/* number of search results kept around between keystrokes */
+#define SEARCH_CACHE_SIZE (32)
+
+/* shorter queries match almost everything with the fuzzy match */
+#define SEARCH_FUZZY_LENGTH (3)
+
+/* number of embedded dialogs kept running after going back */
+#define PLUG_CACHE_SIZE (4)
+
+/* number of threads loading the category icons */
+#define ICON_THREADS (2)
+
 
 
 struct _XfceSettingsManagerDialogClass
@@ -52,58 +65,132 @@ struct _XfceSettingsManagerDialogClass
     XfceTitledDialogClass __parent__;
 };
 
+typedef struct
+{
+    XfceSettingsManagerDialog *dialog;
+    GtkWidget                 *socket;
+    guint                      plugged : 1;
+
+    /* the item is owned by the menu snapshot */
+    XfceSettingsMenu          *menu;
+    XfceSettingsMenuItem      *item;
+}
+DialogPlug;
+
 struct _XfceSettingsManagerDialog
 {
     XfceTitledDialog __parent__;
 
-    XfconfChannel  *channel;
-    GarconMenu     *menu;
+    XfconfChannel        *channel;
 
-    GtkListStore   *store;
+    /* snapshot of the menu shown in the dialog */
+    XfceSettingsMenu     *menu;
+    gchar                *menu_file;
+    guint                 menu_loading : 1;
+    guint                 menu_reload : 1;
 
-    GtkWidget      *filter_entry;
-    gchar          *filter_text;
+    /* file monitors on the sources of the snapshot */
+    GPtrArray            *menu_monitors;
+
+    GtkListStore         *store;
+
+    GtkWidget            *filter_entry;
+    gchar                *filter_text;
+
+    /* search index over all the items in the store */
+    GPtrArray            *items;
+    GArray               *tokens;
+    GHashTable           *results;
+    gint                 *scores;
 
-    GtkWidget      *category_viewport;
-    GtkWidget      *category_scroll;
-    GtkWidget      *category_box;
+    GtkWidget            *category_viewport;
+    GtkWidget            *category_scroll;
+    GtkWidget            *category_box;
 
-    GList          *categories;
+    GList                *categories;
 
-    GtkWidget      *socket_scroll;
-    GtkWidget      *socket_viewport;
-    GarconMenuItem *socket_item;
+    GtkWidget            *socket_scroll;
+    GtkWidget            *socket_viewport;
+    GtkWidget            *socket_box;
 
-    GtkWidget      *button_back;
-    GtkWidget      *button_help;
+    /* running embedded dialogs, the most recent first */
+    GList                *plugs;
+    DialogPlug           *plug;
 
-    gchar          *help_page;
-    gchar          *help_component;
-    gchar          *help_version;
+    GtkWidget            *button_back;
+    GtkWidget            *button_help;
+
+    gchar                *help_page;
+    gchar                *help_component;
+    gchar                *help_version;
 };
 
 typedef struct
 {
-    GarconMenuDirectory       *directory;
+    const gchar               *name;
     XfceSettingsManagerDialog *dialog;
     GtkWidget                 *iconview;
     GtkWidget                 *box;
+    gint                       n_visible;
+    guint                      changed : 1;
 }
 DialogCategory;
 
+typedef struct
+{
+    GtkTreeIter                iter;
+    XfceSettingsMenuItem      *entry;
+    DialogCategory            *category;
+    gchar                     *name;
+    gchar                     *haystack;
+    gint                       score;
+}
+DialogItem;
+
+typedef struct
+{
+    gchar                     *word;
+    guint                      item;
+    gint                       weight;
+}
+DialogToken;
+
+typedef struct
+{
+    XfceSettingsManagerDialog *dialog;
+    gchar                     *key;
+    gchar                     *icon_name;
+    gchar                     *filename;
+    gint                       size;
+    guint                      generation;
+    GdkPixbuf                 *pixbuf;
+}
+IconJob;
+
 
 
 enum
 {
     COLUMN_NAME,
     COLUMN_ICON_NAME,
+    COLUMN_ICON,
     COLUMN_TOOLTIP,
-    COLUMN_MENU_ITEM,
-    COLUMN_MENU_DIRECTORY,
-    COLUMN_FILTER_TEXT,
+    COLUMN_ITEM_INDEX,
     N_COLUMNS
 };
 
+/* search ranking, a higher score is a better match */
+enum
+{
+    SCORE_FUZZY       = 1,
+    SCORE_SUBSTRING   = 2,
+    SCORE_CATEGORY    = 4,
+    SCORE_COMMENT     = 6,
+    SCORE_KEYWORD     = 8,
+    SCORE_NAME        = 12,
+    SCORE_NAME_PREFIX = 16
+};
+
 
 
 static void     xfce_settings_manager_dialog_finalize        (GObject                   *object);
@@ -119,6 +206,8 @@ static void     xfce_settings_manager_dialog_set_title       (XfceSettingsManage
                                                               const gchar               *icon_name,
                                                               const gchar               *subtitle);
 static void     xfce_settings_manager_dialog_go_back         (XfceSettingsManagerDialog *dialog);
+static void     xfce_settings_manager_dialog_item_free       (gpointer                   data);
+static void     xfce_settings_manager_dialog_index_clear     (XfceSettingsManagerDialog *dialog);
 static void     xfce_settings_manager_dialog_entry_changed   (GtkWidget                 *entry,
                                                               XfceSettingsManagerDialog *dialog);
 static gboolean xfce_settings_manager_dialog_entry_key_press (GtkWidget                 *entry,
@@ -127,9 +216,22 @@ static gboolean xfce_settings_manager_dialog_entry_key_press (GtkWidget
 static void     xfce_settings_manager_dialog_entry_clear     (GtkWidget                 *entry,
                                                               GtkEntryIconPosition       icon_pos,
                                                               GdkEvent                  *event);
+static void     xfce_settings_manager_dialog_menu_apply      (XfceSettingsManagerDialog *dialog,
+                                                              XfceSettingsMenu          *menu);
 static void     xfce_settings_manager_dialog_menu_reload     (XfceSettingsManagerDialog *dialog);
+static void     xfce_settings_manager_dialog_menu_unwatch    (XfceSettingsManagerDialog *dialog);
 static void     xfce_settings_manager_dialog_scroll_to_item  (GtkWidget                 *iconview,
                                                               XfceSettingsManagerDialog *dialog);
+static void     xfce_settings_manager_dialog_icons_changed   (GtkIconTheme              *icon_theme,
+                                                              XfceSettingsManagerDialog *dialog);
+
+
+
+/* pixbufs of the category icons by size and name */
+static GHashTable  *icon_cache = NULL;
+static GHashTable  *icon_pending = NULL;
+static guint        icon_generation = 0;
+static GThreadPool *icon_pool = NULL;
 
 
 
@@ -159,31 +261,36 @@ xfce_settings_manager_dialog_class_init (XfceSettingsManagerDialogClass *klass)
 static void
 xfce_settings_manager_dialog_init (XfceSettingsManagerDialog *dialog)
 {
-    GtkWidget *align;
-    GtkWidget *bbox;
-    GtkWidget *dialog_vbox;
-    GtkWidget *ebox;
-    GtkWidget *entry;
-    GtkWidget *hbox;
-    GtkWidget *header;
-    GtkWidget *scroll;
-    GtkWidget *viewport;
-    GList     *children;
-    gchar     *path;
+    GtkWidget        *align;
+    GtkWidget        *bbox;
+    GtkWidget        *dialog_vbox;
+    GtkWidget        *ebox;
+    GtkWidget        *entry;
+    GtkWidget        *hbox;
+    GtkWidget        *header;
+    GtkWidget        *scroll;
+    GtkWidget        *viewport;
+    GList            *children;
+    gchar            *path;
+    XfceSettingsMenu *menu;
+    gboolean          stale = FALSE;
+    GError           *error = NULL;
 
     dialog->channel = xfconf_channel_get ("xfce4-settings-manager");
 
     dialog->store = gtk_list_store_new (N_COLUMNS,
                                         G_TYPE_STRING,
                                         G_TYPE_STRING,
+                                        GDK_TYPE_PIXBUF,
                                         G_TYPE_STRING,
-                                        GARCON_TYPE_MENU_ITEM,
-                                        GARCON_TYPE_MENU_DIRECTORY,
-                                        G_TYPE_STRING);
+                                        G_TYPE_UINT);
+
+    dialog->items = g_ptr_array_new_with_free_func (xfce_settings_manager_dialog_item_free);
+    dialog->tokens = g_array_new (FALSE, FALSE, sizeof (DialogToken));
+    dialog->results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
     path = xfce_resource_lookup (XFCE_RESOURCE_CONFIG, "menus/xfce-settings-manager.menu");
-    dialog->menu = garcon_menu_new_for_path (path != NULL ? path : MENUFILE);
-    g_free (path);
+    dialog->menu_file = path != NULL ? path : g_strdup (MENUFILE);
 
     gtk_window_set_default_size (GTK_WINDOW (dialog),
       xfconf_channel_get_int (dialog->channel, "/last/window-width", 640),
@@ -276,10 +383,41 @@ xfce_settings_manager_dialog_init (XfceSettingsManagerDialog *dialog)
     gtk_viewport_set_shadow_type (GTK_VIEWPORT (viewport), GTK_SHADOW_NONE);
     gtk_widget_show (viewport);
 
-    xfce_settings_manager_dialog_menu_reload (dialog);
+    /* the sockets of the running dialogs, only the active one is visible */
+    dialog->socket_box = gtk_vbox_new (FALSE, 0);
+    gtk_container_add (GTK_CONTAINER (viewport), dialog->socket_box);
+    gtk_widget_show (dialog->socket_box);
 
-    g_signal_connect_swapped (G_OBJECT (dialog->menu), "reload-required",
-        G_CALLBACK (xfce_settings_manager_dialog_menu_reload), dialog);
+    /* the prefetched icons are outdated after a theme change */
+    g_signal_connect (G_OBJECT (gtk_icon_theme_get_default ()), "changed",
+        G_CALLBACK (xfce_settings_manager_dialog_icons_changed), dialog);
+
+    /* show the last snapshot, only parse the menu if it is outdated */
+    menu = xfce_settings_menu_load_cache (dialog->menu_file, &stale);
+    if (G_LIKELY (menu != NULL))
+    {
+        xfce_settings_manager_dialog_menu_apply (dialog, menu);
+        xfce_settings_menu_unref (menu);
+
+        if (stale)
+            xfce_settings_manager_dialog_menu_reload (dialog);
+    }
+    else
+    {
+        /* nothing to show yet, load the menu right away */
+        menu = xfce_settings_menu_load (dialog->menu_file, &error);
+        if (G_LIKELY (menu != NULL))
+        {
+            xfce_settings_menu_save_cache (menu, dialog->menu_file);
+            xfce_settings_manager_dialog_menu_apply (dialog, menu);
+            xfce_settings_menu_unref (menu);
+        }
+        else
+        {
+            g_critical ("Failed to load menu: %s", error->message);
+            g_error_free (error);
+        }
+    }
 }
 
 
@@ -295,10 +433,22 @@ xfce_settings_manager_dialog_finalize (GObject *object)
 
     g_free (dialog->filter_text);
 
-    if (dialog->socket_item != NULL)
-        g_object_unref (G_OBJECT (dialog->socket_item));
+    xfce_settings_manager_dialog_index_clear (dialog);
+    g_ptr_array_free (dialog->items, TRUE);
+    g_array_free (dialog->tokens, TRUE);
+    g_hash_table_destroy (dialog->results);
+
+    g_signal_handlers_disconnect_by_func (G_OBJECT (gtk_icon_theme_get_default ()),
+        G_CALLBACK (xfce_settings_manager_dialog_icons_changed), dialog);
+
+    /* the plugs are released with their sockets */
+    g_list_free (dialog->plugs);
+
+    xfce_settings_manager_dialog_menu_unwatch (dialog);
+    if (dialog->menu != NULL)
+        xfce_settings_menu_unref (dialog->menu);
+    g_free (dialog->menu_file);
 
-    g_object_unref (G_OBJECT (dialog->menu));
     g_object_unref (G_OBJECT (dialog->store));
 
     G_OBJECT_CLASS (xfce_settings_manager_dialog_parent_class)->finalize (object);
@@ -516,11 +666,9 @@ xfce_settings_manager_dialog_query_tooltip (GtkWidget                 *iconview,
                                             XfceSettingsManagerDialog *dialog)
 {
     GtkTreePath    *path;
-    GValue          value = { 0, };
     GtkTreeModel   *model;
     GtkTreeIter     iter;
-    GarconMenuItem *item;
-    const gchar    *comment;
+    gchar          *comment;
 
     if (keyboard_mode)
     {
@@ -537,15 +685,11 @@ xfce_settings_manager_dialog_query_tooltip (GtkWidget                 *iconview,
     model = exo_icon_view_get_model (EXO_ICON_VIEW (iconview));
     if (gtk_tree_model_get_iter (model, &iter, path))
     {
-        gtk_tree_model_get_value (model, &iter, COLUMN_MENU_ITEM, &value);
-        item = g_value_get_object (&value);
-        g_assert (GARCON_IS_MENU_ITEM (item));
-
-        comment = garcon_menu_item_get_comment (item);
+        gtk_tree_model_get (model, &iter, COLUMN_TOOLTIP, &comment, -1);
         if (!exo_str_is_empty (comment))
             gtk_tooltip_set_text (tooltip, comment);
 
-        g_value_unset (&value);
+        g_free (comment);
     }
 
     gtk_tree_path_free (path);
@@ -588,8 +732,6 @@ xfce_settings_manager_dialog_iconview_focus (GtkWidget                 *iconview
 static void
 xfce_settings_manager_dialog_go_back (XfceSettingsManagerDialog *dialog)
 {
-    GtkWidget *socket;
-
     /* make sure no cursor is shown */
     gdk_window_set_cursor (GTK_WIDGET (dialog)->window, NULL);
 
@@ -613,15 +755,286 @@ xfce_settings_manager_dialog_go_back (XfceSettingsManagerDialog *dialog)
     gtk_entry_set_text (GTK_ENTRY (dialog->filter_entry), "");
     gtk_widget_grab_focus (dialog->filter_entry);
 
-    socket = gtk_bin_get_child (GTK_BIN (dialog->socket_viewport));
-    if (G_LIKELY (socket != NULL))
-        gtk_widget_destroy (socket);
+    /* keep the dialog running, so it shows up instantly next time */
+    if (dialog->plug != NULL)
+    {
+        gtk_widget_hide (dialog->plug->socket);
+        dialog->plug = NULL;
+    }
+}
+
+
+
+static void
+xfce_settings_manager_dialog_item_free (gpointer data)
+{
+    DialogItem *item = data;
+
+    g_free (item->name);
+    g_free (item->haystack);
+    g_slice_free (DialogItem, item);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_index_clear (XfceSettingsManagerDialog *dialog)
+{
+    guint i;
+
+    for (i = 0; i < dialog->tokens->len; i++)
+        g_free (g_array_index (dialog->tokens, DialogToken, i).word);
+    g_array_set_size (dialog->tokens, 0);
+
+    g_ptr_array_set_size (dialog->items, 0);
+
+    g_hash_table_remove_all (dialog->results);
+    dialog->scores = NULL;
+}
+
+
+
+static gchar *
+xfce_settings_manager_dialog_normalize (const gchar *text)
+{
+    gchar *normalized;
+    gchar *casefolded;
+
+    normalized = g_utf8_normalize (text, -1, G_NORMALIZE_DEFAULT);
+    if (G_UNLIKELY (normalized == NULL))
+        return NULL;
+
+    casefolded = g_utf8_casefold (normalized, -1);
+    g_free (normalized);
+
+    return casefolded;
+}
+
+
+
+static gchar **
+xfce_settings_manager_dialog_tokenize (const gchar *normalized)
+{
+    GPtrArray   *words;
+    const gchar *p;
+    const gchar *start = NULL;
+
+    words = g_ptr_array_new ();
+
+    /* split on everything that is not a letter or digit */
+    for (p = normalized; ; p = g_utf8_next_char (p))
+    {
+        if (*p != '\0' && g_unichar_isalnum (g_utf8_get_char (p)))
+        {
+            if (start == NULL)
+                start = p;
+        }
+        else
+        {
+            if (start != NULL)
+                g_ptr_array_add (words, g_strndup (start, p - start));
+            start = NULL;
+
+            if (*p == '\0')
+                break;
+        }
+    }
+
+    g_ptr_array_add (words, NULL);
+
+    return (gchar **) g_ptr_array_free (words, FALSE);
+}
+
+
+
+static gint
+xfce_settings_manager_dialog_token_compare (gconstpointer a,
+                                            gconstpointer b)
+{
+    return strcmp (((const DialogToken *) a)->word,
+                   ((const DialogToken *) b)->word);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_index_text (XfceSettingsManagerDialog *dialog,
+                                         GString                   *haystack,
+                                         guint                      item,
+                                         const gchar               *text,
+                                         gint                       weight)
+{
+    gchar       *normalized;
+    gchar      **words;
+    guint        i;
+    DialogToken  token;
+
+    if (text == NULL || *text == '\0')
+        return;
+
+    normalized = xfce_settings_manager_dialog_normalize (text);
+    if (G_UNLIKELY (normalized == NULL))
+        return;
+
+    /* full text for substring matches */
+    g_string_append (haystack, normalized);
+    g_string_append_c (haystack, '\n');
+
+    /* the words for prefix matches, the array takes the strings */
+    words = xfce_settings_manager_dialog_tokenize (normalized);
+    for (i = 0; words[i] != NULL; i++)
+    {
+        token.word = words[i];
+        token.item = item;
+        token.weight = weight;
+        g_array_append_val (dialog->tokens, token);
+    }
+
+    g_free (words);
+    g_free (normalized);
+}
+
+
+
+static gboolean
+xfce_settings_manager_dialog_fuzzy_match (const gchar *name,
+                                          const gchar *text)
+{
+    const gchar *p;
+    gunichar     c;
+
+    if (g_utf8_strlen (text, -1) < SEARCH_FUZZY_LENGTH)
+        return FALSE;
+
+    /* all the query characters in the same order, ignoring spaces */
+    for (p = text; *p != '\0'; p = g_utf8_next_char (p))
+    {
+        c = g_utf8_get_char (p);
+        if (g_unichar_isspace (c))
+            continue;
+
+        name = g_utf8_strchr (name, -1, c);
+        if (name == NULL)
+            return FALSE;
+
+        name = g_utf8_next_char (name);
+    }
+
+    return TRUE;
+}
+
+
+
+static gint *
+xfce_settings_manager_dialog_search (XfceSettingsManagerDialog *dialog,
+                                     const gchar               *text)
+{
+    gint        *scores;
+    gint        *base = NULL;
+    gint        *best;
+    gchar      **terms;
+    guint        n_items = dialog->items->len;
+    guint        n_tokens = dialog->tokens->len;
+    guint        i, k;
+    guint        lower, upper, mid;
+    gint         weight;
+    DialogToken *token;
+    DialogItem  *item;
+
+    /* result of an earlier query, e.g. after a backspace */
+    scores = g_hash_table_lookup (dialog->results, text);
+    if (scores != NULL)
+        return scores;
+
+    /* if the user is typing ahead, only the previous matches can match,
+     * unless the previous query was too short for the fuzzy match */
+    if (dialog->scores != NULL
+        && dialog->filter_text != NULL
+        && g_str_has_prefix (text, dialog->filter_text)
+        && (g_utf8_strlen (dialog->filter_text, -1) >= SEARCH_FUZZY_LENGTH
+            || g_utf8_strlen (text, -1) < SEARCH_FUZZY_LENGTH))
+        base = dialog->scores;
+
+    scores = g_new0 (gint, MAX (n_items, 1));
+    best = g_new (gint, MAX (n_items, 1));
+
+    /* every word in the query should be the prefix of an indexed word */
+    terms = xfce_settings_manager_dialog_tokenize (text);
+    for (k = 0; terms[k] != NULL; k++)
+    {
+        memset (best, 0, n_items * sizeof (gint));
 
-    if (dialog->socket_item != NULL)
+        /* find the first token in the sorted index */
+        lower = 0;
+        upper = n_tokens;
+        while (lower < upper)
+        {
+            mid = (lower + upper) / 2;
+            token = &g_array_index (dialog->tokens, DialogToken, mid);
+            if (strcmp (token->word, terms[k]) < 0)
+                lower = mid + 1;
+            else
+                upper = mid;
+        }
+
+        for (; lower < n_tokens; lower++)
+        {
+            token = &g_array_index (dialog->tokens, DialogToken, lower);
+            if (!g_str_has_prefix (token->word, terms[k]))
+                break;
+
+            if (base != NULL && base[token->item] == 0)
+                continue;
+
+            /* complete words rank higher */
+            weight = token->weight;
+            if (strcmp (token->word, terms[k]) == 0)
+                weight *= 2;
+
+            best[token->item] = MAX (best[token->item], weight);
+        }
+
+        for (i = 0; i < n_items; i++)
+        {
+            if ((k == 0 || scores[i] > 0) && best[i] > 0)
+                scores[i] += best[i];
+            else
+                scores[i] = 0;
+        }
+    }
+    g_strfreev (terms);
+    g_free (best);
+
+    for (i = 0; i < n_items; i++)
     {
-        g_object_unref (G_OBJECT (dialog->socket_item));
-        dialog->socket_item = NULL;
+        if (base != NULL && base[i] == 0)
+        {
+            scores[i] = 0;
+            continue;
+        }
+
+        item = g_ptr_array_index (dialog->items, i);
+        if (scores[i] > 0)
+        {
+            if (g_str_has_prefix (item->name, text))
+                scores[i] += SCORE_NAME_PREFIX;
+        }
+        else if (strstr (item->haystack, text) != NULL)
+        {
+            scores[i] = SCORE_SUBSTRING;
+        }
+        else if (xfce_settings_manager_dialog_fuzzy_match (item->name, text))
+        {
+            scores[i] = SCORE_FUZZY;
+        }
     }
+
+    /* keep the cache small, the base is not used anymore */
+    if (g_hash_table_size (dialog->results) >= SEARCH_CACHE_SIZE)
+        g_hash_table_remove_all (dialog->results);
+    g_hash_table_insert (dialog->results, g_strdup (text), scores);
+
+    return scores;
 }
 
 
@@ -631,62 +1044,75 @@ xfce_settings_manager_dialog_entry_changed (GtkWidget                 *entry,
                                             XfceSettingsManagerDialog *dialog)
 {
     const gchar    *text;
-    gchar          *normalized;
     gchar          *filter_text;
+    gint           *scores;
+    gint            score;
+    guint           i;
     GList          *li;
     GtkTreeModel   *model;
-    gint            n_children;
     DialogCategory *category;
+    DialogItem     *item;
 
     text = gtk_entry_get_text (GTK_ENTRY (entry));
     if (text == NULL || *text == '\0')
-    {
         filter_text = NULL;
-    }
     else
+        filter_text = xfce_settings_manager_dialog_normalize (text);
+
+    /* check if we need to update */
+    if (g_strcmp0 (dialog->filter_text, filter_text) == 0)
     {
-        /* create independent search string */
-        normalized = g_utf8_normalize (text, -1, G_NORMALIZE_DEFAULT);
-        filter_text = g_utf8_casefold (normalized, -1);
-        g_free (normalized);
+        g_free (filter_text);
+        return;
     }
 
-    /* check if we need to update */
-    if (g_strcmp0 (dialog->filter_text, filter_text) != 0)
+    /* update entry */
+    if (dialog->filter_text == NULL || filter_text == NULL)
     {
-        /* update entry */
-        if (dialog->filter_text == NULL || filter_text == NULL)
-        {
-            gtk_entry_set_icon_from_stock (GTK_ENTRY (dialog->filter_entry),
-                GTK_ENTRY_ICON_SECONDARY,
-                filter_text == NULL ? GTK_STOCK_FIND : GTK_STOCK_CLEAR);
-            gtk_entry_set_icon_activatable (GTK_ENTRY (dialog->filter_entry),
-                GTK_ENTRY_ICON_SECONDARY, filter_text != NULL);
-        }
+        gtk_entry_set_icon_from_stock (GTK_ENTRY (dialog->filter_entry),
+            GTK_ENTRY_ICON_SECONDARY,
+            filter_text == NULL ? GTK_STOCK_FIND : GTK_STOCK_CLEAR);
+        gtk_entry_set_icon_activatable (GTK_ENTRY (dialog->filter_entry),
+            GTK_ENTRY_ICON_SECONDARY, filter_text != NULL);
+    }
 
-        /* set new filter */
-        g_free (dialog->filter_text);
-        dialog->filter_text = filter_text;
+    /* lookup before the old filter is released */
+    scores = filter_text != NULL ? xfce_settings_manager_dialog_search (dialog, filter_text) : NULL;
 
-        /* update the category models */
-        for (li = dialog->categories; li != NULL; li = li->next)
-        {
-            category = li->data;
+    /* set new filter */
+    g_free (dialog->filter_text);
+    dialog->filter_text = filter_text;
+    dialog->scores = scores;
 
-            /* update model filters */
-            model = exo_icon_view_get_model (EXO_ICON_VIEW (category->iconview));
-            gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (model));
+    /* update the item scores and remember which categories changed */
+    for (i = 0; i < dialog->items->len; i++)
+    {
+        item = g_ptr_array_index (dialog->items, i);
+        score = scores != NULL ? scores[i] : 1;
 
-            /* set visibility of the category */
-            n_children = gtk_tree_model_iter_n_children (model, NULL);
-            gtk_widget_set_visible (category->box, n_children > 0);
+        if ((item->score > 0) != (score > 0))
+        {
+            item->category->n_visible += score > 0 ? 1 : -1;
+            item->category->changed = TRUE;
         }
+
+        item->score = score;
     }
-    else
+
+    /* only refilter the category models with a different result set */
+    for (li = dialog->categories; li != NULL; li = li->next)
     {
-        g_free (dialog->filter_text);
-        dialog->filter_text = NULL;
-        g_free (filter_text);
+        category = li->data;
+        if (!category->changed)
+            continue;
+
+        category->changed = FALSE;
+
+        model = exo_icon_view_get_model (EXO_ICON_VIEW (category->iconview));
+        gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (model));
+
+        /* set visibility of the category */
+        gtk_widget_set_visible (category->box, category->n_visible > 0);
     }
 }
 
@@ -697,12 +1123,14 @@ xfce_settings_manager_dialog_entry_key_press (GtkWidget                 *entry,
                                               GdkEventKey               *event,
                                               XfceSettingsManagerDialog *dialog)
 {
-    GList          *li;
-    DialogCategory *category;
     GtkTreePath    *path;
+    GtkTreePath    *child_path;
     gint            n_visible_items;
     GtkTreeModel   *model;
     const gchar    *text;
+    guint           i;
+    DialogItem     *item;
+    DialogItem     *best;
 
     if (event->keyval == GDK_Escape)
     {
@@ -715,45 +1143,44 @@ xfce_settings_manager_dialog_entry_key_press (GtkWidget                 *entry,
     }
     else if (event->keyval == GDK_Return)
     {
-        /* count visible children */
+        /* count visible children and find the best ranked one */
         n_visible_items = 0;
-        for (li = dialog->categories; li != NULL; li = li->next)
+        best = NULL;
+        for (i = 0; i < dialog->items->len; i++)
         {
-            category = li->data;
-            if (gtk_widget_get_visible (category->box))
+            item = g_ptr_array_index (dialog->items, i);
+            if (item->score > 0)
             {
-                model = exo_icon_view_get_model (EXO_ICON_VIEW (category->iconview));
-                n_visible_items += gtk_tree_model_iter_n_children (model, NULL);
-
-                /* stop searching if there are more then 1 items */
-                if (n_visible_items > 1)
-                    break;
+                n_visible_items++;
+                if (best == NULL || item->score > best->score)
+                    best = item;
             }
         }
 
-        for (li = dialog->categories; li != NULL; li = li->next)
+        if (best != NULL)
         {
-            category = li->data;
-
-            /* find the first visible category */
-            if (!gtk_widget_get_visible (category->box))
-                continue;
+            model = exo_icon_view_get_model (EXO_ICON_VIEW (best->category->iconview));
+            child_path = gtk_tree_model_get_path (GTK_TREE_MODEL (dialog->store), &best->iter);
+            path = gtk_tree_model_filter_convert_child_path_to_path (GTK_TREE_MODEL_FILTER (model), child_path);
+            gtk_tree_path_free (child_path);
 
-            path = gtk_tree_path_new_first ();
-            if (n_visible_items == 1)
-            {
-                /* activate this one item */
-                exo_icon_view_item_activated (EXO_ICON_VIEW (category->iconview), path);
-            }
-            else
+            if (path != NULL)
             {
-                /* select first item in view */
-                exo_icon_view_set_cursor (EXO_ICON_VIEW (category->iconview),
-                                          path, NULL, FALSE);
-                gtk_widget_grab_focus (category->iconview);
+                if (n_visible_items == 1)
+                {
+                    /* activate this one item */
+                    exo_icon_view_item_activated (EXO_ICON_VIEW (best->category->iconview), path);
+                }
+                else
+                {
+                    /* select the best match in view */
+                    exo_icon_view_set_cursor (EXO_ICON_VIEW (best->category->iconview),
+                                              path, NULL, FALSE);
+                    gtk_widget_grab_focus (best->category->iconview);
+                    xfce_settings_manager_dialog_scroll_to_item (best->category->iconview, dialog);
+                }
+                gtk_tree_path_free (path);
             }
-            gtk_tree_path_free (path);
-            break;
         }
 
         return TRUE;
@@ -776,16 +1203,28 @@ xfce_settings_manager_dialog_entry_clear (GtkWidget            *entry,
 
 
 static void
-xfce_settings_manager_dialog_plug_added (GtkWidget                 *socket,
-                                         XfceSettingsManagerDialog *dialog)
+xfce_settings_manager_dialog_plug_show (XfceSettingsManagerDialog *dialog,
+                                        DialogPlug                *plug)
 {
+    GList      *li;
+    DialogPlug *other;
+
+    /* only one embedded dialog is visible at a time */
+    for (li = dialog->plugs; li != NULL; li = li->next)
+    {
+        other = li->data;
+        if (other != plug)
+            gtk_widget_hide (other->socket);
+    }
+
     /* set dialog information from desktop file */
     xfce_settings_manager_dialog_set_title (dialog,
-        garcon_menu_item_get_name (dialog->socket_item),
-        garcon_menu_item_get_icon_name (dialog->socket_item),
-        garcon_menu_item_get_comment (dialog->socket_item));
+        plug->item->name,
+        plug->item->icon_name,
+        plug->item->comment);
 
     /* show socket and hide the categories view */
+    gtk_widget_show (plug->socket);
     gtk_widget_show (dialog->socket_scroll);
     gtk_widget_hide (dialog->category_scroll);
 
@@ -801,79 +1240,156 @@ xfce_settings_manager_dialog_plug_added (GtkWidget                 *socket,
 
 
 static void
-xfce_settings_manager_dialog_plug_removed (GtkWidget                 *socket,
-                                           XfceSettingsManagerDialog *dialog)
+xfce_settings_manager_dialog_plug_free (gpointer  data,
+                                        GClosure *closure)
+{
+    DialogPlug                *plug = data;
+    XfceSettingsManagerDialog *dialog = plug->dialog;
+
+    dialog->plugs = g_list_remove (dialog->plugs, plug);
+    if (dialog->plug == plug)
+        dialog->plug = NULL;
+
+    xfce_settings_menu_unref (plug->menu);
+    g_slice_free (DialogPlug, plug);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_plug_added (GtkWidget  *socket,
+                                         DialogPlug *plug)
+{
+    plug->plugged = TRUE;
+
+    /* the socket is shown once the dialog is embedded, unless the
+     * user went back or opened another dialog in the meantime */
+    if (plug->dialog->plug == plug)
+        xfce_settings_manager_dialog_plug_show (plug->dialog, plug);
+}
+
+
+
+static gboolean
+xfce_settings_manager_dialog_plug_removed (GtkWidget  *socket,
+                                           DialogPlug *plug)
 {
+    XfceSettingsManagerDialog *dialog = plug->dialog;
+
     /* this shouldn't happen */
-    g_critical ("pluggable dialog \"%s\" crashed",
-                garcon_menu_item_get_command (dialog->socket_item));
+    g_critical ("pluggable dialog \"%s\" crashed", plug->item->command);
 
     /* restore dialog */
-    xfce_settings_manager_dialog_go_back (dialog);
+    if (dialog->plug == plug)
+        xfce_settings_manager_dialog_go_back (dialog);
+
+    /* let gtk destroy the socket, this releases the plug */
+    dialog->plugs = g_list_remove (dialog->plugs, plug);
+
+    return FALSE;
+}
+
+
+
+static DialogPlug *
+xfce_settings_manager_dialog_plug_lookup (XfceSettingsManagerDialog *dialog,
+                                          XfceSettingsMenuItem      *item)
+{
+    GList      *li;
+    DialogPlug *plug;
+
+    for (li = dialog->plugs; li != NULL; li = li->next)
+    {
+        plug = li->data;
+        if (g_strcmp0 (plug->item->desktop_id, item->desktop_id) == 0
+            && g_strcmp0 (plug->item->command, item->command) == 0)
+            return plug;
+    }
+
+    return NULL;
 }
 
 
 
 static void
 xfce_settings_manager_dialog_spawn (XfceSettingsManagerDialog *dialog,
-                                    GarconMenuItem            *item)
+                                    XfceSettingsMenuItem      *item)
 {
     const gchar    *command;
     gboolean        snotify;
     GdkScreen      *screen;
     GError         *error = NULL;
-    GFile          *desktop_file;
-    gchar          *filename;
-    XfceRc         *rc;
-    gboolean        pluggable = FALSE;
     gchar          *cmd;
     GtkWidget      *socket;
     GdkCursor      *cursor;
+    DialogPlug     *plug;
+    GList          *li;
 
-    g_return_if_fail (GARCON_IS_MENU_ITEM (item));
+    g_return_if_fail (item != NULL);
 
     screen = gtk_window_get_screen (GTK_WINDOW (dialog));
-    command = garcon_menu_item_get_command (item);
-
-    /* we need to read some more info from the desktop
-     *  file that is not supported by garcon */
-    desktop_file = garcon_menu_item_get_file (item);
-    filename = g_file_get_path (desktop_file);
-    g_object_unref (desktop_file);
+    command = item->command;
 
-    rc = xfce_rc_simple_open (filename, TRUE);
-    g_free (filename);
-    if (G_LIKELY (rc != NULL))
+    if (item->pluggable)
     {
-        pluggable = xfce_rc_read_bool_entry (rc, "X-XfcePluggable", FALSE);
-        if (pluggable)
+        /* the help information was read with the menu */
+        dialog->help_page = g_strdup (item->help_page);
+        dialog->help_component = g_strdup (item->help_component);
+        dialog->help_version = g_strdup (item->help_version);
+
+        /* show the dialog if it is still running */
+        plug = xfce_settings_manager_dialog_plug_lookup (dialog, item);
+        if (plug != NULL)
         {
-            dialog->help_page = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpPage", NULL));
-            dialog->help_component = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpComponent", NULL));
-            dialog->help_version = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpVersion", NULL));
+            dialog->plugs = g_list_remove (dialog->plugs, plug);
+            dialog->plugs = g_list_prepend (dialog->plugs, plug);
+            dialog->plug = plug;
+
+            /* a dialog that is still starting is shown from plug-added */
+            if (plug->plugged)
+            {
+                xfce_settings_manager_dialog_plug_show (dialog, plug);
+            }
+            else
+            {
+                cursor = gdk_cursor_new (GDK_WATCH);
+                gdk_window_set_cursor (GTK_WIDGET (dialog)->window, cursor);
+                gdk_cursor_unref (cursor);
+            }
+
+            return;
         }
 
-        xfce_rc_close (rc);
-    }
+        /* stop the least recently used dialog */
+        if (g_list_length (dialog->plugs) >= PLUG_CACHE_SIZE)
+        {
+            li = g_list_last (dialog->plugs);
+            plug = li->data;
+            dialog->plugs = g_list_delete_link (dialog->plugs, li);
+            gtk_widget_destroy (plug->socket);
+        }
 
-    if (pluggable)
-    {
         /* fake startup notification */
         cursor = gdk_cursor_new (GDK_WATCH);
         gdk_window_set_cursor (GTK_WIDGET (dialog)->window, cursor);
         gdk_cursor_unref (cursor);
 
-        /* create fresh socket */
-        socket = gtk_socket_new ();
-        gtk_container_add (GTK_CONTAINER (dialog->socket_viewport), socket);
-        g_signal_connect (G_OBJECT (socket), "plug-added",
-            G_CALLBACK (xfce_settings_manager_dialog_plug_added), dialog);
+        plug = g_slice_new0 (DialogPlug);
+        plug->dialog = dialog;
+        plug->menu = xfce_settings_menu_ref (dialog->menu);
+        plug->item = item;
+
+        /* create fresh socket, the plug is released with the socket */
+        plug->socket = socket = gtk_socket_new ();
+        gtk_box_pack_start (GTK_BOX (dialog->socket_box), socket, TRUE, TRUE, 0);
+        g_signal_connect_data (G_OBJECT (socket), "plug-added",
+            G_CALLBACK (xfce_settings_manager_dialog_plug_added), plug,
+            xfce_settings_manager_dialog_plug_free, 0);
         g_signal_connect (G_OBJECT (socket), "plug-removed",
-            G_CALLBACK (xfce_settings_manager_dialog_plug_removed), dialog);
-        gtk_widget_show (socket);
+            G_CALLBACK (xfce_settings_manager_dialog_plug_removed), plug);
 
-        /* for info when the plug is attached */
-        dialog->socket_item = g_object_ref (item);
+        dialog->plugs = g_list_prepend (dialog->plugs, plug);
+        dialog->plug = plug;
 
         /* spawn dialog with socket argument */
         cmd = g_strdup_printf ("%s --socket-id=%d", command, gtk_socket_get_id (GTK_SOCKET (socket)));
@@ -884,12 +1400,14 @@ xfce_settings_manager_dialog_spawn (XfceSettingsManagerDialog *dialog,
             xfce_dialog_show_error (GTK_WINDOW (dialog), error,
                                     _("Unable to start \"%s\""), command);
             g_error_free (error);
+
+            gtk_widget_destroy (socket);
         }
         g_free (cmd);
     }
     else
     {
-        snotify = garcon_menu_item_supports_startup_notification (item);
+        snotify = item->startup_notify;
         if (!xfce_spawn_command_line_on_screen (screen, command, FALSE, snotify, &error))
         {
             xfce_dialog_show_error (GTK_WINDOW (dialog), error,
@@ -908,17 +1426,17 @@ xfce_settings_manager_dialog_item_activated (ExoIconView               *iconview
 {
     GtkTreeModel   *model;
     GtkTreeIter     iter;
-    GarconMenuItem *item;
+    DialogItem     *item;
+    guint           idx;
 
     model = exo_icon_view_get_model (iconview);
     if (gtk_tree_model_get_iter (model, &iter, path))
     {
-        gtk_tree_model_get (model, &iter, COLUMN_MENU_ITEM, &item, -1);
-        g_assert (GARCON_IS_MENU_ITEM (item));
+        gtk_tree_model_get (model, &iter, COLUMN_ITEM_INDEX, &idx, -1);
+        g_assert (idx < dialog->items->len);
 
-        xfce_settings_manager_dialog_spawn (dialog, item);
-
-        g_object_unref (G_OBJECT (item));
+        item = g_ptr_array_index (dialog->items, idx);
+        xfce_settings_manager_dialog_spawn (dialog, item->entry);
     }
 }
 
@@ -929,27 +1447,18 @@ xfce_settings_manager_dialog_filter_category (GtkTreeModel *model,
                                               GtkTreeIter  *iter,
                                               gpointer      data)
 {
-    GValue          cat_val = { 0, };
-    GValue          filter_val = { 0, };
-    gboolean        visible;
     DialogCategory *category = data;
-    const gchar    *filter_text;
-
-    /* filter only the active category */
-    gtk_tree_model_get_value (model, iter, COLUMN_MENU_DIRECTORY, &cat_val);
-    visible = g_value_get_object (&cat_val) == G_OBJECT (category->directory);
-    g_value_unset (&cat_val);
+    GPtrArray      *items = category->dialog->items;
+    DialogItem     *item;
+    guint           idx;
 
-    /* filter search string */
-    if (visible && category->dialog->filter_text != NULL)
-    {
-        gtk_tree_model_get_value (model, iter, COLUMN_FILTER_TEXT, &filter_val);
-        filter_text = g_value_get_string (&filter_val);
-        visible = strstr (filter_text, category->dialog->filter_text) != NULL;
-        g_value_unset (&filter_val);
-    }
+    gtk_tree_model_get (model, iter, COLUMN_ITEM_INDEX, &idx, -1);
+    if (G_UNLIKELY (idx >= items->len))
+        return FALSE;
 
-    return visible;
+    /* filter only the active category and the search matches */
+    item = g_ptr_array_index (items, idx);
+    return item->category == category && item->score > 0;
 }
 
 
@@ -1017,6 +1526,241 @@ xfce_settings_manager_start_search (GtkWidget                 *iconview,
 
 
 
+static gint
+xfce_settings_manager_dialog_icon_size (void)
+{
+    gint width, height;
+
+    if (!gtk_icon_size_lookup (GTK_ICON_SIZE_DIALOG, &width, &height))
+        return 48;
+
+    return MAX (width, height);
+}
+
+
+
+static gchar *
+xfce_settings_manager_dialog_icon_key (const gchar *icon_name,
+                                       gint         size)
+{
+    return g_strdup_printf ("%d:%s", size, icon_name);
+}
+
+
+
+static GdkPixbuf *
+xfce_settings_manager_dialog_icon_lookup (const gchar *icon_name)
+{
+    GdkPixbuf *pixbuf;
+    gchar     *key;
+
+    if (icon_cache == NULL || icon_name == NULL)
+        return NULL;
+
+    key = xfce_settings_manager_dialog_icon_key (icon_name,
+        xfce_settings_manager_dialog_icon_size ());
+    pixbuf = g_hash_table_lookup (icon_cache, key);
+    g_free (key);
+
+    return pixbuf;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_icon_data (GtkCellLayout   *layout,
+                                        GtkCellRenderer *renderer,
+                                        GtkTreeModel    *model,
+                                        GtkTreeIter     *iter,
+                                        gpointer         data)
+{
+    GdkPixbuf *pixbuf;
+    gchar     *icon_name;
+
+    gtk_tree_model_get (model, iter, COLUMN_ICON, &pixbuf, COLUMN_ICON_NAME, &icon_name, -1);
+
+    /* let the icon theme load the icon if the prefetch did not finish
+     * yet, the pixbuf has to be unset to use the icon name */
+    if (G_LIKELY (pixbuf != NULL))
+        g_object_set (G_OBJECT (renderer), "pixbuf", pixbuf, NULL);
+    else
+        g_object_set (G_OBJECT (renderer), "pixbuf", NULL, "icon-name", icon_name, NULL);
+
+    if (pixbuf != NULL)
+        g_object_unref (G_OBJECT (pixbuf));
+    g_free (icon_name);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_icon_job_free (IconJob *job)
+{
+    if (job->dialog != NULL)
+        g_object_remove_weak_pointer (G_OBJECT (job->dialog), (gpointer *) &job->dialog);
+    if (job->pixbuf != NULL)
+        g_object_unref (G_OBJECT (job->pixbuf));
+    g_free (job->key);
+    g_free (job->icon_name);
+    g_free (job->filename);
+    g_slice_free (IconJob, job);
+}
+
+
+
+static gboolean
+xfce_settings_manager_dialog_icon_loaded (gpointer data)
+{
+    IconJob    *job = data;
+    DialogItem *item;
+    guint       i;
+
+    /* drop icons of the previous icon theme */
+    if (job->generation == icon_generation)
+    {
+        g_hash_table_remove (icon_pending, job->key);
+
+        if (job->pixbuf != NULL)
+        {
+            g_hash_table_insert (icon_cache, job->key, g_object_ref (G_OBJECT (job->pixbuf)));
+            job->key = NULL;
+
+            if (job->dialog != NULL)
+            {
+                for (i = 0; i < job->dialog->items->len; i++)
+                {
+                    item = g_ptr_array_index (job->dialog->items, i);
+                    if (g_strcmp0 (item->entry->icon_name, job->icon_name) == 0)
+                        gtk_list_store_set (job->dialog->store, &item->iter,
+                                            COLUMN_ICON, job->pixbuf, -1);
+                }
+            }
+        }
+    }
+
+    xfce_settings_manager_dialog_icon_job_free (job);
+
+    return FALSE;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_icon_load (gpointer data,
+                                        gpointer user_data)
+{
+    IconJob *job = data;
+
+    /* decoding and scaling the svgs is the expensive part */
+    job->pixbuf = gdk_pixbuf_new_from_file_at_size (job->filename, job->size, job->size, NULL);
+
+    g_idle_add (xfce_settings_manager_dialog_icon_loaded, job);
+}
+
+
+
+static void
+xfce_settings_manager_dialog_icons_prefetch (XfceSettingsManagerDialog *dialog)
+{
+    GtkIconTheme *icon_theme;
+    GtkIconInfo  *icon_info;
+    DialogItem   *item;
+    const gchar  *icon_name;
+    gchar        *key;
+    gchar        *filename;
+    gint          size;
+    guint         i;
+    IconJob      *job;
+
+    if (G_UNLIKELY (icon_cache == NULL))
+    {
+        icon_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+        icon_pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        icon_pool = g_thread_pool_new (xfce_settings_manager_dialog_icon_load, NULL,
+                                       ICON_THREADS, FALSE, NULL);
+    }
+
+    icon_theme = gtk_icon_theme_get_default ();
+    size = xfce_settings_manager_dialog_icon_size ();
+
+    for (i = 0; i < dialog->items->len; i++)
+    {
+        item = g_ptr_array_index (dialog->items, i);
+        icon_name = item->entry->icon_name;
+        if (icon_name == NULL || *icon_name == '\0')
+            continue;
+
+        key = xfce_settings_manager_dialog_icon_key (icon_name, size);
+        if (g_hash_table_lookup (icon_cache, key) != NULL
+            || g_hash_table_lookup (icon_pending, key) != NULL)
+        {
+            g_free (key);
+            continue;
+        }
+
+        /* only the file lookup happens here, that is cheap with the icon cache */
+        if (g_path_is_absolute (icon_name))
+        {
+            filename = g_strdup (icon_name);
+        }
+        else
+        {
+            icon_info = gtk_icon_theme_lookup_icon (icon_theme, icon_name, size, 0);
+            filename = icon_info != NULL ? g_strdup (gtk_icon_info_get_filename (icon_info)) : NULL;
+            if (icon_info != NULL)
+                gtk_icon_info_free (icon_info);
+        }
+
+        /* builtin or missing icons are left to the renderer */
+        if (filename == NULL)
+        {
+            g_free (key);
+            continue;
+        }
+
+        g_hash_table_insert (icon_pending, g_strdup (key), GINT_TO_POINTER (TRUE));
+
+        job = g_slice_new0 (IconJob);
+        job->dialog = dialog;
+        job->key = key;
+        job->icon_name = g_strdup (icon_name);
+        job->filename = filename;
+        job->size = size;
+        job->generation = icon_generation;
+        g_object_add_weak_pointer (G_OBJECT (dialog), (gpointer *) &job->dialog);
+
+        g_thread_pool_push (icon_pool, job, NULL);
+    }
+}
+
+
+
+static void
+xfce_settings_manager_dialog_icons_changed (GtkIconTheme              *icon_theme,
+                                            XfceSettingsManagerDialog *dialog)
+{
+    DialogItem *item;
+    guint       i;
+
+    if (icon_cache == NULL)
+        return;
+
+    /* forget the icons and the running jobs */
+    icon_generation++;
+    g_hash_table_remove_all (icon_cache);
+    g_hash_table_remove_all (icon_pending);
+
+    for (i = 0; i < dialog->items->len; i++)
+    {
+        item = g_ptr_array_index (dialog->items, i);
+        gtk_list_store_set (dialog->store, &item->iter, COLUMN_ICON, NULL, -1);
+    }
+
+    xfce_settings_manager_dialog_icons_prefetch (dialog);
+}
+
+
+
 static void
 xfce_settings_manager_dialog_category_free (gpointer data)
 {
@@ -1025,7 +1769,6 @@ xfce_settings_manager_dialog_category_free (gpointer data)
 
     dialog->categories = g_list_remove (dialog->categories, category);
 
-    g_object_unref (G_OBJECT (category->directory));
     g_slice_free (DialogCategory, category);
 }
 
@@ -1033,7 +1776,7 @@ xfce_settings_manager_dialog_category_free (gpointer data)
 
 static void
 xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
-                                           GarconMenuDirectory       *directory)
+                                           DialogCategory            *category)
 {
     GtkTreeModel    *filter;
     GtkWidget       *alignment;
@@ -1043,11 +1786,6 @@ xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
     GtkWidget       *vbox;
     PangoAttrList   *attrs;
     GtkCellRenderer *render;
-    DialogCategory  *category;
-
-    category = g_slice_new0 (DialogCategory);
-    category->directory = (GarconMenuDirectory *) g_object_ref (G_OBJECT (directory));
-    category->dialog = dialog;
 
     /* filter category from main store */
     filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (dialog->store), NULL);
@@ -1060,7 +1798,7 @@ xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
     gtk_widget_show (vbox);
 
     /* create a label for the category title */
-    label = gtk_label_new (garcon_menu_directory_get_name (directory));
+    label = gtk_label_new (category->name);
     attrs = pango_attr_list_new ();
     pango_attr_list_insert (attrs, pango_attr_weight_new (PANGO_WEIGHT_BOLD));
     gtk_label_set_attributes (GTK_LABEL (label), attrs);
@@ -1110,7 +1848,8 @@ xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
 
     render = gtk_cell_renderer_pixbuf_new ();
     gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (iconview), render, FALSE);
-    gtk_cell_layout_add_attribute (GTK_CELL_LAYOUT (iconview), render, "icon-name", COLUMN_ICON_NAME);
+    gtk_cell_layout_set_cell_data_func (GTK_CELL_LAYOUT (iconview), render,
+        xfce_settings_manager_dialog_icon_data, NULL, NULL);
     g_object_set (G_OBJECT (render),
                   "stock-size", GTK_ICON_SIZE_DIALOG,
                   "follow-state", TRUE,
@@ -1132,62 +1871,95 @@ xfce_settings_manager_dialog_add_category (XfceSettingsManagerDialog *dialog,
 
 
 static void
-xfce_settings_manager_dialog_menu_collect (GarconMenu  *menu,
-                                           GList      **items)
+xfce_settings_manager_dialog_menu_changed (GFileMonitor              *monitor,
+                                           GFile                     *file,
+                                           GFile                     *other_file,
+                                           GFileMonitorEvent          event_type,
+                                           XfceSettingsManagerDialog *dialog)
 {
-    GList *elements, *li;
+    /* wait until a changed file is written */
+    if (event_type == G_FILE_MONITOR_EVENT_CREATED
+        || event_type == G_FILE_MONITOR_EVENT_DELETED
+        || event_type == G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
+        xfce_settings_manager_dialog_menu_reload (dialog);
+}
+
 
-    g_return_if_fail (GARCON_IS_MENU (menu));
 
-    elements = garcon_menu_get_elements (menu);
+static void
+xfce_settings_manager_dialog_menu_unwatch (XfceSettingsManagerDialog *dialog)
+{
+    GFileMonitor *monitor;
+    guint         n;
 
-    for (li = elements; li != NULL; li = li->next)
+    if (dialog->menu_monitors == NULL)
+        return;
+
+    for (n = 0; n < dialog->menu_monitors->len; n++)
     {
-        if (GARCON_IS_MENU_ITEM (li->data))
-        {
-            /* only add visible items */
-            if (garcon_menu_element_get_visible (li->data))
-                *items = g_list_prepend (*items, li->data);
-        }
-        else if (GARCON_IS_MENU (li->data))
-        {
-            /* we collect only 1 level deep in a category, so
-             * add the submenu items too (should never happen tho) */
-            xfce_settings_manager_dialog_menu_collect (li->data, items);
-        }
+        monitor = g_ptr_array_index (dialog->menu_monitors, n);
+        g_signal_handlers_disconnect_by_func (G_OBJECT (monitor),
+            G_CALLBACK (xfce_settings_manager_dialog_menu_changed), dialog);
+        g_file_monitor_cancel (monitor);
     }
 
-    g_list_free (elements);
+    g_ptr_array_free (dialog->menu_monitors, TRUE);
+    dialog->menu_monitors = NULL;
 }
 
 
 
-static gint
-xfce_settings_manager_dialog_menu_sort (gconstpointer a,
-                                        gconstpointer b)
+static void
+xfce_settings_manager_dialog_menu_watch (XfceSettingsManagerDialog *dialog,
+                                         XfceSettingsMenu          *menu)
 {
-    return g_utf8_collate (garcon_menu_item_get_name (GARCON_MENU_ITEM (a)),
-                           garcon_menu_item_get_name (GARCON_MENU_ITEM (b)));
+    GFileMonitor *monitor;
+    GFile        *file;
+    guint         n;
+
+    xfce_settings_manager_dialog_menu_unwatch (dialog);
+
+    /* the same files the stamp of the snapshot is made of, so garcon
+     * does not have to load the menu only to watch it */
+    dialog->menu_monitors = g_ptr_array_new_with_free_func (g_object_unref);
+    for (n = 0; n < menu->sources->len; n++)
+    {
+        file = g_file_new_for_path (g_ptr_array_index (menu->sources, n));
+
+        /* the menu file comes first, then the directories */
+        if (n == 0)
+            monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, NULL);
+        else
+            monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
+        g_object_unref (G_OBJECT (file));
+
+        if (G_UNLIKELY (monitor == NULL))
+            continue;
+
+        g_signal_connect (G_OBJECT (monitor), "changed",
+            G_CALLBACK (xfce_settings_manager_dialog_menu_changed), dialog);
+        g_ptr_array_add (dialog->menu_monitors, monitor);
+    }
 }
 
 
 
 static void
-xfce_settings_manager_dialog_menu_reload (XfceSettingsManagerDialog *dialog)
+xfce_settings_manager_dialog_menu_apply (XfceSettingsManagerDialog *dialog,
+                                         XfceSettingsMenu          *menu)
 {
-    GError              *error = NULL;
-    GList               *elements, *li;
-    GList               *lnext;
-    GarconMenuDirectory *directory;
-    GList               *items, *lp;
-    gint                 i = 0;
-    gchar               *item_text;
-    gchar               *normalized;
-    gchar               *filter_text;
-    DialogCategory      *category;
+    GList                    *li;
+    GList                    *lnext;
+    guint                     n, m;
+    gint                      i = 0;
+    GString                  *haystack;
+    DialogCategory           *category;
+    DialogItem               *item;
+    XfceSettingsMenuCategory *menu_category;
+    XfceSettingsMenuItem     *entry;
 
     g_return_if_fail (XFCE_IS_SETTINGS_MANAGER_DIALOG (dialog));
-    g_return_if_fail (GARCON_IS_MENU (dialog->menu));
+    g_return_if_fail (menu != NULL);
 
     if (dialog->categories != NULL)
     {
@@ -1204,67 +1976,178 @@ xfce_settings_manager_dialog_menu_reload (XfceSettingsManagerDialog *dialog)
         gtk_list_store_clear (GTK_LIST_STORE (dialog->store));
     }
 
-    if (garcon_menu_load (dialog->menu, NULL, &error))
+    /* drop the search index, the active filter is applied again below */
+    xfce_settings_manager_dialog_index_clear (dialog);
+    g_free (dialog->filter_text);
+    dialog->filter_text = NULL;
+
+    /* the items point into the new snapshot */
+    if (dialog->menu != NULL)
+        xfce_settings_menu_unref (dialog->menu);
+    dialog->menu = xfce_settings_menu_ref (menu);
+
+    /* reload when one of the sources of the snapshot changes */
+    xfce_settings_manager_dialog_menu_watch (dialog, menu);
+
+    for (n = 0; n < menu->categories->len; n++)
     {
-        /* get all menu elements (preserve layout) */
-        elements = garcon_menu_get_elements (dialog->menu);
-        for (li = elements; li != NULL; li = li->next)
+        menu_category = g_ptr_array_index (menu->categories, n);
+
+        /* the filter of the category view needs it for the items */
+        category = g_slice_new0 (DialogCategory);
+        category->name = menu_category->name;
+        category->dialog = dialog;
+
+        /* insert new items in main store, they are sorted in the snapshot */
+        for (m = 0; m < menu_category->items->len; m++)
         {
-            /* only accept toplevel menus */
-            if (!GARCON_IS_MENU (li->data))
-                continue;
+            entry = g_ptr_array_index (menu_category->items, m);
+
+            item = g_slice_new0 (DialogItem);
+            item->entry = entry;
+            item->category = category;
+            item->name = xfce_settings_manager_dialog_normalize (entry->name);
+            item->score = 1;
+            if (G_UNLIKELY (item->name == NULL))
+                item->name = g_strdup ("");
+
+            /* index the search strings */
+            haystack = g_string_new (NULL);
+            xfce_settings_manager_dialog_index_text (dialog, haystack, dialog->items->len,
+                entry->name, SCORE_NAME);
+            xfce_settings_manager_dialog_index_text (dialog, haystack, dialog->items->len,
+                entry->comment, SCORE_COMMENT);
+            xfce_settings_manager_dialog_index_text (dialog, haystack, dialog->items->len,
+                entry->keywords, SCORE_KEYWORD);
+            xfce_settings_manager_dialog_index_text (dialog, haystack, dialog->items->len,
+                menu_category->name, SCORE_CATEGORY);
+            item->haystack = g_string_free (haystack, FALSE);
+
+            g_ptr_array_add (dialog->items, item);
+            category->n_visible++;
+
+            gtk_list_store_insert_with_values (dialog->store, &item->iter, i++,
+                COLUMN_NAME, entry->name,
+                COLUMN_ICON_NAME, entry->icon_name,
+                COLUMN_ICON, xfce_settings_manager_dialog_icon_lookup (entry->icon_name),
+                COLUMN_TOOLTIP, entry->comment,
+                COLUMN_ITEM_INDEX, dialog->items->len - 1, -1);
+        }
 
-            directory = garcon_menu_get_directory (li->data);
-            if (G_UNLIKELY (directory == NULL))
-                continue;
+        /* add the new category to the box */
+        xfce_settings_manager_dialog_add_category (dialog, category);
+    }
 
-            items = NULL;
+    /* sort the index for prefix lookups */
+    g_array_sort (dialog->tokens, xfce_settings_manager_dialog_token_compare);
 
-            xfce_settings_manager_dialog_menu_collect (li->data, &items);
+    /* load the missing icons in the background */
+    xfce_settings_manager_dialog_icons_prefetch (dialog);
 
-            /* add the new category if it has visible items */
-            if (G_LIKELY (items != NULL))
-            {
-                /* insert new items in main store */
-                items = g_list_sort (items, xfce_settings_manager_dialog_menu_sort);
-                for (lp = items; lp != NULL; lp = lp->next)
-                {
-                    /* create independent search string */
-                    item_text = g_strdup_printf ("%s\n%s",
-                        garcon_menu_item_get_name (lp->data),
-                        garcon_menu_item_get_comment (lp->data));
-                    normalized = g_utf8_normalize (item_text, -1, G_NORMALIZE_DEFAULT);
-                    g_free (item_text);
-                    filter_text = g_utf8_casefold (normalized, -1);
-                    g_free (normalized);
-
-                    gtk_list_store_insert_with_values (dialog->store, NULL, i++,
-                        COLUMN_NAME, garcon_menu_item_get_name (lp->data),
-                        COLUMN_ICON_NAME, garcon_menu_item_get_icon_name (lp->data),
-                        COLUMN_TOOLTIP, garcon_menu_item_get_comment (lp->data),
-                        COLUMN_MENU_ITEM, lp->data,
-                        COLUMN_MENU_DIRECTORY, directory,
-                        COLUMN_FILTER_TEXT, filter_text, -1);
-
-                    g_free (filter_text);
-                }
-                g_list_free (items);
+    /* restore the search results */
+    xfce_settings_manager_dialog_entry_changed (dialog->filter_entry, dialog);
+}
 
-                /* add the new category to the box */
-                xfce_settings_manager_dialog_add_category (dialog, directory);
-            }
+
+
+typedef struct
+{
+    XfceSettingsManagerDialog *dialog;
+    gchar                     *filename;
+    XfceSettingsMenu          *menu;
+    GError                    *error;
+}
+MenuLoadJob;
+
+
+
+static gboolean
+xfce_settings_manager_dialog_menu_loaded (gpointer data)
+{
+    MenuLoadJob               *job = data;
+    XfceSettingsManagerDialog *dialog = job->dialog;
+
+    if (G_LIKELY (dialog != NULL))
+    {
+        g_object_remove_weak_pointer (G_OBJECT (dialog), (gpointer *) &job->dialog);
+        dialog->menu_loading = FALSE;
+
+        if (job->menu != NULL)
+        {
+            xfce_settings_manager_dialog_menu_apply (dialog, job->menu);
+        }
+        else
+        {
+            g_critical ("Failed to load menu: %s", job->error->message);
         }
 
-        g_list_free (elements);
+        /* the menu changed again while loading */
+        if (dialog->menu_reload)
+        {
+            dialog->menu_reload = FALSE;
+            xfce_settings_manager_dialog_menu_reload (dialog);
+        }
     }
-    else
+
+    if (job->menu != NULL)
+        xfce_settings_menu_unref (job->menu);
+    if (job->error != NULL)
+        g_error_free (job->error);
+    g_free (job->filename);
+    g_slice_free (MenuLoadJob, job);
+
+    return FALSE;
+}
+
+
+
+static gpointer
+xfce_settings_manager_dialog_menu_load (gpointer data)
+{
+    MenuLoadJob *job = data;
+
+    /* parse the menu and all the desktop files outside the main loop */
+    job->menu = xfce_settings_menu_load (job->filename, &job->error);
+    if (job->menu != NULL)
+        xfce_settings_menu_save_cache (job->menu, job->filename);
+
+    g_idle_add (xfce_settings_manager_dialog_menu_loaded, job);
+
+    return NULL;
+}
+
+
+
+static void
+xfce_settings_manager_dialog_menu_reload (XfceSettingsManagerDialog *dialog)
+{
+    MenuLoadJob *job;
+
+    g_return_if_fail (XFCE_IS_SETTINGS_MANAGER_DIALOG (dialog));
+
+    /* reload once more when the running load is finished */
+    if (dialog->menu_loading)
+    {
+        dialog->menu_reload = TRUE;
+        return;
+    }
+
+    job = g_slice_new0 (MenuLoadJob);
+    job->dialog = dialog;
+    job->filename = g_strdup (dialog->menu_file);
+    g_object_add_weak_pointer (G_OBJECT (dialog), (gpointer *) &job->dialog);
+
+    dialog->menu_loading = TRUE;
+
+    if (g_thread_create (xfce_settings_manager_dialog_menu_load, job, FALSE, NULL) == NULL)
     {
-        g_critical ("Failed to load menu: %s", error->message);
-        g_error_free (error);
+        /* load in the main loop then */
+        xfce_settings_manager_dialog_menu_load (job);
     }
 }
 
 
+
 GtkWidget *
 xfce_settings_manager_dialog_new (void)
 {
@@ -1277,34 +2160,23 @@ gboolean
 xfce_settings_manager_dialog_show_dialog (XfceSettingsManagerDialog *dialog,
                                           const gchar               *dialog_name)
 {
-    GtkTreeModel   *model = GTK_TREE_MODEL (dialog->store);
-    GtkTreeIter     iter;
-    GarconMenuItem *item;
-    const gchar    *desktop_id;
+    DialogItem     *item;
     gchar          *name;
+    guint           i;
     gboolean        found = FALSE;
 
     g_return_val_if_fail (XFCE_IS_SETTINGS_MANAGER_DIALOG (dialog), FALSE);
 
     name = g_strdup_printf ("%s.desktop", dialog_name);
 
-    if (gtk_tree_model_get_iter_first (model, &iter))
+    for (i = 0; !found && i < dialog->items->len; i++)
     {
-        do
+        item = g_ptr_array_index (dialog->items, i);
+        if (g_strcmp0 (item->entry->desktop_id, name) == 0)
         {
-             gtk_tree_model_get (model, &iter, COLUMN_MENU_ITEM, &item, -1);
-             g_assert (GARCON_IS_MENU_ITEM (item));
-
-             desktop_id = garcon_menu_item_get_desktop_id (item);
-             if (g_strcmp0 (desktop_id, name) == 0)
-             {
-                  xfce_settings_manager_dialog_spawn (dialog, item);
-                  found = TRUE;
-             }
-
-             g_object_unref (G_OBJECT (item));
+            xfce_settings_manager_dialog_spawn (dialog, item->entry);
+            found = TRUE;
         }
-        while (!found && gtk_tree_model_iter_next (model, &iter));
     }
 
     g_free (name);
@@ -0,0 +1,614 @@
+/*
+ * Copyright (C) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib/gstdio.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include "xfce-settings-menu.h"
+
+
+
+/* bump this when the layout of the cache file changes */
+#define MENU_CACHE_VERSION (2)
+#define MENU_CACHE_FILE    "xfce4" G_DIR_SEPARATOR_S "settings-manager" G_DIR_SEPARATOR_S "menu.cache"
+
+
+
+static void
+xfce_settings_menu_item_free (gpointer data)
+{
+    XfceSettingsMenuItem *item = data;
+
+    g_free (item->desktop_id);
+    g_free (item->filename);
+    g_free (item->name);
+    g_free (item->collate_key);
+    g_free (item->icon_name);
+    g_free (item->comment);
+    g_free (item->command);
+    g_free (item->keywords);
+    g_free (item->help_page);
+    g_free (item->help_component);
+    g_free (item->help_version);
+    g_slice_free (XfceSettingsMenuItem, item);
+}
+
+
+
+static void
+xfce_settings_menu_category_free (gpointer data)
+{
+    XfceSettingsMenuCategory *category = data;
+
+    g_free (category->name);
+    g_ptr_array_free (category->items, TRUE);
+    g_slice_free (XfceSettingsMenuCategory, category);
+}
+
+
+
+static XfceSettingsMenu *
+xfce_settings_menu_new (void)
+{
+    XfceSettingsMenu *menu;
+
+    menu = g_slice_new0 (XfceSettingsMenu);
+    menu->ref_count = 1;
+    menu->categories = g_ptr_array_new_with_free_func (xfce_settings_menu_category_free);
+    menu->sources = g_ptr_array_new_with_free_func (g_free);
+
+    return menu;
+}
+
+
+
+static XfceSettingsMenuCategory *
+xfce_settings_menu_category_new (const gchar *name)
+{
+    XfceSettingsMenuCategory *category;
+
+    category = g_slice_new0 (XfceSettingsMenuCategory);
+    category->name = g_strdup (name != NULL ? name : "");
+    category->items = g_ptr_array_new_with_free_func (xfce_settings_menu_item_free);
+
+    return category;
+}
+
+
+
+static void
+xfce_settings_menu_stamp_dir (const gchar *path,
+                              GString     *stamp,
+                              GPtrArray   *sources)
+{
+    GDir        *dir;
+    const gchar *name;
+    gchar       *filename;
+    struct stat  statb;
+
+    if (g_stat (path, &statb) != 0 || !S_ISDIR (statb.st_mode))
+        return;
+
+    g_string_append_printf (stamp, "%s=%" G_GINT64_FORMAT ";",
+                            path, (gint64) statb.st_mtime);
+    g_ptr_array_add (sources, g_strdup (path));
+
+    /* adding or removing a desktop file only changes
+     * the mtime of the directory it lives in */
+    dir = g_dir_open (path, 0, NULL);
+    if (G_LIKELY (dir != NULL))
+    {
+        while ((name = g_dir_read_name (dir)) != NULL)
+        {
+            if (g_str_has_suffix (name, ".desktop")
+                || g_str_has_suffix (name, ".directory"))
+                continue;
+
+            filename = g_build_filename (path, name, NULL);
+            xfce_settings_menu_stamp_dir (filename, stamp, sources);
+            g_free (filename);
+        }
+
+        g_dir_close (dir);
+    }
+}
+
+
+
+static gchar *
+xfce_settings_menu_stamp (const gchar *filename,
+                          GPtrArray   *sources)
+{
+    GString      *stamp;
+    gchar       **dirs;
+    gchar        *path;
+    guint         i;
+    struct stat   statb;
+    gchar        *checksum;
+
+    stamp = g_string_new (NULL);
+
+    /* names are localized */
+    g_string_append (stamp, g_get_language_names ()[0]);
+    g_string_append_c (stamp, ';');
+
+    /* the menu file itself */
+    if (g_stat (filename, &statb) == 0)
+        g_string_append_printf (stamp, "%s=%" G_GINT64_FORMAT ";",
+                                filename, (gint64) statb.st_mtime);
+    g_ptr_array_add (sources, g_strdup (filename));
+
+    /* the directories garcon reads the desktop files from */
+    dirs = xfce_resource_dirs (XFCE_RESOURCE_DATA);
+    for (i = 0; dirs != NULL && dirs[i] != NULL; i++)
+    {
+        path = g_build_filename (dirs[i], "applications", NULL);
+        xfce_settings_menu_stamp_dir (path, stamp, sources);
+        g_free (path);
+
+        path = g_build_filename (dirs[i], "desktop-directories", NULL);
+        xfce_settings_menu_stamp_dir (path, stamp, sources);
+        g_free (path);
+    }
+    g_strfreev (dirs);
+
+    checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, stamp->str, stamp->len);
+    g_string_free (stamp, TRUE);
+
+    return checksum;
+}
+
+
+
+static void
+xfce_settings_menu_item_read_extra (GarconMenuItem       *garcon_item,
+                                    XfceSettingsMenuItem *item)
+{
+    XfceRc   *rc;
+#if GARCON_CHECK_VERSION (0, 6, 2)
+    GList    *li;
+    GString  *text;
+
+    /* garcon already parsed the keywords with the desktop file */
+    li = garcon_menu_item_get_keywords (garcon_item);
+    if (li != NULL)
+    {
+        text = g_string_new (li->data);
+        for (li = li->next; li != NULL; li = li->next)
+        {
+            g_string_append_c (text, ' ');
+            g_string_append (text, li->data);
+        }
+
+        item->keywords = g_string_free (text, FALSE);
+    }
+#else
+    gchar   **keywords;
+#endif
+
+    if (G_UNLIKELY (item->filename == NULL))
+        return;
+
+    /* the pluggable information is not supported by garcon,
+     * read it from the desktop file */
+    rc = xfce_rc_simple_open (item->filename, TRUE);
+    if (G_LIKELY (rc != NULL))
+    {
+        xfce_rc_set_group (rc, "Desktop Entry");
+
+#if !GARCON_CHECK_VERSION (0, 6, 2)
+        /* this version of garcon does not read the keywords */
+        keywords = xfce_rc_read_list_entry (rc, "Keywords", ";");
+        if (keywords != NULL)
+        {
+            item->keywords = g_strjoinv (" ", keywords);
+            g_strfreev (keywords);
+        }
+#endif
+
+        item->pluggable = xfce_rc_read_bool_entry (rc, "X-XfcePluggable", FALSE);
+        if (item->pluggable)
+        {
+            item->help_page = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpPage", NULL));
+            item->help_component = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpComponent", NULL));
+            item->help_version = g_strdup (xfce_rc_read_entry (rc, "X-XfceHelpVersion", NULL));
+        }
+
+        xfce_rc_close (rc);
+    }
+}
+
+
+
+static gint
+xfce_settings_menu_item_compare (gconstpointer a,
+                                 gconstpointer b)
+{
+    const XfceSettingsMenuItem *item_a = *(XfceSettingsMenuItem **) a;
+    const XfceSettingsMenuItem *item_b = *(XfceSettingsMenuItem **) b;
+
+    return strcmp (item_a->collate_key, item_b->collate_key);
+}
+
+
+
+static void
+xfce_settings_menu_collect (GarconMenu                *garcon_menu,
+                            XfceSettingsMenuCategory  *category)
+{
+    GList                *elements, *li;
+    GarconMenuItem       *garcon_item;
+    XfceSettingsMenuItem *item;
+    GFile                *desktop_file;
+    const gchar          *name;
+
+    elements = garcon_menu_get_elements (garcon_menu);
+
+    for (li = elements; li != NULL; li = li->next)
+    {
+        if (GARCON_IS_MENU_ITEM (li->data))
+        {
+            /* only add visible items */
+            if (!garcon_menu_element_get_visible (li->data))
+                continue;
+
+            garcon_item = GARCON_MENU_ITEM (li->data);
+            name = garcon_menu_item_get_name (garcon_item);
+            if (G_UNLIKELY (name == NULL))
+                name = "";
+
+            item = g_slice_new0 (XfceSettingsMenuItem);
+            item->desktop_id = g_strdup (garcon_menu_item_get_desktop_id (garcon_item));
+            item->name = g_strdup (name);
+            item->collate_key = g_utf8_collate_key (name, -1);
+            item->icon_name = g_strdup (garcon_menu_item_get_icon_name (garcon_item));
+            item->comment = g_strdup (garcon_menu_item_get_comment (garcon_item));
+            item->command = g_strdup (garcon_menu_item_get_command (garcon_item));
+            item->startup_notify = garcon_menu_item_supports_startup_notification (garcon_item);
+
+            desktop_file = garcon_menu_item_get_file (garcon_item);
+            item->filename = g_file_get_path (desktop_file);
+            g_object_unref (desktop_file);
+
+            xfce_settings_menu_item_read_extra (garcon_item, item);
+
+            g_ptr_array_add (category->items, item);
+        }
+        else if (GARCON_IS_MENU (li->data))
+        {
+            /* we collect only 1 level deep in a category, so
+             * add the submenu items too (should never happen tho) */
+            xfce_settings_menu_collect (li->data, category);
+        }
+    }
+
+    g_list_free (elements);
+}
+
+
+
+/**
+ * xfce_settings_menu_load:
+ * @filename : the menu file.
+ * @error    : return location for errors or %NULL.
+ *
+ * Loads the menu with garcon and takes a snapshot of the categories
+ * and their visible items. This does not touch any widgets, so it can
+ * run in a thread. The garcon menu is not kept, watch the sources of
+ * the snapshot to notice changes.
+ *
+ * Return value: the new snapshot or %NULL on error.
+ **/
+XfceSettingsMenu *
+xfce_settings_menu_load (const gchar  *filename,
+                         GError      **error)
+{
+    XfceSettingsMenu         *menu;
+    XfceSettingsMenuCategory *category;
+    GarconMenu               *garcon_menu;
+    GarconMenuDirectory      *directory;
+    GList                    *elements, *li;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+    menu = xfce_settings_menu_new ();
+
+    /* before loading, so changes during the load make the snapshot stale */
+    menu->stamp = xfce_settings_menu_stamp (filename, menu->sources);
+
+    garcon_menu = garcon_menu_new_for_path (filename);
+    if (!garcon_menu_load (garcon_menu, NULL, error))
+    {
+        g_object_unref (G_OBJECT (garcon_menu));
+        xfce_settings_menu_unref (menu);
+
+        return NULL;
+    }
+
+    /* get all menu elements (preserve layout) */
+    elements = garcon_menu_get_elements (garcon_menu);
+    for (li = elements; li != NULL; li = li->next)
+    {
+        /* only accept toplevel menus */
+        if (!GARCON_IS_MENU (li->data))
+            continue;
+
+        directory = garcon_menu_get_directory (li->data);
+        if (G_UNLIKELY (directory == NULL))
+            continue;
+
+        category = xfce_settings_menu_category_new (garcon_menu_directory_get_name (directory));
+        xfce_settings_menu_collect (li->data, category);
+
+        /* only keep categories with visible items */
+        if (G_LIKELY (category->items->len > 0))
+        {
+            g_ptr_array_sort (category->items, xfce_settings_menu_item_compare);
+            g_ptr_array_add (menu->categories, category);
+        }
+        else
+        {
+            xfce_settings_menu_category_free (category);
+        }
+    }
+    g_list_free (elements);
+
+    g_object_unref (G_OBJECT (garcon_menu));
+
+    return menu;
+}
+
+
+
+/**
+ * xfce_settings_menu_load_cache:
+ * @filename : the menu file.
+ * @stale    : return location for whether the menu sources changed
+ *             since the snapshot was saved.
+ *
+ * Reads the snapshot saved by xfce_settings_menu_save_cache(). A stale
+ * snapshot is still returned, so it can be shown while the menu is
+ * loaded again.
+ *
+ * Return value: the snapshot or %NULL if there is no usable cache.
+ **/
+XfceSettingsMenu *
+xfce_settings_menu_load_cache (const gchar *filename,
+                               gboolean    *stale)
+{
+    XfceSettingsMenu         *menu = NULL;
+    XfceSettingsMenuCategory *category;
+    XfceSettingsMenuItem     *item;
+    GKeyFile                 *key_file;
+    gchar                    *cache_file;
+    gchar                    *cache_stamp = NULL;
+    gchar                    *cache_menu = NULL;
+    gchar                     group[32];
+    gint                      i, j, n_items;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+    g_return_val_if_fail (stale != NULL, NULL);
+
+    cache_file = xfce_resource_save_location (XFCE_RESOURCE_CACHE, MENU_CACHE_FILE, FALSE);
+    if (G_UNLIKELY (cache_file == NULL))
+        return NULL;
+
+    key_file = g_key_file_new ();
+    if (!g_key_file_load_from_file (key_file, cache_file, G_KEY_FILE_NONE, NULL))
+        goto bailout;
+
+    if (g_key_file_get_integer (key_file, "Menu", "Version", NULL) != MENU_CACHE_VERSION)
+        goto bailout;
+
+    /* a snapshot of another menu file is no use */
+    cache_menu = g_key_file_get_string (key_file, "Menu", "File", NULL);
+    if (g_strcmp0 (cache_menu, filename) != 0)
+        goto bailout;
+
+    menu = xfce_settings_menu_new ();
+
+    for (i = 0; ; i++)
+    {
+        g_snprintf (group, sizeof (group), "Category %d", i);
+        if (!g_key_file_has_group (key_file, group))
+            break;
+
+        category = xfce_settings_menu_category_new (NULL);
+        g_free (category->name);
+        category->name = g_key_file_get_string (key_file, group, "Name", NULL);
+        n_items = g_key_file_get_integer (key_file, group, "Items", NULL);
+
+        for (j = 0; j < n_items; j++)
+        {
+            g_snprintf (group, sizeof (group), "Item %d.%d", i, j);
+
+            item = g_slice_new0 (XfceSettingsMenuItem);
+            item->desktop_id = g_key_file_get_string (key_file, group, "Id", NULL);
+            item->filename = g_key_file_get_string (key_file, group, "File", NULL);
+            item->name = g_key_file_get_string (key_file, group, "Name", NULL);
+            item->icon_name = g_key_file_get_string (key_file, group, "Icon", NULL);
+            item->comment = g_key_file_get_string (key_file, group, "Comment", NULL);
+            item->command = g_key_file_get_string (key_file, group, "Exec", NULL);
+            item->keywords = g_key_file_get_string (key_file, group, "Keywords", NULL);
+            item->startup_notify = g_key_file_get_boolean (key_file, group, "StartupNotify", NULL);
+            item->pluggable = g_key_file_get_boolean (key_file, group, "Pluggable", NULL);
+            item->help_page = g_key_file_get_string (key_file, group, "HelpPage", NULL);
+            item->help_component = g_key_file_get_string (key_file, group, "HelpComponent", NULL);
+            item->help_version = g_key_file_get_string (key_file, group, "HelpVersion", NULL);
+
+            if (G_UNLIKELY (item->name == NULL
+                || item->command == NULL))
+            {
+                xfce_settings_menu_item_free (item);
+                continue;
+            }
+
+            /* collation keys are not valid UTF-8, so they are not saved */
+            item->collate_key = g_utf8_collate_key (item->name, -1);
+
+            g_ptr_array_add (category->items, item);
+        }
+
+        if (G_UNLIKELY (category->name == NULL || category->items->len == 0))
+        {
+            xfce_settings_menu_category_free (category);
+            continue;
+        }
+
+        /* the saved order, unless the file was edited */
+        g_ptr_array_sort (category->items, xfce_settings_menu_item_compare);
+        g_ptr_array_add (menu->categories, category);
+    }
+
+    cache_stamp = g_key_file_get_string (key_file, "Menu", "Stamp", NULL);
+    menu->stamp = xfce_settings_menu_stamp (filename, menu->sources);
+    *stale = g_strcmp0 (cache_stamp, menu->stamp) != 0;
+
+    bailout:
+
+    g_free (cache_menu);
+    g_free (cache_stamp);
+    g_key_file_free (key_file);
+    g_free (cache_file);
+
+    return menu;
+}
+
+
+
+/**
+ * xfce_settings_menu_save_cache:
+ * @menu     : a #XfceSettingsMenu loaded with xfce_settings_menu_load().
+ * @filename : the menu file @menu was loaded from.
+ *
+ * Writes the snapshot to the user's cache directory.
+ **/
+void
+xfce_settings_menu_save_cache (XfceSettingsMenu *menu,
+                               const gchar      *filename)
+{
+    XfceSettingsMenuCategory *category;
+    XfceSettingsMenuItem     *item;
+    GKeyFile                 *key_file;
+    gchar                    *cache_file;
+    gchar                     group[32];
+    guint                     i, j;
+    gchar                    *data;
+    gsize                     length;
+
+    g_return_if_fail (menu != NULL);
+    g_return_if_fail (menu->stamp != NULL);
+
+    cache_file = xfce_resource_save_location (XFCE_RESOURCE_CACHE, MENU_CACHE_FILE, TRUE);
+    if (G_UNLIKELY (cache_file == NULL))
+        return;
+
+    key_file = g_key_file_new ();
+    g_key_file_set_integer (key_file, "Menu", "Version", MENU_CACHE_VERSION);
+    g_key_file_set_string (key_file, "Menu", "File", filename);
+    g_key_file_set_string (key_file, "Menu", "Stamp", menu->stamp);
+
+    for (i = 0; i < menu->categories->len; i++)
+    {
+        category = g_ptr_array_index (menu->categories, i);
+
+        g_snprintf (group, sizeof (group), "Category %u", i);
+        g_key_file_set_string (key_file, group, "Name", category->name);
+        g_key_file_set_integer (key_file, group, "Items", category->items->len);
+
+        for (j = 0; j < category->items->len; j++)
+        {
+            item = g_ptr_array_index (category->items, j);
+
+            g_snprintf (group, sizeof (group), "Item %u.%u", i, j);
+            if (item->desktop_id != NULL)
+                g_key_file_set_string (key_file, group, "Id", item->desktop_id);
+            if (item->filename != NULL)
+                g_key_file_set_string (key_file, group, "File", item->filename);
+            g_key_file_set_string (key_file, group, "Name", item->name);
+            if (item->icon_name != NULL)
+                g_key_file_set_string (key_file, group, "Icon", item->icon_name);
+            if (item->comment != NULL)
+                g_key_file_set_string (key_file, group, "Comment", item->comment);
+            if (item->command != NULL)
+                g_key_file_set_string (key_file, group, "Exec", item->command);
+            if (item->keywords != NULL)
+                g_key_file_set_string (key_file, group, "Keywords", item->keywords);
+            g_key_file_set_boolean (key_file, group, "StartupNotify", item->startup_notify);
+            g_key_file_set_boolean (key_file, group, "Pluggable", item->pluggable);
+            if (item->help_page != NULL)
+                g_key_file_set_string (key_file, group, "HelpPage", item->help_page);
+            if (item->help_component != NULL)
+                g_key_file_set_string (key_file, group, "HelpComponent", item->help_component);
+            if (item->help_version != NULL)
+                g_key_file_set_string (key_file, group, "HelpVersion", item->help_version);
+        }
+    }
+
+    data = g_key_file_to_data (key_file, &length, NULL);
+    if (!g_file_set_contents (cache_file, data, length, NULL))
+        g_warning ("Failed to write the menu cache \"%s\"", cache_file);
+
+    g_free (data);
+    g_key_file_free (key_file);
+    g_free (cache_file);
+}
+
+
+
+XfceSettingsMenu *
+xfce_settings_menu_ref (XfceSettingsMenu *menu)
+{
+    g_return_val_if_fail (menu != NULL, NULL);
+
+    g_atomic_int_inc (&menu->ref_count);
+
+    return menu;
+}
+
+
+
+void
+xfce_settings_menu_unref (XfceSettingsMenu *menu)
+{
+    g_return_if_fail (menu != NULL);
+
+    if (g_atomic_int_dec_and_test (&menu->ref_count))
+    {
+        g_ptr_array_free (menu->categories, TRUE);
+        g_ptr_array_free (menu->sources, TRUE);
+        g_free (menu->stamp);
+
+        g_slice_free (XfceSettingsMenu, menu);
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XFCE_SETTINGS_MENU_H__
+#define __XFCE_SETTINGS_MENU_H__
+
+#include <garcon/garcon.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfceSettingsMenu         XfceSettingsMenu;
+typedef struct _XfceSettingsMenuCategory XfceSettingsMenuCategory;
+typedef struct _XfceSettingsMenuItem     XfceSettingsMenuItem;
+
+struct _XfceSettingsMenuItem
+{
+    gchar      *desktop_id;
+    gchar      *filename;
+    gchar      *name;
+    gchar      *collate_key;
+    gchar      *icon_name;
+    gchar      *comment;
+    gchar      *command;
+    gchar      *keywords;
+    guint       startup_notify : 1;
+
+    /* embedded in the settings manager */
+    guint       pluggable : 1;
+    gchar      *help_page;
+    gchar      *help_component;
+    gchar      *help_version;
+};
+
+struct _XfceSettingsMenuCategory
+{
+    gchar      *name;
+
+    /* the visible items, sorted by name */
+    GPtrArray  *items;
+};
+
+struct _XfceSettingsMenu
+{
+    gint        ref_count;
+
+    GPtrArray  *categories;
+
+    /* mtimes of the menu sources when the snapshot was taken */
+    gchar      *stamp;
+
+    /* paths of the menu file and the directories in the stamp,
+     * the menu file first */
+    GPtrArray  *sources;
+};
+
+XfceSettingsMenu *xfce_settings_menu_load       (const gchar       *filename,
+                                                 GError           **error);
+
+XfceSettingsMenu *xfce_settings_menu_load_cache (const gchar       *filename,
+                                                 gboolean          *stale);
+
+void              xfce_settings_menu_save_cache (XfceSettingsMenu  *menu,
+                                                 const gchar       *filename);
+
+XfceSettingsMenu *xfce_settings_menu_ref        (XfceSettingsMenu  *menu);
+
+void              xfce_settings_menu_unref      (XfceSettingsMenu  *menu);
+
+G_END_DECLS
+
+#endif /* !__XFCE_SETTINGS_MENU_H__ */
@@ -50,6 +50,9 @@ enum
   LAST_SIGNAL,
 };
 
+/* drop the prepared layouts when more than this many texts were seen */
+#define LAYOUT_CACHE_SIZE (256)
+
 
 
 static void xfce_text_renderer_finalize     (GObject               *object);
@@ -90,7 +93,7 @@ struct _XfceTextRenderer
 {
   GtkCellRenderer __parent__;
 
-  PangoLayout  *layout;
+  GHashTable   *layouts;
   GtkWidget    *widget;
   gboolean      text_static;
   gchar        *text;
@@ -105,6 +108,20 @@ struct _XfceTextRenderer
   gboolean      follow_prelit;
 };
 
+typedef struct
+{
+  PangoLayout  *layout;
+  gint          width;
+  gint          height;
+
+  /* wrapping the extents were measured with */
+  gint          wrap_width;
+  PangoWrapMode wrap_mode;
+
+  gboolean      underline;
+}
+XfceTextLayout;
+
 
 
 G_DEFINE_TYPE (XfceTextRenderer, xfce_text_renderer, GTK_TYPE_CELL_RENDERER)
@@ -315,6 +332,83 @@ xfce_text_renderer_set_property (GObject      *object,
 
 
 
+static void
+xfce_text_layout_free (gpointer data)
+{
+  XfceTextLayout *text_layout = data;
+
+  g_object_unref (G_OBJECT (text_layout->layout));
+  g_slice_free (XfceTextLayout, text_layout);
+}
+
+
+
+static XfceTextLayout *
+xfce_text_renderer_get_layout (XfceTextRenderer *text_renderer)
+{
+  XfceTextLayout *text_layout;
+  const gchar    *text;
+  gint            wrap_width;
+  PangoWrapMode   wrap_mode;
+
+  g_return_val_if_fail (text_renderer->layouts != NULL, NULL);
+
+  text = (text_renderer->text != NULL) ? text_renderer->text : "";
+
+  /* the layouts are keyed by text, the font is the one of the widget
+   * style, so they are dropped on style changes */
+  text_layout = g_hash_table_lookup (text_renderer->layouts, text);
+  if (G_UNLIKELY (text_layout == NULL))
+    {
+      /* start over if the texts keep changing */
+      if (g_hash_table_size (text_renderer->layouts) >= LAYOUT_CACHE_SIZE)
+        g_hash_table_remove_all (text_renderer->layouts);
+
+      text_layout = g_slice_new0 (XfceTextLayout);
+      text_layout->layout = gtk_widget_create_pango_layout (text_renderer->widget, NULL);
+
+      /* disable automatic text direction, but use the direction specified by Gtk+ */
+      pango_layout_set_auto_dir (text_layout->layout, FALSE);
+
+      /* we don't want to interpret line separators in file names */
+      pango_layout_set_single_paragraph_mode (text_layout->layout, TRUE);
+
+      pango_layout_set_text (text_layout->layout, text, -1);
+
+      /* force measuring below */
+      text_layout->wrap_width = G_MININT;
+
+      g_hash_table_insert (text_renderer->layouts, g_strdup (text), text_layout);
+    }
+
+  if (text_renderer->wrap_width < 0)
+    {
+      wrap_width = -1;
+      wrap_mode = PANGO_WRAP_CHAR;
+    }
+  else
+    {
+      wrap_width = text_renderer->wrap_width * PANGO_SCALE;
+      wrap_mode = text_renderer->wrap_mode;
+    }
+
+  /* (re)measure the text if the wrapping changed */
+  if (text_layout->wrap_width != wrap_width
+      || text_layout->wrap_mode != wrap_mode)
+    {
+      pango_layout_set_width (text_layout->layout, wrap_width);
+      pango_layout_set_wrap (text_layout->layout, wrap_mode);
+      pango_layout_get_pixel_size (text_layout->layout, &text_layout->width, &text_layout->height);
+
+      text_layout->wrap_width = wrap_width;
+      text_layout->wrap_mode = wrap_mode;
+    }
+
+  return text_layout;
+}
+
+
+
 static void
 xfce_text_renderer_get_size (GtkCellRenderer *renderer,
                              GtkWidget       *widget,
@@ -325,6 +419,7 @@ xfce_text_renderer_get_size (GtkCellRenderer *renderer,
                              gint            *height)
 {
   XfceTextRenderer *text_renderer = XFCE_TEXT_RENDERER (renderer);
+  XfceTextLayout   *text_layout;
   gint              text_length;
   gint              text_width;
   gint              text_height;
@@ -347,11 +442,10 @@ xfce_text_renderer_get_size (GtkCellRenderer *renderer,
     }
   else
     {
-      /* calculate the real text dimension */
-      pango_layout_set_width (text_renderer->layout, text_renderer->wrap_width * PANGO_SCALE);
-      pango_layout_set_wrap (text_renderer->layout, text_renderer->wrap_mode);
-      pango_layout_set_text (text_renderer->layout, text_renderer->text, -1);
-      pango_layout_get_pixel_size (text_renderer->layout, &text_width, &text_height);
+      /* use the real text dimension */
+      text_layout = xfce_text_renderer_get_layout (text_renderer);
+      text_width = text_layout->width;
+      text_height = text_layout->height;
     }
 
   /* if we have to follow the state manually, we'll need
@@ -447,6 +541,8 @@ xfce_text_renderer_render (GtkCellRenderer     *renderer,
                            GtkCellRendererState flags)
 {
   XfceTextRenderer *text_renderer = XFCE_TEXT_RENDERER (renderer);
+  XfceTextLayout   *text_layout;
+  gboolean          underline;
   GtkStateType      state;
   cairo_t          *cr;
   gint              x0, x1, y0, y1;
@@ -478,28 +574,21 @@ xfce_text_renderer_render (GtkCellRenderer     *renderer,
         state = GTK_STATE_NORMAL;
     }
 
-  /* check if we should follow the prelit state (used for single click support) */
-  if (text_renderer->follow_prelit && (flags & GTK_CELL_RENDERER_PRELIT) != 0)
-    pango_layout_set_attributes (text_renderer->layout, xfce_pango_attr_list_underline_single ());
-  else
-    pango_layout_set_attributes (text_renderer->layout, NULL);
+  /* get the prepared layout for the text and wrapping */
+  text_layout = xfce_text_renderer_get_layout (text_renderer);
 
-  /* setup the wrapping */
-  if (text_renderer->wrap_width < 0)
-    {
-      pango_layout_set_width (text_renderer->layout, -1);
-      pango_layout_set_wrap (text_renderer->layout, PANGO_WRAP_CHAR);
-    }
-  else
+  /* check if we should follow the prelit state (used for single click support),
+   * only touch the attributes on a change, this drops the shaped lines */
+  underline = text_renderer->follow_prelit && (flags & GTK_CELL_RENDERER_PRELIT) != 0;
+  if (text_layout->underline != underline)
     {
-      pango_layout_set_width (text_renderer->layout, text_renderer->wrap_width * PANGO_SCALE);
-      pango_layout_set_wrap (text_renderer->layout, text_renderer->wrap_mode);
+      pango_layout_set_attributes (text_layout->layout, underline ? xfce_pango_attr_list_underline_single () : NULL);
+      text_layout->underline = underline;
     }
 
-  pango_layout_set_text (text_renderer->layout, text_renderer->text, -1);
-
-  /* calculate the real text dimension */
-  pango_layout_get_pixel_size (text_renderer->layout, &text_width, &text_height);
+  /* the real text dimension */
+  text_width = text_layout->width;
+  text_height = text_layout->height;
 
   /* take into account the state indicator (required for calculation) */
   if (text_renderer->follow_state)
@@ -565,7 +654,7 @@ xfce_text_renderer_render (GtkCellRenderer     *renderer,
                     expose_area, widget, "cellrenderertext",
                     cell_area->x + x_offset + renderer->xpad,
                     cell_area->y + y_offset + renderer->ypad,
-                    text_renderer->layout);
+                    text_layout->layout);
 }
 
 
@@ -594,7 +683,7 @@ xfce_text_renderer_set_widget (XfceTextRenderer *text_renderer,
   if (G_UNLIKELY (text_renderer->widget != NULL))
     {
       g_signal_handlers_disconnect_by_func (G_OBJECT (text_renderer->widget), xfce_text_renderer_invalidate, text_renderer);
-      g_object_unref (G_OBJECT (text_renderer->layout));
+      g_hash_table_destroy (text_renderer->layouts);
       g_object_unref (G_OBJECT (text_renderer->widget));
     }
 
@@ -611,17 +700,11 @@ xfce_text_renderer_set_widget (XfceTextRenderer *text_renderer,
       g_signal_connect_swapped (G_OBJECT (text_renderer->widget), "destroy", G_CALLBACK (xfce_text_renderer_invalidate), text_renderer);
       g_signal_connect_swapped (G_OBJECT (text_renderer->widget), "style-set", G_CALLBACK (xfce_text_renderer_invalidate), text_renderer);
 
-      /* allocate a new pango layout for this widget */
-      context = gtk_widget_get_pango_context (widget);
-      text_renderer->layout = pango_layout_new (context);
-
-      /* disable automatic text direction, but use the direction specified by Gtk+ */
-      pango_layout_set_auto_dir (text_renderer->layout, FALSE);
-
-      /* we don't want to interpret line separators in file names */
-      pango_layout_set_single_paragraph_mode (text_renderer->layout, TRUE);
+      /* allocate a new layout cache for this widget */
+      text_renderer->layouts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, xfce_text_layout_free);
 
       /* calculate the average character dimensions */
+      context = gtk_widget_get_pango_context (widget);
       metrics = pango_context_get_metrics (context, widget->style->font_desc, pango_context_get_language (context));
       text_renderer->char_width = PANGO_PIXELS (pango_font_metrics_get_approximate_char_width (metrics));
       text_renderer->char_height = PANGO_PIXELS (pango_font_metrics_get_ascent (metrics) + pango_font_metrics_get_descent (metrics));
@@ -637,7 +720,7 @@ xfce_text_renderer_set_widget (XfceTextRenderer *text_renderer,
     }
   else
     {
-      text_renderer->layout = NULL;
+      text_renderer->layouts = NULL;
       text_renderer->char_width = 0;
       text_renderer->char_height = 0;
     }
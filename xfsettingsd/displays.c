@@ -27,6 +27,7 @@
 #ifdef HAVE_MATH_H
 #include <math.h>
 #endif
+#include <stdio.h>
 
 #include <glib.h>
 #include <gdk/gdkx.h>
@@ -36,6 +37,8 @@
 
 #include <X11/extensions/Xrandr.h>
 
+#include <common/display-layout.h>
+
 #include "debug.h"
 #include "displays.h"
 #ifdef HAVE_UPOWERGLIB
@@ -52,22 +55,24 @@
 /* Xfconf properties */
 #define APPLY_SCHEME_PROP   "/Schemes/Apply"
 #define DEFAULT_SCHEME_NAME "Default"
-#define OUTPUT_FMT          "/%s/%s"
-#define PRIMARY_PROP        OUTPUT_FMT "/Primary"
-#define ACTIVE_PROP         OUTPUT_FMT "/Active"
-#define ROTATION_PROP       OUTPUT_FMT "/Rotation"
-#define REFLECTION_PROP     OUTPUT_FMT "/Reflection"
-#define RESOLUTION_PROP     OUTPUT_FMT "/Resolution"
-#define RRATE_PROP          OUTPUT_FMT "/RefreshRate"
-#define POSX_PROP           OUTPUT_FMT "/Position/X"
-#define POSY_PROP           OUTPUT_FMT "/Position/Y"
 #define NOTIFY_PROP         "/Notify"
 
+/* Output properties, below /<scheme>/<output> */
+#define PRIMARY_PROP        "/Primary"
+#define ACTIVE_PROP         "/Active"
+#define ROTATION_PROP       "/Rotation"
+#define REFLECTION_PROP     "/Reflection"
+#define RESOLUTION_PROP     "/Resolution"
+#define RRATE_PROP          "/RefreshRate"
+#define POSX_PROP           "/Position/X"
+#define POSY_PROP           "/Position/Y"
+
 
 
 /* wrappers to avoid querying too often */
-typedef struct _XfceRRCrtc   XfceRRCrtc;
-typedef struct _XfceRROutput XfceRROutput;
+typedef struct _XfceRRCrtc      XfceRRCrtc;
+typedef struct _XfceRROutput    XfceRROutput;
+typedef struct _XfceSavedOutput XfceSavedOutput;
 
 
 
@@ -78,8 +83,13 @@ static GdkFilterReturn  xfce_displays_helper_screen_on_event                (Gdk
                                                                              GdkEvent                *event,
                                                                              gpointer                 data);
 static void             xfce_displays_helper_set_screen_size                (XfceDisplaysHelper      *helper);
+static void             xfce_displays_helper_free_saved_output              (XfceSavedOutput         *saved);
+static GHashTable      *xfce_displays_helper_get_scheme                     (XfceDisplaysHelper      *helper,
+                                                                             const gchar             *scheme);
+static XRRModeInfo     *xfce_displays_helper_find_saved_mode                (XfceDisplaysHelper      *helper,
+                                                                             XfceSavedOutput         *saved,
+                                                                             XfceRROutput            *output);
 static gboolean         xfce_displays_helper_load_from_xfconf               (XfceDisplaysHelper      *helper,
-                                                                             const gchar             *scheme,
                                                                              GHashTable              *saved_outputs,
                                                                              XfceRROutput            *output);
 static GPtrArray       *xfce_displays_helper_list_outputs                   (XfceDisplaysHelper      *helper);
@@ -90,10 +100,7 @@ static XfceRRCrtc      *xfce_displays_helper_find_crtc_by_id                (Xfc
 static void             xfce_displays_helper_free_crtc                      (XfceRRCrtc              *crtc);
 static XfceRRCrtc      *xfce_displays_helper_find_usable_crtc               (XfceDisplaysHelper      *helper,
                                                                              XfceRROutput            *output);
-static void             xfce_displays_helper_get_topleftmost_pos            (XfceRRCrtc              *crtc,
-                                                                             XfceDisplaysHelper      *helper);
-static void             xfce_displays_helper_normalize_crtc                 (XfceRRCrtc              *crtc,
-                                                                             XfceDisplaysHelper      *helper);
+static void             xfce_displays_helper_normalize_crtcs                (XfceDisplaysHelper      *helper);
 static Status           xfce_displays_helper_disable_crtc                   (XfceDisplaysHelper      *helper,
                                                                              RRCrtc                   crtc);
 static void             xfce_displays_helper_workaround_crtc_size           (XfceRRCrtc              *crtc,
@@ -154,9 +161,9 @@ struct _XfceDisplaysHelper
     gint                mm_width;
     gint                mm_height;
 
-    /* used to normalize positions */
-    gint                min_x;
-    gint                min_y;
+    /* parsed schemes, scheme name to a table of XfceSavedOutput by
+     * output name, dropped whenever a property of the scheme changes */
+    GHashTable         *schemes;
 };
 
 struct _XfceRRCrtc
@@ -184,6 +191,29 @@ struct _XfceRROutput
     guint          active : 1;
 };
 
+struct _XfceSavedOutput
+{
+    /* "/<scheme>/<output>" is set */
+    guint     exists : 1;
+
+    guint     primary : 1;
+    guint     has_active : 1;
+    guint     active : 1;
+
+    /* rotation and reflection */
+    Rotation  rotation;
+
+    /* resolution as saved and parsed, if it has the "%dx%d" format */
+    gchar    *resolution;
+    guint     has_size : 1;
+    gint      width;
+    gint      height;
+
+    gdouble   rate;
+    gint      x;
+    gint      y;
+};
+
 
 G_DEFINE_TYPE (XfceDisplaysHelper, xfce_displays_helper, G_TYPE_OBJECT);
 
@@ -214,6 +244,8 @@ xfce_displays_helper_init (XfceDisplaysHelper *helper)
     helper->outputs = NULL;
     helper->crtcs = NULL;
     helper->handler = 0;
+    helper->schemes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                             (GDestroyNotify) g_hash_table_destroy);
 
     /* get the default display */
     helper->display = gdk_display_get_default ();
@@ -358,6 +390,8 @@ xfce_displays_helper_finalize (GObject *object)
         helper->resources = NULL;
     }
 
+    g_hash_table_destroy (helper->schemes);
+
     (*G_OBJECT_CLASS (xfce_displays_helper_parent_class)->finalize) (object);
 }
 
@@ -411,6 +445,9 @@ xfce_displays_helper_screen_on_event (GdkXEvent *xevent,
 {
     XfceDisplaysHelper *helper = XFCE_DISPLAYS_HELPER (data);
     GPtrArray          *old_outputs;
+    GHashTable         *saved_outputs;
+    XfceSavedOutput    *saved;
+    XRRModeInfo        *mode_info;
     XfceRRCrtc         *crtc = NULL;
     XfceRROutput       *output, *o;
     XEvent             *e = xevent;
@@ -497,6 +534,7 @@ xfce_displays_helper_screen_on_event (GdkXEvent *xevent,
                 {
                     xfsettings_dbg (XFSD_DEBUG_DISPLAYS, "New output connected: %s",
                                     output->info->name);
+
                     /* need to enable crtc for output ? */
                     if (output->info->crtc == None)
                     {
@@ -504,18 +542,45 @@ xfce_displays_helper_screen_on_event (GdkXEvent *xevent,
                         crtc = xfce_displays_helper_find_usable_crtc (helper, output);
                         if (crtc)
                         {
-                            crtc->mode = output->preferred_mode;
-                            crtc->rotation = RR_Rotate_0;
+                            /* the mode and rotation the user saved for this output, if
+                             * the output still supports them, else the preferred mode */
+                            saved_outputs = xfce_displays_helper_get_scheme (helper, DEFAULT_SCHEME_NAME);
+                            saved = saved_outputs ? g_hash_table_lookup (saved_outputs, output->info->name) : NULL;
+                            mode_info = (saved && saved->exists)
+                                        ? xfce_displays_helper_find_saved_mode (helper, saved, output) : NULL;
+
+                            if (mode_info != NULL)
+                            {
+                                xfsettings_dbg (XFSD_DEBUG_DISPLAYS, "Restoring the saved mode of %s.",
+                                                output->info->name);
+                                crtc->mode = mode_info->id;
+                                crtc->rotation = (crtc->rotations & saved->rotation) != 0
+                                                 ? saved->rotation : RR_Rotate_0;
+                            }
+                            else
+                            {
+                                crtc->mode = output->preferred_mode;
+                                crtc->rotation = RR_Rotate_0;
+                            }
+
                             if ((crtc->x > gdk_screen_width() + 1) || (crtc->y > gdk_screen_height() + 1)) {
                                 crtc->x = crtc->y = 0;
                             } /* else - leave values from last time we saw the monitor */
                             /* set width and height */
                             for (j = 0; j < helper->resources->nmode; ++j)
                             {
-                                if (helper->resources->modes[j].id == output->preferred_mode)
+                                if (helper->resources->modes[j].id == crtc->mode)
                                 {
-                                    crtc->width = helper->resources->modes[j].width;
-                                    crtc->height = helper->resources->modes[j].height;
+                                    if ((crtc->rotation & (RR_Rotate_90|RR_Rotate_270)) != 0)
+                                    {
+                                        crtc->width = helper->resources->modes[j].height;
+                                        crtc->height = helper->resources->modes[j].width;
+                                    }
+                                    else
+                                    {
+                                        crtc->width = helper->resources->modes[j].width;
+                                        crtc->height = helper->resources->modes[j].height;
+                                    }
                                     break;
                                 }
                             }
@@ -584,50 +649,217 @@ xfce_displays_helper_set_screen_size (XfceDisplaysHelper *helper)
 
 
 
+static void
+xfce_displays_helper_free_saved_output (XfceSavedOutput *saved)
+{
+    g_free (saved->resolution);
+    g_slice_free (XfceSavedOutput, saved);
+}
+
+
+
+static GHashTable *
+xfce_displays_helper_get_scheme (XfceDisplaysHelper *helper,
+                                 const gchar        *scheme)
+{
+    GHashTable      *saved_outputs, *properties;
+    GHashTableIter   iter;
+    XfceSavedOutput *saved;
+    const gchar     *property, *name, *key;
+    const GValue    *value;
+    gchar           *prefix, *output_name, *str;
+    gsize            prefix_len;
+    Rotation         rot;
+
+    g_assert (XFCE_IS_DISPLAYS_HELPER (helper));
+
+    /* parsed since the last change of the scheme? */
+    saved_outputs = g_hash_table_lookup (helper->schemes, scheme);
+    if (saved_outputs != NULL)
+        return saved_outputs;
+
+    prefix = g_strdup_printf ("/%s", scheme);
+    properties = xfconf_channel_get_properties (helper->channel, prefix);
+    if (properties == NULL)
+    {
+        g_free (prefix);
+        return NULL;
+    }
+
+    xfsettings_dbg (XFSD_DEBUG_DISPLAYS, "Parsing scheme %s.", scheme);
+
+    saved_outputs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                           (GDestroyNotify) xfce_displays_helper_free_saved_output);
+    prefix_len = strlen (prefix);
+
+    g_hash_table_iter_init (&iter, properties);
+    while (g_hash_table_iter_next (&iter, (gpointer) &property, (gpointer) &value))
+    {
+        /* properties are "/<scheme>/<output>" and "/<scheme>/<output>/<key>" */
+        if (strncmp (property, prefix, prefix_len) != 0 || property[prefix_len] != '/')
+            continue;
+
+        name = property + prefix_len + 1;
+        key = strchr (name, '/');
+        if (key != NULL)
+            output_name = g_strndup (name, key - name);
+        else
+            output_name = g_strdup (name);
+
+        saved = g_hash_table_lookup (saved_outputs, output_name);
+        if (saved == NULL)
+        {
+            saved = g_slice_new0 (XfceSavedOutput);
+            saved->rotation = RR_Rotate_0;
+            g_hash_table_insert (saved_outputs, output_name, saved);
+        }
+        else
+        {
+            g_free (output_name);
+        }
+
+        if (key == NULL)
+        {
+            saved->exists = G_VALUE_HOLDS_STRING (value);
+        }
+        else if (strcmp (key, PRIMARY_PROP) == 0)
+        {
+            saved->primary = G_VALUE_HOLDS_BOOLEAN (value) && g_value_get_boolean (value);
+        }
+        else if (strcmp (key, ACTIVE_PROP) == 0)
+        {
+            saved->has_active = G_VALUE_HOLDS_BOOLEAN (value);
+            saved->active = saved->has_active && g_value_get_boolean (value);
+        }
+        else if (strcmp (key, ROTATION_PROP) == 0)
+        {
+            /* convert to a Rotation */
+            switch (G_VALUE_HOLDS_INT (value) ? g_value_get_int (value) : 0)
+            {
+                case 90:  rot = RR_Rotate_90;  break;
+                case 180: rot = RR_Rotate_180; break;
+                case 270: rot = RR_Rotate_270; break;
+                default:  rot = RR_Rotate_0;   break;
+            }
+
+            saved->rotation = (saved->rotation & (RR_Reflect_X|RR_Reflect_Y)) | rot;
+        }
+        else if (strcmp (key, REFLECTION_PROP) == 0 && G_VALUE_HOLDS_STRING (value))
+        {
+            /* convert to a Rotation */
+            if (g_strcmp0 (g_value_get_string (value), "X") == 0)
+                saved->rotation |= RR_Reflect_X;
+            else if (g_strcmp0 (g_value_get_string (value), "Y") == 0)
+                saved->rotation |= RR_Reflect_Y;
+            else if (g_strcmp0 (g_value_get_string (value), "XY") == 0)
+                saved->rotation |= (RR_Reflect_X|RR_Reflect_Y);
+        }
+        else if (strcmp (key, RESOLUTION_PROP) == 0 && G_VALUE_HOLDS_STRING (value))
+        {
+            g_free (saved->resolution);
+            saved->resolution = g_value_dup_string (value);
+
+            /* only a resolution in the format of the display panel
+             * can match a mode */
+            saved->has_size = FALSE;
+            if (saved->resolution != NULL
+                && sscanf (saved->resolution, "%dx%d", &saved->width, &saved->height) == 2)
+            {
+                str = g_strdup_printf ("%dx%d", saved->width, saved->height);
+                saved->has_size = strcmp (str, saved->resolution) == 0;
+                g_free (str);
+            }
+        }
+        else if (strcmp (key, RRATE_PROP) == 0 && G_VALUE_HOLDS_DOUBLE (value))
+        {
+            saved->rate = g_value_get_double (value);
+        }
+        else if (strcmp (key, POSX_PROP) == 0 && G_VALUE_HOLDS_INT (value))
+        {
+            saved->x = g_value_get_int (value);
+        }
+        else if (strcmp (key, POSY_PROP) == 0 && G_VALUE_HOLDS_INT (value))
+        {
+            saved->y = g_value_get_int (value);
+        }
+    }
+
+    g_hash_table_destroy (properties);
+
+    g_hash_table_insert (helper->schemes, g_strdup (scheme), saved_outputs);
+    g_free (prefix);
+
+    return saved_outputs;
+}
+
+
+
+static XRRModeInfo *
+xfce_displays_helper_find_saved_mode (XfceDisplaysHelper *helper,
+                                      XfceSavedOutput    *saved,
+                                      XfceRROutput       *output)
+{
+    gdouble rate;
+    gint    n, m;
+
+    if (!saved->has_size)
+        return NULL;
+
+    for (n = 0; n < output->info->nmode; ++n)
+    {
+        /* walk all modes */
+        for (m = 0; m < helper->resources->nmode; ++m)
+        {
+            /* does the mode info match the mode we seek? */
+            if (helper->resources->modes[m].id != output->info->modes[n])
+                continue;
+
+            /* calculate the refresh rate */
+            rate = (gdouble) helper->resources->modes[m].dotClock /
+                    ((gdouble) helper->resources->modes[m].hTotal * (gdouble) helper->resources->modes[m].vTotal);
+
+            /* find the mode corresponding to the saved values */
+            if (rint (rate * 10) == rint (saved->rate * 10)
+                && (gint) helper->resources->modes[m].width == saved->width
+                && (gint) helper->resources->modes[m].height == saved->height)
+                return &helper->resources->modes[m];
+        }
+    }
+
+    return NULL;
+}
+
+
+
 static gboolean
 xfce_displays_helper_load_from_xfconf (XfceDisplaysHelper *helper,
-                                       const gchar        *scheme,
                                        GHashTable         *saved_outputs,
                                        XfceRROutput       *output)
 {
-    XfceRRCrtc  *crtc = NULL;
-    GValue      *value;
-    const gchar *str_value;
-    gchar        property[512];
-    gdouble      output_rate, rate;
-    RRMode       valid_mode;
-    Rotation     rot;
-    gint         x, y, n, m, int_value;
-    gboolean     active;
+    XfceRRCrtc      *crtc = NULL;
+    XfceSavedOutput *saved;
+    XRRModeInfo     *mode_info;
+    Rotation         rot;
+    gboolean         active;
 
     g_assert (XFCE_IS_DISPLAYS_HELPER (helper) && helper->resources && output);
 
     active = output->active;
 
     /* does this output exist in xfconf? */
-    g_snprintf (property, sizeof (property), OUTPUT_FMT, scheme, output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
+    saved = g_hash_table_lookup (saved_outputs, output->info->name);
 
-    if (value == NULL || !G_VALUE_HOLDS_STRING (value))
+    if (saved == NULL || !saved->exists)
         return active;
 
 #ifdef HAS_RANDR_ONE_POINT_THREE
-    if (helper->has_1_3)
-    {
-        /* is it the primary output? */
-        g_snprintf (property, sizeof (property), PRIMARY_PROP, scheme,
-                    output->info->name);
-        value = g_hash_table_lookup (saved_outputs, property);
-        if (G_VALUE_HOLDS_BOOLEAN (value) && g_value_get_boolean (value))
-            helper->primary = output->id;
-    }
+    /* is it the primary output? */
+    if (helper->has_1_3 && saved->primary)
+        helper->primary = output->id;
 #endif
 
     /* status */
-    g_snprintf (property, sizeof (property), ACTIVE_PROP, scheme, output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
-
-    if (value == NULL || !G_VALUE_HOLDS_BOOLEAN (value))
+    if (!saved->has_active)
         return active;
 
     /* Get the associated CRTC */
@@ -636,7 +868,7 @@ xfce_displays_helper_load_from_xfconf (XfceDisplaysHelper *helper,
         return active;
 
     /* disable inactive outputs */
-    if (!g_value_get_boolean (value))
+    if (!saved->active)
     {
         if (crtc->mode != None)
         {
@@ -651,40 +883,8 @@ xfce_displays_helper_load_from_xfconf (XfceDisplaysHelper *helper,
         return active;
     }
 
-    /* rotation */
-    g_snprintf (property, sizeof (property), ROTATION_PROP, scheme, output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
-    if (G_VALUE_HOLDS_INT (value))
-        int_value = g_value_get_int (value);
-    else
-        int_value = 0;
-
-    /* convert to a Rotation */
-    switch (int_value)
-    {
-        case 90:  rot = RR_Rotate_90;  break;
-        case 180: rot = RR_Rotate_180; break;
-        case 270: rot = RR_Rotate_270; break;
-        default:  rot = RR_Rotate_0;   break;
-    }
-
-    /* reflection */
-    g_snprintf (property, sizeof (property), REFLECTION_PROP, scheme, output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
-    if (G_VALUE_HOLDS_STRING (value))
-        str_value = g_value_get_string (value);
-    else
-        str_value = "0";
-
-    /* convert to a Rotation */
-    if (g_strcmp0 (str_value, "X") == 0)
-        rot |= RR_Reflect_X;
-    else if (g_strcmp0 (str_value, "Y") == 0)
-        rot |= RR_Reflect_Y;
-    else if (g_strcmp0 (str_value, "XY") == 0)
-        rot |= (RR_Reflect_X|RR_Reflect_Y);
-
     /* check rotation support */
+    rot = saved->rotation;
     if ((crtc->rotations & rot) == 0)
     {
         g_warning ("Unsupported rotation for %s. Fallback to RR_Rotate_0.", output->info->name);
@@ -698,107 +898,44 @@ xfce_displays_helper_load_from_xfconf (XfceDisplaysHelper *helper,
         crtc->changed = TRUE;
     }
 
-    /* resolution */
-    g_snprintf (property, sizeof (property), RESOLUTION_PROP, scheme, output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
-    if (value == NULL || !G_VALUE_HOLDS_STRING (value))
-        str_value = "";
-    else
-        str_value = g_value_get_string (value);
-
-    /* refresh rate */
-    g_snprintf (property, sizeof (property), RRATE_PROP, scheme, output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
-    if (G_VALUE_HOLDS_DOUBLE (value))
-        output_rate = g_value_get_double (value);
-    else
-        output_rate = 0.0;
-
     /* check mode validity */
-    valid_mode = None;
-    for (n = 0; n < output->info->nmode; ++n)
-    {
-        /* walk all modes */
-        for (m = 0; m < helper->resources->nmode; ++m)
-        {
-            /* does the mode info match the mode we seek? */
-            if (helper->resources->modes[m].id != output->info->modes[n])
-                continue;
+    mode_info = xfce_displays_helper_find_saved_mode (helper, saved, output);
 
-            /* calculate the refresh rate */
-            rate = (gdouble) helper->resources->modes[m].dotClock /
-                    ((gdouble) helper->resources->modes[m].hTotal * (gdouble) helper->resources->modes[m].vTotal);
-
-            /* construct a string equivalent to the mode generated in displays */
-            /* property is the resources mode translated into display panel name */
-            g_snprintf (property, sizeof (property), "%dx%d", helper->resources->modes[m].width,
-                        helper->resources->modes[m].height);
-
-            /* find the mode corresponding to the saved values */
-            if (rint (rate * 10) == rint (output_rate * 10)
-                && (g_strcmp0 (property, str_value) == 0))
-            {
-                valid_mode = helper->resources->modes[m].id;
-                break;
-            }
-        }
-        /* found it */
-        if (valid_mode != None)
-            break;
-    }
-
-    if (valid_mode == None)
+    if (mode_info == NULL)
     {
         /* unsupported mode, abort for this output */
         g_warning ("Unknown mode '%s @ %.1f' for output %s, aborting.",
-                   str_value, output_rate, output->info->name);
+                   saved->resolution != NULL ? saved->resolution : "",
+                   saved->rate, output->info->name);
         return active;
     }
-    else if (crtc->mode != valid_mode)
+    else if (crtc->mode != mode_info->id)
     {
         if (crtc->mode == None)
             active = TRUE;
 
         /* update CRTC mode */
-        crtc->mode = valid_mode;
+        crtc->mode = mode_info->id;
         crtc->changed = TRUE;
     }
 
     /* recompute dimensions according to the selected rotation */
     if ((crtc->rotation & (RR_Rotate_90|RR_Rotate_270)) != 0)
     {
-        crtc->width = helper->resources->modes[m].height;
-        crtc->height = helper->resources->modes[m].width;
+        crtc->width = mode_info->height;
+        crtc->height = mode_info->width;
     }
     else
     {
-        crtc->width = helper->resources->modes[m].width;
-        crtc->height = helper->resources->modes[m].height;
+        crtc->width = mode_info->width;
+        crtc->height = mode_info->height;
     }
 
-    /* position, x */
-    g_snprintf (property, sizeof (property), POSX_PROP, scheme,
-                output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
-    if (G_VALUE_HOLDS_INT (value))
-        x = g_value_get_int (value);
-    else
-        x = 0;
-
-    /* position, y */
-    g_snprintf (property, sizeof (property), POSY_PROP, scheme,
-                output->info->name);
-    value = g_hash_table_lookup (saved_outputs, property);
-    if (G_VALUE_HOLDS_INT (value))
-        y = g_value_get_int (value);
-    else
-        y = 0;
-
     /* update CRTC position */
-    if (crtc->x != x || crtc->y != y)
+    if (crtc->x != saved->x || crtc->y != saved->y)
     {
-        crtc->x = x;
-        crtc->y = y;
+        crtc->x = saved->x;
+        crtc->y = saved->y;
         crtc->changed = TRUE;
     }
 
@@ -1057,45 +1194,57 @@ xfce_displays_helper_find_usable_crtc (XfceDisplaysHelper *helper,
 
 
 static void
-xfce_displays_helper_get_topleftmost_pos (XfceRRCrtc         *crtc,
-                                          XfceDisplaysHelper *helper)
+xfce_displays_helper_normalize_crtcs (XfceDisplaysHelper *helper)
 {
-    g_assert (XFCE_IS_DISPLAYS_HELPER (helper) && crtc);
-
-    if (crtc->mode == None)
-        return;
+    XfceRRCrtc     *crtc;
+    XfceLayoutRect  rect;
+    GArray         *rects;
+    gboolean        moved;
+    guint           n, i;
 
-    /* used to normalize positions later */
-    helper->min_x = MIN (helper->min_x, crtc->x);
-    helper->min_y = MIN (helper->min_y, crtc->y);
-}
+    g_assert (XFCE_IS_DISPLAYS_HELPER (helper) && helper->crtcs);
 
+    rects = g_array_sized_new (FALSE, FALSE, sizeof (XfceLayoutRect), helper->crtcs->len);
 
+    /* ignore disabled outputs for size computations */
+    for (n = 0; n < helper->crtcs->len; ++n)
+    {
+        crtc = g_ptr_array_index (helper->crtcs, n);
+        if (crtc->mode == None)
+            continue;
 
-static void
-xfce_displays_helper_normalize_crtc (XfceRRCrtc         *crtc,
-                                     XfceDisplaysHelper *helper)
-{
-    g_assert (XFCE_IS_DISPLAYS_HELPER (helper) && crtc);
+        rect.x = crtc->x;
+        rect.y = crtc->y;
+        rect.width = crtc->width;
+        rect.height = crtc->height;
+        g_array_append_val (rects, rect);
+    }
 
-    /* ignore disabled outputs for size computations */
-    if (crtc->mode == None)
-        return;
+    /* normalize positions to ensure the upper left corner is at (0,0)
+     * and calculate the total screen size */
+    moved = xfce_layout_normalize ((XfceLayoutRect *) rects->data, rects->len,
+                                   &helper->width, &helper->height);
 
-    /* normalize positions to ensure the upper left corner is at (0,0) */
-    if (helper->min_x || helper->min_y)
+    for (n = 0, i = 0; n < helper->crtcs->len; ++n)
     {
-        crtc->x -= helper->min_x;
-        crtc->y -= helper->min_y;
-        crtc->changed = TRUE;
-    }
+        crtc = g_ptr_array_index (helper->crtcs, n);
+        if (crtc->mode == None)
+            continue;
+
+        if (moved)
+        {
+            rect = g_array_index (rects, XfceLayoutRect, i);
+            crtc->x = rect.x;
+            crtc->y = rect.y;
+            crtc->changed = TRUE;
+        }
+        i++;
 
-    xfsettings_dbg (XFSD_DEBUG_DISPLAYS, "Normalized CRTC %lu: size=%dx%d, pos=%dx%d.",
-                    crtc->id, crtc->width, crtc->height, crtc->x, crtc->y);
+        xfsettings_dbg (XFSD_DEBUG_DISPLAYS, "Normalized CRTC %lu: size=%dx%d, pos=%dx%d.",
+                        crtc->id, crtc->width, crtc->height, crtc->x, crtc->y);
+    }
 
-    /* calculate the total screen size */
-    helper->width = MAX (helper->width, crtc->x + crtc->width);
-    helper->height = MAX (helper->height, crtc->y + crtc->height);
+    g_array_free (rects, TRUE);
 
     /* The 'physical size' of an X screen is meaningless if that screen
      * can consist of many monitors. So just pick a size that make the
@@ -1221,12 +1370,8 @@ xfce_displays_helper_apply_all (XfceDisplaysHelper *helper)
 {
     g_assert (XFCE_IS_DISPLAYS_HELPER (helper) && helper->crtcs);
 
-    helper->mm_width = helper->mm_height = helper->width = helper->height = 0;
-    helper->min_x = helper->min_y = 32768;
-
     /* normalization and screen size calculation */
-    g_ptr_array_foreach (helper->crtcs, (GFunc) xfce_displays_helper_get_topleftmost_pos, helper);
-    g_ptr_array_foreach (helper->crtcs, (GFunc) xfce_displays_helper_normalize_crtc, helper);
+    xfce_displays_helper_normalize_crtcs (helper);
 
     gdk_error_trap_push ();
 
@@ -1263,28 +1408,25 @@ static void
 xfce_displays_helper_channel_apply (XfceDisplaysHelper *helper,
                                     const gchar        *scheme)
 {
-    gchar       property[512];
     guint       n, nactive;
     GHashTable *saved_outputs;
 
-    saved_outputs = NULL;
 #ifdef HAS_RANDR_ONE_POINT_THREE
     helper->primary = None;
 #endif
 
-    /* finally the list of saved outputs from xfconf */
-    g_snprintf (property, sizeof (property), "/%s", scheme);
-    saved_outputs = xfconf_channel_get_properties (helper->channel, property);
+    /* finally the list of saved outputs, parsed once per change of the scheme */
+    saved_outputs = xfce_displays_helper_get_scheme (helper, scheme);
 
     /* nothing saved, nothing to do */
     if (saved_outputs == NULL)
-        goto err_cleanup;
+        return;
 
     /* first loop, loads all the outputs, and gets the number of active ones */
     nactive = 0;
     for (n = 0; n < helper->outputs->len; ++n)
     {
-        if (xfce_displays_helper_load_from_xfconf (helper, scheme, saved_outputs,
+        if (xfce_displays_helper_load_from_xfconf (helper, saved_outputs,
                                                    g_ptr_array_index (helper->outputs,
                                                                       n)))
             ++nactive;
@@ -1296,16 +1438,11 @@ xfce_displays_helper_channel_apply (XfceDisplaysHelper *helper,
     if (nactive == 0)
     {
         g_critical ("Stored Xfconf properties disable all outputs, aborting.");
-        goto err_cleanup;
+        return;
     }
 
     /* apply settings */
     xfce_displays_helper_apply_all (helper);
-
-err_cleanup:
-    /* Free the xfconf properties */
-    if (saved_outputs)
-        g_hash_table_destroy (saved_outputs);
 }
 
 
@@ -1316,6 +1453,9 @@ xfce_displays_helper_channel_property_changed (XfconfChannel      *channel,
                                                const GValue       *value,
                                                XfceDisplaysHelper *helper)
 {
+    const gchar *end;
+    gchar       *scheme;
+
     if (G_UNLIKELY (G_VALUE_HOLDS_STRING (value) &&
         g_strcmp0 (property_name, APPLY_SCHEME_PROP) == 0))
     {
@@ -1324,6 +1464,22 @@ xfce_displays_helper_channel_property_changed (XfconfChannel      *channel,
         /* remove the apply property */
         xfconf_channel_reset_property (channel, APPLY_SCHEME_PROP, FALSE);
     }
+    else if (g_strcmp0 (property_name, APPLY_SCHEME_PROP) != 0)
+    {
+        /* a property of "/<scheme>/..." changed, parse this scheme again
+         * when it is applied */
+        if (property_name != NULL && property_name[0] == '/')
+        {
+            end = strchr (property_name + 1, '/');
+            if (end != NULL)
+                scheme = g_strndup (property_name + 1, end - property_name - 1);
+            else
+                scheme = g_strdup (property_name + 1);
+
+            g_hash_table_remove (helper->schemes, scheme);
+            g_free (scheme);
+        }
+    }
 }
 
 
@@ -1375,7 +1531,7 @@ xfce_displays_helper_toggle_internal (gpointer           *power,
     else if (!lvds->active && !lid_is_closed)
     {
         /* re-activate it because the user opened the lid */
-        saved_outputs = xfconf_channel_get_properties (helper->channel, "/" DEFAULT_SCHEME_NAME);
+        saved_outputs = xfce_displays_helper_get_scheme (helper, DEFAULT_SCHEME_NAME);
         if (saved_outputs)
         {
             /* first, ensure the position of the other outputs is correct */
@@ -1387,14 +1543,11 @@ xfce_displays_helper_toggle_internal (gpointer           *power,
                 if (output->id == lvds->id)
                     continue;
 
-                xfce_displays_helper_load_from_xfconf (helper, DEFAULT_SCHEME_NAME,
-                                                       saved_outputs, output);
+                xfce_displays_helper_load_from_xfconf (helper, saved_outputs, output);
             }
 
             /* try to load user saved settings for lvds */
-            active = xfce_displays_helper_load_from_xfconf (helper, DEFAULT_SCHEME_NAME,
-                                                            saved_outputs, lvds);
-            g_hash_table_destroy (saved_outputs);
+            active = xfce_displays_helper_load_from_xfconf (helper, saved_outputs, lvds);
         }
         if (!active)
         {
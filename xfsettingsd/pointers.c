@@ -37,6 +37,9 @@
 #include <glib.h>
 #include <gdk/gdk.h>
 #include <gdk/gdkx.h>
+#ifdef HAVE_XI2
+#include <X11/extensions/XInput2.h>
+#endif /* HAVE_XI2 */
 #include <xfconf/xfconf.h>
 #include <libxfce4util/libxfce4util.h>
 #include <locale.h>
@@ -59,6 +62,18 @@
 static void             xfce_pointers_helper_finalize                 (GObject            *object);
 static void             xfce_pointers_helper_syndaemon_stop           (XfcePointersHelper *helper);
 static void             xfce_pointers_helper_syndaemon_check          (XfcePointersHelper *helper);
+#ifdef HAVE_XI2
+static void             xfce_pointers_helper_touchpad_init            (XfcePointersHelper *helper,
+                                                                       Display            *xdisplay);
+static void             xfce_pointers_helper_touchpad_check           (XfcePointersHelper *helper);
+static void             xfce_pointers_helper_touchpad_set_disabled    (XfcePointersHelper *helper,
+                                                                       gboolean            disabled);
+static void             xfce_pointers_helper_touchpad_remove          (XfcePointersHelper *helper,
+                                                                       XID                 deviceid);
+static GdkFilterReturn  xfce_pointers_helper_touchpad_filter          (GdkXEvent          *xevent,
+                                                                       GdkEvent           *gdk_event,
+                                                                       gpointer            user_data);
+#endif /* HAVE_XI2 */
 static void             xfce_pointers_helper_restore_devices          (XfcePointersHelper *helper,
                                                                        XID                *xid);
 static void             xfce_pointers_helper_channel_property_changed (XfconfChannel      *channel,
@@ -96,6 +111,21 @@ struct _XfcePointersHelper
     GPid           syndaemon_pid;
 #endif
 
+#ifdef HAVE_XI2
+    /* xi opcode, 0 if xi 2.1 raw events are not supported */
+    gint             xi_opcode;
+
+    /* touchpads disabled while typing */
+    GArray          *touchpads;
+    guint            touchpads_disabled : 1;
+    guint            touchpad_timeout_id;
+    guint            touchpad_duration;
+
+    /* to ignore modifiers and modifier+key combos */
+    XModifierKeymap *modmap;
+    gint             modifiers_down;
+#endif /* HAVE_XI2 */
+
 #ifdef DEVICE_HOTPLUGGING
     /* device presence event type */
     gint           device_presence_event_type;
@@ -111,6 +141,21 @@ typedef struct
 }
 XfcePointerData;
 
+#ifdef HAVE_XI2
+typedef struct
+{
+    gint   deviceid;
+
+    /* Synaptics Off or Device Enabled */
+    Atom   prop;
+    guchar disabled_value;
+
+    /* value before the touchpad was disabled */
+    guchar restore_value;
+}
+XfceTouchpad;
+#endif /* HAVE_XI2 */
+
 
 
 G_DEFINE_TYPE (XfcePointersHelper, xfce_pointers_helper, G_TYPE_OBJECT);
@@ -171,6 +216,11 @@ xfce_pointers_helper_init (XfcePointersHelper *helper)
         g_signal_connect (G_OBJECT (helper->channel), "property-changed",
              G_CALLBACK (xfce_pointers_helper_channel_property_changed), helper);
 
+#ifdef HAVE_XI2
+        /* try to watch the keyboard ourselves */
+        xfce_pointers_helper_touchpad_init (helper, xdisplay);
+#endif
+
         /* launch syndaemon if required */
         xfce_pointers_helper_syndaemon_check (helper);
 
@@ -197,6 +247,25 @@ xfce_pointers_helper_init (XfcePointersHelper *helper)
 static void
 xfce_pointers_helper_finalize (GObject *object)
 {
+#ifdef HAVE_XI2
+    XfcePointersHelper *helper = XFCE_POINTERS_HELPER (object);
+
+    if (helper->xi_opcode != 0)
+    {
+        gdk_window_remove_filter (NULL, xfce_pointers_helper_touchpad_filter, helper);
+
+        if (helper->touchpad_timeout_id != 0)
+            g_source_remove (helper->touchpad_timeout_id);
+
+        /* never leave the touchpads disabled */
+        xfce_pointers_helper_touchpad_set_disabled (helper, FALSE);
+        g_array_free (helper->touchpads, TRUE);
+
+        if (helper->modmap != NULL)
+            XFreeModifiermap (helper->modmap);
+    }
+#endif
+
     xfce_pointers_helper_syndaemon_stop (XFCE_POINTERS_HELPER (object));
 
     (*G_OBJECT_CLASS (xfce_pointers_helper_parent_class)->finalize) (object);
@@ -296,6 +365,15 @@ xfce_pointers_helper_syndaemon_check (XfcePointersHelper *helper)
     gchar       *args[] = { "syndaemon", "-i", disable_duration_string, "-K", "-R", NULL };
     GError      *error = NULL;
 
+#ifdef HAVE_XI2
+    /* no need for syndaemon if we see the raw key events */
+    if (helper->xi_opcode != 0)
+    {
+        xfce_pointers_helper_touchpad_check (helper);
+        return;
+    }
+#endif
+
     /* only stop a running daemon */
     if (!xfconf_channel_get_bool (helper->channel, "/DisableTouchpadWhileTyping", FALSE))
         goto start_stop_daemon;
@@ -371,6 +449,340 @@ xfce_pointers_helper_syndaemon_check (XfcePointersHelper *helper)
 
 
 
+#ifdef HAVE_XI2
+static void
+xfce_pointers_helper_touchpad_init (XfcePointersHelper *helper,
+                                    Display            *xdisplay)
+{
+    gint   opcode, event, error;
+    gint   major = 2, minor = 1;
+    Status status;
+
+    /* raw events are delivered to root window listeners since xi 2.1 */
+    if (!XQueryExtension (xdisplay, INAME, &opcode, &event, &error))
+        return;
+
+    gdk_error_trap_push ();
+    status = XIQueryVersion (xdisplay, &major, &minor);
+    if (gdk_error_trap_pop () != 0
+        || status != Success
+        || (major == 2 && minor < 1))
+    {
+        xfsettings_dbg (XFSD_DEBUG_POINTERS, "xi 2.1 not available, "
+                        "using syndaemon for the touchpads");
+        return;
+    }
+
+    helper->xi_opcode = opcode;
+    helper->touchpads = g_array_new (FALSE, FALSE, sizeof (XfceTouchpad));
+
+    gdk_window_add_filter (NULL, xfce_pointers_helper_touchpad_filter, helper);
+}
+
+
+
+static void
+xfce_pointers_helper_touchpad_select (XfcePointersHelper *helper,
+                                      gboolean            watch)
+{
+    Display     *xdisplay = GDK_DISPLAY ();
+    XIEventMask  mask;
+    guchar       bits[XIMaskLen (XI_LASTEVENT)] = { 0, };
+
+    mask.deviceid = XIAllMasterDevices;
+    mask.mask_len = sizeof (bits);
+    mask.mask = bits;
+
+    if (watch)
+    {
+        XISetMask (bits, XI_RawKeyPress);
+        XISetMask (bits, XI_RawKeyRelease);
+    }
+
+    gdk_error_trap_push ();
+    XISelectEvents (xdisplay, RootWindow (xdisplay, DefaultScreen (xdisplay)), &mask, 1);
+    if (gdk_error_trap_pop () != 0)
+        g_warning ("Failed to select the raw key events");
+}
+
+
+
+static void
+xfce_pointers_helper_touchpad_check (XfcePointersHelper *helper)
+{
+    Display        *xdisplay = GDK_DISPLAY ();
+    XIDeviceInfo   *device_list;
+    XfceTouchpad    touchpad;
+    Atom            synaptics_off_prop;
+    Atom            device_enabled_prop;
+#ifdef HAVE_LIBINPUT
+    Atom            libinput_tap_prop;
+#endif
+    Atom           *props;
+    gint            n, ndevices;
+    gint            i, nprops;
+    gboolean        has_synaptics_off;
+    gboolean        is_touchpad;
+    gdouble         disable_duration;
+
+    /* the touchpads are collected again */
+    if (helper->touchpad_timeout_id != 0)
+        g_source_remove (helper->touchpad_timeout_id);
+    xfce_pointers_helper_touchpad_set_disabled (helper, FALSE);
+    g_array_set_size (helper->touchpads, 0);
+    helper->modifiers_down = 0;
+
+    if (helper->modmap != NULL)
+    {
+        XFreeModifiermap (helper->modmap);
+        helper->modmap = NULL;
+    }
+
+    if (xfconf_channel_get_bool (helper->channel, "/DisableTouchpadWhileTyping", FALSE))
+    {
+        disable_duration = xfconf_channel_get_double (helper->channel,
+                                                      "/DisableTouchpadDuration",
+                                                      2.0);
+        helper->touchpad_duration = MAX (disable_duration, 0.1) * 1000;
+
+        synaptics_off_prop = XInternAtom (xdisplay, "Synaptics Off", True);
+        device_enabled_prop = XInternAtom (xdisplay, DEVICE_ENABLED, True);
+#ifdef HAVE_LIBINPUT
+        libinput_tap_prop = XInternAtom (xdisplay, LIBINPUT_PROP_TAP, True);
+#endif
+
+        gdk_error_trap_push ();
+        device_list = XIQueryDevice (xdisplay, XIAllDevices, &ndevices);
+        if (gdk_error_trap_pop () == 0 && device_list != NULL)
+        {
+            for (n = 0; n < ndevices; n++)
+            {
+                if (device_list[n].use != XISlavePointer)
+                    continue;
+
+                /* search for a touchpad, this does not open the device */
+                gdk_error_trap_push ();
+                props = XIListProperties (xdisplay, device_list[n].deviceid, &nprops);
+                if (gdk_error_trap_pop () != 0 || props == NULL)
+                    continue;
+
+                has_synaptics_off = FALSE;
+                is_touchpad = FALSE;
+                for (i = 0; i < nprops; i++)
+                {
+                    if (props[i] == None)
+                        continue;
+                    else if (props[i] == synaptics_off_prop)
+                        has_synaptics_off = TRUE;
+#ifdef HAVE_LIBINPUT
+                    else if (props[i] == libinput_tap_prop)
+                        is_touchpad = TRUE;
+#endif
+                }
+
+                XFree (props);
+
+                touchpad.deviceid = device_list[n].deviceid;
+                if (has_synaptics_off)
+                {
+                    touchpad.prop = synaptics_off_prop;
+                    touchpad.disabled_value = 1;
+                }
+                else if (is_touchpad && device_enabled_prop != None)
+                {
+                    touchpad.prop = device_enabled_prop;
+                    touchpad.disabled_value = 0;
+                }
+                else
+                {
+                    continue;
+                }
+
+                xfsettings_dbg (XFSD_DEBUG_POINTERS, "disable touchpad \"%s\" while typing",
+                                device_list[n].name);
+
+                g_array_append_val (helper->touchpads, touchpad);
+            }
+
+            XIFreeDeviceInfo (device_list);
+        }
+
+        if (helper->touchpads->len > 0)
+            helper->modmap = XGetModifierMapping (xdisplay);
+    }
+
+    /* only receive key events when there is something to disable */
+    xfce_pointers_helper_touchpad_select (helper, helper->touchpads->len > 0);
+}
+
+
+
+static void
+xfce_pointers_helper_touchpad_set_disabled (XfcePointersHelper *helper,
+                                            gboolean            disabled)
+{
+    Display      *xdisplay = GDK_DISPLAY ();
+    XfceTouchpad *touchpad;
+    guint         n;
+    Atom          type;
+    gint          format;
+    gulong        n_items, bytes_after;
+    guchar       *data;
+    guchar        value;
+
+    if (helper->touchpads_disabled == !!disabled)
+        return;
+
+    helper->touchpads_disabled = !!disabled;
+
+    gdk_error_trap_push ();
+
+    for (n = 0; n < helper->touchpads->len; n++)
+    {
+        touchpad = &g_array_index (helper->touchpads, XfceTouchpad, n);
+
+        if (disabled)
+        {
+            /* remember the value, the user might have turned the touchpad off */
+            touchpad->restore_value = !touchpad->disabled_value;
+            if (XIGetProperty (xdisplay, touchpad->deviceid, touchpad->prop, 0, 1, False,
+                               XA_INTEGER, &type, &format, &n_items, &bytes_after, &data) == Success)
+            {
+                if (format == 8 && n_items > 0)
+                    touchpad->restore_value = *data;
+                XFree (data);
+            }
+
+            value = touchpad->disabled_value;
+        }
+        else
+        {
+            value = touchpad->restore_value;
+        }
+
+        XIChangeProperty (xdisplay, touchpad->deviceid, touchpad->prop, XA_INTEGER, 8,
+                          PropModeReplace, &value, 1);
+    }
+
+    if (gdk_error_trap_pop () != 0)
+        g_warning ("Failed to %s the touchpads", disabled ? "disable" : "enable");
+}
+
+
+
+static void
+xfce_pointers_helper_touchpad_remove (XfcePointersHelper *helper,
+                                      XID                 deviceid)
+{
+    guint n;
+
+    /* the device is gone, so its property cannot be restored */
+    for (n = 0; n < helper->touchpads->len; n++)
+    {
+        if (g_array_index (helper->touchpads, XfceTouchpad, n).deviceid == (gint) deviceid)
+        {
+            g_array_remove_index_fast (helper->touchpads, n);
+            break;
+        }
+    }
+}
+
+
+
+static gboolean
+xfce_pointers_helper_touchpad_timeout (gpointer user_data)
+{
+    XfcePointersHelper *helper = XFCE_POINTERS_HELPER (user_data);
+
+    /* the user stopped typing */
+    xfce_pointers_helper_touchpad_set_disabled (helper, FALSE);
+
+    return FALSE;
+}
+
+
+
+static void
+xfce_pointers_helper_touchpad_timeout_destroyed (gpointer user_data)
+{
+    XFCE_POINTERS_HELPER (user_data)->touchpad_timeout_id = 0;
+}
+
+
+
+static gboolean
+xfce_pointers_helper_touchpad_is_modifier (XfcePointersHelper *helper,
+                                           gint                keycode)
+{
+    gint i;
+
+    if (helper->modmap == NULL)
+        return FALSE;
+
+    for (i = 0; i < 8 * helper->modmap->max_keypermod; i++)
+        if (helper->modmap->modifiermap[i] == keycode)
+            return TRUE;
+
+    return FALSE;
+}
+
+
+
+static GdkFilterReturn
+xfce_pointers_helper_touchpad_filter (GdkXEvent *xevent,
+                                      GdkEvent  *gdk_event,
+                                      gpointer   user_data)
+{
+    XGenericEventCookie *cookie = &((XEvent *) xevent)->xcookie;
+    XfcePointersHelper  *helper = XFCE_POINTERS_HELPER (user_data);
+    XIRawEvent          *raw;
+    gboolean             is_modifier;
+
+    if (cookie->type != GenericEvent
+        || cookie->extension != helper->xi_opcode
+        || (cookie->evtype != XI_RawKeyPress
+            && cookie->evtype != XI_RawKeyRelease)
+        || helper->touchpads->len == 0)
+        return GDK_FILTER_CONTINUE;
+
+    if (!XGetEventData (cookie->display, cookie))
+        return GDK_FILTER_CONTINUE;
+
+    raw = cookie->data;
+    is_modifier = xfce_pointers_helper_touchpad_is_modifier (helper, raw->detail);
+
+    if (cookie->evtype == XI_RawKeyPress)
+    {
+        if (is_modifier)
+        {
+            if ((raw->flags & XIKeyRepeat) == 0)
+                helper->modifiers_down++;
+        }
+        else if (helper->modifiers_down == 0)
+        {
+            /* typing, disable the touchpads until the keyboard is idle */
+            xfce_pointers_helper_touchpad_set_disabled (helper, TRUE);
+
+            if (helper->touchpad_timeout_id != 0)
+                g_source_remove (helper->touchpad_timeout_id);
+            helper->touchpad_timeout_id = g_timeout_add_full (G_PRIORITY_DEFAULT, helper->touchpad_duration,
+                                                              xfce_pointers_helper_touchpad_timeout, helper,
+                                                              xfce_pointers_helper_touchpad_timeout_destroyed);
+        }
+    }
+    else if (is_modifier && helper->modifiers_down > 0)
+    {
+        helper->modifiers_down--;
+    }
+
+    XFreeEventData (cookie->display, cookie);
+
+    return GDK_FILTER_CONTINUE;
+}
+#endif /* HAVE_XI2 */
+
+
+
 static gboolean
 xfce_pointers_helper_change_button_mapping_swap (guchar   *buttonmap,
                                                  gshort    num_buttons,
@@ -1166,8 +1578,18 @@ xfce_pointers_helper_event_filter (GdkXEvent *xevent,
         if (dpn_event->devchange == DeviceAdded)
             xfce_pointers_helper_restore_devices (helper, &dpn_event->deviceid);
 
-        /* check if we need to launch syndaemon */
-        xfce_pointers_helper_syndaemon_check (helper);
+#ifdef HAVE_XI2
+        /* do not enable the removed touchpad again in the check below */
+        if (dpn_event->devchange == DeviceRemoved
+            && helper->xi_opcode != 0)
+            xfce_pointers_helper_touchpad_remove (helper, dpn_event->deviceid);
+#endif
+
+        /* check if we need to launch syndaemon, not on enable or disable
+         * notifications, touchpads are disabled while typing */
+        if (dpn_event->devchange == DeviceAdded
+            || dpn_event->devchange == DeviceRemoved)
+            xfce_pointers_helper_syndaemon_check (helper);
     }
 
     return GDK_FILTER_CONTINUE;